@@ -0,0 +1,52 @@
+#ifndef DATETIME_BENCH_H
+#define DATETIME_BENCH_H
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+namespace bench
+{
+
+// Runs f() n times and prints the mean time per call in nanoseconds.
+template <class F>
+double run(const std::string& name, std::size_t n, F f)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        f(i);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    auto ns = std::chrono::duration<double, std::nano>(elapsed).count() / n;
+    std::cout << name << ": " << ns << " ns/op" << std::endl;
+    return ns;
+}
+
+// Runs f() once over a batch of n items and prints the mean time per item.
+template <class F>
+double run_batch(const std::string& name, std::size_t n, F f)
+{
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    auto ns = std::chrono::duration<double, std::nano>(elapsed).count() / n;
+    std::cout << name << ": " << ns << " ns/item" << std::endl;
+    return ns;
+}
+
+// Keeps the optimizer from discarding a computed value.
+template <class T>
+inline void do_not_optimize(const T& value)
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static volatile char sink;
+    sink = *reinterpret_cast<const volatile char*>(&value);
+#endif
+}
+
+} // namespace bench
+
+#endif // DATETIME_BENCH_H
@@ -0,0 +1,69 @@
+#include "bucket.h"
+#include "bench.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+int main() 
+{
+    using namespace datetime;
+    using namespace std::chrono;
+
+    // a year of events, about one every 3 seconds, in the zone of the viewer
+    const std::size_t n = 10000000;
+    const auto zone = date::locate_zone("Europe/Paris");
+    const auto start = date::sys_time<milliseconds>(date::sys_days(date::year(2017)/1/1));
+    std::vector<date::sys_time<milliseconds>> sorted(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        sorted[i] = start + milliseconds(i * 3153 + i * i % 997);
+    }
+    std::vector<date::sys_time<milliseconds>> shuffled(sorted);
+    std::random_shuffle(shuffled.begin(), shuffled.end());
+    std::vector<date::sys_time<milliseconds>> out(n);
+
+    // local day of each event by date.h, back to UTC
+    auto zoned = bench::run_batch("day, make_zoned and floor<days>", n / 10, [&]() {
+        for (std::size_t i = 0; i < n / 10; ++i)
+        {
+            const auto local = date::make_zoned(zone, sorted[i]).get_local_time();
+            const auto day = date::floor<date::days>(local);
+            out[i] = date::make_zoned(zone, day, date::choose::earliest).get_sys_time();
+        }
+        bench::do_not_optimize(out);
+    });
+
+    auto copy = bench::run_batch("memcpy", n, [&]() {
+        std::memcpy(out.data(), sorted.data(), n * sizeof(sorted[0]));
+        bench::do_not_optimize(out);
+    });
+
+    auto column = bench::run_batch("day, floor_column, sorted", n, [&]() {
+        floor_column(sorted.data(), n, zone, BucketUnit::day, out.data());
+        bench::do_not_optimize(out);
+    });
+
+    bench::run_batch("minute, floor_column, sorted", n, [&]() {
+        floor_column(sorted.data(), n, zone, BucketUnit::minute, out.data());
+        bench::do_not_optimize(out);
+    });
+
+    bench::run_batch("month, ceil_column, sorted", n, [&]() {
+        ceil_column(sorted.data(), n, zone, BucketUnit::month, out.data());
+        bench::do_not_optimize(out);
+    });
+
+    bench::run_batch("hour, round_column, sorted", n, [&]() {
+        round_column(sorted.data(), n, zone, BucketUnit::hour, out.data());
+        bench::do_not_optimize(out);
+    });
+
+    bench::run_batch("day, floor_column, shuffled", n, [&]() {
+        floor_column(shuffled.data(), n, zone, BucketUnit::day, out.data());
+        bench::do_not_optimize(out);
+    });
+
+    std::cout << "speedup: " << zoned / column << "x, " << column / copy << " copies" << std::endl;
+}
@@ -0,0 +1,73 @@
+#include "business.h"
+#include "bench.h"
+
+#include <iostream>
+#include <set>
+#include <vector>
+
+int main() 
+{
+    using namespace datetime;
+
+    std::vector<Date> holidays;
+    for (int y = 1990; y <= 2050; ++y)
+    {
+        for (auto md : {date::jan/1, date::may/1, date::may/8, date::jul/14, date::aug/15, date::nov/1,
+                        date::nov/11, date::dec/25})
+        {
+            holidays.push_back(Date(date::year(y)/md));
+        }
+    }
+    const std::set<Date> set(holidays.begin(), holidays.end());
+    const BusinessCalendar cal({date::sat, date::sun}, holidays);
+
+    const std::size_t n = 1000000;
+    std::vector<Date> dates(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        dates[i] = SerialDate(static_cast<std::int32_t>(8000 + i * 7919 % 20000)).date();
+    }
+    std::vector<Date> out(n);
+    const auto day = TimeDelta(date::days(1));
+
+    // T+2, a day at a time
+    auto loop = bench::run_batch("T+2, Date + TimeDelta, weekday() and std::set", n, [&]() {
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            auto d = dates[i];
+            for (int left = 2; left > 0;)
+            {
+                d = d + day;
+                if (d.weekday() < 5 && set.count(d) == 0)
+                {
+                    --left;
+                }
+            }
+            out[i] = d;
+        }
+        bench::do_not_optimize(out);
+    });
+
+    bench::run("T+2, add_business_days", n, [&](std::size_t i) {
+        bench::do_not_optimize(cal.add_business_days(dates[i], 2));
+    });
+
+    auto column = bench::run_batch("T+2, add_business_days column", n, [&]() {
+        cal.add_business_days(dates.data(), n, 2, out.data());
+        bench::do_not_optimize(out);
+    });
+
+    bench::run_batch("T+60, add_business_days column", n, [&]() {
+        cal.add_business_days(dates.data(), n, 60, out.data());
+        bench::do_not_optimize(out);
+    });
+
+    std::vector<Date> ends(dates.rbegin(), dates.rend());
+    std::vector<std::int64_t> counts(n);
+    bench::run_batch("business_days_between column, years apart", n, [&]() {
+        cal.business_days_between(dates.data(), ends.data(), n, counts.data());
+        bench::do_not_optimize(counts);
+    });
+
+    std::cout << "speedup: " << loop / column << "x" << std::endl;
+}
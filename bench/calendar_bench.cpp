@@ -0,0 +1,114 @@
+#include "calendar.h"
+#include "bench.h"
+
+#include <iostream>
+#include <vector>
+
+int main() 
+{
+    using namespace datetime;
+
+    // 100M conversions, 100 passes over 1M days spread over 1900-2100
+    const std::size_t n = 1000000;
+    const std::size_t passes = 100;
+    std::vector<std::int32_t> days(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        days[i] = static_cast<std::int32_t>(-25567 + (i * 7919) % 73049);
+    }
+    std::vector<std::int32_t> year(n), back(n);
+    std::vector<unsigned char> month(n), day(n);
+
+    auto scalar = bench::run_batch("date::year_month_day from sys_days", n * passes, [&]() {
+        for (std::size_t pass = 0; pass < passes; ++pass)
+        {
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                date::year_month_day ymd{date::sys_days{date::days{days[i]}}};
+                year[i] = static_cast<int>(ymd.year());
+                month[i] = static_cast<unsigned char>(static_cast<unsigned>(ymd.month()));
+                day[i] = static_cast<unsigned char>(static_cast<unsigned>(ymd.day()));
+            }
+            bench::do_not_optimize(year);
+        }
+    });
+
+    auto batch = bench::run_batch("civil_from_days", n * passes, [&]() {
+        for (std::size_t pass = 0; pass < passes; ++pass)
+        {
+            civil_from_days(days.data(), n, year.data(), month.data(), day.data());
+            bench::do_not_optimize(year);
+        }
+    });
+
+    auto scalar_back = bench::run_batch("sys_days from date::year_month_day", n * passes, [&]() {
+        for (std::size_t pass = 0; pass < passes; ++pass)
+        {
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                date::year_month_day ymd{date::year{year[i]}, date::month{month[i]}, date::day{day[i]}};
+                back[i] = date::sys_days{ymd}.time_since_epoch().count();
+            }
+            bench::do_not_optimize(back);
+        }
+    });
+
+    auto batch_back = bench::run_batch("days_from_civil", n * passes, [&]() {
+        for (std::size_t pass = 0; pass < passes; ++pass)
+        {
+            days_from_civil(year.data(), month.data(), day.data(), n, back.data());
+            bench::do_not_optimize(back);
+        }
+    });
+
+    // ISO week keys, from the Thursday of the week by date.h
+    std::vector<unsigned char> week(n), weekday(n);
+    auto scalar_iso = bench::run_batch("ISO weeks by date.h", n * passes, [&]() {
+        for (std::size_t pass = 0; pass < passes; ++pass)
+        {
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                const date::sys_days d{date::days{days[i]}};
+                const auto w = date::weekday(d);
+                const auto thursday = d - (w - date::mon) + date::days(3);
+                const auto y = date::year_month_day(thursday).year();
+                year[i] = static_cast<int>(y);
+                week[i] = static_cast<unsigned char>((thursday - date::sys_days(y/date::jan/1)).count() / 7 + 1);
+                weekday[i] = static_cast<unsigned char>((w - date::mon).count() + 1);
+            }
+            bench::do_not_optimize(week);
+        }
+    });
+
+    bench::run_batch("SerialDate::isocalendar", n * passes, [&]() {
+        for (std::size_t pass = 0; pass < passes; ++pass)
+        {
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                const auto iso = SerialDate(days[i]).isocalendar();
+                year[i] = iso.year;
+                week[i] = static_cast<unsigned char>(iso.week);
+                weekday[i] = static_cast<unsigned char>(iso.weekday);
+            }
+            bench::do_not_optimize(week);
+        }
+    });
+
+    auto batch_iso = bench::run_batch("iso_from_days", n * passes, [&]() {
+        for (std::size_t pass = 0; pass < passes; ++pass)
+        {
+            iso_from_days(days.data(), n, year.data(), week.data(), weekday.data());
+            bench::do_not_optimize(week);
+        }
+    });
+
+#if defined(__AVX512F__)
+    const char* isa = "AVX-512";
+#elif defined(__AVX2__)
+    const char* isa = "AVX2";
+#else
+    const char* isa = "scalar";
+#endif
+    std::cout << "speedup (" << isa << "): " << scalar / batch << "x to civil, "
+              << scalar_back / batch_back << "x to days, " << scalar_iso / batch_iso << "x to ISO weeks" << std::endl;
+}
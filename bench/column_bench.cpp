@@ -0,0 +1,51 @@
+#include "bulk.h"
+#include "bench.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main() 
+{
+    using namespace datetime;
+    using namespace std::chrono;
+
+    const std::size_t n = 1000000;
+    std::vector<date::sys_time<microseconds>> times(n);
+    auto start = date::sys_days(date::year(2017)/1/1);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        times[i] = start + microseconds(i * 7919123);
+    }
+
+    std::string csv;
+    auto naive = bench::run_batch("date::format per row appended to a std::string", n, [&]() {
+        csv.clear();
+        for (auto& t : times)
+        {
+            csv += date::format("%Y-%m-%dT%H:%M:%S", t);
+            csv += '\n';
+        }
+        bench::do_not_optimize(csv);
+    });
+
+    Format format("%Y-%m-%dT%H:%M:%S");
+    TextColumn text;
+    auto column = bench::run_batch("strftime_column", n, [&]() {
+        strftime_column(times.data(), n, format, nullptr, '\n', text);
+        bench::do_not_optimize(text);
+    });
+
+    ThreadPool pool;
+    auto parallel = bench::run_batch("strftime_column with a ThreadPool", n, [&]() {
+        strftime_column(times.data(), n, format, nullptr, '\n', text, pool);
+        bench::do_not_optimize(text);
+    });
+
+    bench::run_batch("TextColumn::join", n, [&]() {
+        bench::do_not_optimize(text.join());
+    });
+
+    std::cout << "speedup: " << naive / column << "x, " << naive / parallel << "x with "
+              << pool.size() << " threads" << std::endl;
+}
@@ -0,0 +1,43 @@
+#include "datetime.h"
+#include "bench.h"
+
+#include <iostream>
+
+int main() 
+{
+    using namespace datetime;
+
+    const std::size_t n = 200000;
+    auto d = Date(date::year(2017)/6/21);
+
+    auto facet = bench::run("strftime(\"%c\") (locale facets)", n, [&](std::size_t i) {
+        auto s = (d + TimeDelta(date::days(i % 1000))).strftime("%c");
+        bench::do_not_optimize(s);
+    });
+
+    auto c_names = bench::run("ctime() (C locale names)", n, [&](std::size_t i) {
+        auto s = (d + TimeDelta(date::days(i % 1000))).ctime();
+        bench::do_not_optimize(s);
+    });
+
+    std::cout << "speedup: " << facet / c_names << "x" << std::endl;
+
+    // same comparison without the cost of building a new stream for every call
+    std::ostringstream os;
+    auto sd = date::sys_days(d.year_month_day());
+
+    auto facet_stream = bench::run("to_stream(\"%c\") reused stream (locale facets)", n, [&](std::size_t i) {
+        os.str("");
+        date::to_stream(os, "%c", sd + date::days(i % 1000));
+        bench::do_not_optimize(os);
+    });
+
+    os << date::c_locale_names;
+    auto c_names_stream = bench::run("to_stream(\"%c\") reused stream (C locale names)", n, [&](std::size_t i) {
+        os.str("");
+        date::to_stream(os, "%c", sd + date::days(i % 1000));
+        bench::do_not_optimize(os);
+    });
+
+    std::cout << "speedup: " << facet_stream / c_names_stream << "x" << std::endl;
+}
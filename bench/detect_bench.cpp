@@ -0,0 +1,47 @@
+#include "detect.h"
+#include "bench.h"
+
+#include <iostream>
+#include <sstream>
+
+int main() 
+{
+    using namespace datetime;
+    using namespace std::chrono;
+
+    const std::size_t n = 200000;
+    std::vector<std::string> column(n);
+    auto start = date::sys_days(date::year(2017)/1/1);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        column[i] = date::format("%d/%m/%Y %H:%M:%S", start + seconds(3 * 3600 + 7) * i);
+    }
+    std::vector<date::sys_seconds> out(n);
+    std::unique_ptr<bool[]> errors(new bool[n]);
+
+    // guessing per row: try the formats in turn until one parses
+    const char* guesses[] = {"%Y-%m-%dT%H:%M:%S", "%Y-%m-%d %H:%M:%S", "%m/%d/%Y %H:%M:%S", "%d/%m/%Y %H:%M:%S"};
+    auto guess = bench::run("date::parse with 4 guessed formats per row", n, [&](std::size_t i) {
+        for (auto f : guesses)
+        {
+            std::istringstream ss(column[i]);
+            ss >> date::parse(f, out[i]);
+            if (!ss.fail() && ss.peek() == EOF)
+            {
+                break;
+            }
+        }
+    });
+
+    DetectedFormat format;
+    bench::run_batch("detect_format on 1000 rows", 1000, [&] {
+        format = detect_format(column.data(), n);
+    });
+    std::cout << "detected \"" << format.str() << "\"" << std::endl;
+
+    auto detected = bench::run_batch("parse_column with the detected format", n, [&] {
+        parse_column(column.data(), n, format, nullptr, out.data(), errors.get());
+    });
+
+    std::cout << "speedup: " << guess / detected << "x" << std::endl;
+}
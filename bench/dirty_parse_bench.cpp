@@ -0,0 +1,65 @@
+#include "datetime.h"
+#include "bench.h"
+
+#include <iostream>
+
+int main() 
+{
+    using namespace datetime;
+    using namespace std::chrono;
+
+    // 5% of the rows are malformed
+    const std::size_t n = 200000;
+    std::vector<std::string> column(n);
+    auto start = date::sys_days(date::year(2017)/1/1);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        column[i] = date::format("%Y-%m-%d %H:%M:%S", start + seconds(7 * i));
+        if (i % 20 == 0)
+        {
+            column[i][5] = 'x';
+        }
+    }
+    const std::string format = "%Y-%m-%d %H:%M:%S";
+    std::size_t failed = 0;
+
+    auto exceptions = bench::run("strptime with try/catch", n, [&](std::size_t i) {
+        try
+        {
+            auto dt = DateTime<>::strptime(column[i], format);
+            bench::do_not_optimize(dt);
+        }
+        catch (const std::exception&)
+        {
+            ++failed;
+        }
+    });
+
+    auto codes = bench::run("strptime with std::error_code", n, [&](std::size_t i) {
+        std::error_code ec;
+        auto dt = DateTime<>::strptime(column[i], format, ec);
+        bench::do_not_optimize(dt);
+        failed += !!ec;
+    });
+
+    Format compiled(format);
+    auto zone = try_locate_zone("Europe/Paris");
+    auto parse = [&](const std::string& s) {
+        std::error_code ec;
+        auto dt = DateTime<>::strptime(s.data(), s.data() + s.size(), compiled, zone, ec);
+        bench::do_not_optimize(dt);
+        failed += !!ec;
+    };
+    auto compiled_codes = bench::run("strptime(Format, zone) with std::error_code", n, [&](std::size_t i) {
+        parse(column[i]);
+    });
+
+    std::cout << "speedup: " << exceptions / codes << "x error_code, "
+              << exceptions / compiled_codes << "x compiled format" << std::endl;
+
+    // cost of one row, accepted or rejected
+    bench::run("  valid row", n, [&](std::size_t) { parse(column[1]); });
+    bench::run("  malformed row", n, [&](std::size_t) { parse(column[0]); });
+
+    std::cout << "(" << failed << " failures)" << std::endl;
+}
@@ -0,0 +1,45 @@
+#include "bulk.h"
+#include "bench.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main() 
+{
+    using namespace datetime;
+    using namespace std::chrono;
+
+    const std::size_t n = 1000000;
+    std::vector<std::string> column;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        auto s = std::to_string(1497252490 + i * 37) + "." + std::to_string(100000000 + i * 7919 % 900000000);
+        column.push_back(s);
+    }
+
+    auto floating = bench::run("strtod then fromtimestamp(double) arithmetic", n, [&](std::size_t i) {
+        // what fromtimestamp(Rep) does, without the zone lookup
+        double t = std::strtod(column[i].c_str(), nullptr);
+        auto nanos = static_cast<unsigned>(1e9*std::fmod(t, 1));
+        auto tp = system_clock::from_time_t(static_cast<std::time_t>(t)) + nanoseconds(nanos);
+        bench::do_not_optimize(tp);
+    });
+
+    date::sys_time<nanoseconds> tp;
+    auto exact = bench::run("parse_epoch", n, [&](std::size_t i) {
+        const std::string& s = column[i];
+        bench::do_not_optimize(parse_epoch(s.data(), s.data() + s.size(), tp));
+    });
+
+    std::vector<date::sys_time<nanoseconds>> out(n);
+    std::unique_ptr<bool[]> errors(new bool[n]);
+    auto batch = bench::run_batch("fromtimestamp_column", n, [&]() {
+        bench::do_not_optimize(fromtimestamp_column(column.data(), n, seconds(1), out.data(), errors.get()));
+    });
+
+    std::cout << "speedup: " << floating / exact << "x parse_epoch, " << floating / batch << "x column" << std::endl;
+}
@@ -0,0 +1,40 @@
+#include "datetime.h"
+#include "bench.h"
+
+#include <iostream>
+#include <sstream>
+
+int main() 
+{
+    using namespace datetime;
+    using namespace std::chrono;
+
+    const std::size_t n = 1000000;
+    auto start = Date(date::year(2017)/1/1);
+
+    auto stream = bench::run("operator<< into a new std::ostringstream", n, [&](std::size_t i) {
+        std::ostringstream os;
+        os << start + TimeDelta(date::days(i % 5000)) << ',' << Time(microseconds(i * 86399));
+        auto s = os.str();
+        bench::do_not_optimize(s);
+    });
+
+    std::string buffer;
+    auto reused = bench::run("format_to into a reused std::string", n, [&](std::size_t i) {
+        buffer.clear();
+        format_to(std::back_inserter(buffer), start + TimeDelta(date::days(i % 5000)));
+        buffer += ',';
+        format_to(std::back_inserter(buffer), Time(microseconds(i * 86399)));
+        bench::do_not_optimize(buffer);
+    });
+
+    char buf[64];
+    auto fixed = bench::run("format_to_n into a fixed array", n, [&](std::size_t i) {
+        auto r = format_to_n(buf, sizeof(buf), start + TimeDelta(date::days(i % 5000)));
+        *r.out++ = ',';
+        r = format_to_n(r.out, buf + sizeof(buf) - r.out, Time(microseconds(i * 86399)));
+        bench::do_not_optimize(r);
+    });
+
+    std::cout << "speedup: " << stream / reused << "x std::string, " << stream / fixed << "x array" << std::endl;
+}
@@ -0,0 +1,55 @@
+#include "httpdate.h"
+#include "bench.h"
+
+#include <iostream>
+#include <sstream>
+
+int main() 
+{
+    using namespace datetime;
+    using namespace std::chrono;
+
+    const std::size_t n = 1000000;
+    auto start = date::sys_days(date::year(2017)/1/1);
+
+    auto stream = bench::run("date::format(\"%a, %d %b %Y %H:%M:%S GMT\")", n, [&](std::size_t i) {
+        auto s = date::format("%a, %d %b %Y %H:%M:%S GMT", start + seconds(7 * i));
+        bench::do_not_optimize(s);
+    });
+
+    char buf[http_date_length];
+    auto codec = bench::run("http_date_to_chars", n, [&](std::size_t i) {
+        auto end = http_date_to_chars(buf, buf + sizeof(buf), start + seconds(7 * i));
+        bench::do_not_optimize(end);
+    });
+
+    std::cout << "speedup: " << stream / codec << "x" << std::endl;
+
+    HttpDateCache cache;
+    char cached[TimeCache::max_length];
+    bench::run("HttpDateCache::copy (current time)", n, [&](std::size_t) {
+        auto len = cache.copy(cached);
+        bench::do_not_optimize(len);
+    });
+
+    std::string header = "Sun, 06 Nov 1994 08:49:37 GMT";
+    date::sys_seconds tp;
+    auto stream_parse = bench::run("date::parse of an IMF-fixdate", n, [&](std::size_t) {
+        std::istringstream ss(header);
+        ss >> date::parse("%a, %d %b %Y %H:%M:%S GMT", tp);
+        bench::do_not_optimize(tp);
+    });
+
+    auto codec_parse = bench::run("parse_http_date", n, [&](std::size_t) {
+        auto end = parse_http_date(header.data(), header.data() + header.size(), tp);
+        bench::do_not_optimize(end);
+    });
+
+    std::cout << "speedup: " << stream_parse / codec_parse << "x" << std::endl;
+
+    std::string bad = "Sun, 06 Nov 1994 08:49:37 UTC";
+    bench::run("parse_http_date, rejected input", n, [&](std::size_t) {
+        auto end = parse_http_date(bad.data(), bad.data() + bad.size(), tp);
+        bench::do_not_optimize(end);
+    });
+}
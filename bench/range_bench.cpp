@@ -0,0 +1,53 @@
+#include "range.h"
+#include "bench.h"
+
+#include <iostream>
+#include <vector>
+
+int main() 
+{
+    using namespace datetime;
+
+    const std::size_t n = 10000000;
+    const auto start = Date(date::year(2017)/1/1);
+    const auto step = TimeDelta(date::days(1));
+
+    std::vector<Date> dates;
+    auto vector = bench::run_batch("vector filled with d + TimeDelta", n, [&]() {
+        dates.clear();
+        dates.reserve(n);
+        auto d = start;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            dates.push_back(d);
+            d = d + step;
+        }
+        bench::do_not_optimize(dates);
+    });
+
+    auto range = date_range(start, start + TimeDelta(date::days(n - 1)));
+    auto lazy = bench::run_batch("date_range days, iterated", n, [&]() {
+        unsigned sum = 0;
+        for (auto d : range)
+        {
+            sum += static_cast<unsigned>(d.day());
+        }
+        bench::do_not_optimize(sum);
+    });
+
+    bench::run("date_range days, operator[]", n, [&](std::size_t i) {
+        bench::do_not_optimize(range[i]);
+    });
+
+    auto month_ends = date_range(Date(date::year(-30000)/1/31), Date(date::year(30000)/12/31), date::months(1));
+    bench::run_batch("date_range month ends, iterated", month_ends.size(), [&]() {
+        unsigned sum = 0;
+        for (auto d : month_ends)
+        {
+            sum += static_cast<unsigned>(d.day());
+        }
+        bench::do_not_optimize(sum);
+    });
+
+    std::cout << "speedup: " << vector / lazy << "x" << std::endl;
+}
@@ -0,0 +1,66 @@
+#include "relativedelta.h"
+#include "bench.h"
+
+#include <iostream>
+#include <vector>
+
+int main() 
+{
+    using namespace datetime;
+
+    const std::size_t n = 10000000;
+    std::vector<std::int32_t> days(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        days[i] = static_cast<std::int32_t>(i % 30000) + 10000;
+    }
+    std::vector<std::int32_t> out(n);
+
+    // next billing date: same day next month, clamped, by hand through year_month_day
+    auto scalar = bench::run_batch("month + 1 through year_month_day", n, [&]() {
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            auto ymd = date::year_month_day(date::sys_days(date::days(days[i])));
+            auto next = ymd + date::months(1);
+            if (!next.ok())
+            {
+                next = date::year_month_day_last(next.year(), date::month_day_last(next.month()));
+            }
+            out[i] = static_cast<std::int32_t>(date::sys_days(next).time_since_epoch().count());
+        }
+        bench::do_not_optimize(out);
+    });
+
+    const RelativeDelta month(date::months(1));
+    bench::run("month + 1, SerialDate + RelativeDelta", n, [&](std::size_t i) {
+        bench::do_not_optimize(SerialDate(days[i]) + month);
+    });
+
+    auto column = bench::run_batch("month + 1, add_column", n, [&]() {
+        add_column(days.data(), n, month, out.data());
+        bench::do_not_optimize(out);
+    });
+
+    bench::run_batch("end of next month, add_column", n, [&]() {
+        add_column(days.data(), n, RelativeDelta(date::months(1), date::last), out.data());
+        bench::do_not_optimize(out);
+    });
+
+    bench::run_batch("third Wednesday of next month, add_column", n, [&]() {
+        add_column(days.data(), n, RelativeDelta(date::months(1), date::wed[3]), out.data());
+        bench::do_not_optimize(out);
+    });
+
+    std::vector<Date> dates(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        dates[i] = SerialDate(days[i]).date();
+    }
+    std::vector<Date> moved(n);
+    bench::run_batch("month + 1, add_column of Date", n, [&]() {
+        add_column(dates.data(), n, month, moved.data());
+        bench::do_not_optimize(moved);
+    });
+
+    std::cout << "speedup: " << scalar / column << "x" << std::endl;
+}
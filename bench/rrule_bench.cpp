@@ -0,0 +1,63 @@
+#include "rrule.h"
+#include "bench.h"
+
+#include <iostream>
+#include <vector>
+
+int main() 
+{
+    using namespace datetime;
+
+    const std::size_t n = 12 * 7000;   // months from 2000
+    const auto start = Date(date::year(2000)/1/1);
+    const auto step = TimeDelta(date::days(1));
+    std::vector<Date> out;
+    out.reserve(n);
+
+    // every 2nd Tuesday, by testing every day
+    auto loop = bench::run_batch("2nd Tuesdays, Date + TimeDelta and weekday()", n, [&]() {
+        out.clear();
+        auto d = start;
+        while (out.size() < n)
+        {
+            if (d.weekday() == 1 && (static_cast<unsigned>(d.day()) - 1) / 7 == 1)
+            {
+                out.push_back(d);
+            }
+            d = d + step;
+        }
+        bench::do_not_optimize(out);
+    });
+
+    auto second_tuesdays = RRule("FREQ=MONTHLY;BYDAY=2TU").expand(start);
+    auto rule = bench::run_batch("2nd Tuesdays, RRule", n, [&]() {
+        out.clear();
+        for (auto it = second_tuesdays.begin(); out.size() < n; ++it)
+        {
+            out.push_back(*it);
+        }
+        bench::do_not_optimize(out);
+    });
+
+    auto last_weekdays = RRule("FREQ=MONTHLY;BYDAY=MO,TU,WE,TH,FR;BYSETPOS=-1").expand(start);
+    bench::run_batch("last weekdays of months, RRule", n, [&]() {
+        out.clear();
+        for (auto it = last_weekdays.begin(); out.size() < n; ++it)
+        {
+            out.push_back(*it);
+        }
+        bench::do_not_optimize(out);
+    });
+
+    auto weekdays = RRule("FREQ=DAILY;BYDAY=MO,TU,WE,TH,FR").expand(start);
+    bench::run_batch("weekdays, RRule", n, [&]() {
+        out.clear();
+        for (auto it = weekdays.begin(); out.size() < n; ++it)
+        {
+            out.push_back(*it);
+        }
+        bench::do_not_optimize(out);
+    });
+
+    std::cout << "speedup: " << loop / rule << "x" << std::endl;
+}
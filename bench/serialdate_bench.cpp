@@ -0,0 +1,64 @@
+#include "datetime.h"
+#include "bench.h"
+
+#include <iostream>
+#include <vector>
+
+int main() 
+{
+    using namespace datetime;
+
+    const std::size_t n = 10000000;
+    const auto step = TimeDelta(date::days(1));
+    auto start = date::year(2017)/1/1;
+
+    std::vector<Date> dates(n, Date(start));
+    auto date_add = bench::run_batch("Date + TimeDelta", n, [&]() {
+        for (std::size_t i = 1; i < n; ++i)
+        {
+            dates[i] = dates[i - 1] + step;
+        }
+        bench::do_not_optimize(dates);
+    });
+
+    std::vector<SerialDate> serials(n, SerialDate(start));
+    auto serial_add = bench::run_batch("SerialDate + TimeDelta", n, [&]() {
+        for (std::size_t i = 1; i < n; ++i)
+        {
+            serials[i] = serials[i - 1] + step;
+        }
+        bench::do_not_optimize(serials);
+    });
+
+    // comparisons through the difference, as Date has no operator<
+    auto cutoff = Date(date::year(2030)/1/1);
+    std::size_t count = 0;
+    auto date_cmp = bench::run_batch("Date difference to a cutoff", n, [&]() {
+        for (auto& d : dates)
+        {
+            count += (d - cutoff).days() < 0;
+        }
+        bench::do_not_optimize(count);
+    });
+
+    auto serial_cutoff = SerialDate(cutoff);
+    auto serial_cmp = bench::run_batch("SerialDate < cutoff", n, [&]() {
+        for (auto& d : serials)
+        {
+            count += d < serial_cutoff;
+        }
+        bench::do_not_optimize(count);
+    });
+
+    bench::run_batch("SerialDate::year_month_day", n, [&]() {
+        unsigned sum = 0;
+        for (auto& d : serials)
+        {
+            sum += static_cast<unsigned>(d.year_month_day().day());
+        }
+        bench::do_not_optimize(sum);
+    });
+
+    std::cout << "speedup: " << date_add / serial_add << "x addition, " << date_cmp / serial_cmp
+              << "x comparison, " << sizeof(Date) << " vs " << sizeof(SerialDate) << " bytes" << std::endl;
+}
@@ -0,0 +1,94 @@
+#include "stats.h"
+#include "bench.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+int main() 
+{
+    using namespace datetime;
+    using namespace std::chrono;
+
+    // 100M latencies, 100 passes over 1M values between 0 and 10 s
+    const std::size_t n = 1000000;
+    const std::size_t passes = 100;
+    std::vector<TimeDelta> column;
+    column.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        column.push_back(TimeDelta(microseconds(static_cast<std::int64_t>((i * 7919123) % 10000000))));
+    }
+
+    auto scalar = bench::run_batch("operator+ loop, extremes, two pass variance", n * passes, [&]() {
+        for (std::size_t pass = 0; pass < passes; ++pass)
+        {
+            auto sum = TimeDelta(microseconds(0));
+            auto lo = column[0].to_duration(), hi = lo;
+            for (const auto& x : column)
+            {
+                sum = sum + x;
+                lo = std::min(lo, x.to_duration());
+                hi = std::max(hi, x.to_duration());
+            }
+            double mean = static_cast<double>(sum.to_duration().count()) / n;
+            double m2 = 0;
+            for (const auto& x : column)
+            {
+                double d = static_cast<double>(x.to_duration().count()) - mean;
+                m2 += d * d;
+            }
+            bench::do_not_optimize(sum);
+            bench::do_not_optimize(m2 + static_cast<double>((hi - lo).count()));
+        }
+    });
+
+    auto batch = bench::run_batch("describe_column", n * passes, [&]() {
+        for (std::size_t pass = 0; pass < passes; ++pass)
+        {
+            bench::do_not_optimize(describe_column(column.data(), n));
+        }
+    });
+
+    ThreadPool pool;
+    auto parallel = bench::run_batch("describe_column with a ThreadPool", n * passes, [&]() {
+        for (std::size_t pass = 0; pass < passes; ++pass)
+        {
+            bench::do_not_optimize(describe_column(column.data(), n, pool));
+        }
+    });
+
+    // percentiles: 10 passes
+    std::vector<microseconds> copy(n, microseconds(0));
+    auto select = bench::run_batch("p50, p99, p99.9 with std::nth_element", n * 10, [&]() {
+        for (std::size_t pass = 0; pass < 10; ++pass)
+        {
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                copy[i] = column[i].to_duration();
+            }
+            for (double p : {0.5, 0.99, 0.999})
+            {
+                auto k = copy.begin() + static_cast<std::ptrdiff_t>(p * (n - 1));
+                std::nth_element(copy.begin(), k, copy.end());
+                bench::do_not_optimize(*k);
+            }
+        }
+    });
+
+    auto histogram = bench::run_batch("p50, p99, p99.9 with DeltaHistogram", n * 10, [&]() {
+        for (std::size_t pass = 0; pass < 10; ++pass)
+        {
+            DeltaHistogram h;
+            h.add(column.data(), n);
+            for (double p : {50.0, 99.0, 99.9})
+            {
+                bench::do_not_optimize(h.percentile(p));
+            }
+        }
+    });
+
+    std::cout << "speedup: " << scalar / batch << "x describe_column, " << scalar / parallel
+              << "x with " << pool.size() << " threads, " << select / histogram << "x percentiles" << std::endl;
+}
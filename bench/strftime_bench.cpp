@@ -0,0 +1,43 @@
+#include "datetime.h"
+#include "bench.h"
+
+#include <iostream>
+
+int main() 
+{
+    using namespace datetime;
+    using namespace std::chrono;
+
+    const std::size_t n = 1000000;
+
+    auto stream = bench::run("Time::strftime(\"%H:%M:%S.%f\") (std::string)", n, [&](std::size_t i) {
+        auto s = Time(microseconds(i * 86399)).strftime("%H:%M:%S.%f");
+        bench::do_not_optimize(s);
+    });
+
+    Format format("%H:%M:%S.%f");
+    char buf[32];
+    auto compiled = bench::run("Time::strftime(buf, Format) (caller buffer)", n, [&](std::size_t i) {
+        auto end = Time(microseconds(i * 86399)).strftime(buf, buf + sizeof(buf), format);
+        bench::do_not_optimize(end);
+    });
+
+    std::cout << "speedup: " << stream / compiled << "x" << std::endl;
+
+    std::ostringstream os;
+    os << date::c_locale_names;
+    auto tp = date::local_days(date::year(2017)/6/21);
+    auto to_stream = bench::run("to_stream(\"%F %T\") reused stream", n, [&](std::size_t i) {
+        os.str("");
+        date::to_stream(os, "%F %T", tp + microseconds(i * 86399));
+        bench::do_not_optimize(os);
+    });
+
+    Format iso("%F %T");
+    auto format_buf = bench::run("Format(\"%F %T\").format(buf)", n, [&](std::size_t i) {
+        auto end = iso.format(buf, buf + sizeof(buf), tp + microseconds(i * 86399));
+        bench::do_not_optimize(end);
+    });
+
+    std::cout << "speedup: " << to_stream / format_buf << "x" << std::endl;
+}
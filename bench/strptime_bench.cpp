@@ -0,0 +1,39 @@
+#include "bulk.h"
+#include "bench.h"
+
+#include <iostream>
+#include <sstream>
+
+int main() 
+{
+    using namespace datetime;
+    using namespace std::chrono;
+
+    const std::size_t n = 1000000;
+    std::vector<std::string> column(n);
+    auto start = date::sys_days(date::year(2017)/1/1);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        column[i] = date::format("%Y-%m-%d %H:%M:%S", start + seconds(7 * i));
+    }
+    std::vector<date::sys_seconds> out(n);
+    std::unique_ptr<bool[]> errors(new bool[n]);
+
+    auto stream = bench::run("date::parse per row", n, [&](std::size_t i) {
+        std::istringstream ss(column[i]);
+        ss >> date::parse("%Y-%m-%d %H:%M:%S", out[i]);
+        errors[i] = ss.fail();
+    });
+
+    Format format("%Y-%m-%d %H:%M:%S");
+    auto single = bench::run_batch("strptime_column, 1 thread", n, [&] {
+        strptime_column(column.data(), n, format, nullptr, out.data(), errors.get());
+    });
+
+    ThreadPool pool;
+    auto parallel = bench::run_batch("strptime_column, " + std::to_string(pool.size()) + " threads", n, [&] {
+        strptime_column(column.data(), n, format, nullptr, out.data(), errors.get(), pool);
+    });
+
+    std::cout << "speedup: " << stream / single << "x single, " << stream / parallel << "x pool" << std::endl;
+}
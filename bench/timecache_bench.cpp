@@ -0,0 +1,27 @@
+#include "timecache.h"
+#include "bench.h"
+
+#include <iostream>
+
+int main() 
+{
+    using namespace datetime;
+
+    const std::size_t n = 1000000;
+
+    auto formatted = bench::run("date::format(now) per call", n, [&](std::size_t) {
+        auto s = date::format("%Y-%m-%dT%H:%M:%S", date::floor<std::chrono::microseconds>(std::chrono::system_clock::now()));
+        bench::do_not_optimize(s);
+    });
+
+    TimeCache cache;
+    auto id = cache.add_format("%Y-%m-%dT%H:%M:%S", 6);
+    char buf[TimeCache::max_length];
+    auto cached = bench::run("TimeCache::copy", n, [&](std::size_t) {
+        auto len = cache.copy(id, buf);
+        bench::do_not_optimize(len);
+        bench::do_not_optimize(buf);
+    });
+
+    std::cout << "speedup: " << formatted / cached << "x" << std::endl;
+}
@@ -0,0 +1,83 @@
+#include "datetime.h"
+#include "bench.h"
+
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+int main() 
+{
+    using namespace datetime;
+    using namespace std::chrono;
+
+    const std::size_t n = 1000000;
+    auto delta = [](std::size_t i) { return TimeDelta(microseconds(static_cast<std::int64_t>(i) * 7919123 - 3000000000000)); };
+
+    auto stream = bench::run("operator<< into a new std::ostringstream", n, [&](std::size_t i) {
+        std::ostringstream os;
+        os << delta(i);
+        auto s = os.str();
+        bench::do_not_optimize(s);
+    });
+
+    char buf[TimeDelta::max_chars];
+    auto python = bench::run("to_chars python", n, [&](std::size_t i) {
+        bench::do_not_optimize(delta(i).to_chars(buf, buf + sizeof(buf)));
+    });
+    auto iso = bench::run("to_chars iso8601", n, [&](std::size_t i) {
+        bench::do_not_optimize(delta(i).to_chars(buf, buf + sizeof(buf), TimeDelta::Style::iso8601));
+    });
+    bench::run("to_chars compact", n, [&](std::size_t i) {
+        bench::do_not_optimize(delta(i).to_chars(buf, buf + sizeof(buf), TimeDelta::Style::compact));
+    });
+
+    std::vector<std::string> texts;
+    for (std::size_t i = 0; i < 1000; ++i)
+    {
+        texts.push_back(delta(i * 1009).str(TimeDelta::Style::iso8601));
+    }
+    auto out = TimeDelta(microseconds(0));
+    bench::run("from_chars iso8601", n, [&](std::size_t i) {
+        const std::string& s = texts[i % texts.size()];
+        bench::do_not_optimize(TimeDelta::from_chars(s.data(), s.data() + s.size(), out, TimeDelta::Style::iso8601));
+    });
+
+    std::vector<TimeDelta> column;
+    column.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        column.push_back(delta(i));
+    }
+    bench::run_batch("sum with operator+", n, [&] {
+        auto total = TimeDelta(microseconds(0));
+        for (const auto& x : column)
+        {
+            total = total + x;
+        }
+        bench::do_not_optimize(total);
+    });
+    bench::run_batch("sum into nanoseconds, mixed precisions", n, [&] {
+        auto total = BasicTimeDelta<nanoseconds>(nanoseconds(0));
+        for (const auto& x : column)
+        {
+            total = total + x;
+        }
+        bench::do_not_optimize(total);
+    });
+    const auto bucket = TimeDelta(minutes(15));
+    bench::run("floor_div and % into 15 min buckets", n, [&](std::size_t i) {
+        bench::do_not_optimize(floor_div(column[i], bucket));
+        bench::do_not_optimize(column[i] % bucket);
+    });
+    std::unordered_map<TimeDelta, std::size_t> seen;
+    bench::run("unordered_map<TimeDelta> lookup", n, [&](std::size_t i) {
+        ++seen[column[i] - column[i] % bucket];
+    });
+    bench::run("days, seconds, microseconds", n, [&](std::size_t i) {
+        const TimeDelta& x = column[i];
+        bench::do_not_optimize(x.days() + x.seconds() + x.microseconds());
+    });
+
+    std::cout << "speedup: " << stream / python << "x python, " << stream / iso << "x iso8601" << std::endl;
+}
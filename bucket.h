@@ -0,0 +1,358 @@
+#ifndef DATETIME_BUCKET_H
+#define DATETIME_BUCKET_H
+
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Florian Dang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "datetime.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace datetime
+{
+// BucketUnit
+// Local time units for bucketing: weeks start on Monday, as ISO 8601.
+enum class BucketUnit
+{
+    minute,
+    hour,
+    day,
+    week,
+    month
+};
+
+
+// LocalBuckets
+// Floors, ceils and rounds time points to the units of local time of a zone
+// (nullptr for UTC), giving the bucket boundaries as time points. Buckets
+// follow the wall clock, so days are 23 or 25 hours long around transitions:
+// + a bucket starts when its local time first occurs in the offset of the
+//   time point, or earlier when that is before the transition into that
+//   offset (the start of a day that began before a transition);
+// + when the local start is skipped by a transition, the bucket starts at the
+//   transition;
+// + round gives the nearest of floor and ceil, the bucket whose number of
+//   units since 1970-01-01 (local) is even on ties.
+// The last bucket and the last few offset intervals of the zone are
+// remembered, so sorted time points mostly cost a comparison, and others
+// within a few years skip the zone lookup. Not thread-safe: use one per thread.
+class LocalBuckets
+{
+public:
+    LocalBuckets(const date::time_zone* zone, BucketUnit unit);
+
+    const date::time_zone* zone() const { return zone_; }
+    BucketUnit unit() const { return unit_; }
+
+    template <class Duration>
+    date::sys_time<typename std::common_type<Duration, std::chrono::seconds>::type>
+    floor(const date::sys_time<Duration>& tp);
+
+    template <class Duration>
+    date::sys_time<typename std::common_type<Duration, std::chrono::seconds>::type>
+    ceil(const date::sys_time<Duration>& tp);
+
+    template <class Duration>
+    date::sys_time<typename std::common_type<Duration, std::chrono::seconds>::type>
+    round(const date::sys_time<Duration>& tp);
+
+private:
+    struct Interval
+    {
+        date::sys_seconds       begin;
+        date::sys_seconds       end;
+        std::chrono::seconds    offset;
+    };
+
+    const date::time_zone*  zone_;
+    BucketUnit              unit_;
+    Interval                intervals_[4];  // the last offset intervals used, empty at first
+    unsigned                replace_;       // the next one to replace
+    date::sys_seconds       lo_;            // the last bucket: [lo_, hi_)
+    date::sys_seconds       hi_;
+    bool                    even_;
+
+    std::int64_t local_floor(std::int64_t local, bool& even) const;  // seconds of local time
+    std::int64_t local_next(std::int64_t local) const;
+    date::sys_seconds start(date::sys_seconds begin, std::chrono::seconds offset, std::int64_t local) const;
+    const Interval& interval(date::sys_seconds tp);
+    void locate(date::sys_seconds tp);
+};
+
+
+// Bucket boundaries of a column of time points, as LocalBuckets. Sorted
+// columns run at about the speed of a copy. out may be times.
+template <class Duration>
+void floor_column(const date::sys_time<Duration>* times, std::size_t n, const date::time_zone* zone,
+                  BucketUnit unit, date::sys_time<Duration>* out);
+
+template <class Duration>
+void ceil_column(const date::sys_time<Duration>* times, std::size_t n, const date::time_zone* zone,
+                 BucketUnit unit, date::sys_time<Duration>* out);
+
+template <class Duration>
+void round_column(const date::sys_time<Duration>* times, std::size_t n, const date::time_zone* zone,
+                  BucketUnit unit, date::sys_time<Duration>* out);
+
+
+// LocalBuckets impl
+
+inline
+LocalBuckets::LocalBuckets(const date::time_zone* zone, BucketUnit unit)
+    : zone_(zone)
+    , unit_(unit)
+    , intervals_()
+    , replace_(0)
+    , lo_()     // empty bucket: the first time point locates it
+    , hi_()
+    , even_(true)
+    {}
+
+inline
+std::int64_t LocalBuckets::local_floor(std::int64_t local, bool& even) const
+{
+    std::int64_t n;
+    switch (unit_)
+    {
+    case BucketUnit::minute:
+        n = detail::floor_div(local, 60);
+        even = (n & 1) == 0;
+        return n * 60;
+    case BucketUnit::hour:
+        n = detail::floor_div(local, 3600);
+        even = (n & 1) == 0;
+        return n * 3600;
+    case BucketUnit::day:
+        n = detail::floor_div(local, 86400);
+        even = (n & 1) == 0;
+        return n * 86400;
+    case BucketUnit::week:
+        // weeks since Monday 1969-12-29
+        n = detail::floor_div(detail::floor_div(local, 86400) + 3, 7);
+        even = (n & 1) == 0;
+        return (n * 7 - 3) * 86400;
+    case BucketUnit::month:
+    default:
+        {
+            std::int32_t y;
+            unsigned char m, d;
+            detail::civil_from_day(static_cast<std::int32_t>(detail::floor_div(local, 86400)), y, m, d);
+            even = (m & 1) != 0;
+            return std::int64_t{detail::day_from_civil(y, m, 1)} * 86400;
+        }
+    }
+}
+
+inline
+std::int64_t LocalBuckets::local_next(std::int64_t local) const
+{
+    switch (unit_)
+    {
+    case BucketUnit::minute:
+        return local + 60;
+    case BucketUnit::hour:
+        return local + 3600;
+    case BucketUnit::day:
+        return local + 86400;
+    case BucketUnit::week:
+        return local + 7 * 86400;
+    case BucketUnit::month:
+    default:
+        {
+            std::int32_t y;
+            unsigned char m, d;
+            detail::civil_from_day(static_cast<std::int32_t>(local / 86400), y, m, d);
+            return std::int64_t{m == 12 ? detail::day_from_civil(y + 1, 1, 1) : detail::day_from_civil(y, m + 1u, 1)}
+                 * 86400;
+        }
+    }
+}
+
+// First instant of the bucket starting at local, in the offset interval
+// starting at begin or the ones before.
+inline
+date::sys_seconds LocalBuckets::start(date::sys_seconds begin, std::chrono::seconds offset, std::int64_t local) const
+{
+    for (;;)
+    {
+        const date::sys_seconds tp{std::chrono::seconds(local) - offset};
+        if (zone_ == nullptr || tp >= begin)
+        {
+            return tp;
+        }
+        const auto before = zone_->get_info(begin - std::chrono::seconds(1));
+        if (date::sys_seconds{std::chrono::seconds(local) - before.offset} >= begin)
+        {
+            return begin;   // local was skipped
+        }
+        begin = before.begin;
+        offset = before.offset;
+    }
+}
+
+inline
+const LocalBuckets::Interval& LocalBuckets::interval(date::sys_seconds tp)
+{
+    if (zone_ == nullptr)
+    {
+        return intervals_[0];   // offset 0, the bounds are not used
+    }
+    for (const auto& in : intervals_)
+    {
+        if (in.begin <= tp && tp < in.end)
+        {
+            return in;
+        }
+    }
+    const auto info = zone_->get_info(tp);
+    auto& in = intervals_[replace_];
+    replace_ = (replace_ + 1) % 4;
+    in.begin = info.begin;
+    in.end = info.end;
+    in.offset = info.offset;
+    return in;
+}
+
+inline
+void LocalBuckets::locate(date::sys_seconds tp)
+{
+    const Interval& in = interval(tp);
+    std::int64_t local = local_floor((tp.time_since_epoch() + in.offset).count(), even_);
+    lo_ = start(in.begin, in.offset, local);
+
+    // the next local start, unless the bucket runs past the end of the
+    // interval: then it ends at the transition when the time points after it
+    // start another bucket
+    date::sys_seconds end = in.end;
+    std::chrono::seconds offset = in.offset;
+    for (;;)
+    {
+        local = local_next(local);
+        const date::sys_seconds next{std::chrono::seconds(local) - offset};
+        if (zone_ == nullptr || next < end)
+        {
+            hi_ = next;
+            return;
+        }
+        const auto after = zone_->get_info(end);
+        bool even;
+        local = local_floor((end.time_since_epoch() + after.offset).count(), even);
+        if (start(after.begin, after.offset, local) != lo_)
+        {
+            hi_ = end;
+            return;
+        }
+        end = after.end;
+        offset = after.offset;
+    }
+}
+
+template <class Duration>
+inline
+date::sys_time<typename std::common_type<Duration, std::chrono::seconds>::type>
+LocalBuckets::floor(const date::sys_time<Duration>& tp)
+{
+    if (!(lo_ <= tp && tp < hi_))
+    {
+        locate(date::floor<std::chrono::seconds>(tp));
+    }
+    return lo_;
+}
+
+template <class Duration>
+inline
+date::sys_time<typename std::common_type<Duration, std::chrono::seconds>::type>
+LocalBuckets::ceil(const date::sys_time<Duration>& tp)
+{
+    using CT = typename std::common_type<Duration, std::chrono::seconds>::type;
+    if (!(lo_ <= tp && tp < hi_))
+    {
+        locate(date::floor<std::chrono::seconds>(tp));
+    }
+    return tp == lo_ ? date::sys_time<CT>(lo_) : date::sys_time<CT>(hi_);
+}
+
+template <class Duration>
+inline
+date::sys_time<typename std::common_type<Duration, std::chrono::seconds>::type>
+LocalBuckets::round(const date::sys_time<Duration>& tp)
+{
+    using CT = typename std::common_type<Duration, std::chrono::seconds>::type;
+    if (!(lo_ <= tp && tp < hi_))
+    {
+        locate(date::floor<std::chrono::seconds>(tp));
+    }
+    const auto down = tp - lo_;
+    const auto up = hi_ - tp;
+    return down < up || (down == up && even_) ? date::sys_time<CT>(lo_) : date::sys_time<CT>(hi_);
+}
+
+namespace detail
+{
+
+template <class Duration, class F>
+inline
+void bucket_column(const date::sys_time<Duration>* times, std::size_t n, date::sys_time<Duration>* out, F f)
+{
+    static_assert(std::is_same<typename std::common_type<Duration, std::chrono::seconds>::type, Duration>::value,
+                  "bucket columns need seconds or finer durations");
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        out[i] = f(times[i]);
+    }
+}
+
+} // namespace detail
+
+template <class Duration>
+inline
+void floor_column(const date::sys_time<Duration>* times, std::size_t n, const date::time_zone* zone,
+                  BucketUnit unit, date::sys_time<Duration>* out)
+{
+    LocalBuckets buckets(zone, unit);
+    detail::bucket_column(times, n, out, [&](const date::sys_time<Duration>& tp) { return buckets.floor(tp); });
+}
+
+template <class Duration>
+inline
+void ceil_column(const date::sys_time<Duration>* times, std::size_t n, const date::time_zone* zone,
+                 BucketUnit unit, date::sys_time<Duration>* out)
+{
+    LocalBuckets buckets(zone, unit);
+    detail::bucket_column(times, n, out, [&](const date::sys_time<Duration>& tp) { return buckets.ceil(tp); });
+}
+
+template <class Duration>
+inline
+void round_column(const date::sys_time<Duration>* times, std::size_t n, const date::time_zone* zone,
+                  BucketUnit unit, date::sys_time<Duration>* out)
+{
+    LocalBuckets buckets(zone, unit);
+    detail::bucket_column(times, n, out, [&](const date::sys_time<Duration>& tp) { return buckets.round(tp); });
+}
+
+} // namespace datetime
+
+#endif // DATETIME_BUCKET_H
@@ -0,0 +1,657 @@
+#ifndef DATETIME_BULK_H
+#define DATETIME_BULK_H
+
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Florian Dang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "datetime.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace datetime
+{
+// ThreadPool
+// Fixed set of worker threads running parallel loops. The calling thread takes
+// part as worker 0. Each worker starts with its own contiguous share of the
+// loop and, once done, steals the back half of the largest remaining share.
+class ThreadPool
+{
+public:
+    explicit ThreadPool(unsigned threads = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const { return static_cast<unsigned>(threads_.size()) + 1; }
+
+    // Calls f(worker, begin, end) on disjoint chunks of at most grain elements
+    // covering [0, n), with worker < size(). Must not be called from f. Calls
+    // from several threads at once are run one after the other.
+    template <class F>
+    void parallel_for(std::size_t n, std::size_t grain, F f);
+
+private:
+    struct Range
+    {
+        std::mutex  mutex;
+        std::size_t begin;
+        std::size_t end;
+    };
+
+    std::vector<std::thread>                threads_;
+    std::mutex                              call_mutex_;    // one loop at a time
+    std::mutex                              mutex_;
+    std::condition_variable                 wake_;
+    std::condition_variable                 done_;
+    const std::function<void(unsigned)>*    job_ = nullptr;
+    std::size_t                             generation_ = 0;
+    unsigned                                pending_ = 0;
+    bool                                    stop_ = false;
+
+    void work(unsigned worker);
+    void execute(const std::function<void(unsigned)>& job);
+};
+
+
+// Parses n strings (anything with data() and size(), e.g. std::string or
+// std::string_view) with one compiled format, as local times of zone (nullptr
+// for UTC) unless the format has %z. The whole string must match. Failed rows,
+// including nonexistent or ambiguous local times, get errors[i] = true and the
+// epoch in out[i]. Returns the number of failed rows.
+template <class String, class Duration>
+std::size_t strptime_column(const String* strings, std::size_t n, const Format& format,
+                            const date::time_zone* zone,
+                            date::sys_time<Duration>* out, bool* errors);
+
+// Same, splitting the rows over the threads of pool, each with its own ZoneCache.
+template <class String, class Duration>
+std::size_t strptime_column(const String* strings, std::size_t n, const Format& format,
+                            const date::time_zone* zone,
+                            date::sys_time<Duration>* out, bool* errors, ThreadPool& pool);
+
+// out[i] = epoch + seconds[i] + nanoseconds[i] floored to Duration, exactly (nanoseconds
+// may be nullptr). Rows out of the range of sys_time<Duration> get errors[i] = true
+// and the epoch. Returns the number of failed rows.
+template <class Duration>
+std::size_t fromtimestamp_column(const std::int64_t* seconds, const std::int64_t* nanoseconds,
+                                 std::size_t n, date::sys_time<Duration>* out, bool* errors);
+
+// Parses n decimal epoch strings counted in unit (see parse_epoch), the whole
+// string must match. Failed rows get errors[i] = true and the epoch in out[i].
+// Returns the number of failed rows.
+template <class String, class Duration>
+std::size_t fromtimestamp_column(const String* strings, std::size_t n, std::chrono::nanoseconds unit,
+                                 date::sys_time<Duration>* out, bool* errors);
+
+// Same, splitting the rows over the threads of pool.
+template <class String, class Duration>
+std::size_t fromtimestamp_column(const String* strings, std::size_t n, std::chrono::nanoseconds unit,
+                                 date::sys_time<Duration>* out, bool* errors, ThreadPool& pool);
+
+
+// TextColumn
+// Output of strftime_column: each chunk holds the text of consecutive rows,
+// every row followed by the separator. Chunks are in row order, so that they
+// can be written as they are (e.g. one iovec each for writev) or joined.
+struct TextColumn
+{
+    std::vector<std::string> chunks;
+
+    std::size_t size() const;   // total length of the chunks
+    std::string join() const;
+};
+
+// Renders n time points with one compiled format as local times of zone
+// (nullptr for UTC), %z and %Z included. Chunk buffers are sized from the
+// width of the first row and grown if longer rows come along.
+template <class Duration>
+void strftime_column(const date::sys_time<Duration>* times, std::size_t n, const Format& format,
+                     const date::time_zone* zone, char separator, TextColumn& out);
+
+// Same, splitting the rows over the threads of pool, one chunk per share.
+template <class Duration>
+void strftime_column(const date::sys_time<Duration>* times, std::size_t n, const Format& format,
+                     const date::time_zone* zone, char separator, TextColumn& out, ThreadPool& pool);
+
+// Same for DateTime values, each in its own time zone.
+template <class Duration>
+void strftime_column(const DateTime<Duration>* times, std::size_t n, const Format& format,
+                     char separator, TextColumn& out);
+
+template <class Duration>
+void strftime_column(const DateTime<Duration>* times, std::size_t n, const Format& format,
+                     char separator, TextColumn& out, ThreadPool& pool);
+
+
+// ThreadPool impl
+
+inline
+ThreadPool::ThreadPool(unsigned threads)
+{
+    for (unsigned i = 1; i < threads; ++i)
+    {
+        threads_.emplace_back(&ThreadPool::work, this, i);
+    }
+}
+
+inline
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& t : threads_)
+    {
+        t.join();
+    }
+}
+
+inline
+void ThreadPool::work(unsigned worker)
+{
+    std::size_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+        if (stop_)
+        {
+            return;
+        }
+        seen = generation_;
+        auto job = job_;
+        lock.unlock();
+        (*job)(worker);
+        lock.lock();
+        if (--pending_ == 0)
+        {
+            done_.notify_all();
+        }
+    }
+}
+
+inline
+void ThreadPool::execute(const std::function<void(unsigned)>& job)
+{
+    // job_, pending_ and generation_ hold a single loop
+    std::lock_guard<std::mutex> call(call_mutex_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job_ = &job;
+        pending_ = static_cast<unsigned>(threads_.size());
+        ++generation_;
+    }
+    wake_.notify_all();
+    job(0);
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [&] { return pending_ == 0; });
+    job_ = nullptr;
+}
+
+template <class F>
+inline
+void ThreadPool::parallel_for(std::size_t n, std::size_t grain, F f)
+{
+    const unsigned k = size();
+    if (grain == 0)
+    {
+        grain = 1;
+    }
+    if (k == 1 || n <= grain)
+    {
+        if (n > 0)
+        {
+            f(0u, std::size_t{0}, n);
+        }
+        return;
+    }
+
+    std::unique_ptr<Range[]> ranges(new Range[k]);
+    for (unsigned i = 0; i < k; ++i)
+    {
+        ranges[i].begin = n * i / k;
+        ranges[i].end   = n * (i + 1) / k;
+    }
+
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    std::function<void(unsigned)> job = [&](unsigned w) {
+        Range& own = ranges[w];
+        try
+        {
+            while (true)
+            {
+                std::size_t b, e;
+                {
+                    std::lock_guard<std::mutex> lock(own.mutex);
+                    b = own.begin;
+                    e = std::min(own.end, b + grain);
+                    own.begin = e;
+                }
+                if (b < e)
+                {
+                    f(w, b, e);
+                    continue;
+                }
+
+                // steal the back half of the largest remaining range
+                unsigned victim = k;
+                std::size_t most = 0;
+                for (unsigned v = 0; v < k; ++v)
+                {
+                    std::lock_guard<std::mutex> lock(ranges[v].mutex);
+                    auto remaining = ranges[v].end - ranges[v].begin;
+                    if (remaining > most)
+                    {
+                        most = remaining;
+                        victim = v;
+                    }
+                }
+                if (victim == k)
+                {
+                    return;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(ranges[victim].mutex);
+                    auto remaining = ranges[victim].end - ranges[victim].begin;
+                    if (remaining == 0)
+                    {
+                        continue;
+                    }
+                    e = ranges[victim].end;
+                    b = e - (remaining + 1) / 2;
+                    ranges[victim].end = b;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(own.mutex);
+                    own.begin = b;
+                    own.end = e;
+                }
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error)
+            {
+                error = std::current_exception();
+            }
+        }
+    };
+    execute(job);
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+
+// strptime_column impl
+
+namespace detail
+{
+
+template <class String, class Duration>
+inline
+std::size_t strptime_rows(const String* strings, std::size_t begin, std::size_t end,
+                          const Format& format, ZoneCache& cache,
+                          date::sys_time<Duration>* out, bool* errors)
+{
+    using CT = typename std::common_type<Duration, std::chrono::seconds>::type;
+    std::size_t failed = 0;
+    for (std::size_t i = begin; i < end; ++i)
+    {
+        const char* first = strings[i].data();
+        const char* last = first + strings[i].size();
+        date::local_time<CT> lt;
+        std::chrono::minutes offset{0};
+        date::sys_time<CT> st;
+        bool ok = format.parse(first, last, lt, &offset) == last;
+        if (ok && format.has_offset())
+        {
+            st = date::sys_time<CT>{lt.time_since_epoch() - offset};
+        }
+        else if (ok)
+        {
+            ok = cache.to_sys(lt, st);
+        }
+        errors[i] = !ok;
+        out[i] = ok ? date::floor<Duration>(st) : date::sys_time<Duration>{};
+        failed += !ok;
+    }
+    return failed;
+}
+
+} // namespace detail
+
+template <class String, class Duration>
+inline
+std::size_t strptime_column(const String* strings, std::size_t n, const Format& format,
+                            const date::time_zone* zone,
+                            date::sys_time<Duration>* out, bool* errors)
+{
+    ZoneCache cache(zone);
+    return detail::strptime_rows(strings, 0, n, format, cache, out, errors);
+}
+
+template <class String, class Duration>
+inline
+std::size_t strptime_column(const String* strings, std::size_t n, const Format& format,
+                            const date::time_zone* zone,
+                            date::sys_time<Duration>* out, bool* errors, ThreadPool& pool)
+{
+    std::vector<ZoneCache> caches(pool.size(), ZoneCache(zone));
+    std::vector<std::size_t> failed(pool.size(), 0);
+    pool.parallel_for(n, 4096, [&](unsigned worker, std::size_t begin, std::size_t end) {
+        failed[worker] += detail::strptime_rows(strings, begin, end, format, caches[worker], out, errors);
+    });
+    std::size_t total = 0;
+    for (auto f : failed)
+    {
+        total += f;
+    }
+    return total;
+}
+
+
+// fromtimestamp_column impl
+
+namespace detail
+{
+
+template <class String, class Duration>
+inline
+std::size_t epoch_rows(const String* strings, std::size_t begin, std::size_t end, std::int64_t unit_ns,
+                       date::sys_time<Duration>* out, bool* errors)
+{
+    std::size_t failed = 0;
+    for (std::size_t i = begin; i < end; ++i)
+    {
+        const char* first = strings[i].data();
+        const char* last = first + strings[i].size();
+        std::int64_t seconds = 0, nanoseconds = 0;
+        bool out_of_range;
+        bool ok = read_epoch(first, last, unit_ns, seconds, nanoseconds, out_of_range) == last &&
+                  !out_of_range && make_sys_time(seconds, nanoseconds, out[i]);
+        if (!ok)
+        {
+            out[i] = date::sys_time<Duration>{};
+        }
+        errors[i] = !ok;
+        failed += !ok;
+    }
+    return failed;
+}
+
+} // namespace detail
+
+template <class Duration>
+inline
+std::size_t fromtimestamp_column(const std::int64_t* seconds, const std::int64_t* nanoseconds,
+                                 std::size_t n, date::sys_time<Duration>* out, bool* errors)
+{
+    std::size_t failed = 0;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        bool ok = detail::make_sys_time(seconds[i], nanoseconds == nullptr ? 0 : nanoseconds[i], out[i]);
+        if (!ok)
+        {
+            out[i] = date::sys_time<Duration>{};
+        }
+        errors[i] = !ok;
+        failed += !ok;
+    }
+    return failed;
+}
+
+template <class String, class Duration>
+inline
+std::size_t fromtimestamp_column(const String* strings, std::size_t n, std::chrono::nanoseconds unit,
+                                 date::sys_time<Duration>* out, bool* errors)
+{
+    return detail::epoch_rows(strings, 0, n, unit.count(), out, errors);
+}
+
+template <class String, class Duration>
+inline
+std::size_t fromtimestamp_column(const String* strings, std::size_t n, std::chrono::nanoseconds unit,
+                                 date::sys_time<Duration>* out, bool* errors, ThreadPool& pool)
+{
+    std::vector<std::size_t> failed(pool.size(), 0);
+    pool.parallel_for(n, 4096, [&](unsigned worker, std::size_t begin, std::size_t end) {
+        failed[worker] += detail::epoch_rows(strings, begin, end, unit.count(), out, errors);
+    });
+    std::size_t total = 0;
+    for (auto f : failed)
+    {
+        total += f;
+    }
+    return total;
+}
+
+
+// TextColumn impl
+
+inline
+std::size_t TextColumn::size() const
+{
+    std::size_t total = 0;
+    for (auto& c : chunks)
+    {
+        total += c.size();
+    }
+    return total;
+}
+
+inline
+std::string TextColumn::join() const
+{
+    std::string s;
+    s.reserve(size());
+    for (auto& c : chunks)
+    {
+        s += c;
+    }
+    return s;
+}
+
+
+// strftime_column impl
+
+namespace detail
+{
+
+template <class Duration>
+inline
+date::sys_time<Duration> column_sys_time(const date::sys_time<Duration>& x)
+{
+    return x;
+}
+
+template <class Duration>
+inline
+date::sys_time<typename std::common_type<Duration, std::chrono::seconds>::type>
+column_sys_time(const DateTime<Duration>& x)
+{
+    return x.zoned_time().get_sys_time();
+}
+
+template <class Duration>
+inline
+const date::time_zone* column_zone(const date::sys_time<Duration>&, const date::time_zone* zone)
+{
+    return zone;
+}
+
+template <class Duration>
+inline
+const date::time_zone* column_zone(const DateTime<Duration>& x, const date::time_zone*)
+{
+    return x.time_zone();
+}
+
+// rows [begin, end) appended to buf, which is grown when a row does not fit
+template <class T>
+inline
+void strftime_rows(const T* times, std::size_t begin, std::size_t end, const Format& format,
+                   const date::time_zone* zone, char separator, std::size_t width,
+                   ZoneCache& cache, std::string& buf)
+{
+    buf.resize((end - begin) * (width + 1));
+    std::size_t used = 0;
+    for (std::size_t i = begin; i < end; ++i)
+    {
+        auto row_zone = column_zone(times[i], zone);
+        if (row_zone != cache.zone())
+        {
+            cache = ZoneCache(row_zone);
+        }
+        auto tp = column_sys_time(times[i]);
+        auto s = date::floor<std::chrono::seconds>(tp);
+        std::chrono::seconds offset = cache.offset(s);
+        const std::string& abbrev = cache.abbrev(s);
+        auto lt = date::local_time<typename decltype(tp)::duration>{tp.time_since_epoch() + offset};
+        while (true)
+        {
+            char* first = &buf[0] + used;
+            char* p = format.format(first, &buf[0] + buf.size(), lt, &abbrev, &offset);
+            if (p != nullptr && p != &buf[0] + buf.size())
+            {
+                *p++ = separator;
+                used = static_cast<std::size_t>(p - &buf[0]);
+                break;
+            }
+            buf.resize(std::max<std::size_t>(2 * buf.size(), 64));
+        }
+    }
+    buf.resize(used);
+}
+
+// width of the first row, as an estimate of the others
+template <class T>
+inline
+std::size_t strftime_width(const T* times, std::size_t n, const Format& format, const date::time_zone* zone)
+{
+    if (n == 0)
+    {
+        return 0;
+    }
+    ZoneCache cache(column_zone(times[0], zone));
+    std::string buf;
+    strftime_rows(times, 0, 1, format, zone, '\n', 32, cache, buf);
+    return buf.size() - 1;
+}
+
+template <class T>
+inline
+void strftime_column(const T* times, std::size_t n, const Format& format,
+                     const date::time_zone* zone, char separator, TextColumn& out)
+{
+    out.chunks.assign(n == 0 ? 0 : 1, std::string());
+    if (n > 0)
+    {
+        ZoneCache cache(zone);
+        strftime_rows(times, 0, n, format, zone, separator, strftime_width(times, n, format, zone),
+                      cache, out.chunks[0]);
+    }
+}
+
+template <class T>
+inline
+void strftime_column(const T* times, std::size_t n, const Format& format,
+                     const date::time_zone* zone, char separator, TextColumn& out, ThreadPool& pool)
+{
+    auto width = strftime_width(times, n, format, zone);
+    std::vector<ZoneCache> caches(pool.size(), ZoneCache(zone));
+    // chunks of each worker with their first row, put in row order afterwards
+    std::vector<std::vector<std::pair<std::size_t, std::string>>> rendered(pool.size());
+    pool.parallel_for(n, 16384, [&](unsigned worker, std::size_t begin, std::size_t end) {
+        rendered[worker].emplace_back(begin, std::string());
+        strftime_rows(times, begin, end, format, zone, separator, width, caches[worker],
+                      rendered[worker].back().second);
+    });
+    std::vector<std::pair<std::size_t, std::string>> all;
+    for (auto& r : rendered)
+    {
+        std::move(r.begin(), r.end(), std::back_inserter(all));
+    }
+    std::sort(all.begin(), all.end(),
+              [](const std::pair<std::size_t, std::string>& x, const std::pair<std::size_t, std::string>& y) {
+                  return x.first < y.first;
+              });
+    out.chunks.clear();
+    for (auto& c : all)
+    {
+        out.chunks.push_back(std::move(c.second));
+    }
+}
+
+} // namespace detail
+
+template <class Duration>
+inline
+void strftime_column(const date::sys_time<Duration>* times, std::size_t n, const Format& format,
+                     const date::time_zone* zone, char separator, TextColumn& out)
+{
+    detail::strftime_column(times, n, format, zone, separator, out);
+}
+
+template <class Duration>
+inline
+void strftime_column(const date::sys_time<Duration>* times, std::size_t n, const Format& format,
+                     const date::time_zone* zone, char separator, TextColumn& out, ThreadPool& pool)
+{
+    detail::strftime_column(times, n, format, zone, separator, out, pool);
+}
+
+template <class Duration>
+inline
+void strftime_column(const DateTime<Duration>* times, std::size_t n, const Format& format,
+                     char separator, TextColumn& out)
+{
+    detail::strftime_column(times, n, format, nullptr, separator, out);
+}
+
+template <class Duration>
+inline
+void strftime_column(const DateTime<Duration>* times, std::size_t n, const Format& format,
+                     char separator, TextColumn& out, ThreadPool& pool)
+{
+    detail::strftime_column(times, n, format, nullptr, separator, out, pool);
+}
+
+} // namespace datetime
+
+#endif // DATETIME_BULK_H
@@ -0,0 +1,486 @@
+#ifndef DATETIME_BUSINESS_H
+#define DATETIME_BUSINESS_H
+
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Florian Dang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "datetime.h"
+#include "calendar.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace datetime
+{
+// BusinessCalendar
+// Business days: the days of the week not in the weekend, but holidays.
+// The weekend is a mask of weekdays, and holidays are a bitset of the days of
+// each year with running counts of the holidays before each word, so that:
+// + is_business_day is a bit test;
+// + business_days_between counts the working weekdays with a closed form
+//   and subtracts the holidays with a few popcounts, whatever the distance;
+// + add_business_days jumps by whole weeks of working weekdays, then again
+//   over the holidays that were jumped over, usually once or twice.
+// Holidays on weekends are ignored. Any year may have holidays; years
+// before the first one or after the last one have none.
+//
+// As numpy.busday_count and numpy.busday_offset with roll='forward':
+// business_days_between(a, b) counts [a, b) and is negative when b < a;
+// add_business_days(d, n) rolls d forward to a business day, then moves n
+// business days from there, back for n < 0. next and prev are the nearest
+// business days strictly after and before, so next of a Saturday is the
+// Monday where add_business_days(Saturday, 1) is the Tuesday.
+class BusinessCalendar
+{
+public:
+    // throw std::invalid_argument when every day of the week is in the weekend
+    explicit BusinessCalendar(const std::vector<date::weekday>& weekend = {date::sat, date::sun},
+                              const std::vector<Date>& holidays = std::vector<Date>());
+
+    void add_holiday(const Date& d);
+
+    unsigned weekend_mask() const { return weekend_; }  // bit w for unsigned(date::weekday) w
+
+    bool is_business_day(const Date& d) const { return business(SerialDate(d).serial()); }
+    bool is_business_day(const SerialDate& d) const { return business(d.serial()); }
+
+    Date        add_business_days(const Date& d, std::int32_t n) const;
+    SerialDate  add_business_days(const SerialDate& d, std::int32_t n) const;
+
+    Date        next(const Date& d) const { return SerialDate(step(SerialDate(d).serial(), 1)).date(); }
+    SerialDate  next(const SerialDate& d) const { return SerialDate(step(d.serial(), 1)); }
+    Date        prev(const Date& d) const { return SerialDate(step(SerialDate(d).serial(), -1)).date(); }
+    SerialDate  prev(const SerialDate& d) const { return SerialDate(step(d.serial(), -1)); }
+
+    std::int64_t business_days_between(const Date& a, const Date& b) const;
+    std::int64_t business_days_between(const SerialDate& a, const SerialDate& b) const;
+
+    // columns; out may be dates for add_business_days
+    void is_business_day(const Date* dates, std::size_t count, bool* out) const;
+    void is_business_day(const SerialDate* dates, std::size_t count, bool* out) const;
+    void add_business_days(const Date* dates, std::size_t count, std::int32_t n, Date* out) const;
+    void add_business_days(const SerialDate* dates, std::size_t count, std::int32_t n, SerialDate* out) const;
+    void business_days_between(const Date* a, const Date* b, std::size_t count, std::int64_t* out) const;
+    void business_days_between(const SerialDate* a, const SerialDate* b, std::size_t count, std::int64_t* out) const;
+
+private:
+    struct Year
+    {
+        std::int32_t    start;      // the serial day of January 1st
+        std::uint64_t   bits[6];    // bit i for the day i of the year, from 0
+        std::int64_t    rank[6];    // holidays before bits[w], from the first year
+    };
+
+    unsigned            weekend_ = 0;
+    unsigned            work_ = 0;          // ~weekend_, twice: bits 0 to 13
+    std::int64_t        per_week_ = 0;      // working weekdays in a week
+    unsigned char       ahead_[7][8];       // days from weekday w to the r-th working weekday after
+    unsigned char       behind_[7][8];      // and before
+    std::int32_t        first_year_ = 0;
+    std::vector<Year>   years_;
+    std::int64_t        total_ = 0;         // holidays of all years
+
+    bool workday(std::int32_t n) const { return ((weekend_ >> detail::weekday_from_day(n)) & 1) == 0; }
+    std::ptrdiff_t year_of(std::int32_t n) const;                   // -1 before the first year
+    bool holiday(std::int32_t n) const;
+    bool business(std::int32_t n) const { return workday(n) && !holiday(n); }
+
+    std::int64_t workdays(std::int32_t a, std::int32_t b) const;    // in [a, b), a <= b
+    std::int64_t holidays_before(std::int32_t n) const;             // from the first year
+    std::int64_t workday_after(std::int64_t n, std::int64_t k) const;   // k >= 1
+    std::int64_t workday_before(std::int64_t n, std::int64_t k) const;
+
+    std::int32_t step(std::int32_t n, std::int32_t k) const;       // k-th strictly after, before for k < 0
+    std::int32_t add(std::int32_t n, std::int32_t k) const;         // step from n rolled forward
+    std::int64_t between(std::int32_t a, std::int32_t b) const;
+};
+
+
+// BusinessCalendar impl
+
+namespace detail
+{
+
+inline
+unsigned popcount(std::uint64_t x)
+{
+#if defined(__GNUC__)
+    return static_cast<unsigned>(__builtin_popcountll(x));
+#else
+    unsigned n = 0;
+    for (; x != 0; x &= x - 1)
+    {
+        ++n;
+    }
+    return n;
+#endif
+}
+
+const std::size_t business_block = 512;
+
+} // namespace detail
+
+inline
+BusinessCalendar::BusinessCalendar(const std::vector<date::weekday>& weekend, const std::vector<Date>& holidays)
+{
+    for (const auto& wd : weekend)
+    {
+        weekend_ |= 1u << static_cast<unsigned>(wd);
+    }
+    weekend_ &= 0x7f;
+    if (weekend_ == 0x7f)
+    {
+        throw std::invalid_argument("BusinessCalendar: no working day in the week");
+    }
+    work_ = (~weekend_ & 0x7f) * 0x81;
+    per_week_ = detail::popcount(~weekend_ & 0x7f);
+    for (unsigned w = 0; w < 7; ++w)
+    {
+        unsigned r = 0;
+        for (unsigned char d = 1; d <= 7; ++d)
+        {
+            if (((work_ >> ((w + d) % 7)) & 1) != 0)
+            {
+                ahead_[w][++r] = d;
+            }
+        }
+        r = 0;
+        for (unsigned char d = 1; d <= 7; ++d)
+        {
+            if (((work_ >> ((w + 7 - d) % 7)) & 1) != 0)
+            {
+                behind_[w][++r] = d;
+            }
+        }
+    }
+    for (const auto& d : holidays)
+    {
+        add_holiday(d);
+    }
+}
+
+inline
+void BusinessCalendar::add_holiday(const Date& d)
+{
+    const std::int32_t n = SerialDate(d).serial();
+    if (!workday(n))
+    {
+        return;
+    }
+    const std::int32_t y = static_cast<int>(d.year());
+    const std::int32_t first = years_.empty() ? y : std::min(first_year_, y);
+    const std::int32_t last = years_.empty() ? y : std::max(first_year_ + static_cast<std::int32_t>(years_.size()) - 1, y);
+    if (years_.empty() || first < first_year_ || last >= first_year_ + static_cast<std::int32_t>(years_.size()))
+    {
+        std::vector<Year> years(static_cast<std::size_t>(last - first + 1));
+        for (std::size_t i = 0; i < years.size(); ++i)
+        {
+            const auto year = first + static_cast<std::int32_t>(i);
+            const auto old = year - first_year_;
+            if (!years_.empty() && old >= 0 && old < static_cast<std::int32_t>(years_.size()))
+            {
+                years[i] = years_[static_cast<std::size_t>(old)];
+            }
+            else
+            {
+                years[i] = Year{detail::day_from_civil(year, 1, 1), {0, 0, 0, 0, 0, 0}, {0, 0, 0, 0, 0, 0}};
+            }
+        }
+        years_.swap(years);
+        first_year_ = first;
+    }
+
+    auto& x = years_[static_cast<std::size_t>(y - first_year_)];
+    const auto doy = static_cast<unsigned>(n - x.start);
+    x.bits[doy / 64] |= std::uint64_t(1) << (doy % 64);
+    total_ = 0;
+    for (auto& year : years_)
+    {
+        for (unsigned w = 0; w < 6; ++w)
+        {
+            year.rank[w] = total_;
+            total_ += detail::popcount(year.bits[w]);
+        }
+    }
+}
+
+inline
+std::ptrdiff_t BusinessCalendar::year_of(std::int32_t n) const
+{
+    if (years_.empty() || n < years_.front().start)
+    {
+        return -1;
+    }
+    // 400 years are 146097 days: one year off at most
+    const auto size = static_cast<std::ptrdiff_t>(years_.size());
+    auto i = static_cast<std::ptrdiff_t>((std::int64_t{n} - years_.front().start) * 400 / 146097);
+    i = std::min(i, size - 1);
+    if (i + 1 < size && n >= years_[static_cast<std::size_t>(i + 1)].start)
+    {
+        ++i;
+    }
+    if (n < years_[static_cast<std::size_t>(i)].start)
+    {
+        --i;
+    }
+    return i;
+}
+
+inline
+bool BusinessCalendar::holiday(std::int32_t n) const
+{
+    const auto i = year_of(n);
+    if (i < 0)
+    {
+        return false;
+    }
+    const auto& x = years_[static_cast<std::size_t>(i)];
+    const auto doy = static_cast<unsigned>(n - x.start);
+    return doy < 6 * 64 && ((x.bits[doy / 64] >> (doy % 64)) & 1) != 0;
+}
+
+inline
+std::int64_t BusinessCalendar::workdays(std::int32_t a, std::int32_t b) const
+{
+    const std::int64_t length = std::int64_t{b} - a;
+    const auto rest = static_cast<unsigned>(length % 7);
+    const unsigned partial = (work_ >> detail::weekday_from_day(a)) & ((1u << rest) - 1);
+    return length / 7 * per_week_ + detail::popcount(partial);
+}
+
+inline
+std::int64_t BusinessCalendar::holidays_before(std::int32_t n) const
+{
+    const auto i = year_of(n);
+    if (i < 0)
+    {
+        return 0;
+    }
+    // past the bits of the last year
+    const auto& x = years_[static_cast<std::size_t>(i)];
+    const auto doy = static_cast<unsigned>(n - x.start);
+    if (doy >= 6 * 64)
+    {
+        return total_;
+    }
+    return x.rank[doy / 64] + detail::popcount(x.bits[doy / 64] & ((std::uint64_t(1) << (doy % 64)) - 1));
+}
+
+inline
+std::int64_t BusinessCalendar::workday_after(std::int64_t n, std::int64_t k) const
+{
+    const auto w = detail::weekday_from_day(static_cast<std::int32_t>(n));
+    return n + (k - 1) / per_week_ * 7 + ahead_[w][(k - 1) % per_week_ + 1];
+}
+
+inline
+std::int64_t BusinessCalendar::workday_before(std::int64_t n, std::int64_t k) const
+{
+    const auto w = detail::weekday_from_day(static_cast<std::int32_t>(n));
+    return n - (k - 1) / per_week_ * 7 - behind_[w][(k - 1) % per_week_ + 1];
+}
+
+inline
+std::int32_t BusinessCalendar::step(std::int32_t n, std::int32_t k) const
+{
+    std::int64_t t = n;
+    std::int64_t left = k > 0 ? k : -std::int64_t{k};
+    while (left != 0)
+    {
+        // the working weekdays, then as many again as holidays were passed
+        if (k > 0)
+        {
+            const std::int64_t t2 = workday_after(t, left);
+            left = holidays_before(static_cast<std::int32_t>(t2 + 1)) - holidays_before(static_cast<std::int32_t>(t + 1));
+            t = t2;
+        }
+        else
+        {
+            const std::int64_t t2 = workday_before(t, left);
+            left = holidays_before(static_cast<std::int32_t>(t)) - holidays_before(static_cast<std::int32_t>(t2));
+            t = t2;
+        }
+    }
+    return static_cast<std::int32_t>(t);
+}
+
+inline
+std::int32_t BusinessCalendar::add(std::int32_t n, std::int32_t k) const
+{
+    if (!business(n))
+    {
+        n = step(n, 1);
+    }
+    return k == 0 ? n : step(n, k);
+}
+
+inline
+std::int64_t BusinessCalendar::between(std::int32_t a, std::int32_t b) const
+{
+    if (b < a)
+    {
+        return -between(b, a);
+    }
+    return workdays(a, b) - (holidays_before(b) - holidays_before(a));
+}
+
+inline
+Date BusinessCalendar::add_business_days(const Date& d, std::int32_t n) const
+{
+    return SerialDate(add(SerialDate(d).serial(), n)).date();
+}
+
+inline
+SerialDate BusinessCalendar::add_business_days(const SerialDate& d, std::int32_t n) const
+{
+    return SerialDate(add(d.serial(), n));
+}
+
+inline
+std::int64_t BusinessCalendar::business_days_between(const Date& a, const Date& b) const
+{
+    return between(SerialDate(a).serial(), SerialDate(b).serial());
+}
+
+inline
+std::int64_t BusinessCalendar::business_days_between(const SerialDate& a, const SerialDate& b) const
+{
+    return between(a.serial(), b.serial());
+}
+
+namespace detail
+{
+
+// days since 1970-01-01 of a block of dates
+inline
+void serial_days(const Date* dates, std::size_t n, std::int32_t* year, unsigned char* month, unsigned char* day,
+                 std::int32_t* out)
+{
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        const auto& ymd = dates[i].year_month_day();
+        year[i] = static_cast<int>(ymd.year());
+        month[i] = static_cast<unsigned char>(static_cast<unsigned>(ymd.month()));
+        day[i] = static_cast<unsigned char>(static_cast<unsigned>(ymd.day()));
+    }
+    days_from_civil(year, month, day, n, out);
+}
+
+} // namespace detail
+
+inline
+void BusinessCalendar::is_business_day(const Date* dates, std::size_t count, bool* out) const
+{
+    std::int32_t year[detail::business_block];
+    unsigned char month[detail::business_block];
+    unsigned char day[detail::business_block];
+    std::int32_t days[detail::business_block];
+    for (std::size_t i = 0; i < count; i += detail::business_block)
+    {
+        const std::size_t b = std::min(count - i, detail::business_block);
+        detail::serial_days(dates + i, b, year, month, day, days);
+        for (std::size_t j = 0; j < b; ++j)
+        {
+            out[i + j] = business(days[j]);
+        }
+    }
+}
+
+inline
+void BusinessCalendar::is_business_day(const SerialDate* dates, std::size_t count, bool* out) const
+{
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        out[i] = business(dates[i].serial());
+    }
+}
+
+inline
+void BusinessCalendar::add_business_days(const Date* dates, std::size_t count, std::int32_t n, Date* out) const
+{
+    std::int32_t year[detail::business_block];
+    unsigned char month[detail::business_block];
+    unsigned char day[detail::business_block];
+    std::int32_t days[detail::business_block];
+    for (std::size_t i = 0; i < count; i += detail::business_block)
+    {
+        const std::size_t b = std::min(count - i, detail::business_block);
+        detail::serial_days(dates + i, b, year, month, day, days);
+        for (std::size_t j = 0; j < b; ++j)
+        {
+            days[j] = add(days[j], n);
+        }
+        civil_from_days(days, b, year, month, day);
+        for (std::size_t j = 0; j < b; ++j)
+        {
+            out[i + j] = Date(date::year(year[j]), date::month(month[j]), date::day(day[j]));
+        }
+    }
+}
+
+inline
+void BusinessCalendar::add_business_days(const SerialDate* dates, std::size_t count, std::int32_t n,
+                                         SerialDate* out) const
+{
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        out[i] = SerialDate(add(dates[i].serial(), n));
+    }
+}
+
+inline
+void BusinessCalendar::business_days_between(const Date* a, const Date* b, std::size_t count,
+                                             std::int64_t* out) const
+{
+    std::int32_t year[detail::business_block];
+    unsigned char month[detail::business_block];
+    unsigned char day[detail::business_block];
+    std::int32_t first[detail::business_block];
+    std::int32_t last[detail::business_block];
+    for (std::size_t i = 0; i < count; i += detail::business_block)
+    {
+        const std::size_t n = std::min(count - i, detail::business_block);
+        detail::serial_days(a + i, n, year, month, day, first);
+        detail::serial_days(b + i, n, year, month, day, last);
+        for (std::size_t j = 0; j < n; ++j)
+        {
+            out[i + j] = between(first[j], last[j]);
+        }
+    }
+}
+
+inline
+void BusinessCalendar::business_days_between(const SerialDate* a, const SerialDate* b, std::size_t count,
+                                             std::int64_t* out) const
+{
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        out[i] = between(a[i].serial(), b[i].serial());
+    }
+}
+
+} // namespace datetime
+
+#endif // DATETIME_BUSINESS_H
@@ -0,0 +1,350 @@
+#ifndef DATETIME_CALENDAR_H
+#define DATETIME_CALENDAR_H
+
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Florian Dang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "datetime.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace datetime
+{
+// Civil calendar columns
+// Batch conversions between days since 1970-01-01 and (year, month, day)
+// columns, for days within the range of date::year (-32767-01-01 to
+// 32767-12-31); other values give unspecified dates. They follow Neri and
+// Schneider, "Euclidean affine functions and their application to calendar
+// algorithms" (2022): the days are shifted by 82 eras so that all arithmetic
+// is unsigned 32 bits, and divisions are multiplications and shifts.
+//
+// The kernels use AVX-512 or AVX2 when the compiler targets them (e.g.
+// -march=native), the same arithmetic one value at a time otherwise.
+void civil_from_days(const std::int32_t* days, std::size_t n,
+                     std::int32_t* year, unsigned char* month, unsigned char* day);
+
+void days_from_civil(const std::int32_t* year, const unsigned char* month, const unsigned char* day,
+                     std::size_t n, std::int32_t* days);
+
+// ISO 8601 week dates of days since 1970-01-01, as SerialDate::isocalendar():
+// the year of the Thursday of the week, the week (1 to 53) and the weekday (1
+// for Monday to 7). With AVX-512 or AVX2, in blocks through the kernels above.
+void iso_from_days(const std::int32_t* days, std::size_t n,
+                   std::int32_t* year, unsigned char* week, unsigned char* weekday);
+
+// Days of the year (1 to 366) of days since 1970-01-01, as SerialDate::dayofyear().
+void dayofyear_from_days(const std::int32_t* days, std::size_t n, unsigned short* yday);
+
+
+// Civil calendar columns impl
+
+namespace detail
+{
+
+// scalar civil_from_day and day_from_civil are in datetime.h
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+// days per pass of the week date and day of year columns, on the stack
+const std::size_t calendar_block = 512;
+#endif
+
+#if defined(__AVX512F__)
+
+#if defined(__GNUC__) && !defined(__clang__)
+// gcc 12 warns on _mm512_undefined_epi32() inside the shift intrinsics
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+// high 32 bits of the 64 bits products of the lanes of x by k
+inline
+__m512i mulhi_epu32(__m512i x, __m512i k)
+{
+    __m512i even = _mm512_srli_epi64(_mm512_mul_epu32(x, k), 32);
+    __m512i odd  = _mm512_mul_epu32(_mm512_srli_epi64(x, 32), k);
+    return _mm512_mask_blend_epi32(0xAAAA, even, odd);
+}
+
+inline
+std::size_t civil_from_days_simd(const std::int32_t* days, std::size_t n,
+                                 std::int32_t* year, unsigned char* month, unsigned char* day)
+{
+    const __m512i shift_days = _mm512_set1_epi32(static_cast<int>(civil_shift_days));
+    const __m512i shift_years = _mm512_set1_epi32(static_cast<int>(civil_shift_years));
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        __m512i v = _mm512_loadu_si512(days + i);
+        __m512i n1 = _mm512_add_epi32(_mm512_slli_epi32(_mm512_add_epi32(v, shift_days), 2), _mm512_set1_epi32(3));
+        __m512i c = _mm512_srli_epi32(mulhi_epu32(n1, _mm512_set1_epi32(15051803)), 9);
+        __m512i nc = _mm512_srli_epi32(_mm512_sub_epi32(n1, _mm512_mullo_epi32(c, _mm512_set1_epi32(146097))), 2);
+        __m512i n2 = _mm512_add_epi32(_mm512_slli_epi32(nc, 2), _mm512_set1_epi32(3));
+        __m512i z = mulhi_epu32(n2, _mm512_set1_epi32(2939745));
+        __m512i ny = _mm512_sub_epi32(_mm512_sub_epi32(nc, _mm512_mullo_epi32(z, _mm512_set1_epi32(365))),
+                                      _mm512_srli_epi32(z, 2));
+        __m512i m = _mm512_srli_epi32(_mm512_add_epi32(_mm512_mullo_epi32(ny, _mm512_set1_epi32(2141)),
+                                                       _mm512_set1_epi32(197913)), 16);
+        __m512i start = _mm512_srli_epi32(_mm512_sub_epi32(_mm512_mullo_epi32(m, _mm512_set1_epi32(979)),
+                                                           _mm512_set1_epi32(2919)), 5);
+        __m512i d = _mm512_add_epi32(_mm512_sub_epi32(ny, start), _mm512_set1_epi32(1));
+        __mmask16 j = _mm512_cmpge_epu32_mask(ny, _mm512_set1_epi32(306));
+        __m512i y = _mm512_sub_epi32(_mm512_add_epi32(_mm512_mullo_epi32(c, _mm512_set1_epi32(100)), z), shift_years);
+        y = _mm512_mask_add_epi32(y, j, y, _mm512_set1_epi32(1));
+        m = _mm512_mask_sub_epi32(m, j, m, _mm512_set1_epi32(12));
+        _mm512_storeu_si512(year + i, y);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(month + i), _mm512_cvtepi32_epi8(m));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(day + i), _mm512_cvtepi32_epi8(d));
+    }
+    return i;
+}
+
+inline
+std::size_t days_from_civil_simd(const std::int32_t* year, const unsigned char* month, const unsigned char* day,
+                                 std::size_t n, std::int32_t* days)
+{
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        __m512i y = _mm512_loadu_si512(year + i);
+        __m512i m = _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(month + i)));
+        __m512i d = _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(day + i)));
+        __mmask16 j = _mm512_cmple_epu32_mask(m, _mm512_set1_epi32(2));
+        y = _mm512_add_epi32(y, _mm512_set1_epi32(static_cast<int>(civil_shift_years)));
+        y = _mm512_mask_sub_epi32(y, j, y, _mm512_set1_epi32(1));
+        m = _mm512_mask_add_epi32(m, j, m, _mm512_set1_epi32(12));
+        __m512i c = _mm512_srli_epi32(mulhi_epu32(y, _mm512_set1_epi32(1374389535)), 5);
+        __m512i v = _mm512_srli_epi32(_mm512_mullo_epi32(y, _mm512_set1_epi32(1461)), 2);
+        v = _mm512_add_epi32(_mm512_sub_epi32(v, c), _mm512_srli_epi32(c, 2));
+        v = _mm512_add_epi32(v, _mm512_srli_epi32(_mm512_sub_epi32(_mm512_mullo_epi32(m, _mm512_set1_epi32(979)),
+                                                                   _mm512_set1_epi32(2919)), 5));
+        v = _mm512_add_epi32(v, d);
+        v = _mm512_sub_epi32(v, _mm512_set1_epi32(static_cast<int>(civil_shift_days + 1)));
+        _mm512_storeu_si512(days + i, v);
+    }
+    return i;
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#elif defined(__AVX2__)
+
+// high 32 bits of the 64 bits products of the lanes of x by k
+inline
+__m256i mulhi_epu32(__m256i x, __m256i k)
+{
+    __m256i even = _mm256_srli_epi64(_mm256_mul_epu32(x, k), 32);
+    __m256i odd  = _mm256_mul_epu32(_mm256_srli_epi64(x, 32), k);
+    return _mm256_blend_epi32(even, odd, 0xAA);
+}
+
+// low byte of each lane, 8 bytes
+inline
+void store_low_bytes(unsigned char* out, __m256i x)
+{
+    const __m256i bytes = _mm256_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                           0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    __m256i packed = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(x, bytes), _mm256_setr_epi32(0, 4, 0, 0, 0, 0, 0, 0));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm256_castsi256_si128(packed));
+}
+
+inline
+std::size_t civil_from_days_simd(const std::int32_t* days, std::size_t n,
+                                 std::int32_t* year, unsigned char* month, unsigned char* day)
+{
+    const __m256i shift_days = _mm256_set1_epi32(static_cast<int>(civil_shift_days));
+    const __m256i shift_years = _mm256_set1_epi32(static_cast<int>(civil_shift_years));
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(days + i));
+        __m256i n1 = _mm256_add_epi32(_mm256_slli_epi32(_mm256_add_epi32(v, shift_days), 2), _mm256_set1_epi32(3));
+        __m256i c = _mm256_srli_epi32(mulhi_epu32(n1, _mm256_set1_epi32(15051803)), 9);
+        __m256i nc = _mm256_srli_epi32(_mm256_sub_epi32(n1, _mm256_mullo_epi32(c, _mm256_set1_epi32(146097))), 2);
+        __m256i n2 = _mm256_add_epi32(_mm256_slli_epi32(nc, 2), _mm256_set1_epi32(3));
+        __m256i z = mulhi_epu32(n2, _mm256_set1_epi32(2939745));
+        __m256i ny = _mm256_sub_epi32(_mm256_sub_epi32(nc, _mm256_mullo_epi32(z, _mm256_set1_epi32(365))),
+                                      _mm256_srli_epi32(z, 2));
+        __m256i m = _mm256_srli_epi32(_mm256_add_epi32(_mm256_mullo_epi32(ny, _mm256_set1_epi32(2141)),
+                                                       _mm256_set1_epi32(197913)), 16);
+        __m256i start = _mm256_srli_epi32(_mm256_sub_epi32(_mm256_mullo_epi32(m, _mm256_set1_epi32(979)),
+                                                           _mm256_set1_epi32(2919)), 5);
+        __m256i d = _mm256_add_epi32(_mm256_sub_epi32(ny, start), _mm256_set1_epi32(1));
+        // ny >= 306, i.e. January or February of the next year: all ones lanes
+        __m256i j = _mm256_cmpgt_epi32(ny, _mm256_set1_epi32(305));
+        __m256i y = _mm256_sub_epi32(_mm256_add_epi32(_mm256_mullo_epi32(c, _mm256_set1_epi32(100)), z), shift_years);
+        y = _mm256_sub_epi32(y, j);
+        m = _mm256_sub_epi32(m, _mm256_and_si256(j, _mm256_set1_epi32(12)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(year + i), y);
+        store_low_bytes(month + i, m);
+        store_low_bytes(day + i, d);
+    }
+    return i;
+}
+
+inline
+std::size_t days_from_civil_simd(const std::int32_t* year, const unsigned char* month, const unsigned char* day,
+                                 std::size_t n, std::int32_t* days)
+{
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(year + i));
+        __m256i m = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(month + i)));
+        __m256i d = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(day + i)));
+        // month <= 2: all ones lanes
+        __m256i j = _mm256_cmpgt_epi32(_mm256_set1_epi32(3), m);
+        y = _mm256_add_epi32(_mm256_add_epi32(y, _mm256_set1_epi32(static_cast<int>(civil_shift_years))), j);
+        m = _mm256_add_epi32(m, _mm256_and_si256(j, _mm256_set1_epi32(12)));
+        __m256i c = _mm256_srli_epi32(mulhi_epu32(y, _mm256_set1_epi32(1374389535)), 5);
+        __m256i v = _mm256_srli_epi32(_mm256_mullo_epi32(y, _mm256_set1_epi32(1461)), 2);
+        v = _mm256_add_epi32(_mm256_sub_epi32(v, c), _mm256_srli_epi32(c, 2));
+        v = _mm256_add_epi32(v, _mm256_srli_epi32(_mm256_sub_epi32(_mm256_mullo_epi32(m, _mm256_set1_epi32(979)),
+                                                                   _mm256_set1_epi32(2919)), 5));
+        v = _mm256_add_epi32(v, d);
+        v = _mm256_sub_epi32(v, _mm256_set1_epi32(static_cast<int>(civil_shift_days + 1)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(days + i), v);
+    }
+    return i;
+}
+
+#else
+
+inline
+std::size_t civil_from_days_simd(const std::int32_t*, std::size_t, std::int32_t*, unsigned char*, unsigned char*)
+{
+    return 0;
+}
+
+inline
+std::size_t days_from_civil_simd(const std::int32_t*, const unsigned char*, const unsigned char*, std::size_t,
+                                 std::int32_t*)
+{
+    return 0;
+}
+
+#endif
+
+} // namespace detail
+
+inline
+void civil_from_days(const std::int32_t* days, std::size_t n,
+                     std::int32_t* year, unsigned char* month, unsigned char* day)
+{
+    for (std::size_t i = detail::civil_from_days_simd(days, n, year, month, day); i < n; ++i)
+    {
+        detail::civil_from_day(days[i], year[i], month[i], day[i]);
+    }
+}
+
+inline
+void days_from_civil(const std::int32_t* year, const unsigned char* month, const unsigned char* day,
+                     std::size_t n, std::int32_t* days)
+{
+    for (std::size_t i = detail::days_from_civil_simd(year, month, day, n, days); i < n; ++i)
+    {
+        days[i] = detail::day_from_civil(year[i], month[i], day[i]);
+    }
+}
+
+inline
+void iso_from_days(const std::int32_t* days, std::size_t n,
+                   std::int32_t* year, unsigned char* week, unsigned char* weekday)
+{
+#if defined(__AVX512F__) || defined(__AVX2__)
+    std::int32_t thursday[detail::calendar_block];
+    std::int32_t first[detail::calendar_block];
+    unsigned char month[detail::calendar_block];
+    unsigned char day[detail::calendar_block];
+    for (std::size_t i = 0; i < n; i += detail::calendar_block)
+    {
+        const std::size_t b = n - i < detail::calendar_block ? n - i : detail::calendar_block;
+        for (std::size_t j = 0; j < b; ++j)
+        {
+            const std::uint32_t w = (static_cast<std::uint32_t>(days[i + j]) + detail::civil_shift_days + 2) % 7;
+            thursday[j] = days[i + j] - static_cast<std::int32_t>(w) + 3;
+            weekday[i + j] = static_cast<unsigned char>(w + 1);
+        }
+        // the weeks from January 1st of the year of the Thursday
+        civil_from_days(thursday, b, year + i, month, day);
+        for (std::size_t j = 0; j < b; ++j)
+        {
+            month[j] = 1;
+            day[j] = 1;
+        }
+        days_from_civil(year + i, month, day, b, first);
+        for (std::size_t j = 0; j < b; ++j)
+        {
+            week[i + j] = static_cast<unsigned char>(static_cast<std::uint32_t>(thursday[j] - first[j]) / 7 + 1);
+        }
+    }
+#else
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        unsigned w = 0, d = 0;
+        detail::iso_from_day(days[i], year[i], w, d);
+        week[i] = static_cast<unsigned char>(w);
+        weekday[i] = static_cast<unsigned char>(d);
+    }
+#endif
+}
+
+inline
+void dayofyear_from_days(const std::int32_t* days, std::size_t n, unsigned short* yday)
+{
+#if defined(__AVX512F__) || defined(__AVX2__)
+    std::int32_t year[detail::calendar_block];
+    std::int32_t first[detail::calendar_block];
+    unsigned char month[detail::calendar_block];
+    unsigned char day[detail::calendar_block];
+    for (std::size_t i = 0; i < n; i += detail::calendar_block)
+    {
+        const std::size_t b = n - i < detail::calendar_block ? n - i : detail::calendar_block;
+        civil_from_days(days + i, b, year, month, day);
+        for (std::size_t j = 0; j < b; ++j)
+        {
+            month[j] = 1;
+            day[j] = 1;
+        }
+        days_from_civil(year, month, day, b, first);
+        for (std::size_t j = 0; j < b; ++j)
+        {
+            yday[i + j] = static_cast<unsigned short>(days[i + j] - first[j] + 1);
+        }
+    }
+#else
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        yday[i] = static_cast<unsigned short>(SerialDate(days[i]).dayofyear());
+    }
+#endif
+}
+
+} // namespace datetime
+
+#endif // DATETIME_CALENDAR_H
@@ -98,6 +98,10 @@ namespace date
 #  define NOEXCEPT noexcept
 #endif
 
+#ifndef ONLY_C_LOCALE
+#  define ONLY_C_LOCALE 0
+#endif
+
 //-----------+
 // Interface |
 //-----------+
@@ -4231,8 +4235,157 @@ extract_weekday(const fields<Duration>& fds)
     return wd;
 }
 
+// C locale names
+//
+// When the C locale names are selected on a stream (see c_locale_names below),
+// %a %A %b %B %h %c %x %X %p %r are written and read with these tables instead
+// of going through the time_put / time_get facets of the stream's locale.
+
+inline
+int
+c_locale_index()
+{
+    static const int i = std::ios_base::xalloc();
+    return i;
+}
+
+inline
+bool
+uses_c_names(std::ios_base& ios)
+{
+#if ONLY_C_LOCALE
+    return true;
+#else
+    return ios.iword(c_locale_index()) != 0;
+#endif
+}
+
+// full names at [0, 7), abbreviations at [7, 14)
+inline
+const char* const*
+weekday_names()
+{
+    static const char* const nm[] =
+    {
+        "Sunday", "Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday",
+        "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"
+    };
+    return nm;
+}
+
+// full names at [0, 12), abbreviations at [12, 24)
+inline
+const char* const*
+month_names()
+{
+    static const char* const nm[] =
+    {
+        "January", "February", "March", "April", "May", "June",
+        "July", "August", "September", "October", "November", "December",
+        "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+        "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+    };
+    return nm;
+}
+
+inline
+const char* const*
+ampm_names()
+{
+    static const char* const nm[] = {"AM", "PM"};
+    return nm;
+}
+
+template <class CharT, class Traits>
+inline
+void
+put_c_name(std::basic_ostream<CharT, Traits>& os, const char* name)
+{
+    auto sb = os.rdbuf();
+    for (; *name; ++name)
+        sb->sputc(CharT(*name));
+}
+
+template <class CharT, class Traits>
+inline
+void
+put_2(std::basic_ostream<CharT, Traits>& os, unsigned x, CharT fill)
+{
+    auto sb = os.rdbuf();
+    sb->sputc(x < 10 ? fill : CharT('0' + x / 10 % 10));
+    sb->sputc(CharT('0' + x % 10));
+}
+
+template <class CharT, class Traits>
+inline
+void
+put_year(std::basic_ostream<CharT, Traits>& os, const year& y)
+{
+    auto i = static_cast<int>(y);
+    if (0 <= i && i <= 9999)
+    {
+        auto u = static_cast<unsigned>(i);
+        put_2(os, u / 100, CharT{'0'});
+        put_2(os, u % 100, CharT{'0'});
+    }
+    else
+        os << y;
+}
+
+// Reads an alphabetic word of at most 9 characters and matches it without
+// regard to case against names[0, n).  Returns the index of the match or -1.
+template <class CharT, class Traits>
+int
+read_c_name(std::basic_istream<CharT, Traits>& is, const char* const* names, unsigned n)
+{
+    char buf[10];
+    unsigned len = 0;
+    while (len < sizeof(buf) - 1)
+    {
+        auto ic = is.peek();
+        if (Traits::eq_int_type(ic, Traits::eof()))
+            break;
+        auto C = Traits::to_char_type(ic);
+        if (!(('a' <= C && C <= 'z') || ('A' <= C && C <= 'Z')))
+            break;
+        buf[len++] = static_cast<char>(C | 0x20);
+        (void)is.get();
+    }
+    for (unsigned i = 0; i < n; ++i)
+    {
+        const char* nm = names[i];
+        unsigned k = 0;
+        while (k < len && nm[k] != '\0' && (nm[k] | 0x20) == buf[k])
+            ++k;
+        if (k == len && nm[k] == '\0')
+            return static_cast<int>(i);
+    }
+    is.setstate(std::ios::failbit);
+    return -1;
+}
+
 }  // namespace detail
 
+// Stream manipulators selecting how names are formatted and parsed:
+// c_locale_names uses fixed English (C locale) tables, locale_names (the
+// default) defers to the facets of the stream's locale.
+
+inline
+std::ios_base&
+c_locale_names(std::ios_base& ios)
+{
+    ios.iword(detail::c_locale_index()) = 1;
+    return ios;
+}
+
+inline
+std::ios_base&
+locale_names(std::ios_base& ios)
+{
+    ios.iword(detail::c_locale_index()) = 0;
+    return ios;
+}
+
 template <class CharT, class Traits, class Duration>
 void
 to_stream(std::basic_ostream<CharT, Traits>& os, const CharT* fmt,
@@ -4243,6 +4396,7 @@ to_stream(std::basic_ostream<CharT, Traits>& os, const CharT* fmt,
     using namespace std::chrono;
     tm tm;
     auto& facet = use_facet<time_put<CharT>>(os.getloc());
+    const bool c_names = detail::uses_c_names(os);
     const CharT* command = nullptr;
     CharT modified = CharT{};
     for (; *fmt; ++fmt)
@@ -4260,8 +4414,21 @@ to_stream(std::basic_ostream<CharT, Traits>& os, const CharT* fmt,
                 if (modified == CharT{})
                 {
                     tm.tm_wday = static_cast<int>(detail::extract_weekday(fds));
-                    const CharT f[] = {'%', *fmt};
-                    facet.put(os, os, os.fill(), &tm, begin(f), end(f));
+                    if (c_names)
+                    {
+                        if (!weekday{static_cast<unsigned>(tm.tm_wday)}.ok())
+                        {
+                            os.setstate(std::ios::failbit);
+                            return;
+                        }
+                        detail::put_c_name(os, detail::weekday_names()[tm.tm_wday +
+                                                (*fmt == CharT{'a'} ? 7 : 0)]);
+                    }
+                    else
+                    {
+                        const CharT f[] = {'%', *fmt};
+                        facet.put(os, os, os.fill(), &tm, begin(f), end(f));
+                    }
                 }
                 else
                 {
@@ -4281,8 +4448,21 @@ to_stream(std::basic_ostream<CharT, Traits>& os, const CharT* fmt,
                 if (modified == CharT{})
                 {
                     tm.tm_mon = static_cast<int>(unsigned(fds.ymd.month())) - 1;
-                    const CharT f[] = {'%', *fmt};
-                    facet.put(os, os, os.fill(), &tm, begin(f), end(f));
+                    if (c_names)
+                    {
+                        if (!fds.ymd.month().ok())
+                        {
+                            os.setstate(std::ios::failbit);
+                            return;
+                        }
+                        detail::put_c_name(os, detail::month_names()[tm.tm_mon +
+                                                (*fmt == CharT{'B'} ? 0 : 12)]);
+                    }
+                    else
+                    {
+                        const CharT f[] = {'%', *fmt};
+                        facet.put(os, os, os.fill(), &tm, begin(f), end(f));
+                    }
                 }
                 else
                 {
@@ -4300,6 +4480,44 @@ to_stream(std::basic_ostream<CharT, Traits>& os, const CharT* fmt,
             {
                 if (modified == CharT{'O'})
                     os << CharT{'%'} << modified << *fmt;
+                else if (c_names)
+                {
+                    // "%a %b %e %H:%M:%S %Y" and "%m/%d/%y"
+                    auto const& ymd = fds.ymd;
+                    auto m = static_cast<unsigned>(ymd.month());
+                    auto d = static_cast<unsigned>(ymd.day());
+                    if (*fmt == CharT{'c'})
+                    {
+                        auto wd = detail::extract_weekday(fds);
+                        if (!weekday{wd}.ok() || !ymd.month().ok())
+                        {
+                            os.setstate(std::ios::failbit);
+                            return;
+                        }
+                        detail::put_c_name(os, detail::weekday_names()[wd + 7]);
+                        os.put(CharT{' '});
+                        detail::put_c_name(os, detail::month_names()[m - 1 + 12]);
+                        os.put(CharT{' '});
+                        detail::put_2(os, d, CharT{' '});
+                        os.put(CharT{' '});
+                        detail::put_2(os, static_cast<unsigned>(fds.tod.hours().count()), CharT{'0'});
+                        os.put(CharT{':'});
+                        detail::put_2(os, static_cast<unsigned>(fds.tod.minutes().count()), CharT{'0'});
+                        os.put(CharT{':'});
+                        detail::put_2(os, static_cast<unsigned>(fds.tod.seconds().count()), CharT{'0'});
+                        os.put(CharT{' '});
+                        detail::put_year(os, ymd.year());
+                    }
+                    else
+                    {
+                        detail::put_2(os, m, CharT{'0'});
+                        os.put(CharT{'/'});
+                        detail::put_2(os, d, CharT{'0'});
+                        os.put(CharT{'/'});
+                        detail::put_2(os, static_cast<unsigned>(std::abs(static_cast<int>(ymd.year())) % 100),
+                                      CharT{'0'});
+                    }
+                }
                 else
                 {
                     tm = std::tm{};
@@ -4604,9 +4822,14 @@ to_stream(std::basic_ostream<CharT, Traits>& os, const CharT* fmt,
             {
                 if (modified == CharT{})
                 {
-                    const CharT f[] = {'%', *fmt};
                     tm.tm_hour = static_cast<int>(fds.tod.hours().count());
-                    facet.put(os, os, os.fill(), &tm, begin(f), end(f));
+                    if (c_names)
+                        detail::put_c_name(os, detail::ampm_names()[tm.tm_hour < 12 ? 0 : 1]);
+                    else
+                    {
+                        const CharT f[] = {'%', *fmt};
+                        facet.put(os, os, os.fill(), &tm, begin(f), end(f));
+                    }
                 }
                 else
                 {
@@ -4623,11 +4846,26 @@ to_stream(std::basic_ostream<CharT, Traits>& os, const CharT* fmt,
             {
                 if (modified == CharT{})
                 {
-                    const CharT f[] = {'%', *fmt};
                     tm.tm_hour = static_cast<int>(fds.tod.hours().count());
                     tm.tm_min = static_cast<int>(fds.tod.minutes().count());
                     tm.tm_sec = static_cast<int>(fds.tod.seconds().count());
-                    facet.put(os, os, os.fill(), &tm, begin(f), end(f));
+                    if (c_names)
+                    {
+                        // "%I:%M:%S %p"
+                        auto h12 = static_cast<unsigned>(tm.tm_hour % 12);
+                        detail::put_2(os, h12 == 0 ? 12u : h12, CharT{'0'});
+                        os.put(CharT{':'});
+                        detail::put_2(os, static_cast<unsigned>(tm.tm_min), CharT{'0'});
+                        os.put(CharT{':'});
+                        detail::put_2(os, static_cast<unsigned>(tm.tm_sec), CharT{'0'});
+                        os.put(CharT{' '});
+                        detail::put_c_name(os, detail::ampm_names()[tm.tm_hour < 12 ? 0 : 1]);
+                    }
+                    else
+                    {
+                        const CharT f[] = {'%', *fmt};
+                        facet.put(os, os, os.fill(), &tm, begin(f), end(f));
+                    }
                 }
                 else
                 {
@@ -4884,6 +5122,15 @@ to_stream(std::basic_ostream<CharT, Traits>& os, const CharT* fmt,
             {
                 if (modified == CharT{'O'})
                     os << CharT{'%'} << modified << *fmt;
+                else if (c_names)
+                {
+                    // "%H:%M:%S"
+                    detail::put_2(os, static_cast<unsigned>(fds.tod.hours().count()), CharT{'0'});
+                    os.put(CharT{':'});
+                    detail::put_2(os, static_cast<unsigned>(fds.tod.minutes().count()), CharT{'0'});
+                    os.put(CharT{':'});
+                    detail::put_2(os, static_cast<unsigned>(fds.tod.seconds().count()), CharT{'0'});
+                }
                 else
                 {
                     tm = std::tm{};
@@ -5459,6 +5706,7 @@ from_stream(std::basic_istream<CharT, Traits>& is, const CharT* fmt,
     if (ok)
     {
         auto& f = use_facet<time_get<CharT>>(is.getloc());
+        const bool c_names = detail::uses_c_names(is);
         std::tm tm{};
         std::basic_string<CharT, Traits, Alloc> temp_abbrev;
         minutes temp_offset{};
@@ -5497,7 +5745,16 @@ from_stream(std::basic_istream<CharT, Traits>& is, const CharT* fmt,
             {
             case 'a':
             case 'A':
-                if (command)
+                if (command && c_names)
+                {
+                    auto i = detail::read_c_name(is, detail::weekday_names(), 14);
+                    command = nullptr;
+                    width = -1;
+                    modified = CharT{};
+                    if (i >= 0)
+                        wd = i % 7;
+                }
+                else if (command)
                 {
                     ios_base::iostate err = ios_base::goodbit;
                     f.get(is, 0, is, err, &tm, command, fmt+1);
@@ -5514,7 +5771,16 @@ from_stream(std::basic_istream<CharT, Traits>& is, const CharT* fmt,
             case 'b':
             case 'B':
             case 'h':
-                if (command)
+                if (command && c_names)
+                {
+                    auto i = detail::read_c_name(is, detail::month_names(), 24);
+                    command = nullptr;
+                    width = -1;
+                    modified = CharT{};
+                    if (i >= 0)
+                        m = i % 12 + 1;
+                }
+                else if (command)
                 {
                     ios_base::iostate err = ios_base::goodbit;
                     f.get(is, 0, is, err, &tm, command, fmt+1);
@@ -5529,7 +5795,27 @@ from_stream(std::basic_istream<CharT, Traits>& is, const CharT* fmt,
                     read(is, *fmt);
                 break;
             case 'c':
-                if (command)
+                if (command && c_names)
+                {
+                    const CharT cf[] = {'%', 'a', ' ', '%', 'b', ' ', '%', 'e', ' ', '%', 'H', ':', '%', 'M', ':', '%', 'S', ' ', '%', 'Y', '\0'};
+                    fields<seconds> cfds;
+                    from_stream(is, cf, cfds, static_cast<std::basic_string<CharT, Traits, Alloc>*>(nullptr),
+                                static_cast<minutes*>(nullptr));
+                    command = nullptr;
+                    width = -1;
+                    modified = CharT{};
+                    if (!is.fail())
+                    {
+                        Y = static_cast<int>(cfds.ymd.year());
+                        m = static_cast<int>(static_cast<unsigned>(cfds.ymd.month()));
+                        d = static_cast<int>(static_cast<unsigned>(cfds.ymd.day()));
+                        h = cfds.tod.hours();
+                        min = cfds.tod.minutes();
+                        s = duration_cast<Duration>(cfds.tod.seconds());
+                        wd = static_cast<int>(static_cast<unsigned>(cfds.wd));
+                    }
+                }
+                else if (command)
                 {
                     ios_base::iostate err = ios_base::goodbit;
                     f.get(is, 0, is, err, &tm, command, fmt+1);
@@ -5551,7 +5837,23 @@ from_stream(std::basic_istream<CharT, Traits>& is, const CharT* fmt,
                     read(is, *fmt);
                 break;
             case 'x':
-                if (command)
+                if (command && c_names)
+                {
+                    const CharT cf[] = {'%', 'm', '/', '%', 'd', '/', '%', 'y', '\0'};
+                    fields<seconds> cfds;
+                    from_stream(is, cf, cfds, static_cast<std::basic_string<CharT, Traits, Alloc>*>(nullptr),
+                                static_cast<minutes*>(nullptr));
+                    command = nullptr;
+                    width = -1;
+                    modified = CharT{};
+                    if (!is.fail())
+                    {
+                        Y = static_cast<int>(cfds.ymd.year());
+                        m = static_cast<int>(static_cast<unsigned>(cfds.ymd.month()));
+                        d = static_cast<int>(static_cast<unsigned>(cfds.ymd.day()));
+                    }
+                }
+                else if (command)
                 {
                     ios_base::iostate err = ios_base::goodbit;
                     f.get(is, 0, is, err, &tm, command, fmt+1);
@@ -5570,7 +5872,23 @@ from_stream(std::basic_istream<CharT, Traits>& is, const CharT* fmt,
                     read(is, *fmt);
                 break;
             case 'X':
-                if (command)
+                if (command && c_names)
+                {
+                    const CharT cf[] = {'%', 'H', ':', '%', 'M', ':', '%', 'S', '\0'};
+                    fields<seconds> cfds;
+                    from_stream(is, cf, cfds, static_cast<std::basic_string<CharT, Traits, Alloc>*>(nullptr),
+                                static_cast<minutes*>(nullptr));
+                    command = nullptr;
+                    width = -1;
+                    modified = CharT{};
+                    if (!is.fail())
+                    {
+                        h = cfds.tod.hours();
+                        min = cfds.tod.minutes();
+                        s = duration_cast<Duration>(cfds.tod.seconds());
+                    }
+                }
+                else if (command)
                 {
                     ios_base::iostate err = ios_base::goodbit;
                     f.get(is, 0, is, err, &tm, command, fmt+1);
@@ -5824,13 +6142,25 @@ from_stream(std::basic_istream<CharT, Traits>& is, const CharT* fmt,
                     {
                         if (I == not_a_hour_12_value)
                             goto broken;
-                        tm.tm_hour = I;
-                        ios_base::iostate err = ios_base::goodbit;
-                        f.get(is, 0, is, err, &tm, command, fmt+1);
-                        if (!(err & ios::failbit))
+                        if (c_names)
                         {
-                            h = hours{tm.tm_hour};
-                            I = not_a_hour_12_value;
+                            auto i = detail::read_c_name(is, detail::ampm_names(), 2);
+                            if (i >= 0)
+                            {
+                                h = hours{I % 12 + 12 * i};
+                                I = not_a_hour_12_value;
+                            }
+                        }
+                        else
+                        {
+                            tm.tm_hour = I;
+                            ios_base::iostate err = ios_base::goodbit;
+                            f.get(is, 0, is, err, &tm, command, fmt+1);
+                            if (!(err & ios::failbit))
+                            {
+                                h = hours{tm.tm_hour};
+                                I = not_a_hour_12_value;
+                            }
                         }
                     }
                     else
@@ -5844,7 +6174,23 @@ from_stream(std::basic_istream<CharT, Traits>& is, const CharT* fmt,
 
                break;
             case 'r':
-                if (command)
+                if (command && c_names)
+                {
+                    const CharT cf[] = {'%', 'I', ':', '%', 'M', ':', '%', 'S', ' ', '%', 'p', '\0'};
+                    fields<seconds> cfds;
+                    from_stream(is, cf, cfds, static_cast<std::basic_string<CharT, Traits, Alloc>*>(nullptr),
+                                static_cast<minutes*>(nullptr));
+                    command = nullptr;
+                    width = -1;
+                    modified = CharT{};
+                    if (!is.fail())
+                    {
+                        h = cfds.tod.hours();
+                        min = cfds.tod.minutes();
+                        s = duration_cast<Duration>(cfds.tod.seconds());
+                    }
+                }
+                else if (command)
                 {
                     ios_base::iostate err = ios_base::goodbit;
                     f.get(is, 0, is, err, &tm, command, fmt+1);
@@ -31,60 +31,382 @@
 #include "tz.h"
 
 #include <iomanip>
+#include <algorithm>
+#include <cctype>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
 
 #include <iostream>
 
 namespace datetime 
 {
-// TimeDelta
-// Warning! normalization of negative values is not the same as in Python
-class TimeDelta
+
+namespace detail
+{
+
+// format with the fixed C locale names instead of the stream locale facets
+template <class Streamable>
+inline
+std::string format_c_locale(const char* format, const Streamable& x)
+{
+    std::ostringstream os;
+    os << date::c_locale_names;
+    date::to_stream(os, format, x);
+    return os.str();
+}
+
+// Writes v in decimal with at least min_width digits (zero padded).
+// Returns the end of the written text or nullptr if it does not fit.
+inline
+char* write_uint(char* first, char* last, std::uint64_t v, unsigned min_width = 1)
+{
+    char buf[20];
+    unsigned n = 0;
+    do
+    {
+        buf[n++] = static_cast<char>('0' + v % 10);
+        v /= 10;
+    } while (v != 0);
+    while (n < min_width && n < sizeof(buf))
+    {
+        buf[n++] = '0';
+    }
+    if (last - first < static_cast<std::ptrdiff_t>(n))
+    {
+        return nullptr;
+    }
+    while (n > 0)
+    {
+        *first++ = buf[--n];
+    }
+    return first;
+}
+
+// Reads at most max_digits decimal digits into x, false if there are none.
+inline
+bool read_digits(const char*& p, const char* last, unsigned max_digits, int& x)
+{
+    unsigned n = 0;
+    int v = 0;
+    while (p != last && n < max_digits && '0' <= *p && *p <= '9')
+    {
+        v = 10 * v + (*p++ - '0');
+        ++n;
+    }
+    x = v;
+    return n > 0;
+}
+
+// Number of decimals needed to show a duration of period Period exactly (at most 9).
+template <class Period>
+inline
+CONSTCD11 unsigned decimals()
+{
+    return Period::num != 1 || Period::den == 1 ? 0
+         : Period::den <= 10 ? 1 : Period::den <= 100 ? 2 : Period::den <= 1000 ? 3
+         : Period::den <= 10000 ? 4 : Period::den <= 100000 ? 5 : Period::den <= 1000000 ? 6
+         : Period::den <= 10000000 ? 7 : Period::den <= 100000000 ? 8 : 9;
+}
+
+// Quotient rounded toward negative infinity and remainder of the sign of b,
+// as // and % in Python.
+CONSTCD11
+inline
+std::int64_t floor_div(std::int64_t a, std::int64_t b)
+{
+    return a / b - (a % b != 0 && (a % b < 0) != (b < 0) ? 1 : 0);
+}
+
+CONSTCD11
+inline
+std::int64_t floor_mod(std::int64_t a, std::int64_t b)
+{
+    return a % b + (a % b != 0 && (a % b < 0) != (b < 0) ? b : 0);
+}
+
+// q + 1 when a = q * b + r is nearer to it, or as near and q is odd; r has the
+// sign of b, as from floor_div and floor_mod
+CONSTCD11
+inline
+std::int64_t round_half_even(std::int64_t q, std::int64_t r, std::int64_t b)
+{
+    return q + ((b > 0 ? r > b - r : r < b - r) || (r == b - r && q % 2 != 0) ? 1 : 0);
+}
+
+// a / b rounded half to even
+CONSTCD11
+inline
+std::int64_t div_half_even(std::int64_t a, std::int64_t b)
+{
+    return round_half_even(floor_div(a, b), floor_mod(a, b), b);
+}
+
+// Writes d as seconds with decimals<Period>() fractional digits, e.g. "-1.500".
+template <class Rep, class Period>
+inline
+char* write_decimal_seconds(char* first, char* last, const std::chrono::duration<Rep, Period>& d)
+{
+    using namespace std::chrono;
+    const unsigned digits = decimals<Period>();
+    if (first == last)
+    {
+        return nullptr;
+    }
+    if (d < duration<Rep, Period>::zero())
+    {
+        *first++ = '-';
+    }
+    // whole seconds and the fraction are split in Period, only the fraction
+    // goes through nanoseconds, which would overflow past +-292 years
+    const auto whole = duration_cast<seconds>(d);
+    auto s = whole.count();
+    first = write_uint(first, last, s < 0 ? 0 - static_cast<std::uint64_t>(s) : static_cast<std::uint64_t>(s));
+    if (digits == 0)
+    {
+        return first;
+    }
+    if (first == nullptr || first == last)
+    {
+        return nullptr;
+    }
+    *first++ = '.';
+    auto ns = duration_cast<nanoseconds>(d - whole).count();
+    auto fraction = ns < 0 ? 0 - static_cast<std::uint64_t>(ns) : static_cast<std::uint64_t>(ns);
+    for (unsigned i = digits; i < 9; ++i)
+    {
+        fraction /= 10;
+    }
+    return write_uint(first, last, fraction, digits);
+}
+
+} // namespace detail
+
+
+// errc
+// Errors reported through std::error_code by the non-throwing overloads.
+enum class errc
+{
+    parse_error = 1,
+    nonexistent_local_time,
+    ambiguous_local_time,
+    unknown_time_zone,
+    timestamp_out_of_range,
+    invalid_rule
+};
+
+const std::error_category& error_category();
+std::error_code make_error_code(errc e);
+
+} // namespace datetime
+
+namespace std
+{
+template <> struct is_error_code_enum<datetime::errc> : true_type {};
+} // namespace std
+
+namespace datetime
+{
+
+// Same lookup as date::locate_zone, but an unknown name (or a missing time
+// zone database) gives nullptr, resp. ec, instead of an exception.
+const date::time_zone* try_locate_zone(const std::string& name);
+const date::time_zone* locate_zone(const std::string& name, std::error_code& ec);
+
+
+class Format;
+
+
+// text forms of BasicTimeDelta, shared by all precisions
+enum class TimeDeltaStyle
+{
+    python,     // str() in Python: "-1 day, 23:59:58.500000"
+    iso8601,    // ISO 8601 duration: "-PT1.5S"
+    compact     // as Go durations: "1h2m3.5s", "1.5ms", "250us", "10ns"
+};
+
+// BasicTimeDelta
+// A single count of ticks of Duration (TimeDelta counts microseconds, as in
+// Python): arithmetic is integer arithmetic, and days, seconds and microseconds
+// are derived on access, normalized as in Python (only days may be negative,
+// 0 <= seconds < 86400, 0 <= microseconds < 10^6, floored for finer ticks).
+// Mixing precisions gives the finer one, so no tick is lost.
+template <class Duration>
+class BasicTimeDelta
 {
-    date::days                  days_;
-    std::chrono::seconds        seconds_;
-    std::chrono::microseconds   microseconds_;
+    Duration duration_;
+
+    // Duration, or seconds when Duration is coarser
+    using fine_duration = typename std::common_type<Duration, std::chrono::seconds>::type;
 
 public:
-    template <class Duration>
-    TimeDelta(const Duration& d);
+    using duration = Duration;
 
-    template<class Duration, class ... Durations>
-    TimeDelta(const Duration& d, const Durations&... durations);
+    template <class Duration2>
+    CONSTCD11 BasicTimeDelta(const Duration2& d); // truncated toward zero to Duration
 
-    const date::days::rep                   days()          const { return days_.count(); }
-    const std::chrono::seconds::rep         seconds()       const { return seconds_.count(); }
-    const std::chrono::microseconds::rep    microseconds()  const { return microseconds_.count(); }
+    template <class Duration2>
+    CONSTCD11 BasicTimeDelta(const BasicTimeDelta<Duration2>& x);
 
-    const std::chrono::seconds::rep         total_seconds() const;
+    template<class Duration2, class ... Durations>
+    CONSTCD11 BasicTimeDelta(const Duration2& d, const Durations&... durations);
 
-private:
-    template<class Duration>
-    void add_delta(const Duration& d); 
+    CONSTCD11 const date::days::rep                 days()          const;
+    CONSTCD11 const std::chrono::seconds::rep       seconds()       const;
+    CONSTCD11 const std::chrono::microseconds::rep  microseconds()  const;
+
+    CONSTCD11 const std::chrono::seconds::rep       total_seconds() const; // floored
+
+    CONSTCD11 Duration to_duration() const { return duration_; } // extra method
+
+    // the range of the tick count and a single tick, as in Python
+    static CONSTCD11 BasicTimeDelta min()           { return BasicTimeDelta(Duration::min()); }
+    static CONSTCD11 BasicTimeDelta max()           { return BasicTimeDelta(Duration::max()); }
+    static CONSTCD11 BasicTimeDelta resolution()    { return BasicTimeDelta(Duration(1)); }
+
+    CONSTCD14 BasicTimeDelta& operator+=(const BasicTimeDelta& x) { duration_ += x.duration_; return *this; }
+    CONSTCD14 BasicTimeDelta& operator-=(const BasicTimeDelta& x) { duration_ -= x.duration_; return *this; }
+    CONSTCD14 BasicTimeDelta& operator%=(const BasicTimeDelta& x);
+    template <class Scalar>
+    CONSTCD14 BasicTimeDelta& operator*=(Scalar s);
+    template <class Scalar>
+    CONSTCD14 BasicTimeDelta& operator/=(Scalar s);
+
+    // extra methods : text forms, values normalized as in Python; fractions
+    // have 6 digits, 9 when a value has ticks below the microsecond
+    using Style = TimeDeltaStyle;
+    static const std::size_t max_chars = 48;
+
+    // returns the end of the written text, or nullptr if [first, last) is too small
+    char* to_chars(char* first, char* last, Style style = Style::python) const;
+    std::string str(Style style = Style::python) const;
 
-    template<class Duration, class ... Durations>
-    void add_delta(const Duration& d, const Durations&... durations); 
+    // returns the end of the parsed text, or nullptr on failure (never throws);
+    // values are rounded half to even to the tick
+    static const char* from_chars(const char* first, const char* last, BasicTimeDelta& out,
+                                  Style style = Style::python);
 };
 
+using TimeDelta = BasicTimeDelta<std::chrono::microseconds>;
 
-TimeDelta operator+(const TimeDelta&  x, const TimeDelta& y);
-TimeDelta operator-(const TimeDelta&  x, const TimeDelta& y);
 
-template<class Scalar, typename std::enable_if<std::is_floating_point<Scalar>::value>::type* = nullptr>
-TimeDelta operator*(Scalar s, const TimeDelta& x);
+CONSTCD11 TimeDelta operator+(const TimeDelta&  x, const TimeDelta& y);
+CONSTCD11 TimeDelta operator-(const TimeDelta&  x, const TimeDelta& y);
 
-template<class Scalar, typename std::enable_if<std::is_integral<Scalar>::value>::type* = nullptr>
-TimeDelta operator*(Scalar s, const TimeDelta& x);
+// mixed precisions, in the finer one
+template <class Duration1, class Duration2>
+CONSTCD11 BasicTimeDelta<typename std::common_type<Duration1, Duration2>::type>
+operator+(const BasicTimeDelta<Duration1>& x, const BasicTimeDelta<Duration2>& y);
 
-template<class Scalar, typename std::enable_if<std::is_floating_point<Scalar>::value>::type* = nullptr>
-TimeDelta operator*(const TimeDelta& x, Scalar s);
+template <class Duration1, class Duration2>
+CONSTCD11 BasicTimeDelta<typename std::common_type<Duration1, Duration2>::type>
+operator-(const BasicTimeDelta<Duration1>& x, const BasicTimeDelta<Duration2>& y);
 
-template<class Scalar, typename std::enable_if<std::is_integral<Scalar>::value>::type* = nullptr>
-TimeDelta operator*(const TimeDelta& x, Scalar s);
+template<class Scalar, class Duration, typename std::enable_if<std::is_floating_point<Scalar>::value>::type* = nullptr>
+BasicTimeDelta<Duration> operator*(Scalar s, const BasicTimeDelta<Duration>& x);
 
-template<class CharT, class Traits>
+template<class Scalar, class Duration, typename std::enable_if<std::is_integral<Scalar>::value>::type* = nullptr>
+CONSTCD11 BasicTimeDelta<Duration> operator*(Scalar s, const BasicTimeDelta<Duration>& x);
+
+template<class Scalar, class Duration, typename std::enable_if<std::is_floating_point<Scalar>::value>::type* = nullptr>
+BasicTimeDelta<Duration> operator*(const BasicTimeDelta<Duration>& x, Scalar s);
+
+template<class Scalar, class Duration, typename std::enable_if<std::is_integral<Scalar>::value>::type* = nullptr>
+CONSTCD11 BasicTimeDelta<Duration> operator*(const BasicTimeDelta<Duration>& x, Scalar s);
+
+// quotients: by a scalar rounded half to even to the tick, by a BasicTimeDelta
+// as a double, as / in Python; a zero divisor throws std::domain_error, as
+// ZeroDivisionError in Python, and so do floor_div, % and divmod below
+template<class Scalar, class Duration, typename std::enable_if<std::is_floating_point<Scalar>::value>::type* = nullptr>
+BasicTimeDelta<Duration> operator/(const BasicTimeDelta<Duration>& x, Scalar s);
+
+template<class Scalar, class Duration, typename std::enable_if<std::is_integral<Scalar>::value>::type* = nullptr>
+CONSTCD11 BasicTimeDelta<Duration> operator/(const BasicTimeDelta<Duration>& x, Scalar s);
+
+template <class Duration1, class Duration2>
+CONSTCD11 double operator/(const BasicTimeDelta<Duration1>& x, const BasicTimeDelta<Duration2>& y);
+
+// floored quotients and remainder of the sign of y, as // % and divmod in Python
+template<class Scalar, class Duration, typename std::enable_if<std::is_integral<Scalar>::value>::type* = nullptr>
+CONSTCD11 BasicTimeDelta<Duration> floor_div(const BasicTimeDelta<Duration>& x, Scalar s);
+
+template <class Duration1, class Duration2>
+CONSTCD11 std::int64_t floor_div(const BasicTimeDelta<Duration1>& x, const BasicTimeDelta<Duration2>& y);
+
+template <class Duration1, class Duration2>
+CONSTCD11 BasicTimeDelta<typename std::common_type<Duration1, Duration2>::type>
+operator%(const BasicTimeDelta<Duration1>& x, const BasicTimeDelta<Duration2>& y);
+
+template <class Duration1, class Duration2>
+CONSTCD11 std::pair<std::int64_t, BasicTimeDelta<typename std::common_type<Duration1, Duration2>::type>>
+divmod(const BasicTimeDelta<Duration1>& x, const BasicTimeDelta<Duration2>& y);
+
+template <class Duration>
+CONSTCD11 BasicTimeDelta<Duration> operator+(const BasicTimeDelta<Duration>& x);
+template <class Duration>
+CONSTCD11 BasicTimeDelta<Duration> operator-(const BasicTimeDelta<Duration>& x);
+template <class Duration>
+CONSTCD11 BasicTimeDelta<Duration> abs(const BasicTimeDelta<Duration>& x);
+
+// across precisions, as std::chrono durations
+template <class Duration1, class Duration2>
+CONSTCD11 bool operator==(const BasicTimeDelta<Duration1>& x, const BasicTimeDelta<Duration2>& y);
+template <class Duration1, class Duration2>
+CONSTCD11 bool operator!=(const BasicTimeDelta<Duration1>& x, const BasicTimeDelta<Duration2>& y);
+template <class Duration1, class Duration2>
+CONSTCD11 bool operator<(const BasicTimeDelta<Duration1>& x, const BasicTimeDelta<Duration2>& y);
+template <class Duration1, class Duration2>
+CONSTCD11 bool operator<=(const BasicTimeDelta<Duration1>& x, const BasicTimeDelta<Duration2>& y);
+template <class Duration1, class Duration2>
+CONSTCD11 bool operator>(const BasicTimeDelta<Duration1>& x, const BasicTimeDelta<Duration2>& y);
+template <class Duration1, class Duration2>
+CONSTCD11 bool operator>=(const BasicTimeDelta<Duration1>& x, const BasicTimeDelta<Duration2>& y);
+
+template<class CharT, class Traits, class Duration>
 std::basic_ostream<CharT, Traits>&
-operator<<(std::basic_ostream<CharT, Traits>& os, const TimeDelta& td);
+operator<<(std::basic_ostream<CharT, Traits>& os, const BasicTimeDelta<Duration>& td);
+
+} // namespace datetime
+
+namespace std
+{
+// the tick count, so that a BasicTimeDelta keys unordered containers
+template <class Duration> struct hash<datetime::BasicTimeDelta<Duration>>
+{
+    std::size_t operator()(const datetime::BasicTimeDelta<Duration>& x) const NOEXCEPT
+    {
+        return hash<typename Duration::rep>()(x.to_duration().count());
+    }
+};
+} // namespace std
+
+namespace datetime
+{
+
+
+
+// IsoCalendar
+// ISO 8601 week date, as date.isocalendar() in Python: weeks start on Monday
+// and belong to the year of their Thursday, so that the first days of January
+// may be in the last week (52 or 53) of the year before, and the last days of
+// December in week 1 of the year after.
+struct IsoCalendar
+{
+    std::int32_t    year;
+    unsigned        week;       // 1 to 53
+    unsigned        weekday;    // 1 (Monday) to 7
+};
+
+CONSTCD11 bool operator==(const IsoCalendar& x, const IsoCalendar& y);
+CONSTCD11 bool operator!=(const IsoCalendar& x, const IsoCalendar& y);
 
 
 
@@ -98,29 +420,39 @@ public:
     template <class Rep>
     static Date fromtimestamp(Rep timestamp);
 
-    Date() = default;
-    Date(const date::year_month_day& ymd);
-    Date(const date::year& y, const date::month& m, const date::day& d);
-
-    const date::year            year()              const;
-    const date::month           month()             const;
-    const date::day             day()               const;
-    const date::year_month_day& year_month_day()    const;
+    static CONSTCD14 Date fromordinal(std::int32_t n);  // 1 for 0001-01-01
 
-    date::weekday   objweekday()    const;
-    unsigned        weekday()       const;
-    unsigned        isoweekday()    const;
+    Date() = default;
+    CONSTCD11 Date(const date::year_month_day& ymd);
+    CONSTCD11 Date(const date::year& y, const date::month& m, const date::day& d);
+
+    CONSTCD11 const date::year            year()              const;
+    CONSTCD11 const date::month           month()             const;
+    CONSTCD11 const date::day             day()               const;
+    CONSTCD11 const date::year_month_day& year_month_day()    const;
+
+    CONSTCD14 date::weekday   objweekday()    const;
+    CONSTCD14 unsigned        weekday()       const;
+    CONSTCD14 unsigned        isoweekday()    const;
+    CONSTCD14 IsoCalendar     isocalendar()   const;
+    CONSTCD14 std::int32_t    toordinal()     const;
+    CONSTCD14 unsigned        dayofyear()     const;  // 1 to 366
     std::string     ctime()         const;
     std::string     isoformat()     const;
     std::string     strftime(const std::string& format) const;
 };
 
-Date operator+(const Date& d, const TimeDelta& td);
-Date operator+(const TimeDelta& td, const Date& d);
-Date operator-(const Date& d, const TimeDelta& td);
-TimeDelta operator-(const Date& x, const Date& y);
+CONSTCD14 Date operator+(const Date& d, const TimeDelta& td);
+CONSTCD14 Date operator+(const TimeDelta& td, const Date& d);
+CONSTCD14 Date operator-(const Date& d, const TimeDelta& td);
+CONSTCD14 TimeDelta operator-(const Date& x, const Date& y);
 
-bool operator==(const Date& x, const Date& y);
+CONSTCD11 bool operator==(const Date& x, const Date& y);
+CONSTCD11 bool operator!=(const Date& x, const Date& y);
+CONSTCD11 bool operator<(const Date& x, const Date& y);
+CONSTCD11 bool operator<=(const Date& x, const Date& y);
+CONSTCD11 bool operator>(const Date& x, const Date& y);
+CONSTCD11 bool operator>=(const Date& x, const Date& y);
 
 template<class CharT, class Traits>
 std::basic_ostream<CharT, Traits>&
@@ -128,6 +460,69 @@ operator<<(std::basic_ostream<CharT, Traits>& os, const Date& date);
 
 
 
+// SerialDate
+// A Date stored as days since 1970-01-01 in 32 bits, for large arrays of dates:
+// arithmetic, differences and ordering are single integer operations and the
+// year, month and day are computed when asked for. Same range as date::year.
+class SerialDate
+{
+    std::int32_t days_;
+
+public:
+    static SerialDate today();
+    static CONSTCD11 SerialDate fromordinal(std::int32_t n);    // 1 for 0001-01-01
+
+    SerialDate() = default;
+    CONSTCD11 explicit SerialDate(std::int32_t days) : days_(days) {}
+    CONSTCD11 SerialDate(const date::sys_days& d);
+    CONSTCD14 SerialDate(const date::year_month_day& ymd);
+    CONSTCD14 SerialDate(const date::year& y, const date::month& m, const date::day& d);
+    CONSTCD14 SerialDate(const Date& d);
+
+    CONSTCD11 std::int32_t    serial()    const { return days_; }   // days since 1970-01-01
+    CONSTCD11 date::sys_days  sys_days()  const { return date::sys_days(date::days(days_)); }
+    CONSTCD14 Date            date()      const;
+
+    CONSTCD14 const date::year            year()              const;
+    CONSTCD14 const date::month           month()             const;
+    CONSTCD14 const date::day             day()               const;
+    CONSTCD14 const date::year_month_day  year_month_day()    const;
+
+    CONSTCD11 date::weekday   objweekday()    const;
+    CONSTCD14 unsigned        weekday()       const;
+    CONSTCD14 unsigned        isoweekday()    const;
+    CONSTCD14 IsoCalendar     isocalendar()   const;
+    CONSTCD11 std::int32_t    toordinal()     const;
+    CONSTCD14 unsigned        dayofyear()     const;  // 1 to 366
+    std::string     isoformat()     const;
+    std::string     strftime(const std::string& format) const;
+
+    CONSTCD14 SerialDate& operator+=(const date::days& d) { days_ += static_cast<std::int32_t>(d.count()); return *this; }
+    CONSTCD14 SerialDate& operator-=(const date::days& d) { days_ -= static_cast<std::int32_t>(d.count()); return *this; }
+};
+
+static_assert(sizeof(SerialDate) == sizeof(std::int32_t), "SerialDate must stay a bare int32");
+
+CONSTCD11 SerialDate operator+(const SerialDate& d, const date::days& n);
+CONSTCD11 SerialDate operator-(const SerialDate& d, const date::days& n);
+CONSTCD11 SerialDate operator+(const SerialDate& d, const TimeDelta& td);
+CONSTCD11 SerialDate operator+(const TimeDelta& td, const SerialDate& d);
+CONSTCD11 SerialDate operator-(const SerialDate& d, const TimeDelta& td);
+CONSTCD11 TimeDelta operator-(const SerialDate& x, const SerialDate& y);
+
+CONSTCD11 bool operator==(const SerialDate& x, const SerialDate& y);
+CONSTCD11 bool operator!=(const SerialDate& x, const SerialDate& y);
+CONSTCD11 bool operator<(const SerialDate& x, const SerialDate& y);
+CONSTCD11 bool operator<=(const SerialDate& x, const SerialDate& y);
+CONSTCD11 bool operator>(const SerialDate& x, const SerialDate& y);
+CONSTCD11 bool operator>=(const SerialDate& x, const SerialDate& y);
+
+template<class CharT, class Traits>
+std::basic_ostream<CharT, Traits>&
+operator<<(std::basic_ostream<CharT, Traits>& os, const SerialDate& date);
+
+
+
 template <class Duration = std::chrono::system_clock::duration>
 class DateTime
 {
@@ -153,9 +548,37 @@ public:
     static DateTime<typename std::common_type<Duration, std::chrono::seconds>::type> 
     utcfromtimestamp(Rep timestamp);
 
+    // extra overloads : exact integer timestamps, nanoseconds may be negative or above one second
+    static DateTime<typename std::common_type<Duration, std::chrono::seconds>::type> 
+    fromtimestamp(std::chrono::seconds seconds, std::chrono::nanoseconds nanoseconds,
+                  const std::string& timezone_name = "");
+
+    static DateTime<typename std::common_type<Duration, std::chrono::seconds>::type> 
+    utcfromtimestamp(std::chrono::seconds seconds,
+                     std::chrono::nanoseconds nanoseconds = std::chrono::nanoseconds::zero());
+
     static DateTime<typename std::common_type<Duration, std::chrono::seconds>::type> 
     strptime(const std::string& date_string, const std::string& format);
 
+    // extra overloads : errors reported in ec instead of exceptions, the result is then the UTC epoch
+    template <class Rep>
+    static DateTime<typename std::common_type<Duration, std::chrono::seconds>::type> 
+    fromtimestamp(Rep timestamp, const std::string& timezone_name, std::error_code& ec);
+
+    static DateTime<typename std::common_type<Duration, std::chrono::seconds>::type> 
+    strptime(const std::string& date_string, const std::string& format, std::error_code& ec);
+
+    // the whole of [first, last) as a decimal count of unit since the epoch (see parse_epoch),
+    // in zone (nullptr for UTC)
+    static DateTime<typename std::common_type<Duration, std::chrono::seconds>::type> 
+    fromtimestamp(const char* first, const char* last, const date::time_zone* zone, std::error_code& ec,
+                  std::chrono::nanoseconds unit = std::chrono::seconds(1));
+
+    // the whole of [first, last) as a local time of zone (nullptr for UTC), unless format has %z
+    static DateTime<typename std::common_type<Duration, std::chrono::seconds>::type> 
+    strptime(const char* first, const char* last, const Format& format,
+             const date::time_zone* zone, std::error_code& ec);
+
     DateTime(const date::zoned_time<common_duration>& zt) : zt_(zt) {}
 
     const date::zoned_time<common_duration>& zoned_time() const { return zt_; }  // extra method : no equivalent in Python
@@ -170,7 +593,15 @@ public:
 
     TimeDelta utcoffset() const;
 
-    std::string timestamp() const;
+    double          timestamp()         const;
+    std::int64_t    timestamp_seconds() const; // extra methods : integer counts since epoch, floored
+    std::int64_t    timestamp_ms()      const;
+    std::int64_t    timestamp_us()      const;
+    std::int64_t    timestamp_ns()      const;
+
+    // decimal form with as many fractional digits as the precision, e.g. "1497252490.028200626"
+    // returns the end of the written text, or nullptr if [first, last) is too small
+    char* timestamp_to_chars(char* first, char* last) const;
 
     std::string ctime() const;
     std::string isoformat(const std::string& sep="T") const;
@@ -182,18 +613,22 @@ private:
     fields_ymd_time() const;
 };
 
-template <class Duration>
-DateTime<Duration> operator+(const DateTime<Duration>&  x, const TimeDelta& y);
+// exact: the result has the finer of the two precisions
+template <class Duration, class DeltaDuration>
+DateTime<typename std::common_type<Duration, DeltaDuration>::type>
+operator+(const DateTime<Duration>&  x, const BasicTimeDelta<DeltaDuration>& y);
 
-template <class Duration>
-DateTime<Duration> operator+(const DateTime<Duration>&  x, const TimeDelta& y);
+template <class Duration, class DeltaDuration>
+DateTime<typename std::common_type<Duration, DeltaDuration>::type>
+operator+(const BasicTimeDelta<DeltaDuration>& y, const DateTime<Duration>&  x);
 
-template <class Duration>
-DateTime<Duration> operator-(const TimeDelta& y, const DateTime<Duration>&  x);
+template <class Duration, class DeltaDuration>
+DateTime<typename std::common_type<Duration, DeltaDuration>::type>
+operator-(const DateTime<Duration>&  x, const BasicTimeDelta<DeltaDuration>& y);
 
-// TODO: allow two different Duration template params ?
-template <class Duration>
-TimeDelta operator-(const DateTime<Duration>&  x, const DateTime<Duration>& y);
+template <class Duration1, class Duration2>
+BasicTimeDelta<typename std::common_type<Duration1, Duration2>::type>
+operator-(const DateTime<Duration1>&  x, const DateTime<Duration2>& y);
 
 template <class Duration>
 bool operator<(const DateTime<Duration>&  x, const DateTime<Duration>& y);
@@ -209,28 +644,25 @@ class Time
     date::time_of_day<std::chrono::system_clock::duration> time_of_day_;
 
 public:
-    template<class Duration>
-    Time(const Duration& dur);
+    template<class Rep, class Period>
+    CONSTCD11 Time(const std::chrono::duration<Rep, Period>& dur);
 
-    template<class Duration, class ... Durations>
-    Time(const Duration& d, const Durations&... durations);
+    template<class Rep, class Period, class ... Durations>
+    CONSTCD11 Time(const std::chrono::duration<Rep, Period>& d, const Durations&... durations);
 
-    const date::time_of_day<std::chrono::system_clock::duration>& time_of_day() const;
+    CONSTCD11 const date::time_of_day<std::chrono::system_clock::duration>& time_of_day() const;
 
-    std::chrono::hours::rep hour() const;
-    std::chrono::minutes::rep minute() const;
-    std::chrono::seconds::rep seconds() const;
+    CONSTCD11 std::chrono::hours::rep hour() const;
+    CONSTCD11 std::chrono::minutes::rep minute() const;
+    CONSTCD11 std::chrono::seconds::rep seconds() const;
+    CONSTCD11 std::chrono::microseconds::rep microsecond() const;
 
     std::string isoformat() const;
     std::string strftime(const std::string& format) const;
-
-private:
-    template<class Duration>
-    Duration add_durations(const Duration& d);
-
-    template<class Duration, class ... Durations>
-    auto add_durations(const Duration& d, const Durations&... durations)
-    -> typename std::common_type<Duration, Durations...>::type;
+    // %S has the 6 decimals of isoformat, none for whole seconds.
+    // Writes into [first, last) without allocating, returns the end of the
+    // text or nullptr if it does not fit. Dates are those of 1900-01-01.
+    char* strftime(char* first, char* last, const Format& format) const;
 };
 
 template<class CharT, class Traits>
@@ -238,567 +670,3260 @@ std::basic_ostream<CharT, Traits>&
 operator<<(std::basic_ostream<CharT, Traits>& os, const Time& time);
 
 
-// TimeDelta impl
+// Format
+// A strftime/strptime format compiled once into a sequence of items, so that
+// it can be applied to many values without reading the format string again
+// and without streams. Names (%a %b %p ...) are always the C locale ones.
+// %S has as many decimals as the precision of the time point, unless the
+// format also has the Python %f (6 digits of microseconds).
+// Directives without a direct implementation (%U %W %V %G %g %C and the %E/%O
+// modified forms) fall back to date::format / date::parse.
+class Format
+{
+public:
+    explicit Format(const std::string& format);
 
-// TODO there is a problem when using date::months
-template <class Duration>
-inline 
-TimeDelta::TimeDelta(const Duration& d) 
-    : days_(std::chrono::duration_cast<date::days>(d))
-    , seconds_(std::chrono::duration_cast<std::chrono::seconds>(d - days_))
-    , microseconds_(std::chrono::duration_cast<std::chrono::microseconds>(d - days_ - seconds_))
-    {
-    }
+    const std::string& str() const { return format_; }
+    bool has_offset() const { return has_offset_; } // format contains %z
+
+    // Returns the end of the parsed text or nullptr on failure, never throws.
+    // *offset is only written when has_offset().
+    template <class Duration>
+    const char* parse(const char* first, const char* last, date::local_time<Duration>& tp,
+                      std::chrono::minutes* offset = nullptr) const;
+
+    // Returns the end of the written text or nullptr if [first, last) is too small.
+    // %z and %Z throw std::runtime_error without offset and abbrev, as date::format.
+    template <class Duration>
+    char* format(char* first, char* last, const date::local_time<Duration>& tp,
+                 const std::string* abbrev = nullptr, const std::chrono::seconds* offset = nullptr) const;
 
+    template <class OutputIt, class Duration>
+    OutputIt format_to(OutputIt out, const date::local_time<Duration>& tp,
+                       const std::string* abbrev = nullptr, const std::chrono::seconds* offset = nullptr) const;
 
-template <class Duration, class ... Durations>
-inline 
-TimeDelta::TimeDelta(const Duration& d, const Durations&... durations) 
-    : TimeDelta(d) // use delegate ctor here
+private:
+    enum class Kind : unsigned char
     {
-        add_delta(durations...);
-    }
+        literal, space, year, year2, month, day, day_space, yday, hour, hour12, minute,
+        second, whole_second, microsecond, month_name, month_abbrev, weekday_name, weekday_abbrev,
+        ampm, weekday_iso, weekday_num, offset, abbrev
+    };
 
-template<class Duration>
-inline
-void TimeDelta::add_delta(const Duration& d)
+    struct Item
+    {
+        Kind kind;
+        unsigned char width;  // max digits, 0 for the default
+        std::size_t pos;      // literal and space: text in literals_
+        std::size_t length;
+    };
+
+    std::string format_;
+    std::string literals_;
+    std::vector<Item> items_;
+    bool has_offset_ = false;
+    bool has_microsecond_ = false;
+    bool fallback_ = false;
+
+    void compile(const char* f, bool whole_seconds);
+    void add(Kind kind, unsigned width = 0);
+    void add_literal(char c);
+    void add_space(char c);
+
+    template <class Duration>
+    const char* parse_fallback(const char* first, const char* last, date::local_time<Duration>& tp,
+                               std::chrono::minutes* offset) const;
+
+    template <class Sink, class Duration>
+    void write(Sink& out, const date::local_time<Duration>& tp,
+               const std::string* abbrev, const std::chrono::seconds* offset) const;
+};
+
+
+// ZoneCache
+// Remembers the offset interval of the last conversion made with a time zone,
+// so that converting many nearby time points (e.g. a sorted column) skips the
+// transition lookup. A null time zone stands for UTC. Not thread-safe: use one
+// per thread.
+class ZoneCache
 {
-    auto total_duration = days_ + seconds_ + microseconds_ + d;
-    days_           = std::chrono::duration_cast<date::days>(total_duration);
-    seconds_        = std::chrono::duration_cast<std::chrono::seconds>(total_duration - days_);
-    microseconds_   = std::chrono::duration_cast<std::chrono::microseconds>(total_duration - days_ - seconds_);
-}
+    const date::time_zone*  zone_;
+    date::sys_seconds       begin_;
+    date::sys_seconds       end_;
+    std::chrono::seconds    offset_;
+    std::string             abbrev_;
 
-template<class Duration, class ... Durations>
-inline
-void TimeDelta::add_delta(const Duration& d, const Durations& ... durations)
+public:
+    explicit ZoneCache(const date::time_zone* zone);
+
+    const date::time_zone* zone() const { return zone_; }
+
+    std::chrono::seconds offset(date::sys_seconds tp);
+    const std::string& abbrev(date::sys_seconds tp);
+
+    template <class Duration>
+    date::local_time<typename std::common_type<Duration, std::chrono::seconds>::type>
+    to_local(const date::sys_time<Duration>& tp);
+
+    // false when tp is nonexistent or ambiguous in the time zone
+    template <class Duration>
+    bool to_sys(const date::local_time<Duration>& tp,
+                date::sys_time<typename std::common_type<Duration, std::chrono::seconds>::type>& out);
+
+private:
+    void reset(const date::sys_info& info);
+};
+
+
+// literals
+// Durations for TimeDelta, Date, Time and DateTime arithmetic, e.g. 15_min or
+// 1_h + 30_min, usable in constant expressions also in C++11. The literals of
+// date.h (2017_y/6/21, 21_d) come along with using namespace datetime::literals.
+inline namespace literals
 {
-    add_delta(d);
-    add_delta(durations...);
-}
 
+using namespace date::literals;
 
-inline
-const std::chrono::seconds::rep TimeDelta::total_seconds() const
+CONSTCD11 date::days                operator "" _days(unsigned long long n) NOEXCEPT;
+CONSTCD11 std::chrono::hours        operator "" _h(unsigned long long n) NOEXCEPT;
+CONSTCD11 std::chrono::minutes      operator "" _min(unsigned long long n) NOEXCEPT;
+CONSTCD11 std::chrono::seconds      operator "" _s(unsigned long long n) NOEXCEPT;
+CONSTCD11 std::chrono::milliseconds operator "" _ms(unsigned long long n) NOEXCEPT;
+CONSTCD11 std::chrono::microseconds operator "" _us(unsigned long long n) NOEXCEPT;
+
+} // inline namespace literals
+
+
+// format_to
+// Same text as operator<< (isoformat for Time, or as strftime with a compiled
+// format), written to an output iterator, e.g. std::back_inserter of a reused
+// std::string. The format_to_n forms write at most n chars and return the full
+// size as well.
+struct format_to_n_result
 {
-    return std::chrono::duration_cast<std::chrono::seconds>(days_ + seconds_).count();
-}
+    char*       out;    // end of the written text
+    std::size_t size;   // size of the whole text, may exceed n
+};
 
+template <class OutputIt, class Duration>
+OutputIt format_to(OutputIt out, const BasicTimeDelta<Duration>& x);
 
-inline
-TimeDelta operator+(const TimeDelta& x, const TimeDelta& y)
+template <class OutputIt>
+OutputIt format_to(OutputIt out, const Date& x);
+
+template <class OutputIt>
+OutputIt format_to(OutputIt out, const Date& x, const Format& format);
+
+template <class OutputIt, class Duration>
+OutputIt format_to(OutputIt out, const DateTime<Duration>& x);
+
+template <class OutputIt, class Duration>
+OutputIt format_to(OutputIt out, const DateTime<Duration>& x, const Format& format);
+
+template <class OutputIt>
+OutputIt format_to(OutputIt out, const Time& x);
+
+template <class OutputIt>
+OutputIt format_to(OutputIt out, const Time& x, const Format& format);
+
+template <class T>
+format_to_n_result format_to_n(char* out, std::size_t n, const T& x);
+
+template <class T>
+format_to_n_result format_to_n(char* out, std::size_t n, const T& x, const Format& format);
+
+
+// parse_epoch
+// "[-]digits[.digits]" as a count of unit since the epoch, e.g. "1497252490.028200626"
+// for seconds or "1497252490028" for milliseconds. Integer arithmetic only, so the
+// value is exact to the nanosecond (further digits are dropped) and floored to
+// Duration. unit must divide one second. Returns the end of the parsed text, or
+// nullptr on a syntax error or a value out of the range of sys_time<Duration>.
+template <class Duration>
+const char* parse_epoch(const char* first, const char* last, date::sys_time<Duration>& out,
+                        std::chrono::nanoseconds unit = std::chrono::seconds(1));
+
+
+// errc impl
+
+namespace detail
 {
-    return 
+
+class error_category_impl : public std::error_category
+{
+public:
+    const char* name() const NOEXCEPT override { return "datetime"; }
+
+    std::string message(int e) const override
     {
-        date::days(x.days() + y.days()), 
-        std::chrono::seconds(x.seconds() + y.seconds()), 
-        std::chrono::microseconds(x.microseconds() + y.microseconds())
-    };
-}
+        switch (static_cast<errc>(e))
+        {
+        case errc::parse_error:             return "string does not match format";
+        case errc::nonexistent_local_time:  return "nonexistent local time";
+        case errc::ambiguous_local_time:    return "ambiguous local time";
+        case errc::unknown_time_zone:       return "time zone not found";
+        case errc::timestamp_out_of_range:  return "timestamp out of range";
+        case errc::invalid_rule:            return "invalid recurrence rule";
+        }
+        return "unknown error";
+    }
+};
 
+template <class Range>
 inline
-TimeDelta operator-(const TimeDelta& x, const TimeDelta& y)
+auto find_by_name(const Range& r, const std::string& name) -> decltype(&*r.begin())
 {
-    return 
-    {
-        date::days(x.days() - y.days()), 
-        std::chrono::seconds(x.seconds() - y.seconds()), 
-        std::chrono::microseconds(x.microseconds() - y.microseconds())
-    };
+    auto it = std::lower_bound(r.begin(), r.end(), name,
+        [](decltype(*r.begin()) x, const std::string& nm) { return x.name() < nm; });
+    return it != r.end() && it->name() == name ? &*it : nullptr;
 }
 
-// float
-template<class Scalar, typename std::enable_if<std::is_floating_point<Scalar>::value>::type*>
 inline
-TimeDelta operator*(Scalar s, const TimeDelta& x)
+const date::time_zone* utc_zone()
 {
-    return 
-    {
-        std::chrono::seconds(std::lrint(s * x.total_seconds())), // round-half-to-even
-        std::chrono::microseconds(std::lrint(s * x.microseconds()))
-    };
+    static const date::time_zone* zone = try_locate_zone("UTC");
+    return zone;
 }
 
-// integer
-template<class Scalar, typename std::enable_if<std::is_integral<Scalar>::value>::type*>
+// date::current_zone() looked up once (it resolves /etc/localtime on each
+// call), without exceptions: nullptr when it fails
+inline
+const date::time_zone* current_zone()
+{
+    static const date::time_zone* zone = [] () -> const date::time_zone* {
+        try
+        {
+            return date::current_zone();
+        }
+        catch (...)
+        {
+            return nullptr;
+        }
+    }();
+    return zone;
+}
+
+// UTC when zone is nullptr
+template <class Duration>
 inline
-TimeDelta operator*(Scalar s, const TimeDelta& x)
+date::sys_time<Duration> to_sys(const date::time_zone* zone, const date::local_time<Duration>& tp,
+                                std::error_code& ec)
 {
-    return 
+    if (zone == nullptr)
     {
-        date::days(s * static_cast<unsigned>(x.days())), 
-        std::chrono::seconds(s * x.seconds()), 
-        std::chrono::microseconds(s * x.microseconds())
-    };
+        return date::sys_time<Duration>{tp.time_since_epoch()};
+    }
+    auto info = zone->get_info(tp);
+    if (info.result == date::local_info::nonexistent)
+    {
+        ec = errc::nonexistent_local_time;
+    }
+    else if (info.result == date::local_info::ambiguous)
+    {
+        ec = errc::ambiguous_local_time;
+    }
+    return date::sys_time<Duration>{tp.time_since_epoch()} - info.first.offset;
 }
 
-template<class Scalar, typename std::enable_if<std::is_floating_point<Scalar>::value>::type*>
+} // namespace detail
+
 inline
-TimeDelta operator*(const TimeDelta& x, Scalar s)
+const std::error_category& error_category()
 {
-    return s * x;
+    static detail::error_category_impl category;
+    return category;
 }
 
-template<class Scalar, typename std::enable_if<std::is_integral<Scalar>::value>::type*>
 inline
-TimeDelta operator*(const TimeDelta& x, Scalar s)
+std::error_code make_error_code(errc e)
 {
-    return s * x;
+    return std::error_code(static_cast<int>(e), error_category());
 }
 
-
-template<class CharT, class Traits>
 inline
-std::basic_ostream<CharT, Traits>&
-operator<<(std::basic_ostream<CharT, Traits>& os, const TimeDelta& td)
+const date::time_zone* try_locate_zone(const std::string& name)
 {
-    // return os << '(' << td.days() << " days, " << td.seconds() << " s, " << td.microseconds() << " µs)";
-    using namespace std::chrono;
-    return os << td.days() << " days, " << date::make_time(seconds(td.seconds()) + microseconds(td.microseconds()));
+    const date::TZ_DB* db;
+    try
+    {
+        db = &date::get_tzdb();
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+    if (auto zone = detail::find_by_name(db->zones, name))
+    {
+        return zone;
+    }
+#if !USE_OS_TZDB
+    if (auto link = detail::find_by_name(db->links, name))
+    {
+        return detail::find_by_name(db->zones, link->target());
+    }
+#endif
+    return nullptr;
+}
+
+inline
+const date::time_zone* locate_zone(const std::string& name, std::error_code& ec)
+{
+    auto zone = try_locate_zone(name);
+    ec = zone == nullptr ? make_error_code(errc::unknown_time_zone) : std::error_code();
+    return zone;
+}
+
+
+// TimeDelta impl
+
+namespace detail
+{
+
+// sum in the common type, a single expression so that it is constexpr in C++11
+template<class Duration>
+CONSTCD11
+inline
+Duration sum_durations(const Duration& d)
+{
+    return d;
+}
+
+template<class Duration, class ... Durations>
+CONSTCD11
+inline
+auto sum_durations(const Duration& d, const Durations& ... durations)
+-> typename std::common_type<Duration, Durations...>::type
+{
+    return d + sum_durations(durations...);
+}
+
+} // namespace detail
+
+// date::months and date::years are average lengths: RelativeDelta adds calendar ones
+template <class Duration>
+template <class Duration2>
+CONSTCD11
+inline 
+BasicTimeDelta<Duration>::BasicTimeDelta(const Duration2& d) 
+    : duration_(std::chrono::duration_cast<Duration>(d))
+    {
+    }
+
+
+template <class Duration>
+template <class Duration2>
+CONSTCD11
+inline 
+BasicTimeDelta<Duration>::BasicTimeDelta(const BasicTimeDelta<Duration2>& x) 
+    : duration_(std::chrono::duration_cast<Duration>(x.to_duration()))
+    {
+    }
+
+
+template <class Duration>
+template <class Duration2, class ... Durations>
+CONSTCD11
+inline 
+BasicTimeDelta<Duration>::BasicTimeDelta(const Duration2& d, const Durations&... durations) 
+    : BasicTimeDelta(detail::sum_durations(d, durations...)) // use delegate ctor here
+    {
+    }
+
+
+template <class Duration>
+CONSTCD11
+inline
+const date::days::rep BasicTimeDelta<Duration>::days() const
+{
+    return static_cast<date::days::rep>(detail::floor_div(fine_duration(duration_).count(),
+                                                          fine_duration(date::days(1)).count()));
+}
+
+template <class Duration>
+CONSTCD11
+inline
+const std::chrono::seconds::rep BasicTimeDelta<Duration>::seconds() const
+{
+    return detail::floor_mod(fine_duration(duration_).count(), fine_duration(date::days(1)).count()) /
+           fine_duration(std::chrono::seconds(1)).count();
+}
+
+template <class Duration>
+CONSTCD11
+inline
+const std::chrono::microseconds::rep BasicTimeDelta<Duration>::microseconds() const
+{
+    // the fraction is not negative, truncating floors it
+    return std::chrono::duration_cast<std::chrono::microseconds>(fine_duration(
+        detail::floor_mod(fine_duration(duration_).count(), fine_duration(std::chrono::seconds(1)).count()))).count();
+}
+
+template <class Duration>
+CONSTCD11
+inline
+const std::chrono::seconds::rep BasicTimeDelta<Duration>::total_seconds() const
+{
+    return detail::floor_div(fine_duration(duration_).count(), fine_duration(std::chrono::seconds(1)).count());
+}
+
+
+CONSTCD11
+inline
+TimeDelta operator+(const TimeDelta& x, const TimeDelta& y)
+{
+    return TimeDelta(x.to_duration() + y.to_duration());
+}
+
+CONSTCD11
+inline
+TimeDelta operator-(const TimeDelta& x, const TimeDelta& y)
+{
+    return TimeDelta(x.to_duration() - y.to_duration());
+}
+
+template <class Duration1, class Duration2>
+CONSTCD11
+inline
+BasicTimeDelta<typename std::common_type<Duration1, Duration2>::type>
+operator+(const BasicTimeDelta<Duration1>& x, const BasicTimeDelta<Duration2>& y)
+{
+    return BasicTimeDelta<typename std::common_type<Duration1, Duration2>::type>(x.to_duration() + y.to_duration());
+}
+
+template <class Duration1, class Duration2>
+CONSTCD11
+inline
+BasicTimeDelta<typename std::common_type<Duration1, Duration2>::type>
+operator-(const BasicTimeDelta<Duration1>& x, const BasicTimeDelta<Duration2>& y)
+{
+    return BasicTimeDelta<typename std::common_type<Duration1, Duration2>::type>(x.to_duration() - y.to_duration());
+}
+
+// float
+template<class Scalar, class Duration, typename std::enable_if<std::is_floating_point<Scalar>::value>::type*>
+inline
+BasicTimeDelta<Duration> operator*(Scalar s, const BasicTimeDelta<Duration>& x)
+{
+    // round-half-to-even
+    using Real = typename std::common_type<Scalar, double>::type;
+    return BasicTimeDelta<Duration>(Duration(std::llrint(s * static_cast<Real>(x.to_duration().count()))));
+}
+
+// integer
+template<class Scalar, class Duration, typename std::enable_if<std::is_integral<Scalar>::value>::type*>
+CONSTCD11
+inline
+BasicTimeDelta<Duration> operator*(Scalar s, const BasicTimeDelta<Duration>& x)
+{
+    return BasicTimeDelta<Duration>(Duration(static_cast<typename Duration::rep>(s * x.to_duration().count())));
+}
+
+template<class Scalar, class Duration, typename std::enable_if<std::is_floating_point<Scalar>::value>::type*>
+inline
+BasicTimeDelta<Duration> operator*(const BasicTimeDelta<Duration>& x, Scalar s)
+{
+    return s * x;
+}
+
+template<class Scalar, class Duration, typename std::enable_if<std::is_integral<Scalar>::value>::type*>
+CONSTCD11
+inline
+BasicTimeDelta<Duration> operator*(const BasicTimeDelta<Duration>& x, Scalar s)
+{
+    return s * x;
+}
+
+
+template<class Scalar, class Duration, typename std::enable_if<std::is_floating_point<Scalar>::value>::type*>
+inline
+BasicTimeDelta<Duration> operator/(const BasicTimeDelta<Duration>& x, Scalar s)
+{
+    // round-half-to-even
+    using Real = typename std::common_type<Scalar, double>::type;
+    if (s == 0)
+    {
+        throw std::domain_error("TimeDelta: division by zero");
+    }
+    return BasicTimeDelta<Duration>(Duration(std::llrint(static_cast<Real>(x.to_duration().count()) / s)));
+}
+
+template<class Scalar, class Duration, typename std::enable_if<std::is_integral<Scalar>::value>::type*>
+CONSTCD11
+inline
+BasicTimeDelta<Duration> operator/(const BasicTimeDelta<Duration>& x, Scalar s)
+{
+    return s == 0 ? throw std::domain_error("TimeDelta: division by zero")
+         : BasicTimeDelta<Duration>(Duration(static_cast<typename Duration::rep>(
+               detail::div_half_even(x.to_duration().count(), static_cast<std::int64_t>(s)))));
+}
+
+template <class Duration1, class Duration2>
+CONSTCD11
+inline
+double operator/(const BasicTimeDelta<Duration1>& x, const BasicTimeDelta<Duration2>& y)
+{
+    using CT = typename std::common_type<Duration1, Duration2>::type;
+    return y.to_duration() == Duration2::zero() ? throw std::domain_error("TimeDelta: division by zero")
+         : static_cast<double>(CT(x.to_duration()).count()) / static_cast<double>(CT(y.to_duration()).count());
+}
+
+template<class Scalar, class Duration, typename std::enable_if<std::is_integral<Scalar>::value>::type*>
+CONSTCD11
+inline
+BasicTimeDelta<Duration> floor_div(const BasicTimeDelta<Duration>& x, Scalar s)
+{
+    return s == 0 ? throw std::domain_error("TimeDelta: division by zero")
+         : BasicTimeDelta<Duration>(Duration(static_cast<typename Duration::rep>(
+               detail::floor_div(x.to_duration().count(), static_cast<std::int64_t>(s)))));
+}
+
+template <class Duration1, class Duration2>
+CONSTCD11
+inline
+std::int64_t floor_div(const BasicTimeDelta<Duration1>& x, const BasicTimeDelta<Duration2>& y)
+{
+    using CT = typename std::common_type<Duration1, Duration2>::type;
+    return y.to_duration() == Duration2::zero() ? throw std::domain_error("TimeDelta: division by zero")
+         : detail::floor_div(CT(x.to_duration()).count(), CT(y.to_duration()).count());
+}
+
+template <class Duration1, class Duration2>
+CONSTCD11
+inline
+BasicTimeDelta<typename std::common_type<Duration1, Duration2>::type>
+operator%(const BasicTimeDelta<Duration1>& x, const BasicTimeDelta<Duration2>& y)
+{
+    using CT = typename std::common_type<Duration1, Duration2>::type;
+    return y.to_duration() == Duration2::zero() ? throw std::domain_error("TimeDelta: modulo by zero")
+         : BasicTimeDelta<CT>(CT(detail::floor_mod(CT(x.to_duration()).count(), CT(y.to_duration()).count())));
+}
+
+template <class Duration1, class Duration2>
+CONSTCD11
+inline
+std::pair<std::int64_t, BasicTimeDelta<typename std::common_type<Duration1, Duration2>::type>>
+divmod(const BasicTimeDelta<Duration1>& x, const BasicTimeDelta<Duration2>& y)
+{
+    return std::pair<std::int64_t, BasicTimeDelta<typename std::common_type<Duration1, Duration2>::type>>(
+        floor_div(x, y), x % y);
+}
+
+template <class Duration>
+CONSTCD11
+inline
+BasicTimeDelta<Duration> operator+(const BasicTimeDelta<Duration>& x)
+{
+    return x;
+}
+
+template <class Duration>
+CONSTCD11
+inline
+BasicTimeDelta<Duration> operator-(const BasicTimeDelta<Duration>& x)
+{
+    return BasicTimeDelta<Duration>(-x.to_duration());
+}
+
+template <class Duration>
+CONSTCD11
+inline
+BasicTimeDelta<Duration> abs(const BasicTimeDelta<Duration>& x)
+{
+    return x.to_duration() < Duration::zero() ? -x : x;
+}
+
+template <class Duration>
+CONSTCD14
+inline
+BasicTimeDelta<Duration>& BasicTimeDelta<Duration>::operator%=(const BasicTimeDelta& x)
+{
+    return *this = *this % x;
+}
+
+template <class Duration>
+template <class Scalar>
+CONSTCD14
+inline
+BasicTimeDelta<Duration>& BasicTimeDelta<Duration>::operator*=(Scalar s)
+{
+    return *this = *this * s;
+}
+
+template <class Duration>
+template <class Scalar>
+CONSTCD14
+inline
+BasicTimeDelta<Duration>& BasicTimeDelta<Duration>::operator/=(Scalar s)
+{
+    return *this = *this / s;
+}
+
+template <class Duration1, class Duration2>
+CONSTCD11
+inline
+bool operator==(const BasicTimeDelta<Duration1>& x, const BasicTimeDelta<Duration2>& y)
+{
+    return x.to_duration() == y.to_duration();
+}
+
+template <class Duration1, class Duration2>
+CONSTCD11
+inline
+bool operator!=(const BasicTimeDelta<Duration1>& x, const BasicTimeDelta<Duration2>& y)
+{
+    return x.to_duration() != y.to_duration();
+}
+
+template <class Duration1, class Duration2>
+CONSTCD11
+inline
+bool operator<(const BasicTimeDelta<Duration1>& x, const BasicTimeDelta<Duration2>& y)
+{
+    return x.to_duration() < y.to_duration();
+}
+
+template <class Duration1, class Duration2>
+CONSTCD11
+inline
+bool operator<=(const BasicTimeDelta<Duration1>& x, const BasicTimeDelta<Duration2>& y)
+{
+    return x.to_duration() <= y.to_duration();
+}
+
+template <class Duration1, class Duration2>
+CONSTCD11
+inline
+bool operator>(const BasicTimeDelta<Duration1>& x, const BasicTimeDelta<Duration2>& y)
+{
+    return x.to_duration() > y.to_duration();
+}
+
+template <class Duration1, class Duration2>
+CONSTCD11
+inline
+bool operator>=(const BasicTimeDelta<Duration1>& x, const BasicTimeDelta<Duration2>& y)
+{
+    return x.to_duration() >= y.to_duration();
+}
+
+
+namespace detail
+{
+
+// whole seconds, floored, and the remainder in [0, 10^9) nanoseconds
+template <class Duration>
+inline
+void split_seconds(const BasicTimeDelta<Duration>& x, std::int64_t& sec, std::int64_t& ns)
+{
+    sec = x.total_seconds();
+    ns = std::chrono::duration_cast<std::chrono::nanoseconds>(x.to_duration() - std::chrono::seconds(sec)).count();
+}
+
+// fraction of digits decimals without its trailing zeros, nothing when zero
+inline
+char* write_trimmed_fraction(char* p, std::uint64_t x, unsigned digits)
+{
+    if (x == 0)
+    {
+        return p;
+    }
+    while (x % 10 == 0)
+    {
+        x /= 10;
+        --digits;
+    }
+    *p++ = '.';
+    return write_uint(p, p + 9, x, digits);
+}
+
+// "<number><unit>" with an optional fraction, unit_ns in nanoseconds; the sum is
+// kept in microseconds plus the nanoseconds below, as a magnitude that may go
+// past the int64 range so that the most negative value can be read
+inline
+bool read_component(const char*& p, const char* last, std::int64_t unit_ns,
+                    std::uint64_t& us, std::int64_t& ns)
+{
+    const std::int64_t max = std::numeric_limits<std::int64_t>::max();
+    const std::uint64_t umax = std::numeric_limits<std::uint64_t>::max();
+    const char* q = p;
+    std::int64_t whole = 0;
+    for (; p != last && '0' <= *p && *p <= '9'; ++p)
+    {
+        if (whole > (max - 9) / 10)
+        {
+            return false;
+        }
+        whole = 10 * whole + (*p - '0');
+    }
+    bool digits = p != q;
+    if (unit_ns >= 1000)
+    {
+        auto unit_us = static_cast<std::uint64_t>(unit_ns / 1000);
+        if (static_cast<std::uint64_t>(whole) > (umax - us) / unit_us)
+        {
+            return false;
+        }
+        us += static_cast<std::uint64_t>(whole) * unit_us;
+    }
+    else
+    {
+        ns += whole * unit_ns;
+    }
+    if (p != last && (*p == '.' || *p == ','))
+    {
+        ++p;
+        const char* f = p;
+        std::int64_t scale = unit_ns;
+        for (; p != last && '0' <= *p && *p <= '9'; ++p)
+        {
+            scale /= 10;
+            ns += (*p - '0') * scale;
+        }
+        digits = digits || p != f;
+    }
+    if (ns >= 1000)
+    {
+        if (static_cast<std::uint64_t>(ns / 1000) > umax - us)
+        {
+            return false;
+        }
+        us += static_cast<std::uint64_t>(ns / 1000);
+        ns %= 1000;
+    }
+    return digits;
+}
+
+// us microseconds and ns < 1000 nanoseconds, rounded half to even to the tick
+// of Duration, as the TimeDelta constructor in Python for microseconds; the
+// magnitude of a negative value may be one tick more than the maximum
+template <class Duration>
+inline
+bool make_timedelta(bool neg, std::uint64_t us, std::int64_t ns, BasicTimeDelta<Duration>& out)
+{
+    using Rep = typename Duration::rep;
+    const std::uint64_t max = static_cast<std::uint64_t>(std::numeric_limits<Rep>::max()) + (neg ? 1 : 0);
+    const std::int64_t tick = std::chrono::duration_cast<std::chrono::nanoseconds>(Duration(1)).count();
+    std::uint64_t ticks;
+    std::int64_t rest;  // in nanoseconds
+    if (tick <= 1000)
+    {
+        const auto per_us = static_cast<std::uint64_t>(1000 / tick);
+        if (us > (max - static_cast<std::uint64_t>(ns / tick)) / per_us)
+        {
+            return false;
+        }
+        ticks = us * per_us + static_cast<std::uint64_t>(ns / tick);
+        rest = ns % tick;
+    }
+    else
+    {
+        const auto us_per_tick = static_cast<std::uint64_t>(tick / 1000);
+        ticks = us / us_per_tick;
+        rest = static_cast<std::int64_t>(us % us_per_tick) * 1000 + ns;
+    }
+    if (2 * rest > tick || (2 * rest == tick && ticks % 2 == 1))
+    {
+        if (ticks >= max)
+        {
+            return false;
+        }
+        ++ticks;
+    }
+    if (ticks > max)
+    {
+        return false;
+    }
+    // -(ticks - 1) - 1 stays in range for the most negative value
+    out = BasicTimeDelta<Duration>(Duration(neg && ticks != 0 ? static_cast<Rep>(-static_cast<Rep>(ticks - 1) - 1)
+                                                              : static_cast<Rep>(ticks)));
+    return true;
+}
+
+} // namespace detail
+
+template <class Duration>
+inline
+char* BasicTimeDelta<Duration>::to_chars(char* first, char* last, Style style) const
+{
+    char buf[max_chars];
+    char* const end = buf + sizeof(buf);
+    char* p = buf;
+    // seconds may be negative, nanoseconds in [0, 10^9)
+    std::int64_t sec, ns;
+    detail::split_seconds(*this, sec, ns);
+    if (style == Style::python)
+    {
+        // days may be negative, the time of day is positive
+        auto d = sec / 86400 - (sec % 86400 < 0 ? 1 : 0);
+        auto tod = static_cast<std::uint64_t>(sec - 86400 * d);
+        if (d != 0)
+        {
+            if (d < 0)
+            {
+                *p++ = '-';
+            }
+            auto ad = d < 0 ? 0 - static_cast<std::uint64_t>(d) : static_cast<std::uint64_t>(d);
+            p = detail::write_uint(p, end, ad);
+            static const char days[] = " days, ";
+            p = std::copy(days, days + (ad == 1 ? 4 : 5), p);
+            p = std::copy(days + 5, days + 7, p);
+        }
+        p = detail::write_uint(p, end, tod / 3600);
+        *p++ = ':';
+        p = detail::write_uint(p, end, tod / 60 % 60, 2);
+        *p++ = ':';
+        p = detail::write_uint(p, end, tod % 60, 2);
+        if (ns % 1000 != 0)
+        {
+            *p++ = '.';
+            p = detail::write_uint(p, end, ns, 9);
+        }
+        else if (ns != 0)
+        {
+            *p++ = '.';
+            p = detail::write_uint(p, end, ns / 1000, 6);
+        }
+    }
+    else
+    {
+        // sign and magnitude
+        if (sec < 0)
+        {
+            *p++ = '-';
+            sec = ns == 0 ? -sec : -sec - 1;
+            ns = ns == 0 ? 0 : 1000000000 - ns;
+        }
+        auto s = static_cast<std::uint64_t>(sec);
+        if (style == Style::iso8601)
+        {
+            *p++ = 'P';
+            if (s >= 86400)
+            {
+                p = detail::write_uint(p, end, s / 86400);
+                *p++ = 'D';
+                s %= 86400;
+            }
+            if (s != 0 || ns != 0 || p[-1] == 'P')
+            {
+                *p++ = 'T';
+                if (s >= 3600)
+                {
+                    p = detail::write_uint(p, end, s / 3600);
+                    *p++ = 'H';
+                }
+                if (s / 60 % 60 != 0)
+                {
+                    p = detail::write_uint(p, end, s / 60 % 60);
+                    *p++ = 'M';
+                }
+                if (s % 60 != 0 || ns != 0 || p[-1] == 'T')
+                {
+                    p = detail::write_uint(p, end, s % 60);
+                    p = detail::write_trimmed_fraction(p, ns, 9);
+                    *p++ = 'S';
+                }
+            }
+        }
+        else if (s == 0 && ns % 1000 != 0 && ns < 1000)
+        {
+            p = detail::write_uint(p, end, ns);
+            *p++ = 'n';
+            *p++ = 's';
+        }
+        else if (s == 0 && ns < 1000000)
+        {
+            p = detail::write_uint(p, end, ns / 1000);
+            p = detail::write_trimmed_fraction(p, ns % 1000, 3);
+            *p++ = 'u';
+            *p++ = 's';
+        }
+        else if (s == 0)
+        {
+            p = detail::write_uint(p, end, ns / 1000000);
+            p = detail::write_trimmed_fraction(p, ns % 1000000, 6);
+            *p++ = 'm';
+            *p++ = 's';
+        }
+        else
+        {
+            if (s >= 3600)
+            {
+                p = detail::write_uint(p, end, s / 3600);
+                *p++ = 'h';
+            }
+            if (s >= 60)
+            {
+                p = detail::write_uint(p, end, s / 60 % 60);
+                *p++ = 'm';
+            }
+            p = detail::write_uint(p, end, s % 60);
+            p = detail::write_trimmed_fraction(p, ns, 9);
+            *p++ = 's';
+        }
+    }
+    if (last - first < p - buf)
+    {
+        return nullptr;
+    }
+    return std::copy(buf, p, first);
+}
+
+template <class Duration>
+inline
+std::string BasicTimeDelta<Duration>::str(Style style) const
+{
+    char buf[max_chars];
+    return std::string(buf, to_chars(buf, buf + sizeof(buf), style));
+}
+
+template <class Duration>
+inline
+const char* BasicTimeDelta<Duration>::from_chars(const char* first, const char* last, BasicTimeDelta& out, Style style)
+{
+    const char* p = first;
+    bool neg = false;
+    std::uint64_t us = 0;
+    std::int64_t ns = 0;
+    switch (style)
+    {
+    case Style::python:
+    {
+        // ["-"]D day[s], H:MM:SS[.ffffff] or H:MM:SS[.ffffff], up to 9 decimals
+        const char* q = p;
+        if (q != last && *q == '-')
+        {
+            ++q;
+        }
+        std::uint64_t d = 0;
+        const char* r = q;
+        if (detail::read_component(r, last, 86400000000000, us, ns) && r != last && *r == ' ')
+        {
+            neg = *p == '-';
+            static const char day[] = " day";
+            if (last - r < 4 || !std::equal(day, day + 4, r))
+            {
+                return nullptr;
+            }
+            r += 4;
+            if (r != last && *r == 's')
+            {
+                ++r;
+            }
+            if (last - r < 2 || r[0] != ',' || r[1] != ' ' || std::find(q, r, '.') != r)
+            {
+                return nullptr;
+            }
+            p = r + 2;
+            d = us;
+            us = 0;
+        }
+        int h = 0, m = 0, sec = 0;
+        if (!detail::read_digits(p, last, 9, h) || p == last || *p++ != ':' ||
+            last - p < 2 || !detail::read_digits(p, p + 2, 2, m) || m > 59 ||
+            p == last || *p++ != ':' ||
+            last - p < 2 || !detail::read_digits(p, p + 2, 2, sec) || sec > 59)
+        {
+            return nullptr;
+        }
+        std::int64_t fraction = 0;  // nanoseconds
+        if (p != last && *p == '.')
+        {
+            ++p;
+            const char* f = p;
+            int x = 0;
+            if (!detail::read_digits(p, last, 9, x))
+            {
+                return nullptr;
+            }
+            fraction = x;
+            for (auto k = p - f; k < 9; ++k)
+            {
+                fraction *= 10;
+            }
+        }
+        // the time of day is added to the (possibly negative) days, then
+        // rounded as a sign and magnitude
+        const auto tod = static_cast<std::uint64_t>(((h * 60LL + m) * 60 + sec) * 1000000 + fraction / 1000);
+        ns = fraction % 1000;
+        if (!neg)
+        {
+            if (tod > std::numeric_limits<std::uint64_t>::max() - d)
+            {
+                return nullptr;
+            }
+            us = d + tod;
+        }
+        else if (d > tod)
+        {
+            us = ns == 0 ? d - tod : d - tod - 1;
+            ns = ns == 0 ? 0 : 1000 - ns;
+        }
+        else
+        {
+            us = tod - d;
+            neg = false;
+        }
+        break;
+    }
+    case Style::iso8601:
+    {
+        // [+-]P[nW][nD][T[nH][nM][nS]], fractions on any component
+        if (p != last && (*p == '-' || *p == '+'))
+        {
+            neg = *p++ == '-';
+        }
+        if (p == last || *p++ != 'P')
+        {
+            return nullptr;
+        }
+        static const char units[] = "WDHMS";
+        static const std::int64_t units_ns[] = {604800000000000, 86400000000000, 3600000000000, 60000000000, 1000000000};
+        bool time = false, any = false;
+        int next = 0;
+        while (p != last)
+        {
+            if (*p == 'T' && !time)
+            {
+                time = true;
+                next = 2;
+                ++p;
+                continue;
+            }
+            const char* q = p;
+            std::uint64_t cus = 0;
+            std::int64_t cns = 0;
+            while (q != last && (('0' <= *q && *q <= '9') || *q == '.' || *q == ','))
+            {
+                ++q;
+            }
+            if (q == p || q == last)
+            {
+                break;
+            }
+            const char* u = std::find(units + next, units + (time ? 5 : 2), *q);
+            if (u == units + (time ? 5 : 2))
+            {
+                return nullptr;
+            }
+            int k = static_cast<int>(u - units);
+            if (!detail::read_component(p, q, units_ns[k], cus, cns) || p != q ||
+                cus > std::numeric_limits<std::uint64_t>::max() - us)
+            {
+                return nullptr;
+            }
+            us += cus;
+            ns += cns;
+            p = q + 1;
+            next = k + 1;
+            any = true;
+        }
+        if (!any || (time && next == 2))
+        {
+            return nullptr;
+        }
+        if (static_cast<std::uint64_t>(ns / 1000) > std::numeric_limits<std::uint64_t>::max() - us)
+        {
+            return nullptr;
+        }
+        us += static_cast<std::uint64_t>(ns / 1000);
+        ns %= 1000;
+        break;
+    }
+    case Style::compact:
+    {
+        // [+-] then <number><unit>... with units ns us µs ms s m h d, or "0"
+        if (p != last && (*p == '-' || *p == '+'))
+        {
+            neg = *p++ == '-';
+        }
+        if (p != last && *p == '0' && (p + 1 == last || !(std::isalnum(static_cast<unsigned char>(p[1])) || p[1] == '.')))
+        {
+            out = BasicTimeDelta(Duration::zero());
+            return p + 1;
+        }
+        bool any = false;
+        while (p != last && (('0' <= *p && *p <= '9') || *p == '.'))
+        {
+            const char* q = p;
+            while (q != last && (('0' <= *q && *q <= '9') || *q == '.'))
+            {
+                ++q;
+            }
+            const char* u = q;
+            while (u != last && (std::isalpha(static_cast<unsigned char>(*u)) || static_cast<unsigned char>(*u) >= 0x80))
+            {
+                ++u;
+            }
+            std::string unit(q, u);
+            std::int64_t unit_ns;
+            if (unit == "ns") unit_ns = 1;
+            else if (unit == "us" || unit == "\xc2\xb5s" || unit == "\xce\xbcs") unit_ns = 1000;
+            else if (unit == "ms") unit_ns = 1000000;
+            else if (unit == "s") unit_ns = 1000000000;
+            else if (unit == "m") unit_ns = 60000000000;
+            else if (unit == "h") unit_ns = 3600000000000;
+            else if (unit == "d") unit_ns = 86400000000000;
+            else return nullptr;
+            if (!detail::read_component(p, q, unit_ns, us, ns) || p != q)
+            {
+                return nullptr;
+            }
+            p = u;
+            any = true;
+        }
+        if (!any)
+        {
+            return nullptr;
+        }
+        break;
+    }
+    }
+    if (!detail::make_timedelta(neg, us, ns, out))
+    {
+        return nullptr;
+    }
+    return p;
+}
+
+
+template<class CharT, class Traits, class Duration>
+inline
+std::basic_ostream<CharT, Traits>&
+operator<<(std::basic_ostream<CharT, Traits>& os, const BasicTimeDelta<Duration>& td)
+{
+    // return os << '(' << td.days() << " days, " << td.seconds() << " s, " << td.microseconds() << " µs)";
+    return os << td.days() << " days, " << date::make_time(td.to_duration() - date::days(td.days()));
+}
+
+
+
+// Date impl
+
+inline
+Date Date::today() 
+{
+    return { date::floor<date::days>(std::chrono::system_clock::now()) };
+}
+
+
+template<class Rep>
+inline
+Date Date::fromtimestamp(Rep timestamp) 
+{
+    using namespace std::chrono;
+    // system_clock::time_point dt{seconds{timestamp}}; // compatible with old compilers ?
+    seconds dur(timestamp);
+    time_point<system_clock> dt(dur);
+
+    return { date::floor<date::days>(dt) }; // convert time_point to sys_days
+}
+
+CONSTCD11
+inline
+Date::Date(const date::year_month_day& ymd) 
+    : ymd_(ymd) 
+    {}
+
+CONSTCD11
+inline
+Date::Date(const date::year& y, const date::month& m, const date::day& d) 
+    : ymd_(y, m, d) 
+    {}
+
+CONSTCD11
+inline
+const date::year_month_day& Date::year_month_day() const 
+{
+    return ymd_;
+}
+
+CONSTCD11
+inline
+const date::year Date::year() const
+{
+    return ymd_.year();
+}
+
+CONSTCD11
+inline
+const date::month Date::month() const
+{
+    return ymd_.month();
+}
+
+CONSTCD11
+inline
+const date::day Date::day() const
+{
+    return ymd_.day();
+}
+
+inline
+std::string Date::ctime() const
+{
+    return detail::format_c_locale("%c", ymd_);
+}
+
+CONSTCD14
+inline
+date::weekday Date::objweekday() const
+{
+    return date::weekday(ymd_);
+}
+
+CONSTCD14
+inline
+unsigned Date::weekday() const
+{
+    return SerialDate(*this).weekday();
+}
+
+CONSTCD14
+inline
+unsigned Date::isoweekday() const
+{
+    return 1 + weekday();
+}
+
+CONSTCD14
+inline
+IsoCalendar Date::isocalendar() const
+{
+    return SerialDate(*this).isocalendar();
+}
+
+CONSTCD14
+inline
+std::int32_t Date::toordinal() const
+{
+    return SerialDate(*this).toordinal();
+}
+
+CONSTCD14
+inline
+unsigned Date::dayofyear() const
+{
+    return SerialDate(*this).dayofyear();
+}
+
+CONSTCD14
+inline
+Date Date::fromordinal(std::int32_t n)
+{
+    return SerialDate::fromordinal(n).date();
+}
+
+CONSTCD11
+inline
+bool operator==(const IsoCalendar& x, const IsoCalendar& y)
+{
+    return x.year == y.year && x.week == y.week && x.weekday == y.weekday;
+}
+
+CONSTCD11
+inline
+bool operator!=(const IsoCalendar& x, const IsoCalendar& y)
+{
+    return !(x == y);
+}
+
+
+inline
+std::string Date::isoformat() const
+{
+    return strftime("YYYY-MM-DD");
+}
+
+inline
+std::string Date::strftime(const std::string& format) const
+{
+    return date::format(format.c_str(), ymd_);
+}
+
+
+
+CONSTCD14
+inline
+Date operator+(const Date& d, const TimeDelta& td)
+{
+    return { date::sys_days(d.year_month_day()) + date::days(td.days()) };
+}
+
+CONSTCD14
+inline
+Date operator+(const TimeDelta& td, const Date& d)
+{
+    return d + td;
+}
+
+CONSTCD14
+inline
+Date operator-(const Date& d, const TimeDelta& td)
+{
+    return { date::sys_days(d.year_month_day()) - date::days(td.days()) };
+}
+
+CONSTCD14
+inline
+TimeDelta operator-(const Date& x, const Date& y)
+{
+    return { date::sys_days(x.year_month_day()) - date::sys_days(y.year_month_day()) };
+}
+
+CONSTCD11
+inline
+bool operator==(const Date& x, const Date& y)
+{
+    return x.year_month_day() == y.year_month_day();
+}
+
+CONSTCD11
+inline
+bool operator!=(const Date& x, const Date& y)
+{
+    return x.year_month_day() != y.year_month_day();
+}
+
+CONSTCD11
+inline
+bool operator<(const Date& x, const Date& y)
+{
+    return x.year_month_day() < y.year_month_day();
+}
+
+CONSTCD11
+inline
+bool operator<=(const Date& x, const Date& y)
+{
+    return x.year_month_day() <= y.year_month_day();
+}
+
+CONSTCD11
+inline
+bool operator>(const Date& x, const Date& y)
+{
+    return x.year_month_day() > y.year_month_day();
+}
+
+CONSTCD11
+inline
+bool operator>=(const Date& x, const Date& y)
+{
+    return x.year_month_day() >= y.year_month_day();
+}
+
+
+template<class CharT, class Traits>
+inline
+std::basic_ostream<CharT, Traits>&
+operator<<(std::basic_ostream<CharT, Traits>& os, const Date& date)
+{
+    return os << date.year_month_day();
+}
+
+
+
+// SerialDate impl
+
+namespace detail
+{
+
+// Civil conversions of Neri and Schneider, "Euclidean affine functions and their
+// application to calendar algorithms" (2022), for the range of date::year: the
+// days are shifted by 82 eras so that all arithmetic is unsigned 32 bits, and
+// divisions are multiplications and shifts. See also calendar.h.
+const std::uint32_t civil_shift_years = 400 * 82;
+const std::uint32_t civil_shift_days = 719468 + 146097 * 82;
+
+CONSTCD14
+inline
+void civil_from_day(std::int32_t n, std::int32_t& year, unsigned char& month, unsigned char& day)
+{
+    const std::uint32_t n1 = 4 * (static_cast<std::uint32_t>(n) + civil_shift_days) + 3;
+    // century and day of the century
+    const std::uint32_t c = static_cast<std::uint32_t>((static_cast<std::uint64_t>(n1) * 15051803) >> 41);
+    const std::uint32_t nc = (n1 - 146097 * c) >> 2;
+    // year of the century and day of the year, starting in March
+    const std::uint32_t z = static_cast<std::uint32_t>((static_cast<std::uint64_t>(4 * nc + 3) * 2939745) >> 32);
+    const std::uint32_t ny = nc - 365 * z - (z >> 2);
+    // month (3 to 14) and day
+    const std::uint32_t m = (2141 * ny + 197913) >> 16;
+    const std::uint32_t d = ny - ((979 * m - 2919) >> 5);
+    const std::uint32_t j = ny >= 306;
+    year  = static_cast<std::int32_t>(100 * c + z + j - civil_shift_years);
+    month = static_cast<unsigned char>(m - 12 * j);
+    day   = static_cast<unsigned char>(d + 1);
+}
+
+CONSTCD14
+inline
+std::int32_t day_from_civil(std::int32_t year, unsigned month, unsigned day)
+{
+    const std::uint32_t j = month <= 2;
+    const std::uint32_t y = static_cast<std::uint32_t>(year) + civil_shift_years - j;
+    const std::uint32_t m = month + 12 * j;
+    const std::uint32_t c = static_cast<std::uint32_t>((static_cast<std::uint64_t>(y) * 1374389535) >> 37);
+    const std::uint32_t n = ((1461 * y) >> 2) - c + (c >> 2) + ((979 * m - 2919) >> 5) + day - 1;
+    return static_cast<std::int32_t>(n - civil_shift_days);
+}
+
+CONSTCD11
+inline
+unsigned days_in_month(std::int32_t y, unsigned m)
+{
+    return m != 2 ? 30 + ((m + (m >> 3)) & 1)
+         : (y % 4 == 0 && (y % 100 != 0 || y % 400 == 0)) ? 29 : 28;
+}
+
+// 0 for Sunday to 6 for Saturday, as unsigned(date::weekday), of days since 1970-01-01
+CONSTCD11
+inline
+unsigned weekday_from_day(std::int32_t n)
+{
+    // 1970-01-01 is a Thursday, and civil_shift_days is 1 mod 7
+    return (static_cast<std::uint32_t>(n) + civil_shift_days + 3) % 7;
+}
+
+// days from 0000-12-31 to 1970-01-01: ordinals count 0001-01-01 as 1, as in Python
+const std::int32_t ordinal_shift = 719163;
+
+// ISO 8601 week date of days since 1970-01-01: the year is that of the Thursday
+// of the week, and its week 1 the one of its first Thursday
+CONSTCD14
+inline
+void iso_from_day(std::int32_t n, std::int32_t& year, unsigned& week, unsigned& weekday)
+{
+    const std::uint32_t w = (static_cast<std::uint32_t>(n) + civil_shift_days + 2) % 7;  // 0 for Monday
+    const std::int32_t thursday = n - static_cast<std::int32_t>(w) + 3;
+    unsigned char m = 0, d = 0;
+    civil_from_day(thursday, year, m, d);
+    week = static_cast<unsigned>(thursday - day_from_civil(year, 1, 1)) / 7 + 1;
+    weekday = w + 1;
+}
+
+} // namespace detail
+
+inline
+SerialDate SerialDate::today()
+{
+    return { date::floor<date::days>(std::chrono::system_clock::now()) };
+}
+
+CONSTCD11
+inline
+SerialDate::SerialDate(const date::sys_days& d)
+    : days_(static_cast<std::int32_t>(d.time_since_epoch().count()))
+    {}
+
+CONSTCD14
+inline
+SerialDate::SerialDate(const date::year_month_day& ymd)
+    : days_(detail::day_from_civil(static_cast<int>(ymd.year()), static_cast<unsigned>(ymd.month()),
+                                   static_cast<unsigned>(ymd.day())))
+    {}
+
+CONSTCD14
+inline
+SerialDate::SerialDate(const date::year& y, const date::month& m, const date::day& d)
+    : SerialDate(date::year_month_day(y, m, d))
+    {}
+
+CONSTCD14
+inline
+SerialDate::SerialDate(const Date& d)
+    : SerialDate(d.year_month_day())
+    {}
+
+CONSTCD14
+inline
+const date::year_month_day SerialDate::year_month_day() const
+{
+    std::int32_t y = 0;
+    unsigned char m = 0, d = 0;
+    detail::civil_from_day(days_, y, m, d);
+    return { date::year(y), date::month(m), date::day(d) };
+}
+
+CONSTCD14
+inline
+Date SerialDate::date() const
+{
+    return { year_month_day() };
+}
+
+CONSTCD14
+inline
+const date::year SerialDate::year() const
+{
+    return year_month_day().year();
+}
+
+CONSTCD14
+inline
+const date::month SerialDate::month() const
+{
+    return year_month_day().month();
+}
+
+CONSTCD14
+inline
+const date::day SerialDate::day() const
+{
+    return year_month_day().day();
+}
+
+CONSTCD11
+inline
+date::weekday SerialDate::objweekday() const
+{
+    return date::weekday(sys_days());
+}
+
+CONSTCD14
+inline
+unsigned SerialDate::weekday() const
+{
+    // 1970-01-01 is a Thursday, 3 with Monday as 0
+    auto w = (days_ + 3) % 7;
+    return static_cast<unsigned>(w < 0 ? w + 7 : w);
+}
+
+CONSTCD14
+inline
+unsigned SerialDate::isoweekday() const
+{
+    return 1 + weekday();
+}
+
+CONSTCD14
+inline
+IsoCalendar SerialDate::isocalendar() const
+{
+    IsoCalendar iso = {0, 0, 0};
+    detail::iso_from_day(days_, iso.year, iso.week, iso.weekday);
+    return iso;
+}
+
+CONSTCD11
+inline
+std::int32_t SerialDate::toordinal() const
+{
+    return days_ + detail::ordinal_shift;
+}
+
+CONSTCD11
+inline
+SerialDate SerialDate::fromordinal(std::int32_t n)
+{
+    return SerialDate(n - detail::ordinal_shift);
+}
+
+CONSTCD14
+inline
+unsigned SerialDate::dayofyear() const
+{
+    std::int32_t y = 0;
+    unsigned char m = 0, d = 0;
+    detail::civil_from_day(days_, y, m, d);
+    return static_cast<unsigned>(days_ - detail::day_from_civil(y, 1, 1)) + 1;
+}
+
+inline
+std::string SerialDate::isoformat() const
+{
+    return strftime("%F");
+}
+
+inline
+std::string SerialDate::strftime(const std::string& format) const
+{
+    return date().strftime(format);
+}
+
+
+CONSTCD11
+inline
+SerialDate operator+(const SerialDate& d, const date::days& n)
+{
+    return SerialDate(d.serial() + static_cast<std::int32_t>(n.count()));
+}
+
+CONSTCD11
+inline
+SerialDate operator-(const SerialDate& d, const date::days& n)
+{
+    return SerialDate(d.serial() - static_cast<std::int32_t>(n.count()));
+}
+
+CONSTCD11
+inline
+SerialDate operator+(const SerialDate& d, const TimeDelta& td)
+{
+    return SerialDate(d.serial() + td.days());
+}
+
+CONSTCD11
+inline
+SerialDate operator+(const TimeDelta& td, const SerialDate& d)
+{
+    return d + td;
+}
+
+CONSTCD11
+inline
+SerialDate operator-(const SerialDate& d, const TimeDelta& td)
+{
+    return SerialDate(d.serial() - td.days());
+}
+
+CONSTCD11
+inline
+TimeDelta operator-(const SerialDate& x, const SerialDate& y)
+{
+    return { date::days(x.serial() - y.serial()) };
+}
+
+CONSTCD11
+inline
+bool operator==(const SerialDate& x, const SerialDate& y)
+{
+    return x.serial() == y.serial();
+}
+
+CONSTCD11
+inline
+bool operator!=(const SerialDate& x, const SerialDate& y)
+{
+    return x.serial() != y.serial();
+}
+
+CONSTCD11
+inline
+bool operator<(const SerialDate& x, const SerialDate& y)
+{
+    return x.serial() < y.serial();
+}
+
+CONSTCD11
+inline
+bool operator<=(const SerialDate& x, const SerialDate& y)
+{
+    return x.serial() <= y.serial();
+}
+
+CONSTCD11
+inline
+bool operator>(const SerialDate& x, const SerialDate& y)
+{
+    return x.serial() > y.serial();
+}
+
+CONSTCD11
+inline
+bool operator>=(const SerialDate& x, const SerialDate& y)
+{
+    return x.serial() >= y.serial();
+}
+
+template<class CharT, class Traits>
+inline
+std::basic_ostream<CharT, Traits>&
+operator<<(std::basic_ostream<CharT, Traits>& os, const SerialDate& date)
+{
+    return os << date.year_month_day();
+}
+
+
+
+// parse_epoch impl
+
+namespace detail
+{
+
+// [-]digits[.digits] counted in unit_ns nanoseconds (dividing one second), as whole
+// seconds and nanoseconds in [0, 1000000000). Sets out_of_range when the seconds
+// do not fit in 64 bits.
+inline
+const char* read_epoch(const char* first, const char* last, std::int64_t unit_ns,
+                       std::int64_t& seconds, std::int64_t& nanoseconds, bool& out_of_range)
+{
+    out_of_range = false;
+    if (unit_ns <= 0 || 1000000000 % unit_ns != 0)
+    {
+        return nullptr;
+    }
+    const std::int64_t per_second = 1000000000 / unit_ns;
+    const char* p = first;
+    bool neg = p != last && *p == '-';
+    if (neg)
+    {
+        ++p;
+    }
+    const char* digits = p;
+    std::uint64_t whole = 0;
+    for (; p != last && '0' <= *p && *p <= '9'; ++p)
+    {
+        if (whole > (std::numeric_limits<std::uint64_t>::max() - 9) / 10)
+        {
+            out_of_range = true;
+        }
+        whole = 10 * whole + static_cast<unsigned>(*p - '0');
+    }
+    if (p == digits)
+    {
+        return nullptr;
+    }
+    std::uint64_t sec = whole / per_second;
+    std::int64_t ns = static_cast<std::int64_t>(whole % per_second) * unit_ns;
+    if (p != last && *p == '.')
+    {
+        ++p;
+        // fraction of unit, digits beyond the nanosecond are dropped
+        std::int64_t scale = unit_ns;
+        for (; p != last && '0' <= *p && *p <= '9'; ++p)
+        {
+            scale /= 10;
+            ns += scale * (*p - '0');
+        }
+    }
+    if (out_of_range || sec > static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max() - 1))
+    {
+        out_of_range = true;
+        return p;
+    }
+    seconds = static_cast<std::int64_t>(sec);
+    nanoseconds = ns;
+    if (neg && ns != 0)
+    {
+        seconds = -seconds - 1;
+        nanoseconds = 1000000000 - ns;
+    }
+    else if (neg)
+    {
+        seconds = -seconds;
+    }
+    return p;
+}
+
+// seconds + nanoseconds floored to Duration, false when out of the range of sys_time<Duration>
+template <class Duration>
+inline
+bool make_sys_time(std::int64_t seconds, std::int64_t nanoseconds, date::sys_time<Duration>& out)
+{
+    using CT = typename std::common_type<Duration, std::chrono::seconds>::type;
+    // normalize nanoseconds to [0, 1000000000)
+    auto carry = nanoseconds / 1000000000 - (nanoseconds % 1000000000 < 0 ? 1 : 0);
+    nanoseconds -= carry * 1000000000;
+    if ((carry > 0 && seconds > std::numeric_limits<std::int64_t>::max() - carry) ||
+        (carry < 0 && seconds < std::numeric_limits<std::int64_t>::min() - carry))
+    {
+        return false;
+    }
+    seconds += carry;
+    // one second of margin for the fraction
+    static const auto limit = std::chrono::duration_cast<std::chrono::seconds>(CT::max()).count() - 1;
+    if (seconds > limit || seconds < -limit)
+    {
+        return false;
+    }
+    out = date::floor<Duration>(date::sys_time<CT>{std::chrono::seconds(seconds)} +
+                                date::floor<CT>(std::chrono::nanoseconds(nanoseconds)));
+    return true;
+}
+
+// whole seconds, floored, and nanoseconds in [0, 1000000000) of a timestamp in
+// seconds, false out of the range of system_clock::time_point and for NaN
+template <class Rep>
+inline
+bool split_timestamp(Rep timestamp, std::int64_t& seconds, std::int64_t& nanoseconds)
+{
+    const auto t = static_cast<double>(timestamp);
+    if (!(t > -9.2e9 && t < 9.2e9))
+    {
+        return false;
+    }
+    const double whole = std::floor(t);
+    seconds = static_cast<std::int64_t>(whole);
+    nanoseconds = static_cast<std::int64_t>((t - whole) * 1e9);
+    return true;
+}
+
+} // namespace detail
+
+template <class Duration>
+inline
+const char* parse_epoch(const char* first, const char* last, date::sys_time<Duration>& out,
+                        std::chrono::nanoseconds unit)
+{
+    std::int64_t seconds = 0, nanoseconds = 0;
+    bool out_of_range;
+    const char* p = detail::read_epoch(first, last, unit.count(), seconds, nanoseconds, out_of_range);
+    if (p == nullptr || out_of_range || !detail::make_sys_time(seconds, nanoseconds, out))
+    {
+        return nullptr;
+    }
+    return p;
+}
+
+
+
+// DateTime impl
+
+template <class Duration>
+inline
+DateTime<typename std::common_type<Duration, std::chrono::seconds>::type> 
+DateTime<Duration>::today()
+{
+    return date::make_zoned(date::current_zone(), date::floor<Duration>(std::chrono::system_clock::now()));
+}
+
+
+template <class Duration>
+inline
+DateTime<typename std::common_type<Duration, std::chrono::seconds>::type> 
+DateTime<Duration>::now(const std::string& timezone_name)
+{
+    if (timezone_name == "")
+    {
+        return today();
+    }
+    return date::make_zoned(timezone_name, date::floor<Duration>(std::chrono::system_clock::now()));
+}
+
+
+template <class Duration>
+inline
+DateTime<typename std::common_type<Duration, std::chrono::seconds>::type> 
+DateTime<Duration>::utcnow()
+{
+    return { date::floor<Duration>(std::chrono::system_clock::now()) };
+}
+
+template<class Duration>
+template<class Rep>
+inline
+DateTime<typename std::common_type<Duration, std::chrono::seconds>::type> 
+DateTime<Duration>::fromtimestamp(Rep timestamp, const std::string& timezone_name) 
+{
+    using CT = typename std::common_type<Duration, std::chrono::seconds>::type;
+    std::int64_t seconds = 0, nanoseconds = 0;
+    date::sys_time<CT> tp;
+    if (!detail::split_timestamp(timestamp, seconds, nanoseconds) || !detail::make_sys_time(seconds, nanoseconds, tp))
+    {
+        throw std::system_error(make_error_code(errc::timestamp_out_of_range), "fromtimestamp");
+    }
+    if (timezone_name == "") 
+    {
+        return { date::make_zoned(date::current_zone(), tp) };
+    }
+    else 
+    {
+        return { date::make_zoned(timezone_name, tp) };
+    }
 }
 
+template<class Duration>
+template<class Rep>
+inline
+DateTime<typename std::common_type<Duration, std::chrono::seconds>::type> 
+DateTime<Duration>::utcfromtimestamp(Rep timestamp) 
+{
+    using CT = typename std::common_type<Duration, std::chrono::seconds>::type;
+    std::int64_t seconds = 0, nanoseconds = 0;
+    date::sys_time<CT> tp;
+    if (!detail::split_timestamp(timestamp, seconds, nanoseconds) || !detail::make_sys_time(seconds, nanoseconds, tp))
+    {
+        throw std::system_error(make_error_code(errc::timestamp_out_of_range), "utcfromtimestamp");
+    }
+    return { tp };
+}
 
+template<class Duration>
+inline
+DateTime<typename std::common_type<Duration, std::chrono::seconds>::type> 
+DateTime<Duration>::fromtimestamp(std::chrono::seconds seconds, std::chrono::nanoseconds nanoseconds,
+                                  const std::string& timezone_name) 
+{
+    using CT = typename std::common_type<Duration, std::chrono::seconds>::type;
+    date::sys_time<CT> tp;
+    if (!detail::make_sys_time(seconds.count(), nanoseconds.count(), tp))
+    {
+        throw std::system_error(make_error_code(errc::timestamp_out_of_range), "fromtimestamp");
+    }
+    if (timezone_name == "") 
+    {
+        return { date::make_zoned(date::current_zone(), tp) };
+    }
+    else 
+    {
+        return { date::make_zoned(timezone_name, tp) };
+    }
+}
 
-// Date impl
-
+template<class Duration>
 inline
-Date Date::today() 
+DateTime<typename std::common_type<Duration, std::chrono::seconds>::type> 
+DateTime<Duration>::utcfromtimestamp(std::chrono::seconds seconds, std::chrono::nanoseconds nanoseconds) 
 {
-    return { date::floor<date::days>(std::chrono::system_clock::now()) };
+    using CT = typename std::common_type<Duration, std::chrono::seconds>::type;
+    date::sys_time<CT> tp;
+    if (!detail::make_sys_time(seconds.count(), nanoseconds.count(), tp))
+    {
+        throw std::system_error(make_error_code(errc::timestamp_out_of_range), "utcfromtimestamp");
+    }
+    return { tp };
 }
 
+template<class Duration>
+inline
+DateTime<typename std::common_type<Duration, std::chrono::seconds>::type> 
+DateTime<Duration>::fromtimestamp(const char* first, const char* last, const date::time_zone* zone,
+                                  std::error_code& ec, std::chrono::nanoseconds unit) 
+{
+    using CT = typename std::common_type<Duration, std::chrono::seconds>::type;
+    ec.clear();
+    std::int64_t seconds = 0, nanoseconds = 0;
+    bool out_of_range;
+    date::sys_time<CT> tp;
+    if (detail::read_epoch(first, last, unit.count(), seconds, nanoseconds, out_of_range) != last)
+    {
+        ec = errc::parse_error;
+    }
+    else if (out_of_range || !detail::make_sys_time(seconds, nanoseconds, tp))
+    {
+        ec = errc::timestamp_out_of_range;
+    }
+    if (ec)
+    {
+        return { date::zoned_time<CT>(detail::utc_zone(), date::sys_time<CT>{}) };
+    }
+    return { date::zoned_time<CT>(zone == nullptr ? detail::utc_zone() : zone, tp) };
+}
 
+template<class Duration>
 template<class Rep>
 inline
-Date Date::fromtimestamp(Rep timestamp) 
+DateTime<typename std::common_type<Duration, std::chrono::seconds>::type> 
+DateTime<Duration>::fromtimestamp(Rep timestamp, const std::string& timezone_name, std::error_code& ec) 
+{
+    using CT = typename std::common_type<Duration, std::chrono::seconds>::type;
+    ec.clear();
+    const date::time_zone* zone = timezone_name == "" ? detail::current_zone() : try_locate_zone(timezone_name);
+    if (zone == nullptr)
+    {
+        ec = errc::unknown_time_zone;
+        return { date::zoned_time<CT>(detail::utc_zone(), date::sys_time<CT>{}) };
+    }
+    std::int64_t seconds = 0, nanoseconds = 0;
+    date::sys_time<CT> tp;
+    if (!detail::split_timestamp(timestamp, seconds, nanoseconds) || !detail::make_sys_time(seconds, nanoseconds, tp))
+    {
+        ec = errc::timestamp_out_of_range;
+        return { date::zoned_time<CT>(detail::utc_zone(), date::sys_time<CT>{}) };
+    }
+    return { date::zoned_time<CT>(zone, tp) };
+}
+
+template <class Duration>
+inline
+DateTime<typename std::common_type<Duration, std::chrono::seconds>::type> 
+DateTime<Duration>::strptime(const std::string& date_string, const std::string& format)
+{
+    std::error_code ec;
+    auto dt = strptime(date_string, format, ec);
+    if (ec)
+    {
+        throw std::system_error(ec, "strptime(\"" + date_string + "\", \"" + format + "\")");
+    }
+    return dt;
+}
+
+template <class Duration>
+inline
+DateTime<typename std::common_type<Duration, std::chrono::seconds>::type> 
+DateTime<Duration>::strptime(const std::string& date_string, const std::string& format, std::error_code& ec)
+{
+    using CT = typename std::common_type<Duration, std::chrono::seconds>::type;
+    const date::time_zone* zone = detail::current_zone();
+    if (zone == nullptr)
+    {
+        ec = errc::unknown_time_zone;
+        return { date::zoned_time<CT>(detail::utc_zone(), date::sys_time<CT>{}) };
+    }
+    return strptime(date_string.data(), date_string.data() + date_string.size(), Format(format), zone, ec);
+}
+
+template <class Duration>
+inline
+DateTime<typename std::common_type<Duration, std::chrono::seconds>::type> 
+DateTime<Duration>::strptime(const char* first, const char* last, const Format& format,
+                             const date::time_zone* zone, std::error_code& ec)
+{
+    using CT = typename std::common_type<Duration, std::chrono::seconds>::type;
+    ec.clear();
+    date::local_time<CT> tp;
+    std::chrono::minutes offset{0};
+    date::sys_time<CT> st{};
+    if (format.parse(first, last, tp, &offset) != last)
+    {
+        ec = errc::parse_error;
+    }
+    else if (format.has_offset())
+    {
+        st = date::sys_time<CT>{tp.time_since_epoch() - offset};
+    }
+    else
+    {
+        st = detail::to_sys(zone, tp, ec);
+    }
+    if (zone == nullptr)
+    {
+        zone = detail::utc_zone();
+        if (zone == nullptr && !ec)
+        {
+            ec = errc::unknown_time_zone;
+        }
+    }
+    if (ec)
+    {
+        return { date::zoned_time<CT>(detail::utc_zone(), date::sys_time<CT>{}) };
+    }
+    return { date::zoned_time<CT>(zone, st) };
+}
+
+
+template <class Duration>
+inline
+date::fields<typename std::common_type<Duration, std::chrono::seconds>::type> 
+DateTime<Duration>::fields_ymd_time() const
+{
+    using CT = typename std::common_type<Duration, std::chrono::seconds>::type;
+    auto tp = zoned_time().get_local_time();
+    auto ld = date::floor<date::days>(tp);
+    date::fields<CT> fds{date::year_month_day{ld}, date::time_of_day<CT>{tp-ld}};
+    return fds;
+}
+
+template <class Duration>
+inline
+Date DateTime<Duration>::date() const
+{
+    return fields_ymd_time().ymd;
+}
+
+template <class Duration>
+inline
+const date::year DateTime<Duration>::year() const
+{
+    return date().year();
+}
+
+template <class Duration>
+inline
+const date::month DateTime<Duration>::month() const
+{
+    return date().month();
+}
+
+template <class Duration>
+inline
+const date::day DateTime<Duration>::day() const
+{
+    return date().day();
+}
+
+template <class Duration>
+inline
+const date::time_zone* DateTime<Duration>::time_zone() const
+{
+    return zt_.get_time_zone();
+}
+
+template <class Duration>
+inline
+const std::string& DateTime<Duration>::tzinfo() const
+{
+    return zt_.get_time_zone()->name();
+}
+
+template <class Duration>
+inline
+TimeDelta DateTime<Duration>::utcoffset() const
+{
+    auto offset = zoned_time().get_info().offset;
+    return { std::chrono::seconds{offset} };
+}
+
+template <class Duration>
+inline
+double DateTime<Duration>::timestamp() const
 {
     using namespace std::chrono;
-    // system_clock::time_point dt{seconds{timestamp}}; // compatible with old compilers ?
-    seconds dur(timestamp);
-    time_point<system_clock> dt(dur);
+    auto d = zt_.get_sys_time().time_since_epoch();
+    auto s = date::floor<seconds>(d);
+    return static_cast<double>(s.count()) + duration<double>(d - s).count();
+}
 
-    return { date::floor<date::days>(dt) }; // convert time_point to sys_days
+template <class Duration>
+inline
+std::int64_t DateTime<Duration>::timestamp_seconds() const
+{
+    return date::floor<std::chrono::seconds>(zt_.get_sys_time().time_since_epoch()).count();
 }
 
+template <class Duration>
 inline
-Date::Date(const date::year_month_day& ymd) 
-    : ymd_(ymd) 
-    {}
+std::int64_t DateTime<Duration>::timestamp_ms() const
+{
+    return date::floor<std::chrono::milliseconds>(zt_.get_sys_time().time_since_epoch()).count();
+}
 
+template <class Duration>
 inline
-Date::Date(const date::year& y, const date::month& m, const date::day& d) 
-    : ymd_(y, m, d) 
-    {}
+std::int64_t DateTime<Duration>::timestamp_us() const
+{
+    return date::floor<std::chrono::microseconds>(zt_.get_sys_time().time_since_epoch()).count();
+}
 
+template <class Duration>
 inline
-const date::year_month_day& Date::year_month_day() const 
+std::int64_t DateTime<Duration>::timestamp_ns() const
 {
-    return ymd_;
+    return date::floor<std::chrono::nanoseconds>(zt_.get_sys_time().time_since_epoch()).count();
 }
 
+template <class Duration>
 inline
-const date::year Date::year() const
+char* DateTime<Duration>::timestamp_to_chars(char* first, char* last) const
 {
-    return ymd_.year();
+    return detail::write_decimal_seconds(first, last, zt_.get_sys_time().time_since_epoch());
 }
 
+template <class Duration>
 inline
-const date::month Date::month() const
+std::string DateTime<Duration>::ctime() const
 {
-    return ymd_.month();
+    return detail::format_c_locale("%c", zt_);
+}
+
+template <class Duration>
+inline
+std::string DateTime<Duration>::isoformat(const std::string& sep) const
+{
+    return strftime("%Y%m%d"+sep+"%H:%M:%S");
 }
 
+template <class Duration>
 inline
-const date::day Date::day() const
+std::string DateTime<Duration>::strftime(const std::string& format) const
 {
-    return ymd_.day();
+    return date::format(format.c_str(), zt_);
 }
 
+template <class Duration, class DeltaDuration>
 inline
-std::string Date::ctime() const
+DateTime<typename std::common_type<Duration, DeltaDuration>::type>
+operator+(const DateTime<Duration>& x, const BasicTimeDelta<DeltaDuration>& y)
 {
-    return strftime("%c");
+    // a single addition in the common type, which is exact
+    auto add = x.zoned_time().get_sys_time() + y.to_duration();
+    return { date::make_zoned(x.zoned_time().get_time_zone(), add) };
 }
 
+template <class Duration, class DeltaDuration>
 inline
-date::weekday Date::objweekday() const
+DateTime<typename std::common_type<Duration, DeltaDuration>::type>
+operator+(const BasicTimeDelta<DeltaDuration>& y, const DateTime<Duration>& x)
 {
-    return date::weekday(ymd_);
+    return x + y;
 }
 
+template <class Duration, class DeltaDuration>
 inline
-unsigned Date::weekday() const
+DateTime<typename std::common_type<Duration, DeltaDuration>::type>
+operator-(const DateTime<Duration>&  x, const BasicTimeDelta<DeltaDuration>& y)
 {
-    return (static_cast<unsigned>(objweekday()) - 1) % 7; // can do better
+    auto diff = x.zoned_time().get_sys_time() - y.to_duration();
+    return { date::make_zoned(x.zoned_time().get_time_zone(), diff) };
 }
 
+template <class Duration1, class Duration2>
 inline
-unsigned Date::isoweekday() const
+BasicTimeDelta<typename std::common_type<Duration1, Duration2>::type>
+operator-(const DateTime<Duration1>&  x, const DateTime<Duration2>& y)
 {
-    return 1 + weekday();
+    return { x.zoned_time().get_sys_time() - y.zoned_time().get_sys_time() };
 }
 
+template <class Duration>
+inline
+bool operator<(const DateTime<Duration>&  x, const DateTime<Duration>& y) 
+{
+    return x.zoned_time().get_sys_time() < y.zoned_time().get_sys_time();
+}
 
+template<class CharT, class Traits, class Duration>
 inline
-std::string Date::isoformat() const
+std::basic_ostream<CharT, Traits>&
+operator<<(std::basic_ostream<CharT, Traits>& os, const DateTime<Duration>& date)
 {
-    return strftime("YYYY-MM-DD");
+    return os << date.zoned_time();
 }
 
+
+// Time impl
+
+template <class Rep, class Period>
+CONSTCD11
 inline
-std::string Date::strftime(const std::string& format) const
+Time::Time(const std::chrono::duration<Rep, Period>& dur) 
+    : time_of_day_(
+        date::make_time(std::chrono::duration_cast<std::chrono::system_clock::duration>(dur))
+    )
+    {}
+
+
+template<class Rep, class Period, class ... Durations>
+CONSTCD11
+inline
+Time::Time(const std::chrono::duration<Rep, Period>& d, const Durations& ... durations)
+    : time_of_day_(
+        date::make_time(std::chrono::duration_cast<std::chrono::system_clock::duration>(detail::sum_durations(d, durations...)))
+    )
+    {}
+
+
+CONSTCD11
+inline
+const date::time_of_day<std::chrono::system_clock::duration>& Time::time_of_day() const
 {
-    return date::format(format.c_str(), ymd_);
+    return time_of_day_;
 }
 
 
+CONSTCD11
+inline
+std::chrono::hours::rep Time::hour() const
+{
+    return time_of_day().hours().count();
+}
+
+CONSTCD11
+inline
+std::chrono::minutes::rep Time::minute() const
+{
+    return time_of_day().minutes().count();
+}
 
+CONSTCD11
 inline
-Date operator+(const Date& d, const TimeDelta& td)
+std::chrono::seconds::rep Time::seconds() const
 {
-    return { date::sys_days(d.year_month_day()) + date::days(td.days()) };
+    return time_of_day().seconds().count();
 }
 
+
+CONSTCD11
 inline
-Date operator+(const TimeDelta& td, const Date& d)
+std::chrono::microseconds::rep Time::microsecond() const
 {
-    return d + td;
+    return std::chrono::duration_cast<std::chrono::microseconds>(time_of_day().subseconds()).count();
 }
 
+
 inline
-Date operator-(const Date& d, const TimeDelta& td)
+std::string Time::isoformat() const
 {
-    return { date::sys_days(d.year_month_day()) - date::days(td.days()) };
+    static const Format format("%H:%M:%S.%f");
+    char buf[16];
+    auto end = strftime(buf, buf + sizeof(buf), format);
+    return std::string(buf, microsecond() == 0 ? buf + 8 : end); // HH:MM:SS[.ffffff]
 }
 
 inline
-TimeDelta operator-(const Date& x, const Date& y)
+std::string Time::strftime(const std::string& format) const
 {
-    return { date::sys_days(x.year_month_day()) - date::sys_days(y.year_month_day()) };
+    std::string s;
+    format_to(std::back_inserter(s), *this, Format(format));
+    return s;
 }
 
 inline
-bool operator==(const Date& x, const Date& y)
+char* Time::strftime(char* first, char* last, const Format& format) const
 {
-    return x.year_month_day() == y.year_month_day();
+    // microseconds as isoformat, and whole seconds when there are none
+    const auto t = date::local_days(date::year{1900}/1/1) +
+                   date::floor<std::chrono::microseconds>(time_of_day().to_duration());
+    if (microsecond() == 0)
+    {
+        return format.format(first, last, date::floor<std::chrono::seconds>(t));
+    }
+    return format.format(first, last, t);
 }
 
-
 template<class CharT, class Traits>
-inline
 std::basic_ostream<CharT, Traits>&
-operator<<(std::basic_ostream<CharT, Traits>& os, const Date& date)
+operator<<(std::basic_ostream<CharT, Traits>& os, const Time& time)
 {
-    return os << date.year_month_day();
+    return os << time.time_of_day();
 }
 
 
+// Format impl
 
-// DateTime impl
-
-template <class Duration>
 inline
-DateTime<typename std::common_type<Duration, std::chrono::seconds>::type> 
-DateTime<Duration>::today()
+Format::Format(const std::string& format)
+    : format_(format)
 {
-    return date::make_zoned(date::current_zone(), date::floor<Duration>(std::chrono::system_clock::now()));
+    compile(format_.c_str(), false);
+    if (has_microsecond_)
+    {
+        for (auto& item : items_)
+        {
+            if (item.kind == Kind::second)
+            {
+                item.kind = Kind::whole_second;
+            }
+        }
+    }
 }
 
+inline
+void Format::add(Kind kind, unsigned width)
+{
+    items_.push_back(Item{kind, static_cast<unsigned char>(width), 0, 0});
+}
 
-template <class Duration>
 inline
-DateTime<typename std::common_type<Duration, std::chrono::seconds>::type> 
-DateTime<Duration>::now(const std::string& timezone_name)
+void Format::add_literal(char c)
 {
-    if (timezone_name == "")
+    if (!items_.empty() && items_.back().kind == Kind::literal &&
+        items_.back().pos + items_.back().length == literals_.size())
     {
-        return today();
+        ++items_.back().length;
     }
-    return date::make_zoned(timezone_name, date::floor<Duration>(std::chrono::system_clock::now()));
+    else
+    {
+        items_.push_back(Item{Kind::literal, 0, literals_.size(), 1});
+    }
+    literals_ += c;
 }
 
-
-template <class Duration>
 inline
-DateTime<typename std::common_type<Duration, std::chrono::seconds>::type> 
-DateTime<Duration>::utcnow()
+void Format::add_space(char c)
 {
-    return { date::floor<Duration>(std::chrono::system_clock::now()) };
+    items_.push_back(Item{Kind::space, 0, literals_.size(), 1});
+    literals_ += c;
 }
 
-template<class Duration>
-template<class Rep>
 inline
-DateTime<typename std::common_type<Duration, std::chrono::seconds>::type> 
-DateTime<Duration>::fromtimestamp(Rep timestamp, const std::string& timezone_name) 
+void Format::compile(const char* f, bool whole_seconds)
 {
+    for (; *f; ++f)
+    {
+        if (*f != '%')
+        {
+            if (std::isspace(static_cast<unsigned char>(*f)))
+            {
+                add_space(*f);
+            }
+            else
+            {
+                add_literal(*f);
+            }
+            continue;
+        }
+        ++f;
+        unsigned width = 0;
+        while ('0' <= *f && *f <= '9')
+        {
+            width = 10 * width + static_cast<unsigned>(*f++ - '0');
+        }
+        switch (*f)
+        {
+        case 'Y': add(Kind::year, width ? width : 4); break;
+        case 'y': add(Kind::year2, 2); break;
+        case 'm': add(Kind::month, 2); break;
+        case 'd': add(Kind::day, 2); break;
+        case 'e': add(Kind::day_space, 2); break;
+        case 'j': add(Kind::yday, 3); break;
+        case 'H': add(Kind::hour, 2); break;
+        case 'I': add(Kind::hour12, 2); break;
+        case 'M': add(Kind::minute, 2); break;
+        case 'S': add(whole_seconds ? Kind::whole_second : Kind::second, 2); break;
+        case 'f': add(Kind::microsecond, 6); has_microsecond_ = true; break;
+        case 'b': case 'h': add(Kind::month_abbrev); break;
+        case 'B': add(Kind::month_name); break;
+        case 'a': add(Kind::weekday_abbrev); break;
+        case 'A': add(Kind::weekday_name); break;
+        case 'p': add(Kind::ampm); break;
+        case 'u': add(Kind::weekday_iso, 1); break;
+        case 'w': add(Kind::weekday_num, 1); break;
+        case 'z': add(Kind::offset); has_offset_ = true; break;
+        case 'Z': add(Kind::abbrev); break;
+        case 'n': add_space('\n'); break;
+        case 't': add_space('\t'); break;
+        case '%': add_literal('%'); break;
+        case 'F': compile("%Y-%m-%d", false); break;
+        case 'T': compile("%H:%M:%S", whole_seconds); break;
+        case 'D': compile("%m/%d/%y", false); break;
+        case 'R': compile("%H:%M", false); break;
+        case 'c': compile("%a %b %e %H:%M:%S %Y", true); break;  // C locale forms
+        case 'x': compile("%m/%d/%y", false); break;
+        case 'X': compile("%H:%M:%S", true); break;
+        case 'r': compile("%I:%M:%S %p", true); break;
+        case '\0':
+            fallback_ = true;
+            return;
+        default:
+            fallback_ = true; // %C %U %W %V %G %g %E.. %O..
+            break;
+        }
+    }
+}
 
-    auto nanos = static_cast<unsigned>(1e9*std::fmod(timestamp,1)); // might loose precision here
-    auto tp = std::chrono::system_clock::from_time_t(timestamp) + std::chrono::nanoseconds(nanos);
-    if (timezone_name == "") 
+namespace detail
+{
+
+// case insensitive match of names[0, n) (see date::detail::read_c_name)
+inline
+int read_name(const char*& p, const char* last, const char* const* names, unsigned n)
+{
+    const char* q = p;
+    while (q != last && q - p < 9 && std::isalpha(static_cast<unsigned char>(*q)))
     {
-        return { date::make_zoned(date::current_zone(), tp) };
+        ++q;
     }
-    else 
+    auto len = static_cast<std::size_t>(q - p);
+    for (unsigned i = 0; i < n; ++i)
     {
-        return { date::make_zoned(timezone_name, tp) };
+        const char* name = names[i];
+        std::size_t k = 0;
+        while (k < len && name[k] != '\0' && (name[k] | 0x20) == (p[k] | 0x20))
+        {
+            ++k;
+        }
+        if (k == len && name[k] == '\0')
+        {
+            p = q;
+            return static_cast<int>(i);
+        }
     }
+    return -1;
 }
 
-template<class Duration>
-template<class Rep>
-inline
-DateTime<typename std::common_type<Duration, std::chrono::seconds>::type> 
-DateTime<Duration>::utcfromtimestamp(Rep timestamp) 
+// output of Format::write into a caller buffer, remembering an overflow
+struct buffer_sink
 {
-    auto nanos = static_cast<unsigned>(1e9*std::fmod(timestamp,1)); // might loose precision here
-    auto tp = std::chrono::system_clock::from_time_t(timestamp) + std::chrono::nanoseconds(nanos);
+    char* p;
+    char* last;
 
-    return { tp };
-}
+    void put(char c)
+    {
+        if (p != nullptr && p != last)
+        {
+            *p++ = c;
+        }
+        else
+        {
+            p = nullptr;
+        }
+    }
 
-template <class Duration>
-inline
-DateTime<typename std::common_type<Duration, std::chrono::seconds>::type> 
-DateTime<Duration>::strptime(const std::string& date_string, const std::string& format)
+    void write(const char* s, std::size_t n)
+    {
+        if (p != nullptr && static_cast<std::size_t>(last - p) >= n)
+        {
+            std::memcpy(p, s, n);
+            p += n;
+        }
+        else
+        {
+            p = nullptr;
+        }
+    }
+};
+
+// output of Format::write into an output iterator
+template <class OutputIt>
+struct iterator_sink
 {
-    using namespace std::chrono;
+    OutputIt out;
 
-    date::local_seconds tp;
-    std::istringstream ss(date_string);
-    ss >> date::parse(format, tp);
-    auto zt = date::make_zoned(date::current_zone(), tp);
-    return { zt };
-}
+    void put(char c)
+    {
+        *out++ = c;
+    }
 
+    void write(const char* s, std::size_t n)
+    {
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            *out++ = s[i];
+        }
+    }
+};
 
-template <class Duration>
+template <class Sink>
 inline
-date::fields<typename std::common_type<Duration, std::chrono::seconds>::type> 
-DateTime<Duration>::fields_ymd_time() const
+void put_uint(Sink& out, std::uint64_t v, unsigned width)
 {
-    using CT = typename std::common_type<Duration, std::chrono::seconds>::type;
-    auto tp = zoned_time().get_local_time();
-    auto ld = date::floor<date::days>(tp);
-    date::fields<CT> fds{date::year_month_day{ld}, date::time_of_day<CT>{tp-ld}};
-    return fds;
+    char buf[20];
+    out.write(buf, static_cast<std::size_t>(write_uint(buf, buf + sizeof(buf), v, width) - buf));
 }
 
-template <class Duration>
+template <class Sink>
 inline
-Date DateTime<Duration>::date() const
+void put_name(Sink& out, const char* name)
 {
-    return fields_ymd_time().ymd;
+    out.write(name, std::strlen(name));
 }
 
+} // namespace detail
+
 template <class Duration>
 inline
-const date::year DateTime<Duration>::year() const
+char* Format::format(char* first, char* last, const date::local_time<Duration>& tp,
+                     const std::string* abbrev, const std::chrono::seconds* offset) const
 {
-    return date().year();
+    detail::buffer_sink out{first, last};
+    write(out, tp, abbrev, offset);
+    return out.p;
 }
 
-template <class Duration>
+template <class OutputIt, class Duration>
 inline
-const date::month DateTime<Duration>::month() const
+OutputIt Format::format_to(OutputIt out, const date::local_time<Duration>& tp,
+                           const std::string* abbrev, const std::chrono::seconds* offset) const
 {
-    return date().month();
+    detail::iterator_sink<OutputIt> sink{out};
+    write(sink, tp, abbrev, offset);
+    return sink.out;
 }
 
-template <class Duration>
+template <class Sink, class Duration>
 inline
-const date::day DateTime<Duration>::day() const
+void Format::write(Sink& out, const date::local_time<Duration>& tp,
+                   const std::string* abbrev, const std::chrono::seconds* offset) const
 {
-    return date().day();
+    using namespace std::chrono;
+    using CT = typename std::common_type<Duration, seconds>::type;
+    if (fallback_)
+    {
+        std::ostringstream os;
+        os << date::c_locale_names;
+        if (has_microsecond_)
+        {
+            // date knows nothing of %f: substitute the digits, %S is then whole seconds
+            std::string f;
+            for (std::size_t i = 0; i < format_.size(); ++i)
+            {
+                if (format_[i] == '%' && i + 1 < format_.size())
+                {
+                    if (format_[++i] == 'f')
+                    {
+                        char digits[6];
+                        auto us = duration_cast<microseconds>(tp - date::floor<seconds>(tp)).count();
+                        f.append(digits, detail::write_uint(digits, digits + 6, static_cast<std::uint64_t>(us), 6));
+                        continue;
+                    }
+                    f += '%';
+                }
+                f += format_[i];
+            }
+            date::to_stream(os, f.c_str(), date::floor<seconds>(tp), abbrev, offset);
+        }
+        else
+        {
+            date::to_stream(os, format_.c_str(), tp, abbrev, offset);
+        }
+        auto s = os.str();
+        out.write(s.data(), s.size());
+        return;
+    }
+
+    auto ld = date::floor<date::days>(tp);
+    date::year_month_day ymd{ld};
+    date::weekday wd{ld};
+    auto since_midnight = date::local_time<CT>{tp} - ld;
+    auto subseconds = since_midnight - date::floor<seconds>(since_midnight);
+    const auto S = static_cast<std::uint64_t>(date::floor<seconds>(since_midnight).count());
+    const auto H = static_cast<unsigned>(S / 3600);
+
+    for (const Item& item : items_)
+    {
+        switch (item.kind)
+        {
+        case Kind::literal:
+        case Kind::space:
+            out.write(literals_.data() + item.pos, item.length);
+            break;
+        case Kind::year:
+        {
+            int y = static_cast<int>(ymd.year());
+            if (y < 0)
+            {
+                out.put('-');
+            }
+            detail::put_uint(out, static_cast<std::uint64_t>(y < 0 ? -y : y), 4);
+            break;
+        }
+        case Kind::year2:
+        {
+            int y = static_cast<int>(ymd.year()) % 100;
+            detail::put_uint(out, static_cast<std::uint64_t>(y < 0 ? -y : y), 2);
+            break;
+        }
+        case Kind::month:
+            detail::put_uint(out, static_cast<unsigned>(ymd.month()), 2);
+            break;
+        case Kind::day:
+            detail::put_uint(out, static_cast<unsigned>(ymd.day()), 2);
+            break;
+        case Kind::day_space:
+        {
+            auto d = static_cast<unsigned>(ymd.day());
+            if (d < 10)
+            {
+                out.put(' ');
+            }
+            detail::put_uint(out, d, 1);
+            break;
+        }
+        case Kind::yday:
+            detail::put_uint(out, static_cast<std::uint64_t>(
+                (ld - date::local_days(ymd.year()/1/1)).count() + 1), 3);
+            break;
+        case Kind::hour:
+            detail::put_uint(out, H, 2);
+            break;
+        case Kind::hour12:
+            detail::put_uint(out, H % 12 == 0 ? 12 : H % 12, 2);
+            break;
+        case Kind::minute:
+            detail::put_uint(out, S / 60 % 60, 2);
+            break;
+        case Kind::whole_second:
+            detail::put_uint(out, S % 60, 2);
+            break;
+        case Kind::second:
+            detail::put_uint(out, S % 60, 2);
+            if (detail::decimals<typename CT::period>() > 0)
+            {
+                auto fraction = static_cast<std::uint64_t>(duration_cast<nanoseconds>(subseconds).count());
+                for (unsigned i = detail::decimals<typename CT::period>(); i < 9; ++i)
+                {
+                    fraction /= 10;
+                }
+                out.put('.');
+                detail::put_uint(out, fraction, detail::decimals<typename CT::period>());
+            }
+            break;
+        case Kind::microsecond:
+            detail::put_uint(out, static_cast<std::uint64_t>(duration_cast<microseconds>(subseconds).count()), 6);
+            break;
+        case Kind::month_name:
+            detail::put_name(out, date::detail::month_names()[static_cast<unsigned>(ymd.month()) - 1]);
+            break;
+        case Kind::month_abbrev:
+            detail::put_name(out, date::detail::month_names()[static_cast<unsigned>(ymd.month()) + 11]);
+            break;
+        case Kind::weekday_name:
+            detail::put_name(out, date::detail::weekday_names()[static_cast<unsigned>(wd)]);
+            break;
+        case Kind::weekday_abbrev:
+            detail::put_name(out, date::detail::weekday_names()[static_cast<unsigned>(wd) + 7]);
+            break;
+        case Kind::ampm:
+            detail::put_name(out, date::detail::ampm_names()[H < 12 ? 0 : 1]);
+            break;
+        case Kind::weekday_iso:
+            detail::put_uint(out, wd == date::sun ? 7u : static_cast<unsigned>(wd), 1);
+            break;
+        case Kind::weekday_num:
+            detail::put_uint(out, static_cast<unsigned>(wd), 1);
+            break;
+        case Kind::offset:
+        {
+            if (offset == nullptr)
+            {
+                throw std::runtime_error("Can not format %z with unknown offset");
+            }
+            auto m = duration_cast<minutes>(*offset).count();
+            out.put(m < 0 ? '-' : '+');
+            m = m < 0 ? -m : m;
+            detail::put_uint(out, static_cast<std::uint64_t>(m / 60), 2);
+            detail::put_uint(out, static_cast<std::uint64_t>(m % 60), 2);
+            break;
+        }
+        case Kind::abbrev:
+            if (abbrev == nullptr)
+            {
+                throw std::runtime_error("Can not format %Z with unknown time_zone");
+            }
+            out.write(abbrev->data(), abbrev->size());
+            break;
+        }
+    }
 }
 
 template <class Duration>
 inline
-const date::time_zone* DateTime<Duration>::time_zone() const
+const char* Format::parse(const char* first, const char* last, date::local_time<Duration>& tp,
+                          std::chrono::minutes* offset) const
 {
-    return zt_.get_time_zone();
+    using namespace std::chrono;
+    if (fallback_)
+    {
+        return parse_fallback(first, last, tp, offset);
+    }
+
+    const int not_set = -1;
+    int Y = not_set, y2 = not_set, m = not_set, d = not_set, j = not_set;
+    int H = not_set, I = not_set, pm = not_set, M = 0, S = 0, wd = not_set;
+    int off = 0;
+    nanoseconds subseconds{0};
+
+    const char* p = first;
+    for (const Item& item : items_)
+    {
+        int x = 0;
+        switch (item.kind)
+        {
+        case Kind::literal:
+            if (static_cast<std::size_t>(last - p) < item.length ||
+                literals_.compare(item.pos, item.length, p, item.length) != 0)
+            {
+                return nullptr;
+            }
+            p += item.length;
+            break;
+        case Kind::space:
+            while (p != last && std::isspace(static_cast<unsigned char>(*p)))
+            {
+                ++p;
+            }
+            break;
+        case Kind::year:
+        {
+            bool neg = p != last && *p == '-';
+            if (p != last && (*p == '-' || *p == '+'))
+            {
+                ++p;
+            }
+            if (!detail::read_digits(p, last, item.width, Y))
+            {
+                return nullptr;
+            }
+            if (neg)
+            {
+                Y = -Y;
+            }
+            break;
+        }
+        case Kind::year2:
+            if (!detail::read_digits(p, last, item.width, y2)) return nullptr;
+            break;
+        case Kind::month:
+            if (!detail::read_digits(p, last, item.width, m)) return nullptr;
+            break;
+        case Kind::day_space:
+            if (p != last && *p == ' ')
+            {
+                ++p;
+            }
+            // fall through
+        case Kind::day:
+            if (!detail::read_digits(p, last, item.width, d)) return nullptr;
+            break;
+        case Kind::yday:
+            if (!detail::read_digits(p, last, item.width, j)) return nullptr;
+            break;
+        case Kind::hour:
+            if (!detail::read_digits(p, last, item.width, H)) return nullptr;
+            break;
+        case Kind::hour12:
+            if (!detail::read_digits(p, last, item.width, I) || I < 1 || I > 12) return nullptr;
+            break;
+        case Kind::minute:
+            if (!detail::read_digits(p, last, item.width, M)) return nullptr;
+            break;
+        case Kind::whole_second:
+            if (!detail::read_digits(p, last, item.width, S)) return nullptr;
+            break;
+        case Kind::second:
+            if (!detail::read_digits(p, last, item.width, S)) return nullptr;
+            if (std::ratio_less<typename Duration::period, std::ratio<1>>::value &&
+                p != last && *p == '.')
+            {
+                ++p;
+                std::int64_t ns = 0;
+                unsigned n = 0;
+                for (; p != last && '0' <= *p && *p <= '9'; ++p, ++n)
+                {
+                    if (n < 9)
+                    {
+                        ns = 10 * ns + (*p - '0');
+                    }
+                }
+                for (; n < 9; ++n)
+                {
+                    ns *= 10;
+                }
+                subseconds = nanoseconds{ns};
+            }
+            break;
+        case Kind::microsecond:
+        {
+            const char* q = p;
+            if (!detail::read_digits(p, last, item.width, x)) return nullptr;
+            for (auto n = p - q; n < 6; ++n)
+            {
+                x *= 10;
+            }
+            subseconds = microseconds{x};
+            break;
+        }
+        case Kind::month_name:
+        case Kind::month_abbrev:
+            x = detail::read_name(p, last, date::detail::month_names(), 24);
+            if (x < 0) return nullptr;
+            m = x % 12 + 1;
+            break;
+        case Kind::weekday_name:
+        case Kind::weekday_abbrev:
+            x = detail::read_name(p, last, date::detail::weekday_names(), 14);
+            if (x < 0) return nullptr;
+            wd = x % 7;
+            break;
+        case Kind::ampm:
+            pm = detail::read_name(p, last, date::detail::ampm_names(), 2);
+            if (pm < 0) return nullptr;
+            break;
+        case Kind::weekday_iso:
+            if (!detail::read_digits(p, last, item.width, x) || x < 1 || x > 7) return nullptr;
+            wd = x % 7;
+            break;
+        case Kind::weekday_num:
+            if (!detail::read_digits(p, last, item.width, x) || x > 6) return nullptr;
+            wd = x;
+            break;
+        case Kind::offset:
+        {
+            if (p == last || (*p != '+' && *p != '-'))
+            {
+                return nullptr;
+            }
+            bool neg = *p++ == '-';
+            int hh = 0, mm = 0;
+            if (last - p < 2 || !detail::read_digits(p, p + 2, 2, hh))
+            {
+                return nullptr;
+            }
+            // +hh, +hhmm or +hh:mm, two digits of minutes below 60
+            const bool colon = p != last && *p == ':';
+            if (colon)
+            {
+                ++p;
+            }
+            if (colon || (last - p >= 2 && '0' <= *p && *p <= '9'))
+            {
+                const char* q = p;
+                if (last - p < 2 || !detail::read_digits(p, p + 2, 2, mm) || p - q != 2 || mm > 59)
+                {
+                    return nullptr;
+                }
+            }
+            off = neg ? -(60 * hh + mm) : 60 * hh + mm;
+            break;
+        }
+        case Kind::abbrev:
+        {
+            const char* q = p;
+            while (q != last && (std::isalnum(static_cast<unsigned char>(*q)) ||
+                                 *q == '_' || *q == '/' || *q == '-' || *q == '+'))
+            {
+                ++q;
+            }
+            if (q == p) return nullptr;
+            p = q;
+            break;
+        }
+        }
+    }
+
+    if (y2 != not_set)
+    {
+        int tY = y2 >= 69 ? 1900 + y2 : 2000 + y2;
+        if (Y != not_set && Y != tY) return nullptr;
+        Y = tY;
+    }
+    if (Y == not_set)
+    {
+        return nullptr;
+    }
+    if (j != not_set)
+    {
+        auto ymd = date::year_month_day{date::local_days(date::year{Y}/1/1) + date::days{j - 1}};
+        if (ymd.year() != date::year{Y}) return nullptr;
+        int jm = static_cast<int>(static_cast<unsigned>(ymd.month()));
+        int jd = static_cast<int>(static_cast<unsigned>(ymd.day()));
+        if ((m != not_set && m != jm) || (d != not_set && d != jd)) return nullptr;
+        m = jm;
+        d = jd;
+    }
+    if (m == not_set || d == not_set)
+    {
+        return nullptr;
+    }
+    auto ymd = date::year{Y}/static_cast<unsigned>(m)/static_cast<unsigned>(d);
+    if (!ymd.ok())
+    {
+        return nullptr;
+    }
+    auto ld = date::local_days(ymd);
+    if (wd != not_set && date::weekday{ld} != date::weekday{static_cast<unsigned>(wd)})
+    {
+        return nullptr;
+    }
+    if (I != not_set)
+    {
+        int tH = I % 12 + (pm == 1 ? 12 : 0);
+        if (H != not_set && H != tH) return nullptr;
+        H = tH;
+    }
+    else if (pm != not_set)
+    {
+        return nullptr;
+    }
+    if (H == not_set)
+    {
+        H = 0;
+    }
+    if (H > 23 || M > 59 || S > 60)
+    {
+        return nullptr;
+    }
+    tp = ld + hours{H} + minutes{M} + seconds{S} + duration_cast<Duration>(subseconds);
+    if (offset != nullptr && has_offset_)
+    {
+        *offset = minutes{off};
+    }
+    return p;
 }
 
 template <class Duration>
 inline
-const std::string& DateTime<Duration>::tzinfo() const
+const char* Format::parse_fallback(const char* first, const char* last, date::local_time<Duration>& tp,
+                                   std::chrono::minutes* offset) const
 {
-    return zt_.get_time_zone()->name();
+    std::istringstream is(std::string(first, last));
+    is >> date::c_locale_names;
+    std::chrono::minutes off{0};
+    date::local_time<Duration> t;
+    date::from_stream(is, format_.c_str(), t, static_cast<std::string*>(nullptr), &off);
+    if (is.fail())
+    {
+        return nullptr;
+    }
+    tp = t;
+    if (offset != nullptr && has_offset_)
+    {
+        *offset = off;
+    }
+    is.clear();
+    auto consumed = is.tellg();
+    return consumed < 0 ? last : first + static_cast<std::ptrdiff_t>(consumed);
 }
 
-template <class Duration>
+
+// ZoneCache impl
+
 inline
-TimeDelta DateTime<Duration>::utcoffset() const
+ZoneCache::ZoneCache(const date::time_zone* zone)
+    : zone_(zone)
+    , begin_()
+    , end_()  // empty interval: the first conversion does the lookup
+    , offset_(0)
+    , abbrev_("UTC")
+    {}
+
+inline
+void ZoneCache::reset(const date::sys_info& info)
 {
-    auto offset = zoned_time().get_info().offset;
-    return { std::chrono::seconds{offset} };
+    begin_  = info.begin;
+    end_    = info.end;
+    offset_ = info.offset;
+    abbrev_ = info.abbrev;
 }
 
-template <class Duration>
 inline
-std::string DateTime<Duration>::timestamp() const
+std::chrono::seconds ZoneCache::offset(date::sys_seconds tp)
 {
-    std::stringstream ss;
-    ss << std::fixed << zoned_time().get_sys_time().time_since_epoch().count() / 1000000000.0;
-    return ss.str();
+    if (zone_ == nullptr)
+    {
+        return std::chrono::seconds{0};
+    }
+    if (!(begin_ <= tp && tp < end_))
+    {
+        reset(zone_->get_info(tp));
+    }
+    return offset_;
 }
 
-template <class Duration>
 inline
-std::string DateTime<Duration>::ctime() const
+const std::string& ZoneCache::abbrev(date::sys_seconds tp)
 {
-    return strftime("%c");
+    offset(tp);
+    return abbrev_;
 }
 
 template <class Duration>
 inline
-std::string DateTime<Duration>::isoformat(const std::string& sep) const
+date::local_time<typename std::common_type<Duration, std::chrono::seconds>::type>
+ZoneCache::to_local(const date::sys_time<Duration>& tp)
 {
-    return strftime("%Y%m%d"+sep+"%H:%M:%S");
+    using CT = typename std::common_type<Duration, std::chrono::seconds>::type;
+    auto off = offset(date::floor<std::chrono::seconds>(tp));
+    return date::local_time<CT>{tp.time_since_epoch() + off};
 }
 
 template <class Duration>
 inline
-std::string DateTime<Duration>::strftime(const std::string& format) const
+bool ZoneCache::to_sys(const date::local_time<Duration>& tp,
+                       date::sys_time<typename std::common_type<Duration, std::chrono::seconds>::type>& out)
 {
-    return date::format(format.c_str(), zt_);
+    using CT = typename std::common_type<Duration, std::chrono::seconds>::type;
+    if (zone_ == nullptr)
+    {
+        out = date::sys_time<CT>{tp.time_since_epoch()};
+        return true;
+    }
+    // Away from both ends of the cached interval, no neighbouring offset (they
+    // differ by at most a day) can make the local time nonexistent or ambiguous.
+    const date::days margin{2};
+    auto candidate = date::sys_time<CT>{tp.time_since_epoch() - offset_};
+    if (begin_ + margin <= candidate && candidate < end_ - margin)
+    {
+        out = candidate;
+        return true;
+    }
+    auto info = zone_->get_info(tp);
+    if (info.result != date::local_info::unique)
+    {
+        return false;
+    }
+    reset(info.first);
+    out = date::sys_time<CT>{tp.time_since_epoch() - offset_};
+    return true;
 }
 
-template <class Duration>
+
+// literals impl
+
+inline namespace literals
+{
+
+CONSTCD11
 inline
-DateTime<Duration> operator+(const DateTime<Duration>& x, const TimeDelta& y)
+date::days operator "" _days(unsigned long long n) NOEXCEPT
 {
-    // TODO make this work for non default Duration
-    using namespace std::chrono;
-    auto add = x.zoned_time().get_sys_time() + seconds(y.total_seconds()) + microseconds(y.microseconds());
-    return { date::make_zoned(x.zoned_time().get_time_zone(), add) };
+    return date::days(static_cast<date::days::rep>(n));
 }
 
-template <class Duration>
+CONSTCD11
 inline
-DateTime<Duration> operator+(const TimeDelta& y, const DateTime<Duration>& x)
+std::chrono::hours operator "" _h(unsigned long long n) NOEXCEPT
 {
-    return x + y;
+    return std::chrono::hours(static_cast<std::chrono::hours::rep>(n));
 }
 
-template <class Duration>
+CONSTCD11
 inline
-DateTime<Duration> operator-(const DateTime<Duration>&  x, const TimeDelta& y)
+std::chrono::minutes operator "" _min(unsigned long long n) NOEXCEPT
 {
-    using namespace std::chrono;
-    auto diff = x.zoned_time().get_sys_time() - seconds(y.total_seconds()) - microseconds(y.microseconds());
-    return { date::make_zoned(x.zoned_time().get_time_zone(), diff) };
+    return std::chrono::minutes(static_cast<std::chrono::minutes::rep>(n));
 }
 
-template <class Duration>
+CONSTCD11
 inline
-TimeDelta operator-(const DateTime<Duration>&  x, const DateTime<Duration>& y)
+std::chrono::seconds operator "" _s(unsigned long long n) NOEXCEPT
 {
-    return { x.zoned_time().get_sys_time() - y.zoned_time().get_sys_time() };
+    return std::chrono::seconds(static_cast<std::chrono::seconds::rep>(n));
 }
 
-template <class Duration>
+CONSTCD11
 inline
-bool operator<(const DateTime<Duration>&  x, const DateTime<Duration>& y) 
+std::chrono::milliseconds operator "" _ms(unsigned long long n) NOEXCEPT
 {
-    return x.zoned_time().get_sys_time() < y.zoned_time().get_sys_time();
+    return std::chrono::milliseconds(static_cast<std::chrono::milliseconds::rep>(n));
 }
 
-template<class CharT, class Traits, class Duration>
+CONSTCD11
 inline
-std::basic_ostream<CharT, Traits>&
-operator<<(std::basic_ostream<CharT, Traits>& os, const DateTime<Duration>& date)
+std::chrono::microseconds operator "" _us(unsigned long long n) NOEXCEPT
 {
-    return os << date.zoned_time();
+    return std::chrono::microseconds(static_cast<std::chrono::microseconds::rep>(n));
 }
 
+} // inline namespace literals
 
-// Time impl
 
-template <class Duration>
-inline
-Time::Time(const Duration& dur) 
-    : time_of_day_(
-        date::make_time(std::chrono::duration_cast<std::chrono::system_clock::duration>(dur))
-    )
-    {}
+// format_to impl
 
+namespace detail
+{
 
-template<class Duration, class ... Durations>
-inline
-Time::Time(const Duration& d, const Durations& ... durations)
-    : time_of_day_(
-        date::make_time(std::chrono::duration_cast<std::chrono::system_clock::duration>(add_durations(d, durations...)))
-    )
-    {}
+// output iterator keeping what fits in [p, last) and counting everything
+class truncating_iterator
+{
+    char*       p_;
+    char*       last_;
+    std::size_t size_ = 0;
+
+public:
+    using iterator_category = std::output_iterator_tag;
+    using value_type        = void;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = void;
+    using reference         = void;
 
+    truncating_iterator(char* first, char* last) : p_(first), last_(last) {}
 
-template<class Duration>
+    char* base() const { return p_; }
+    std::size_t size() const { return size_; }
+
+    truncating_iterator& operator=(char c)
+    {
+        if (p_ != last_)
+        {
+            *p_++ = c;
+        }
+        ++size_;
+        return *this;
+    }
+
+    truncating_iterator& operator*() { return *this; }
+    truncating_iterator& operator++() { return *this; }
+    truncating_iterator& operator++(int) { return *this; }
+};
+
+template <class OutputIt>
 inline
-Duration Time::add_durations(const Duration& d)
+OutputIt copy_chars(const char* first, const char* last, OutputIt out)
 {
-    return d;
+    for (; first != last; ++first)
+    {
+        *out++ = *first;
+    }
+    return out;
 }
 
-template<class Duration, class ... Durations>
+} // namespace detail
+
+template <class OutputIt, class Duration>
 inline
-auto Time::add_durations(const Duration& d, const Durations& ... durations)
--> typename std::common_type<Duration, Durations...>::type
+OutputIt format_to(OutputIt out, const BasicTimeDelta<Duration>& x)
 {
-    return d + add_durations(durations...);
+    // "<days> days, HH:MM:SS.ffffff", as operator<<, with the decimals of Duration
+    char buf[64];
+    char* p = buf;
+    auto d = x.days();
+    if (d < 0)
+    {
+        *p++ = '-';
+    }
+    p = detail::write_uint(p, buf + sizeof(buf), d < 0 ? 0 - static_cast<std::uint64_t>(d) : static_cast<std::uint64_t>(d));
+    static const char days[] = " days, ";
+    p = std::copy(days, days + sizeof(days) - 1, p);
+    auto s = static_cast<std::uint64_t>(x.seconds());
+    p = detail::write_uint(p, buf + sizeof(buf), s / 3600, 2);
+    *p++ = ':';
+    p = detail::write_uint(p, buf + sizeof(buf), s / 60 % 60, 2);
+    *p++ = ':';
+    p = detail::write_uint(p, buf + sizeof(buf), s % 60, 2);
+    const unsigned digits = detail::decimals<typename Duration::period>();
+    if (digits > 0)
+    {
+        std::int64_t sec, ns;
+        detail::split_seconds(x, sec, ns);
+        for (unsigned i = digits; i < 9; ++i)
+        {
+            ns /= 10;
+        }
+        *p++ = '.';
+        p = detail::write_uint(p, buf + sizeof(buf), static_cast<std::uint64_t>(ns), digits);
+    }
+    return detail::copy_chars(buf, p, out);
 }
 
-
+template <class OutputIt>
 inline
-const date::time_of_day<std::chrono::system_clock::duration>& Time::time_of_day() const
+OutputIt format_to(OutputIt out, const Date& x)
 {
-    return time_of_day_;
+    static const Format format("%F");
+    return format_to(out, x, format);
 }
 
-
+template <class OutputIt>
 inline
-std::chrono::hours::rep Time::hour() const
+OutputIt format_to(OutputIt out, const Date& x, const Format& format)
 {
-    return time_of_day().hours().count();
+    return format.format_to(out, date::local_days(x.year_month_day()));
 }
 
+template <class OutputIt, class Duration>
 inline
-std::chrono::minutes::rep Time::minute() const
+OutputIt format_to(OutputIt out, const DateTime<Duration>& x)
 {
-    return time_of_day().minutes().count();
+    static const Format format("%F %T %Z");
+    return format_to(out, x, format);
 }
 
+template <class OutputIt, class Duration>
 inline
-std::chrono::seconds::rep Time::seconds() const
+OutputIt format_to(OutputIt out, const DateTime<Duration>& x, const Format& format)
 {
-    return time_of_day().seconds().count();
+    auto info = x.zoned_time().get_info();
+    return format.format_to(out, x.zoned_time().get_local_time(), &info.abbrev, &info.offset);
 }
 
+template <class OutputIt>
+inline
+OutputIt format_to(OutputIt out, const Time& x)
+{
+    static const Format format("%T");
+    return format_to(out, x, format);
+}
 
+template <class OutputIt>
 inline
-std::string Time::isoformat() const
+OutputIt format_to(OutputIt out, const Time& x, const Format& format)
 {
-    return strftime("%H:%M:%S");
+    // as Time::strftime
+    const auto t = date::local_days(date::year{1900}/1/1) +
+                   date::floor<std::chrono::microseconds>(x.time_of_day().to_duration());
+    if (x.microsecond() == 0)
+    {
+        return format.format_to(out, date::floor<std::chrono::seconds>(t));
+    }
+    return format.format_to(out, t);
 }
 
+template <class T>
 inline
-std::string Time::strftime(const std::string& format) const
+format_to_n_result format_to_n(char* out, std::size_t n, const T& x)
 {
-    std::tm tm;
-    tm.tm_sec = static_cast<int>(seconds());
-    tm.tm_min = static_cast<int>(minute());
-    tm.tm_hour = static_cast<int>(hour());
-    // no milli nor microseconds :(
-    std::stringstream buffer;
-    buffer << std::put_time(&tm, format.c_str());
-    return buffer.str();
+    auto it = format_to(detail::truncating_iterator(out, out + n), x);
+    return { it.base(), it.size() };
 }
 
-template<class CharT, class Traits>
-std::basic_ostream<CharT, Traits>&
-operator<<(std::basic_ostream<CharT, Traits>& os, const Time& time)
+template <class T>
+inline
+format_to_n_result format_to_n(char* out, std::size_t n, const T& x, const Format& format)
 {
-    return os << time.time_of_day();
+    auto it = format_to(detail::truncating_iterator(out, out + n), x, format);
+    return { it.base(), it.size() };
 }
 
 
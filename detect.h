@@ -0,0 +1,394 @@
+#ifndef DATETIME_DETECT_H
+#define DATETIME_DETECT_H
+
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Florian Dang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "datetime.h"
+#include "bulk.h"
+#include "httpdate.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace datetime
+{
+class DetectedFormat;
+
+// Tries the ISO 8601 variants, month first (US) and day first (EU) dates,
+// epoch seconds, milliseconds, microseconds or nanoseconds and RFC 2822 on the
+// first sample non-empty strings. A date valid both ways (days up to 12) is
+// taken month first. Epochs are unsigned and told apart by their number of
+// digits before the point: 9 or 10 for seconds (1973 to 2286), 12 or 13 for
+// milliseconds, 15 or 16 for microseconds and 18 or 19 for nanoseconds.
+template <class String>
+DetectedFormat detect_format(const String* strings, std::size_t n, std::size_t sample = 1000);
+
+
+// DetectedFormat
+// Timestamp format of a column inferred from a sample of its strings (see
+// detect_format). Rows are parsed with the best candidate only, and with the
+// other candidates which matched part of the sample when it fails, so that a
+// few rows written differently are still understood. Rows are never read as
+// epochs nor with day and month the other way round unless the best candidate
+// does: they would give other dates, and fail instead.
+class DetectedFormat
+{
+public:
+    enum class Kind
+    {
+        none,       // nothing matched the sample
+        format,     // a strftime format, see str()
+        epoch_seconds, epoch_milliseconds, epoch_microseconds, epoch_nanoseconds,
+        rfc2822
+    };
+
+    DetectedFormat() = default;
+
+    Kind kind() const { return candidates_.empty() ? Kind::none : candidates_.front().kind; }
+    bool ok() const { return !candidates_.empty(); }
+
+    // the strftime format, or a name for the other kinds ("epoch seconds", "RFC 2822")
+    std::string str() const;
+
+    // fraction of the sample parsed by the best candidate
+    double confidence() const { return confidence_; }
+
+    // The whole of [first, last) as a local time of cache.zone() unless the
+    // text has an offset. Returns false on failure, never throws.
+    template <class Duration>
+    bool parse(const char* first, const char* last, ZoneCache& cache, date::sys_time<Duration>& out) const;
+
+private:
+    struct Candidate
+    {
+        Kind kind;
+        Format format;
+        std::size_t matches;
+        int order;          // 1 month then day, -1 day then month, 0 neither
+    };
+
+    std::vector<Candidate> candidates_; // best first
+    double confidence_ = 0;
+    int order_ = 0;                     // that of the best candidate with one
+
+    template <class String>
+    friend DetectedFormat detect_format(const String* strings, std::size_t n, std::size_t sample);
+
+    template <class Duration>
+    static bool parse(const Candidate& c, const char* first, const char* last, ZoneCache& cache,
+                      date::sys_time<Duration>& out);
+};
+
+// Same contract as strptime_column, with a detected format.
+template <class String, class Duration>
+std::size_t parse_column(const String* strings, std::size_t n, const DetectedFormat& format,
+                         const date::time_zone* zone,
+                         date::sys_time<Duration>* out, bool* errors);
+
+template <class String, class Duration>
+std::size_t parse_column(const String* strings, std::size_t n, const DetectedFormat& format,
+                         const date::time_zone* zone,
+                         date::sys_time<Duration>* out, bool* errors, ThreadPool& pool);
+
+
+// DetectedFormat impl
+
+inline
+std::string DetectedFormat::str() const
+{
+    switch (kind())
+    {
+    case Kind::none:                return "";
+    case Kind::format:              return candidates_.front().format.str();
+    case Kind::epoch_seconds:       return "epoch seconds";
+    case Kind::epoch_milliseconds:  return "epoch milliseconds";
+    case Kind::epoch_microseconds:  return "epoch microseconds";
+    case Kind::epoch_nanoseconds:   return "epoch nanoseconds";
+    case Kind::rfc2822:             return "RFC 2822";
+    }
+    return "";
+}
+
+template <class Duration>
+inline
+bool DetectedFormat::parse(const Candidate& c, const char* first, const char* last, ZoneCache& cache,
+                           date::sys_time<Duration>& out)
+{
+    using namespace std::chrono;
+    using CT = typename std::common_type<Duration, seconds>::type;
+    switch (c.kind)
+    {
+    case Kind::none:
+        return false;
+    case Kind::format:
+    {
+        date::local_time<CT> lt;
+        minutes offset{0};
+        if (c.format.parse(first, last, lt, &offset) != last)
+        {
+            return false;
+        }
+        date::sys_time<CT> st;
+        if (c.format.has_offset())
+        {
+            st = date::sys_time<CT>{lt.time_since_epoch() - offset};
+        }
+        else if (!cache.to_sys(lt, st))
+        {
+            return false;
+        }
+        out = date::floor<Duration>(st);
+        return true;
+    }
+    case Kind::epoch_seconds:
+    case Kind::epoch_milliseconds:
+    case Kind::epoch_microseconds:
+    case Kind::epoch_nanoseconds:
+    {
+        static const std::int64_t units[] = {1000000000, 1000000, 1000, 1};
+        std::int64_t seconds = 0, ns = 0;
+        bool out_of_range;
+        return detail::read_epoch(first, last, units[static_cast<int>(c.kind) - static_cast<int>(Kind::epoch_seconds)],
+                                  seconds, ns, out_of_range) == last &&
+               !out_of_range && detail::make_sys_time(seconds, ns, out);
+    }
+    case Kind::rfc2822:
+    {
+        date::sys_seconds st;
+        if (parse_rfc2822(first, last, st) != last)
+        {
+            return false;
+        }
+        out = date::floor<Duration>(st);
+        return true;
+    }
+    }
+    return false;
+}
+
+template <class Duration>
+inline
+bool DetectedFormat::parse(const char* first, const char* last, ZoneCache& cache,
+                           date::sys_time<Duration>& out) const
+{
+    for (std::size_t i = 0; i < candidates_.size(); ++i)
+    {
+        const Candidate& c = candidates_[i];
+        const bool epoch = c.kind >= Kind::epoch_seconds && c.kind <= Kind::epoch_nanoseconds;
+        if (i != 0 && (epoch || (c.order != 0 && c.order != order_)))
+        {
+            continue;
+        }
+        if (parse(c, first, last, cache, out))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+namespace detail
+{
+
+inline
+int day_order(const std::string& format)
+{
+    if (format.compare(0, 2, "%m") == 0 && format.find("%d") != std::string::npos)
+    {
+        return 1;
+    }
+    if (format.compare(0, 2, "%d") == 0 && format.find("%m") != std::string::npos)
+    {
+        return -1;
+    }
+    return 0;
+}
+
+} // namespace detail
+
+template <class String>
+inline
+DetectedFormat detect_format(const String* strings, std::size_t n, std::size_t sample)
+{
+    using Kind = DetectedFormat::Kind;
+    static const char* const formats[] =
+    {
+        // ISO 8601, %S takes a fraction and %z an offset with or without colon
+        "%Y-%m-%dT%H:%M:%S%z", "%Y-%m-%dT%H:%M:%SZ", "%Y-%m-%dT%H:%M:%S", "%Y-%m-%dT%H:%M",
+        "%Y-%m-%d %H:%M:%S%z", "%Y-%m-%d %H:%M:%S %z", "%Y-%m-%d %H:%M:%S", "%Y-%m-%d %H:%M",
+        "%Y-%m-%d", "%Y%m%dT%H%M%S%z", "%Y%m%dT%H%M%SZ", "%Y%m%dT%H%M%S", "%Y%m%d",
+        "%Y/%m/%d %H:%M:%S", "%Y/%m/%d",
+        // month first
+        "%m/%d/%Y %H:%M:%S", "%m/%d/%Y %H:%M", "%m/%d/%Y %I:%M:%S %p", "%m/%d/%Y %I:%M %p",
+        "%m/%d/%Y", "%m/%d/%y %H:%M", "%m/%d/%y",
+        // day first
+        "%d/%m/%Y %H:%M:%S", "%d/%m/%Y %H:%M", "%d/%m/%Y", "%d/%m/%y %H:%M", "%d/%m/%y",
+        "%d.%m.%Y %H:%M:%S", "%d.%m.%Y %H:%M", "%d.%m.%Y", "%d-%m-%Y %H:%M:%S", "%d-%m-%Y",
+        // names
+        "%d %b %Y %H:%M:%S", "%d %b %Y", "%b %d %Y %H:%M:%S", "%b %d, %Y", "%a %b %d %H:%M:%S %Y"
+    };
+
+    std::vector<DetectedFormat::Candidate> candidates;
+    for (auto f : formats)
+    {
+        candidates.push_back(DetectedFormat::Candidate{Kind::format, Format(f), 0, detail::day_order(f)});
+    }
+    const Kind others[] = {Kind::rfc2822, Kind::epoch_seconds, Kind::epoch_milliseconds,
+                           Kind::epoch_microseconds, Kind::epoch_nanoseconds};
+    for (auto k : others)
+    {
+        candidates.push_back(DetectedFormat::Candidate{k, Format(""), 0, 0});
+    }
+
+    ZoneCache utc(nullptr);
+    std::size_t sampled = 0;
+    for (std::size_t i = 0; i < n && sampled < sample; ++i)
+    {
+        const char* first = strings[i].data();
+        const char* last = first + strings[i].size();
+        if (first == last)
+        {
+            continue;
+        }
+        ++sampled;
+        std::int64_t seconds, ns;
+        bool out_of_range;
+        for (auto& c : candidates)
+        {
+            if (c.kind >= Kind::epoch_seconds && c.kind <= Kind::epoch_nanoseconds)
+            {
+                // the unit is told by the magnitude, dates from 1973 to 2286
+                if (*first != '-' && detail::read_epoch(first, last, 1, seconds, ns, out_of_range) == last &&
+                    !out_of_range)
+                {
+                    const char* q = first;
+                    while (q != last && '0' <= *q && *q <= '9')
+                    {
+                        ++q;
+                    }
+                    const auto digits = q - first;
+                    const int unit = static_cast<int>(c.kind) - static_cast<int>(Kind::epoch_seconds);
+                    if (digits >= 9 + 3 * unit && digits <= 10 + 3 * unit)
+                    {
+                        ++c.matches;
+                    }
+                }
+                continue;
+            }
+            date::sys_time<std::chrono::nanoseconds> tp;
+            if (DetectedFormat::parse(c, first, last, utc, tp))
+            {
+                ++c.matches;
+            }
+        }
+    }
+
+    DetectedFormat result;
+    for (auto& c : candidates)
+    {
+        if (c.matches > 0)
+        {
+            result.candidates_.push_back(std::move(c));
+        }
+    }
+    std::stable_sort(result.candidates_.begin(), result.candidates_.end(),
+        [](const DetectedFormat::Candidate& x, const DetectedFormat::Candidate& y) { return x.matches > y.matches; });
+    if (!result.candidates_.empty())
+    {
+        result.confidence_ = static_cast<double>(result.candidates_.front().matches) / sampled;
+    }
+    for (const auto& c : result.candidates_)
+    {
+        if (c.order != 0)
+        {
+            result.order_ = c.order;
+            break;
+        }
+    }
+    return result;
+}
+
+
+// parse_column impl
+
+namespace detail
+{
+
+template <class String, class Duration>
+inline
+std::size_t parse_rows(const String* strings, std::size_t begin, std::size_t end,
+                       const DetectedFormat& format, ZoneCache& cache,
+                       date::sys_time<Duration>* out, bool* errors)
+{
+    std::size_t failed = 0;
+    for (std::size_t i = begin; i < end; ++i)
+    {
+        const char* first = strings[i].data();
+        bool ok = format.parse(first, first + strings[i].size(), cache, out[i]);
+        if (!ok)
+        {
+            out[i] = date::sys_time<Duration>{};
+        }
+        errors[i] = !ok;
+        failed += !ok;
+    }
+    return failed;
+}
+
+} // namespace detail
+
+template <class String, class Duration>
+inline
+std::size_t parse_column(const String* strings, std::size_t n, const DetectedFormat& format,
+                         const date::time_zone* zone,
+                         date::sys_time<Duration>* out, bool* errors)
+{
+    ZoneCache cache(zone);
+    return detail::parse_rows(strings, 0, n, format, cache, out, errors);
+}
+
+template <class String, class Duration>
+inline
+std::size_t parse_column(const String* strings, std::size_t n, const DetectedFormat& format,
+                         const date::time_zone* zone,
+                         date::sys_time<Duration>* out, bool* errors, ThreadPool& pool)
+{
+    std::vector<ZoneCache> caches(pool.size(), ZoneCache(zone));
+    std::vector<std::size_t> failed(pool.size(), 0);
+    pool.parallel_for(n, 4096, [&](unsigned worker, std::size_t begin, std::size_t end) {
+        failed[worker] += detail::parse_rows(strings, begin, end, format, caches[worker], out, errors);
+    });
+    std::size_t total = 0;
+    for (auto f : failed)
+    {
+        total += f;
+    }
+    return total;
+}
+
+} // namespace datetime
+
+#endif // DATETIME_DETECT_H
@@ -27,7 +27,7 @@ int main()
     cout << "datetime from strptime is " << x4 << endl;
 
     auto x5 = DateTime<>::utcfromtimestamp(1497252490.0282006);
-    std::cout << "UTC datetime from timestamp is " << x5 << ". Get timestamp back: " << x5.timestamp() << std::endl;
+    std::cout << "UTC datetime from timestamp is " << x5 << ". Get timestamp back: " << std::fixed << x5.timestamp() << std::endl;
 
     std::cout << "You can substract two datetimes into a timedelta " << x5 - x4 << std::endl;
 }
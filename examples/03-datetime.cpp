@@ -22,7 +22,7 @@ int main()
     auto x3 = DateTime<>::fromtimestamp(1497252490.0282006);
     std::cout << "fromtimestamp(1497252490.0282006) = " << x3 << std::endl;
     std::cout << "fromtimestamp(1497252490.0282006).tzinfo() = " << x3.tzinfo() << std::endl;
-    std::cout << "fromtimestamp(1497252490.0282006).timestamp() = " << x3.timestamp() << std::endl;
+    std::cout << "fromtimestamp(1497252490.0282006).timestamp() = " << std::fixed << x3.timestamp() << std::endl;
 
     auto x4 = DateTime<>::utcfromtimestamp(1497252490.0282006);
     std::cout << "utcfromtimestamp(1497252490.0282006) = " << x4 << std::endl;
@@ -0,0 +1,444 @@
+#ifndef DATETIME_HTTPDATE_H
+#define DATETIME_HTTPDATE_H
+
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Florian Dang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "datetime.h"
+#include "timecache.h"
+
+#include <chrono>
+#include <cstdint>
+
+namespace datetime
+{
+// HTTP dates (RFC 7231 section 7.1.1.1) and Internet Message Format dates
+// (RFC 2822 section 3.3), written into fixed-length buffers without streams
+// and parsed without exceptions. Names are the fixed English ones.
+
+// "Sun, 06 Nov 1994 08:49:37 GMT"
+const std::size_t http_date_length = 29;
+// "Sun, 06 Nov 1994 08:49:37 +0100"
+const std::size_t rfc2822_length = 31;
+
+// Writes the IMF-fixdate form. Returns the end of the text, or nullptr if
+// [first, last) is too small or the year is outside [0, 9999].
+template <class Duration>
+char* http_date_to_chars(char* first, char* last, const date::sys_time<Duration>& tp);
+
+// Writes the RFC 2822 form of tp seen with the given UTC offset.
+template <class Duration>
+char* rfc2822_to_chars(char* first, char* last, const date::sys_time<Duration>& tp,
+                       std::chrono::minutes offset = std::chrono::minutes(0));
+
+template <class Duration>
+char* rfc2822_to_chars(char* first, char* last, const DateTime<Duration>& dt);
+
+// Parses an IMF-fixdate, RFC 850 or asctime date as HTTP recipients must.
+// Returns the end of the parsed text or nullptr on failure, never throws.
+const char* parse_http_date(const char* first, const char* last, date::sys_seconds& tp);
+
+// Parses an RFC 2822 date, including the obsolete 2 digit years and zone names.
+// *offset (if not nullptr) receives the UTC offset written in the text.
+const char* parse_rfc2822(const char* first, const char* last, date::sys_seconds& tp,
+                          std::chrono::minutes* offset = nullptr);
+
+
+// HttpDateCache
+// Current HTTP date for Date: headers, rendered once per second (see TimeCache).
+class HttpDateCache
+{
+public:
+    HttpDateCache();
+
+    // buf must hold at least http_date_length chars
+    std::size_t copy(char* buf) const { return cache_.copy(id_, buf); }
+    std::string str() const { return cache_.str(id_); }
+
+private:
+    TimeCache cache_;
+    std::size_t id_;
+};
+
+
+// HTTP date impl
+
+namespace detail
+{
+
+inline
+void write_2digits(char* p, unsigned v)
+{
+    p[0] = static_cast<char>('0' + v / 10);
+    p[1] = static_cast<char>('0' + v % 10);
+}
+
+// "Sun, 06 Nov 1994 08:49:37 " common to both forms, false if the year does not fit
+inline
+bool write_rfc1123_prefix(char* p, date::sys_seconds tp)
+{
+    auto dp = date::floor<date::days>(tp);
+    date::year_month_day ymd{dp};
+    int y = static_cast<int>(ymd.year());
+    if (y < 0 || y > 9999)
+    {
+        return false;
+    }
+    auto s = static_cast<unsigned>((tp - dp).count());
+    const char* wd = date::detail::weekday_names()[static_cast<unsigned>(date::weekday{dp}) + 7];
+    const char* mon = date::detail::month_names()[static_cast<unsigned>(ymd.month()) + 11];
+    p[0] = wd[0]; p[1] = wd[1]; p[2] = wd[2]; p[3] = ','; p[4] = ' ';
+    write_2digits(p + 5, static_cast<unsigned>(ymd.day()));
+    p[7] = ' ';
+    p[8] = mon[0]; p[9] = mon[1]; p[10] = mon[2]; p[11] = ' ';
+    write_2digits(p + 12, static_cast<unsigned>(y) / 100);
+    write_2digits(p + 14, static_cast<unsigned>(y) % 100);
+    p[16] = ' ';
+    write_2digits(p + 17, s / 3600);
+    p[19] = ':';
+    write_2digits(p + 20, s / 60 % 60);
+    p[22] = ':';
+    write_2digits(p + 23, s % 60);
+    p[25] = ' ';
+    return true;
+}
+
+// exactly n digits
+inline
+bool read_fixed(const char*& p, const char* last, unsigned n, int& x)
+{
+    if (static_cast<unsigned>(last - p) < n)
+    {
+        return false;
+    }
+    const char* q = p;
+    if (!read_digits(q, p + n, n, x) || q != p + n)
+    {
+        return false;
+    }
+    p = q;
+    return true;
+}
+
+inline
+bool read_char(const char*& p, const char* last, char c)
+{
+    if (p == last || *p != c)
+    {
+        return false;
+    }
+    ++p;
+    return true;
+}
+
+inline
+bool skip_spaces(const char*& p, const char* last)
+{
+    const char* q = p;
+    while (p != last && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n'))
+    {
+        ++p;
+    }
+    return p != q;
+}
+
+// "08:49:37", seconds optional if !need_seconds
+inline
+bool read_hms(const char*& p, const char* last, int& h, int& m, int& s, bool need_seconds)
+{
+    s = 0;
+    if (!read_fixed(p, last, 2, h) || !read_char(p, last, ':') || !read_fixed(p, last, 2, m))
+    {
+        return false;
+    }
+    if (p != last && *p == ':')
+    {
+        ++p;
+        return read_fixed(p, last, 2, s);
+    }
+    return !need_seconds;
+}
+
+// false if not a valid date and time (second 60 rolls over)
+inline
+bool make_sys_seconds(int y, int mon, int d, int h, int m, int s, int wd, date::sys_seconds& tp)
+{
+    auto ymd = date::year{y}/static_cast<unsigned>(mon)/static_cast<unsigned>(d);
+    if (!ymd.ok() || h > 23 || m > 59 || s > 60)
+    {
+        return false;
+    }
+    date::sys_days dp{ymd};
+    if (wd >= 0 && date::weekday{dp} != date::weekday{static_cast<unsigned>(wd)})
+    {
+        return false;
+    }
+    tp = dp + std::chrono::hours{h} + std::chrono::minutes{m} + std::chrono::seconds{s};
+    return true;
+}
+
+// RFC 7231: a 2 digit year more than 50 years in the future is in the past century
+inline
+int rfc850_year(int yy)
+{
+    auto today = date::year_month_day{date::floor<date::days>(std::chrono::system_clock::now())};
+    int current = static_cast<int>(today.year());
+    int y = current - current % 100 + yy;
+    return y > current + 50 ? y - 100 : y;
+}
+
+} // namespace detail
+
+template <class Duration>
+inline
+char* http_date_to_chars(char* first, char* last, const date::sys_time<Duration>& tp)
+{
+    if (static_cast<std::size_t>(last - first) < http_date_length ||
+        !detail::write_rfc1123_prefix(first, date::floor<std::chrono::seconds>(tp)))
+    {
+        return nullptr;
+    }
+    first[26] = 'G'; first[27] = 'M'; first[28] = 'T';
+    return first + http_date_length;
+}
+
+template <class Duration>
+inline
+char* rfc2822_to_chars(char* first, char* last, const date::sys_time<Duration>& tp,
+                       std::chrono::minutes offset)
+{
+    auto m = offset.count();
+    if (static_cast<std::size_t>(last - first) < rfc2822_length || m <= -6000 || m >= 6000 ||
+        !detail::write_rfc1123_prefix(first, date::floor<std::chrono::seconds>(tp) + offset))
+    {
+        return nullptr;
+    }
+    first[26] = m < 0 ? '-' : '+';
+    m = m < 0 ? -m : m;
+    detail::write_2digits(first + 27, static_cast<unsigned>(m / 60));
+    detail::write_2digits(first + 29, static_cast<unsigned>(m % 60));
+    return first + rfc2822_length;
+}
+
+template <class Duration>
+inline
+char* rfc2822_to_chars(char* first, char* last, const DateTime<Duration>& dt)
+{
+    auto info = dt.zoned_time().get_info();
+    return rfc2822_to_chars(first, last, dt.zoned_time().get_sys_time(),
+                            std::chrono::duration_cast<std::chrono::minutes>(info.offset));
+}
+
+inline
+const char* parse_http_date(const char* first, const char* last, date::sys_seconds& tp)
+{
+    const char* p = first;
+    int wd = detail::read_name(p, last, date::detail::weekday_names(), 14);
+    if (wd < 0)
+    {
+        return nullptr;
+    }
+    int y = 0, mon = 0, d = 0, h = 0, m = 0, s = 0;
+    if (p != last && *p == ',')
+    {
+        ++p;
+        if (!detail::read_char(p, last, ' '))
+        {
+            return nullptr;
+        }
+        if (wd >= 7)
+        {
+            // IMF-fixdate: Sun, 06 Nov 1994 08:49:37 GMT
+            if (!detail::read_fixed(p, last, 2, d) || !detail::read_char(p, last, ' '))
+            {
+                return nullptr;
+            }
+            mon = detail::read_name(p, last, date::detail::month_names() + 12, 12);
+            if (mon < 0 || !detail::read_char(p, last, ' ') ||
+                !detail::read_fixed(p, last, 4, y) || !detail::read_char(p, last, ' '))
+            {
+                return nullptr;
+            }
+        }
+        else
+        {
+            // RFC 850: Sunday, 06-Nov-94 08:49:37 GMT
+            if (!detail::read_fixed(p, last, 2, d) || !detail::read_char(p, last, '-'))
+            {
+                return nullptr;
+            }
+            mon = detail::read_name(p, last, date::detail::month_names() + 12, 12);
+            if (mon < 0 || !detail::read_char(p, last, '-') ||
+                !detail::read_fixed(p, last, 2, y) || !detail::read_char(p, last, ' '))
+            {
+                return nullptr;
+            }
+            y = detail::rfc850_year(y);
+        }
+        if (!detail::read_hms(p, last, h, m, s, true) || last - p < 4 ||
+            p[0] != ' ' || p[1] != 'G' || p[2] != 'M' || p[3] != 'T')
+        {
+            return nullptr;
+        }
+        p += 4;
+    }
+    else
+    {
+        // asctime: Sun Nov  6 08:49:37 1994
+        if (wd < 7 || !detail::read_char(p, last, ' '))
+        {
+            return nullptr;
+        }
+        mon = detail::read_name(p, last, date::detail::month_names() + 12, 12);
+        if (mon < 0 || !detail::read_char(p, last, ' '))
+        {
+            return nullptr;
+        }
+        if (p != last && *p == ' ')
+        {
+            ++p;
+            if (!detail::read_fixed(p, last, 1, d))
+            {
+                return nullptr;
+            }
+        }
+        else if (!detail::read_fixed(p, last, 2, d))
+        {
+            return nullptr;
+        }
+        if (!detail::read_char(p, last, ' ') || !detail::read_hms(p, last, h, m, s, true) ||
+            !detail::read_char(p, last, ' ') || !detail::read_fixed(p, last, 4, y))
+        {
+            return nullptr;
+        }
+    }
+    if (!detail::make_sys_seconds(y, mon + 1, d, h, m, s, wd % 7, tp))
+    {
+        return nullptr;
+    }
+    return p;
+}
+
+inline
+const char* parse_rfc2822(const char* first, const char* last, date::sys_seconds& tp,
+                          std::chrono::minutes* offset)
+{
+    const char* p = first;
+    detail::skip_spaces(p, last);
+    int wd = -1;
+    if (p != last && !('0' <= *p && *p <= '9'))
+    {
+        wd = detail::read_name(p, last, date::detail::weekday_names() + 7, 7);
+        detail::skip_spaces(p, last);
+        if (wd < 0 || !detail::read_char(p, last, ','))
+        {
+            return nullptr;
+        }
+        detail::skip_spaces(p, last);
+    }
+
+    int d = 0, y = 0, h = 0, m = 0, s = 0;
+    if (!detail::read_digits(p, last, 2, d) || !detail::skip_spaces(p, last))
+    {
+        return nullptr;
+    }
+    int mon = detail::read_name(p, last, date::detail::month_names() + 12, 12);
+    if (mon < 0 || !detail::skip_spaces(p, last))
+    {
+        return nullptr;
+    }
+    const char* q = p;
+    if (!detail::read_digits(p, last, 4, y) || p - q == 1)
+    {
+        return nullptr;
+    }
+    if (p - q < 4)
+    {
+        // obsolete 2 and 3 digit years (RFC 2822 section 4.3)
+        y += p - q == 2 && y < 50 ? 2000 : 1900;
+    }
+    if (!detail::skip_spaces(p, last))
+    {
+        return nullptr;
+    }
+    if (!detail::read_hms(p, last, h, m, s, false) || !detail::skip_spaces(p, last))
+    {
+        return nullptr;
+    }
+
+    int off = 0;
+    if (p != last && (*p == '+' || *p == '-'))
+    {
+        bool neg = *p++ == '-';
+        int hh = 0, mm = 0;
+        if (!detail::read_fixed(p, last, 2, hh) || !detail::read_fixed(p, last, 2, mm) || mm > 59)
+        {
+            return nullptr;
+        }
+        off = neg ? -(60 * hh + mm) : 60 * hh + mm;
+    }
+    else
+    {
+        // obsolete zone names, military zones are taken as +0000
+        static const char* const zones[] = {"UT", "GMT", "EST", "EDT", "CST", "CDT", "MST", "MDT", "PST", "PDT"};
+        static const int offsets[] = {0, 0, -5, -4, -6, -5, -7, -6, -8, -7};
+        int i = detail::read_name(p, last, zones, 10);
+        if (i >= 0)
+        {
+            off = 60 * offsets[i];
+        }
+        else if (p != last && std::isalpha(static_cast<unsigned char>(*p)) &&
+                 (p + 1 == last || !std::isalpha(static_cast<unsigned char>(p[1]))))
+        {
+            ++p;
+        }
+        else
+        {
+            return nullptr;
+        }
+    }
+
+    date::sys_seconds local;
+    if (!detail::make_sys_seconds(y, mon + 1, d, h, m, s, wd, local))
+    {
+        return nullptr;
+    }
+    tp = local - std::chrono::minutes{off};
+    if (offset != nullptr)
+    {
+        *offset = std::chrono::minutes{off};
+    }
+    return p;
+}
+
+
+// HttpDateCache impl
+
+inline
+HttpDateCache::HttpDateCache()
+    : cache_(nullptr)
+    , id_(cache_.add_format("%a, %d %b %Y %H:%M:%S GMT"))
+    {}
+
+} // namespace datetime
+
+#endif // DATETIME_HTTPDATE_H
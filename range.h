@@ -0,0 +1,596 @@
+#ifndef DATETIME_RANGE_H
+#define DATETIME_RANGE_H
+
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Florian Dang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "datetime.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <ratio>
+#include <stdexcept>
+
+namespace datetime
+{
+// DateRange
+// The dates from start to end, both included, every step days or months, as
+// pandas.date_range. Nothing is stored: size() and operator[] are O(1) from the
+// index, and iterators step the year, month and day themselves, going through
+// days since the epoch only when a day step leaves the month. Month steps keep
+// the day of start, clamped to the end of shorter months, and a start on the
+// last day of its month steps through month ends. Steps may be negative.
+class DateRange
+{
+public:
+    class iterator;
+
+    DateRange() = default;  // empty
+
+    // throw std::invalid_argument when step is zero
+    DateRange(const Date& start, const Date& end, date::days step);
+    DateRange(const Date& start, const Date& end, date::months step);
+
+    std::size_t size()  const { return size_; }
+    bool        empty() const { return size_ == 0; }
+
+    Date operator[](std::size_t i) const;
+    Date front() const { return (*this)[0]; }
+    Date back()  const { return (*this)[size_ - 1]; }
+
+    iterator begin() const;
+    iterator end()   const;
+
+    // elements [first, last) as a range of their own, e.g. for the chunks of
+    // ThreadPool::parallel_for; same steps, so month ends stay month ends
+    DateRange slice(std::size_t first, std::size_t last) const;
+
+private:
+    std::int32_t    serial_ = 0;        // of the start, days since 1970-01-01
+    std::int32_t    year_ = 1970;       // of the start
+    unsigned        month_ = 1;
+    unsigned        day_ = 1;
+    std::int32_t    step_ = 1;          // days or months
+    bool            months_ = false;
+    bool            month_end_ = false; // month steps from the last day of a month
+    std::int64_t    offset_ = 0;        // index of the first element from the start
+    std::size_t     size_ = 0;
+
+    void count(const Date& end);
+    void at(std::int64_t k, std::int32_t& y, unsigned& m, unsigned& d) const;
+};
+
+// Random access; ++ and -- are incremental, other moves go through the index.
+class DateRange::iterator
+{
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type        = Date;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = void;
+    using reference         = Date;
+
+    iterator() = default;
+
+    Date operator*() const { return Date(date::year(y_), date::month(m_), date::day(d_)); }
+    Date operator[](difference_type n) const { return *(*this + n); }
+
+    iterator& operator++();
+    iterator& operator--();
+    iterator  operator++(int) { iterator x = *this; ++*this; return x; }
+    iterator  operator--(int) { iterator x = *this; --*this; return x; }
+
+    iterator& operator+=(difference_type n) { set(k_ + n); return *this; }
+    iterator& operator-=(difference_type n) { set(k_ - n); return *this; }
+    iterator  operator+(difference_type n) const { iterator x = *this; return x += n; }
+    iterator  operator-(difference_type n) const { iterator x = *this; return x -= n; }
+    difference_type operator-(const iterator& x) const { return static_cast<difference_type>(k_ - x.k_); }
+
+    bool operator==(const iterator& x) const { return k_ == x.k_; }
+    bool operator!=(const iterator& x) const { return k_ != x.k_; }
+    bool operator<(const iterator& x)  const { return k_ < x.k_; }
+    bool operator<=(const iterator& x) const { return k_ <= x.k_; }
+    bool operator>(const iterator& x)  const { return k_ > x.k_; }
+    bool operator>=(const iterator& x) const { return k_ >= x.k_; }
+
+    friend iterator operator+(difference_type n, const iterator& x) { return x + n; }
+
+private:
+    friend class DateRange;
+
+    iterator(const DateRange& range, std::int64_t k) : range_(range) { set(k); }
+
+    void set(std::int64_t k);
+    void step(std::int32_t n);
+
+    DateRange       range_;
+    std::int64_t    k_ = 0;
+    std::int32_t    pos_ = 0;   // days since 1970-01-01, or months since year 0
+    std::int32_t    y_ = 0;
+    unsigned        m_ = 1;
+    unsigned        d_ = 1;
+};
+
+DateRange date_range(const Date& start, const Date& end, date::days step = date::days(1));
+DateRange date_range(const Date& start, const Date& end, date::months step);
+
+
+// DateTimeRange
+// The times of the zone of start from start to end, both included, every step.
+// A step of whole days (days, weeks) steps the local wall clock, as date
+// arithmetic on local_days: the same local time every day across offset
+// changes, a local time skipped by a transition mapping to the transition and
+// an ambiguous one to its earlier instant. Any other step is absolute, as
+// pandas with a fixed frequency. As DateRange, nothing is stored and size()
+// and operator[] are O(1); iterators add the step to the time point, and wall
+// clock steps convert through a ZoneCache, without a transition lookup away
+// from transitions.
+template <class Duration>
+class DateTimeRange
+{
+    using common_duration = typename std::common_type<Duration, std::chrono::seconds>::type;
+
+public:
+    class iterator;
+
+    DateTimeRange() = default;  // empty
+
+    // throw std::invalid_argument when step is zero
+    template <class Rep, class Period>
+    DateTimeRange(const DateTime<Duration>& start, const DateTime<Duration>& end,
+                  const std::chrono::duration<Rep, Period>& step);
+
+    std::size_t size()  const { return size_; }
+    bool        empty() const { return size_ == 0; }
+
+    DateTime<Duration> operator[](std::size_t i) const;
+    DateTime<Duration> front() const { return (*this)[0]; }
+    DateTime<Duration> back()  const { return (*this)[size_ - 1]; }
+
+    iterator begin() const;
+    iterator end()   const;
+
+    // elements [first, last) as a range of their own, e.g. for the chunks of
+    // ThreadPool::parallel_for
+    DateTimeRange slice(std::size_t first, std::size_t last) const;
+
+    const date::time_zone* time_zone() const { return zone_; }
+
+private:
+    const date::time_zone*              zone_ = nullptr;
+    date::sys_time<common_duration>     start_{};
+    date::local_time<common_duration>   local_{};   // of the start, for wall clock steps
+    common_duration                     step_{1};
+    bool                                wall_ = false;
+    std::int64_t                        offset_ = 0;
+    std::size_t                         size_ = 0;
+
+    date::sys_time<common_duration> at(std::int64_t k) const;
+    bool beyond(const date::sys_time<common_duration>& tp, const date::sys_time<common_duration>& end) const;
+};
+
+template <class Duration>
+class DateTimeRange<Duration>::iterator
+{
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type        = DateTime<Duration>;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = void;
+    using reference         = DateTime<Duration>;
+
+    iterator() = default;
+
+    DateTime<Duration> operator*() const
+    {
+        return { date::zoned_time<common_duration>(range_.zone_, sys_) };
+    }
+    DateTime<Duration> operator[](difference_type n) const { return *(*this + n); }
+
+    iterator& operator++() { return step(1); }
+    iterator& operator--() { return step(-1); }
+    iterator  operator++(int) { iterator x = *this; ++*this; return x; }
+    iterator  operator--(int) { iterator x = *this; --*this; return x; }
+
+    iterator& operator+=(difference_type n) { set(k_ + n); return *this; }
+    iterator& operator-=(difference_type n) { set(k_ - n); return *this; }
+    iterator  operator+(difference_type n) const { iterator x = *this; return x += n; }
+    iterator  operator-(difference_type n) const { iterator x = *this; return x -= n; }
+    difference_type operator-(const iterator& x) const { return static_cast<difference_type>(k_ - x.k_); }
+
+    bool operator==(const iterator& x) const { return k_ == x.k_; }
+    bool operator!=(const iterator& x) const { return k_ != x.k_; }
+    bool operator<(const iterator& x)  const { return k_ < x.k_; }
+    bool operator<=(const iterator& x) const { return k_ <= x.k_; }
+    bool operator>(const iterator& x)  const { return k_ > x.k_; }
+    bool operator>=(const iterator& x) const { return k_ >= x.k_; }
+
+    friend iterator operator+(difference_type n, const iterator& x) { return x + n; }
+
+private:
+    friend class DateTimeRange;
+
+    iterator(const DateTimeRange& range, std::int64_t k) : range_(range), cache_(range.zone_) { set(k); }
+
+    void set(std::int64_t k);
+    iterator& step(int n);
+
+    DateTimeRange                       range_;
+    ZoneCache                           cache_{nullptr};
+    std::int64_t                        k_ = 0;
+    date::sys_time<common_duration>     sys_{};
+    date::local_time<common_duration>   local_{};
+};
+
+// the precision of the result is the finer of those of start and step
+template <class Duration, class Rep, class Period>
+DateTimeRange<typename std::common_type<Duration, std::chrono::duration<Rep, Period>>::type>
+date_range(const DateTime<Duration>& start, const DateTime<Duration>& end, const std::chrono::duration<Rep, Period>& step);
+
+template <class Duration, class DeltaDuration>
+DateTimeRange<typename std::common_type<Duration, DeltaDuration>::type>
+date_range(const DateTime<Duration>& start, const DateTime<Duration>& end, const BasicTimeDelta<DeltaDuration>& step);
+
+
+// DateRange impl
+
+namespace detail
+{
+
+// the number of steps from first to last, floored: negative when last is before
+// first in the direction of step
+inline
+std::int64_t range_steps(std::int64_t first, std::int64_t last, std::int64_t step)
+{
+    return detail::floor_div(last - first, step);
+}
+
+} // namespace detail
+
+inline
+DateRange::DateRange(const Date& start, const Date& end, date::days step)
+    : serial_(SerialDate(start).serial()),
+      year_(static_cast<int>(start.year())),
+      month_(static_cast<unsigned>(start.month())),
+      day_(static_cast<unsigned>(start.day())),
+      step_(static_cast<std::int32_t>(step.count())),
+      months_(false),
+      month_end_(false),
+      offset_(0),
+      size_(0)
+{
+    if (step_ == 0)
+    {
+        throw std::invalid_argument("date_range: zero step");
+    }
+    count(end);
+}
+
+inline
+DateRange::DateRange(const Date& start, const Date& end, date::months step)
+    : serial_(SerialDate(start).serial()),
+      year_(static_cast<int>(start.year())),
+      month_(static_cast<unsigned>(start.month())),
+      day_(static_cast<unsigned>(start.day())),
+      step_(static_cast<std::int32_t>(step.count())),
+      months_(true),
+      month_end_(day_ == detail::days_in_month(year_, month_)),
+      offset_(0),
+      size_(0)
+{
+    if (step_ == 0)
+    {
+        throw std::invalid_argument("date_range: zero step");
+    }
+    count(end);
+}
+
+inline
+void DateRange::count(const Date& end)
+{
+    std::int64_t k;
+    if (!months_)
+    {
+        k = detail::range_steps(serial_, SerialDate(end).serial(), step_);
+    }
+    else
+    {
+        // the element of the month of end may still be after it
+        std::int64_t first = 12LL * year_ + month_ - 1;
+        std::int64_t last = 12LL * static_cast<int>(end.year()) + static_cast<unsigned>(end.month()) - 1;
+        k = detail::range_steps(first, last, step_);
+        if (k >= 0)
+        {
+            std::int32_t y;
+            unsigned m, d;
+            at(k, y, m, d);
+            auto serial = detail::day_from_civil(y, m, d);
+            if (step_ > 0 ? serial > SerialDate(end).serial() : serial < SerialDate(end).serial())
+            {
+                --k;
+            }
+        }
+    }
+    size_ = k < 0 ? 0 : static_cast<std::size_t>(k) + 1;
+}
+
+inline
+void DateRange::at(std::int64_t k, std::int32_t& y, unsigned& m, unsigned& d) const
+{
+    if (!months_)
+    {
+        unsigned char mm, dd;
+        detail::civil_from_day(static_cast<std::int32_t>(serial_ + k * step_), y, mm, dd);
+        m = mm;
+        d = dd;
+        return;
+    }
+    auto t = 12LL * year_ + month_ - 1 + k * step_;
+    y = static_cast<std::int32_t>(detail::floor_div(t, 12));
+    m = static_cast<unsigned>(detail::floor_mod(t, 12)) + 1;
+    auto last = detail::days_in_month(y, m);
+    d = month_end_ || day_ > last ? last : day_;
+}
+
+inline
+Date DateRange::operator[](std::size_t i) const
+{
+    std::int32_t y;
+    unsigned m, d;
+    at(offset_ + static_cast<std::int64_t>(i), y, m, d);
+    return Date(date::year(y), date::month(m), date::day(d));
+}
+
+inline
+DateRange::iterator DateRange::begin() const
+{
+    return iterator(*this, offset_);
+}
+
+inline
+DateRange::iterator DateRange::end() const
+{
+    return iterator(*this, offset_ + static_cast<std::int64_t>(size_));
+}
+
+inline
+DateRange DateRange::slice(std::size_t first, std::size_t last) const
+{
+    DateRange r = *this;
+    last = last < size_ ? last : size_;
+    first = first < last ? first : last;
+    r.offset_ = offset_ + static_cast<std::int64_t>(first);
+    r.size_ = last - first;
+    return r;
+}
+
+inline
+void DateRange::iterator::set(std::int64_t k)
+{
+    k_ = k;
+    range_.at(k, y_, m_, d_);
+    pos_ = range_.months_ ? static_cast<std::int32_t>(12LL * y_ + m_ - 1)
+                          : static_cast<std::int32_t>(range_.serial_ + k * range_.step_);
+}
+
+inline
+void DateRange::iterator::step(std::int32_t n)
+{
+    if (!range_.months_)
+    {
+        // within the month, only the day changes
+        pos_ += n;
+        auto d = static_cast<std::int32_t>(d_) + n;
+        if (d >= 1 && (d <= 28 || d <= static_cast<std::int32_t>(detail::days_in_month(y_, m_))))
+        {
+            d_ = static_cast<unsigned>(d);
+            return;
+        }
+        unsigned char mm, dd;
+        detail::civil_from_day(pos_, y_, mm, dd);
+        m_ = mm;
+        d_ = dd;
+        return;
+    }
+    pos_ += n;
+    y_ = static_cast<std::int32_t>(detail::floor_div(pos_, 12));
+    m_ = static_cast<unsigned>(detail::floor_mod(pos_, 12)) + 1;
+    auto last = detail::days_in_month(y_, m_);
+    d_ = range_.month_end_ || range_.day_ > last ? last : range_.day_;
+}
+
+inline
+DateRange::iterator& DateRange::iterator::operator++()
+{
+    ++k_;
+    step(range_.step_);
+    return *this;
+}
+
+inline
+DateRange::iterator& DateRange::iterator::operator--()
+{
+    --k_;
+    step(-range_.step_);
+    return *this;
+}
+
+inline
+DateRange date_range(const Date& start, const Date& end, date::days step)
+{
+    return DateRange(start, end, step);
+}
+
+inline
+DateRange date_range(const Date& start, const Date& end, date::months step)
+{
+    return DateRange(start, end, step);
+}
+
+
+// DateTimeRange impl
+
+template <class Duration>
+template <class Rep, class Period>
+inline
+DateTimeRange<Duration>::DateTimeRange(const DateTime<Duration>& start, const DateTime<Duration>& end,
+                                       const std::chrono::duration<Rep, Period>& step)
+    : zone_(start.zoned_time().get_time_zone()),
+      start_(start.zoned_time().get_sys_time()),
+      local_(start.zoned_time().get_local_time()),
+      step_(std::chrono::duration_cast<common_duration>(step)),
+      wall_(std::ratio_divide<Period, date::days::period>::den == 1),
+      offset_(0),
+      size_(0)
+{
+    if (step_ == common_duration::zero())
+    {
+        throw std::invalid_argument("date_range: zero step");
+    }
+    const auto last = end.zoned_time().get_sys_time();
+    std::int64_t k;
+    if (!wall_)
+    {
+        k = detail::range_steps(start_.time_since_epoch().count(), last.time_since_epoch().count(), step_.count());
+    }
+    else
+    {
+        // estimated on the local times, then moved by the few steps the
+        // offset changes between start and end may shift it by
+        const auto local_last = date::zoned_time<common_duration>(zone_, last).get_local_time();
+        k = detail::range_steps(local_.time_since_epoch().count(), local_last.time_since_epoch().count(),
+                                step_.count());
+        while (k >= -1 && !beyond(at(k + 1), last))
+        {
+            ++k;
+        }
+        while (k >= 0 && beyond(at(k), last))
+        {
+            --k;
+        }
+    }
+    size_ = k < 0 ? 0 : static_cast<std::size_t>(k) + 1;
+}
+
+template <class Duration>
+inline
+bool DateTimeRange<Duration>::beyond(const date::sys_time<common_duration>& tp,
+                                     const date::sys_time<common_duration>& end) const
+{
+    return step_ > common_duration::zero() ? tp > end : tp < end;
+}
+
+template <class Duration>
+inline
+date::sys_time<typename DateTimeRange<Duration>::common_duration> DateTimeRange<Duration>::at(std::int64_t k) const
+{
+    if (!wall_)
+    {
+        return start_ + k * step_;
+    }
+    return date::zoned_time<common_duration>(zone_, local_ + k * step_, date::choose::earliest).get_sys_time();
+}
+
+template <class Duration>
+inline
+DateTime<Duration> DateTimeRange<Duration>::operator[](std::size_t i) const
+{
+    return { date::zoned_time<common_duration>(zone_, at(offset_ + static_cast<std::int64_t>(i))) };
+}
+
+template <class Duration>
+inline
+typename DateTimeRange<Duration>::iterator DateTimeRange<Duration>::begin() const
+{
+    return iterator(*this, offset_);
+}
+
+template <class Duration>
+inline
+typename DateTimeRange<Duration>::iterator DateTimeRange<Duration>::end() const
+{
+    return iterator(*this, offset_ + static_cast<std::int64_t>(size_));
+}
+
+template <class Duration>
+inline
+DateTimeRange<Duration> DateTimeRange<Duration>::slice(std::size_t first, std::size_t last) const
+{
+    DateTimeRange r = *this;
+    last = last < size_ ? last : size_;
+    first = first < last ? first : last;
+    r.offset_ = offset_ + static_cast<std::int64_t>(first);
+    r.size_ = last - first;
+    return r;
+}
+
+template <class Duration>
+inline
+void DateTimeRange<Duration>::iterator::set(std::int64_t k)
+{
+    k_ = k;
+    if (range_.wall_)
+    {
+        local_ = range_.local_ + k * range_.step_;
+    }
+    sys_ = range_.at(k);
+}
+
+template <class Duration>
+inline
+typename DateTimeRange<Duration>::iterator& DateTimeRange<Duration>::iterator::step(int n)
+{
+    k_ += n;
+    if (!range_.wall_)
+    {
+        sys_ += n * range_.step_;
+        return *this;
+    }
+    local_ += n * range_.step_;
+    if (!cache_.to_sys(local_, sys_))
+    {
+        sys_ = range_.at(k_);
+    }
+    return *this;
+}
+
+template <class Duration, class Rep, class Period>
+inline
+DateTimeRange<typename std::common_type<Duration, std::chrono::duration<Rep, Period>>::type>
+date_range(const DateTime<Duration>& start, const DateTime<Duration>& end, const std::chrono::duration<Rep, Period>& step)
+{
+    using CT = typename std::common_type<Duration, std::chrono::duration<Rep, Period>>::type;
+    return DateTimeRange<CT>(DateTime<CT>(start.zoned_time()), DateTime<CT>(end.zoned_time()), step);
+}
+
+template <class Duration, class DeltaDuration>
+inline
+DateTimeRange<typename std::common_type<Duration, DeltaDuration>::type>
+date_range(const DateTime<Duration>& start, const DateTime<Duration>& end, const BasicTimeDelta<DeltaDuration>& step)
+{
+    return date_range(start, end, step.to_duration());
+}
+
+} // namespace datetime
+
+#endif // DATETIME_RANGE_H
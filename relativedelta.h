@@ -0,0 +1,541 @@
+#ifndef DATETIME_RELATIVEDELTA_H
+#define DATETIME_RELATIVEDELTA_H
+
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Florian Dang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "datetime.h"
+#include "calendar.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace datetime
+{
+// RelativeDelta
+// Calendar arithmetic as dateutil.relativedelta: a delta made of relative
+// parts, added to the fields of a date, and of absolute parts replacing them.
+// RelativeDelta(parts...) takes, in any order:
+//   date::years, date::months                relative months
+//   date::weeks, date::days                  relative days
+//   date::year, date::month, date::day       replace the field
+//   date::last                               replace the day by the last of the month
+//   date::weekday                            anchor: that weekday, on or after
+//   date::weekday_indexed (date::fri[2])  anchor: that one of the month
+//   date::weekday_last (date::fri[date::last])
+// Applying it replaces the year and month, adds the months, sets the day
+// (clamped to the end of the month), adds the days, then moves to the anchor.
+// So RelativeDelta(date::months(1)) moves 2016-01-31 to 2016-02-29, and
+// RelativeDelta(date::months(1), date::last) any day to the end of next month.
+// For the previous weekday, on or before, anchor after date::days(-6).
+//
+// DateTime moves on its local wall clock and keeps its time of day, a time
+// skipped by a transition mapping to the transition and an ambiguous one to
+// its earlier instant. Results out of the range of date::year are unspecified.
+class RelativeDelta
+{
+public:
+    RelativeDelta() = default;  // changes nothing
+
+    template <class ... Parts>
+    explicit RelativeDelta(const Parts& ... parts);
+
+    std::int32_t months() const { return months_; }  // relative, years included
+    std::int32_t days()   const { return days_; }    // relative, weeks included
+
+    // the date moved by the delta, as fields or days since 1970-01-01
+    date::year_month_day apply(const date::year_month_day& ymd) const;
+    std::int32_t apply(std::int32_t days) const;
+
+    RelativeDelta& operator+=(const RelativeDelta& y);
+    RelativeDelta& operator*=(std::int32_t n);
+
+    friend RelativeDelta operator-(const RelativeDelta& x);
+    friend bool operator==(const RelativeDelta& x, const RelativeDelta& y);
+
+    friend void add_column(const std::int32_t* days, std::size_t n, const RelativeDelta& delta, std::int32_t* out);
+    friend void add_column(const Date* dates, std::size_t n, const RelativeDelta& delta, Date* out);
+
+private:
+    static const unsigned char no_weekday = 7;
+
+    std::int32_t    months_ = 0;
+    std::int32_t    days_ = 0;
+    std::int32_t    year_ = 0;
+    bool            has_year_ = false;
+    bool            last_ = false;
+    unsigned char   month_ = 0;             // 0: kept
+    unsigned char   day_ = 0;               // 0: kept
+    unsigned char   weekday_ = no_weekday;  // 0 for Sunday
+    signed char     index_ = 0;             // 0: on or after, 1 to 5: of the month, -1: last of the month
+
+    void set(date::years y) { months_ += static_cast<std::int32_t>(y.count()) * 12; }
+    void set(date::months m) { months_ += static_cast<std::int32_t>(m.count()); }
+    void set(date::days d) { days_ += static_cast<std::int32_t>(d.count()); }
+    void set(date::weeks w) { days_ += static_cast<std::int32_t>(w.count()) * 7; }
+    void set(const date::year& y) { year_ = static_cast<int>(y); has_year_ = true; }
+    void set(const date::month& m) { month_ = static_cast<unsigned char>(static_cast<unsigned>(m)); }
+    void set(const date::day& d) { day_ = static_cast<unsigned char>(static_cast<unsigned>(d)); last_ = false; }
+    void set(date::last_spec) { day_ = 0; last_ = true; }
+    void set(const date::weekday& wd);
+    void set(const date::weekday_indexed& wdi);
+    void set(const date::weekday_last& wdl);
+
+    bool monthly_anchor() const { return index_ != 0; }
+
+    // the fields before the days and the anchor; the first or last day of the
+    // month for a monthly anchor, when there are no days to add first
+    void fields(std::int32_t& y, unsigned& m, unsigned& d) const;
+    // the days and the anchor, from the days of the fields
+    std::int32_t finish(std::int32_t n) const;
+};
+
+RelativeDelta operator+(const RelativeDelta& x, const RelativeDelta& y);  // y's absolute parts win
+RelativeDelta operator-(const RelativeDelta& x, const RelativeDelta& y);
+RelativeDelta operator*(const RelativeDelta& x, std::int32_t n);
+RelativeDelta operator*(std::int32_t n, const RelativeDelta& x);
+bool operator!=(const RelativeDelta& x, const RelativeDelta& y);
+
+Date operator+(const Date& d, const RelativeDelta& delta);
+Date operator+(const RelativeDelta& delta, const Date& d);
+Date operator-(const Date& d, const RelativeDelta& delta);
+
+SerialDate operator+(const SerialDate& d, const RelativeDelta& delta);
+SerialDate operator+(const RelativeDelta& delta, const SerialDate& d);
+SerialDate operator-(const SerialDate& d, const RelativeDelta& delta);
+
+template <class Duration>
+DateTime<Duration> operator+(const DateTime<Duration>& x, const RelativeDelta& delta);
+template <class Duration>
+DateTime<Duration> operator+(const RelativeDelta& delta, const DateTime<Duration>& x);
+template <class Duration>
+DateTime<Duration> operator-(const DateTime<Duration>& x, const RelativeDelta& delta);
+
+// Columns: out[i] = in[i] + delta, out may be in. Days since 1970-01-01 go
+// through the civil_from_days and days_from_civil kernels of calendar.h in
+// blocks, the fields of Dates are moved directly when the delta has no days
+// nor anchor, and DateTimes share a ZoneCache.
+void add_column(const std::int32_t* days, std::size_t n, const RelativeDelta& delta, std::int32_t* out);
+void add_column(const SerialDate* dates, std::size_t n, const RelativeDelta& delta, SerialDate* out);
+void add_column(const Date* dates, std::size_t n, const RelativeDelta& delta, Date* out);
+template <class Duration>
+void add_column(const DateTime<Duration>* times, std::size_t n, const RelativeDelta& delta, DateTime<Duration>* out);
+
+
+// RelativeDelta impl
+
+template <class ... Parts>
+inline
+RelativeDelta::RelativeDelta(const Parts& ... parts)
+{
+    int expand[] = {0, (set(parts), 0)...};
+    (void)expand;
+}
+
+inline
+void RelativeDelta::set(const date::weekday& wd)
+{
+    weekday_ = static_cast<unsigned char>(static_cast<unsigned>(wd));
+    index_ = 0;
+}
+
+inline
+void RelativeDelta::set(const date::weekday_indexed& wdi)
+{
+    weekday_ = static_cast<unsigned char>(static_cast<unsigned>(wdi.weekday()));
+    index_ = static_cast<signed char>(wdi.index());
+}
+
+inline
+void RelativeDelta::set(const date::weekday_last& wdl)
+{
+    weekday_ = static_cast<unsigned char>(static_cast<unsigned>(wdl.weekday()));
+    index_ = -1;
+}
+
+inline
+void RelativeDelta::fields(std::int32_t& y, unsigned& m, unsigned& d) const
+{
+    if (has_year_)
+    {
+        y = year_;
+    }
+    if (month_ != 0)
+    {
+        m = month_;
+    }
+    if (months_ != 0)
+    {
+        // whole years, then a carry: no division per date
+        m += static_cast<unsigned>(detail::floor_mod(months_, 12));
+        const bool carry = m > 12;
+        y += static_cast<std::int32_t>(detail::floor_div(months_, 12)) + carry;
+        m -= carry ? 12 : 0;
+    }
+    const unsigned dim = detail::days_in_month(y, m);
+    if (monthly_anchor() && days_ == 0)
+    {
+        d = index_ > 0 ? 1 : dim;
+    }
+    else
+    {
+        d = last_ ? dim : std::min(day_ != 0 ? unsigned{day_} : d, dim);
+    }
+}
+
+inline
+std::int32_t RelativeDelta::finish(std::int32_t n) const
+{
+    n += days_;
+    if (weekday_ == no_weekday)
+    {
+        return n;
+    }
+    if (monthly_anchor() && days_ != 0)
+    {
+        // the month is only known now
+        std::int32_t y;
+        unsigned char m, d;
+        detail::civil_from_day(n, y, m, d);
+        n = index_ > 0 ? n - (d - 1) : n + static_cast<std::int32_t>(detail::days_in_month(y, m) - d);
+    }
+    const auto wd = static_cast<std::int32_t>(detail::weekday_from_day(n));
+    if (index_ < 0)
+    {
+        return n - (wd - weekday_ + 7) % 7;
+    }
+    return n + (weekday_ - wd + 7) % 7 + 7 * (index_ > 0 ? index_ - 1 : 0);
+}
+
+inline
+date::year_month_day RelativeDelta::apply(const date::year_month_day& ymd) const
+{
+    std::int32_t y = static_cast<int>(ymd.year());
+    unsigned m = static_cast<unsigned>(ymd.month());
+    unsigned d = static_cast<unsigned>(ymd.day());
+    fields(y, m, d);
+    if (days_ != 0 || weekday_ != no_weekday)
+    {
+        unsigned char mm, dd;
+        detail::civil_from_day(finish(detail::day_from_civil(y, m, d)), y, mm, dd);
+        m = mm;
+        d = dd;
+    }
+    return date::year(y) / date::month(m) / date::day(d);
+}
+
+inline
+std::int32_t RelativeDelta::apply(std::int32_t days) const
+{
+    if (months_ == 0 && !has_year_ && month_ == 0 && day_ == 0 && !last_ && !monthly_anchor())
+    {
+        return finish(days);
+    }
+    std::int32_t y;
+    unsigned char mm, dd;
+    detail::civil_from_day(days, y, mm, dd);
+    unsigned m = mm, d = dd;
+    fields(y, m, d);
+    return finish(detail::day_from_civil(y, m, d));
+}
+
+inline
+RelativeDelta& RelativeDelta::operator+=(const RelativeDelta& y)
+{
+    months_ += y.months_;
+    days_ += y.days_;
+    if (y.has_year_)
+    {
+        year_ = y.year_;
+        has_year_ = true;
+    }
+    if (y.month_ != 0)
+    {
+        month_ = y.month_;
+    }
+    if (y.day_ != 0 || y.last_)
+    {
+        day_ = y.day_;
+        last_ = y.last_;
+    }
+    if (y.weekday_ != no_weekday)
+    {
+        weekday_ = y.weekday_;
+        index_ = y.index_;
+    }
+    return *this;
+}
+
+inline
+RelativeDelta& RelativeDelta::operator*=(std::int32_t n)
+{
+    months_ *= n;
+    days_ *= n;
+    return *this;
+}
+
+inline
+RelativeDelta operator-(const RelativeDelta& x)
+{
+    RelativeDelta r = x;
+    r.months_ = -x.months_;
+    r.days_ = -x.days_;
+    return r;
+}
+
+inline
+bool operator==(const RelativeDelta& x, const RelativeDelta& y)
+{
+    return x.months_ == y.months_ && x.days_ == y.days_ && x.has_year_ == y.has_year_
+        && (!x.has_year_ || x.year_ == y.year_) && x.month_ == y.month_ && x.day_ == y.day_
+        && x.last_ == y.last_ && x.weekday_ == y.weekday_ && x.index_ == y.index_;
+}
+
+inline
+bool operator!=(const RelativeDelta& x, const RelativeDelta& y)
+{
+    return !(x == y);
+}
+
+inline
+RelativeDelta operator+(const RelativeDelta& x, const RelativeDelta& y)
+{
+    RelativeDelta r = x;
+    return r += y;
+}
+
+inline
+RelativeDelta operator-(const RelativeDelta& x, const RelativeDelta& y)
+{
+    return x + -y;
+}
+
+inline
+RelativeDelta operator*(const RelativeDelta& x, std::int32_t n)
+{
+    RelativeDelta r = x;
+    return r *= n;
+}
+
+inline
+RelativeDelta operator*(std::int32_t n, const RelativeDelta& x)
+{
+    return x * n;
+}
+
+inline
+Date operator+(const Date& d, const RelativeDelta& delta)
+{
+    return Date(delta.apply(d.year_month_day()));
+}
+
+inline
+Date operator+(const RelativeDelta& delta, const Date& d)
+{
+    return d + delta;
+}
+
+inline
+Date operator-(const Date& d, const RelativeDelta& delta)
+{
+    return d + -delta;
+}
+
+inline
+SerialDate operator+(const SerialDate& d, const RelativeDelta& delta)
+{
+    return SerialDate(delta.apply(d.serial()));
+}
+
+inline
+SerialDate operator+(const RelativeDelta& delta, const SerialDate& d)
+{
+    return d + delta;
+}
+
+inline
+SerialDate operator-(const SerialDate& d, const RelativeDelta& delta)
+{
+    return d + -delta;
+}
+
+template <class Duration>
+inline
+DateTime<Duration> operator+(const DateTime<Duration>& x, const RelativeDelta& delta)
+{
+    using common_duration = typename std::common_type<Duration, std::chrono::seconds>::type;
+    const auto& zt = x.zoned_time();
+    const auto local = zt.get_local_time();
+    const auto day = date::floor<date::days>(local);
+    const auto moved = date::local_days(date::days(delta.apply(static_cast<std::int32_t>(day.time_since_epoch().count()))));
+    return DateTime<Duration>(date::zoned_time<common_duration>(zt.get_time_zone(), moved + (local - day),
+                                                                date::choose::earliest));
+}
+
+template <class Duration>
+inline
+DateTime<Duration> operator+(const RelativeDelta& delta, const DateTime<Duration>& x)
+{
+    return x + delta;
+}
+
+template <class Duration>
+inline
+DateTime<Duration> operator-(const DateTime<Duration>& x, const RelativeDelta& delta)
+{
+    return x + -delta;
+}
+
+namespace detail
+{
+
+const std::size_t relative_block = 512;
+
+} // namespace detail
+
+inline
+void add_column(const std::int32_t* days, std::size_t n, const RelativeDelta& d, std::int32_t* out)
+{
+    const RelativeDelta delta = d;  // not aliased by the stores of months and days
+    std::int32_t year[detail::relative_block];
+    unsigned char month[detail::relative_block];
+    unsigned char day[detail::relative_block];
+    const bool finish = delta.days_ != 0 || delta.weekday_ != RelativeDelta::no_weekday;
+
+    for (std::size_t i = 0; i < n; i += detail::relative_block)
+    {
+        const std::size_t b = std::min(n - i, detail::relative_block);
+        civil_from_days(days + i, b, year, month, day);
+        for (std::size_t j = 0; j < b; ++j)
+        {
+            unsigned m = month[j], d = day[j];
+            delta.fields(year[j], m, d);
+            month[j] = static_cast<unsigned char>(m);
+            day[j] = static_cast<unsigned char>(d);
+        }
+        days_from_civil(year, month, day, b, out + i);
+        if (finish)
+        {
+            for (std::size_t j = 0; j < b; ++j)
+            {
+                out[i + j] = delta.finish(out[i + j]);
+            }
+        }
+    }
+}
+
+inline
+void add_column(const SerialDate* dates, std::size_t n, const RelativeDelta& delta, SerialDate* out)
+{
+    std::int32_t days[detail::relative_block];
+    for (std::size_t i = 0; i < n; i += detail::relative_block)
+    {
+        const std::size_t b = std::min(n - i, detail::relative_block);
+        for (std::size_t j = 0; j < b; ++j)
+        {
+            days[j] = dates[i + j].serial();
+        }
+        add_column(days, b, delta, days);
+        for (std::size_t j = 0; j < b; ++j)
+        {
+            out[i + j] = SerialDate(days[j]);
+        }
+    }
+}
+
+inline
+void add_column(const Date* dates, std::size_t n, const RelativeDelta& d, Date* out)
+{
+    const RelativeDelta delta = d;  // not aliased by the stores of months and days
+    std::int32_t year[detail::relative_block];
+    unsigned char month[detail::relative_block];
+    unsigned char day[detail::relative_block];
+    std::int32_t days[detail::relative_block];
+    const bool finish = delta.days_ != 0 || delta.weekday_ != RelativeDelta::no_weekday;
+
+    for (std::size_t i = 0; i < n; i += detail::relative_block)
+    {
+        const std::size_t b = std::min(n - i, detail::relative_block);
+        for (std::size_t j = 0; j < b; ++j)
+        {
+            const auto& ymd = dates[i + j].year_month_day();
+            std::int32_t y = static_cast<int>(ymd.year());
+            unsigned m = static_cast<unsigned>(ymd.month());
+            unsigned d = static_cast<unsigned>(ymd.day());
+            delta.fields(y, m, d);
+            year[j] = y;
+            month[j] = static_cast<unsigned char>(m);
+            day[j] = static_cast<unsigned char>(d);
+        }
+        if (finish)
+        {
+            days_from_civil(year, month, day, b, days);
+            for (std::size_t j = 0; j < b; ++j)
+            {
+                days[j] = delta.finish(days[j]);
+            }
+            civil_from_days(days, b, year, month, day);
+        }
+        for (std::size_t j = 0; j < b; ++j)
+        {
+            out[i + j] = Date(date::year(year[j]), date::month(month[j]), date::day(day[j]));
+        }
+    }
+}
+
+template <class Duration>
+inline
+void add_column(const DateTime<Duration>* times, std::size_t n, const RelativeDelta& delta, DateTime<Duration>* out)
+{
+    using common_duration = typename std::common_type<Duration, std::chrono::seconds>::type;
+    if (n == 0)
+    {
+        return;
+    }
+    ZoneCache cache(times[0].zoned_time().get_time_zone());
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        const auto& zt = times[i].zoned_time();
+        if (zt.get_time_zone() != cache.zone())
+        {
+            cache = ZoneCache(zt.get_time_zone());
+        }
+        const auto local = cache.to_local(zt.get_sys_time());
+        const auto day = date::floor<date::days>(local);
+        const auto moved = date::local_days(date::days(delta.apply(static_cast<std::int32_t>(day.time_since_epoch().count()))))
+                         + (local - day);
+        date::sys_time<common_duration> sys;
+        if (cache.to_sys(moved, sys))
+        {
+            out[i] = DateTime<Duration>(date::zoned_time<common_duration>(zt.get_time_zone(), sys));
+        }
+        else
+        {
+            out[i] = DateTime<Duration>(date::zoned_time<common_duration>(zt.get_time_zone(), moved, date::choose::earliest));
+        }
+    }
+}
+
+} // namespace datetime
+
+#endif // DATETIME_RELATIVEDELTA_H
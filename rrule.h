@@ -0,0 +1,1211 @@
+#ifndef DATETIME_RRULE_H
+#define DATETIME_RRULE_H
+
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Florian Dang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "datetime.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace datetime
+{
+class DateRecurrence;
+template <class Duration> class DateTimeRecurrence;
+
+namespace detail
+{
+
+struct RRuleStart
+{
+    std::int32_t    serial;     // days since 1970-01-01
+    std::int32_t    year;
+    unsigned        month;
+    unsigned        day;
+    unsigned        weekday;    // 0 for Sunday
+    std::int32_t    second;     // of the day
+};
+
+} // namespace detail
+
+// RRule
+// An RFC 5545 recurrence rule, e.g. "FREQ=MONTHLY;BYDAY=MO,TU,WE,TH,FR;BYSETPOS=-1"
+// (the last weekday of every month), with or without the "RRULE:" prefix.
+// All parts are supported but BYYEARDAY and BYWEEKNO. The BY parts are kept as
+// bit masks: the days of a month are the AND of 32 bits masks built from
+// BYMONTHDAY and BYDAY, and ordinal BYDAYs (2TU, -1FR) are placed directly
+// with date::year_month_weekday, so no day is tested one by one.
+//
+// expand(start) gives the occurrences from start, lazily, a period (year,
+// month, week, day, hour...) of the rule at a time; start itself is only one
+// when it matches, as dateutil.rrule. Expansions stop after 9999-12-31.
+// For a DateTime start, occurrences are in the zone of start:
+// + YEARLY to DAILY rules step the local wall clock, and the times are those
+//   of BYHOUR, BYMINUTE and BYSECOND (those of start by default). A local time
+//   skipped by a transition uses the offset before it (02:30 becomes 03:30
+//   when clocks jump from 02:00 to 03:00) and an ambiguous one is the first,
+//   as RFC 5545 3.3.5.
+// + HOURLY, MINUTELY and SECONDLY rules step the absolute time, so an hourly
+//   rule has 23 or 25 occurrences on the days of transitions; the BY parts
+//   filter the local times.
+// An UNTIL with Z is an instant, one without is a local time of the zone.
+class RRule
+{
+public:
+    enum class Frequency : unsigned char
+    {
+        secondly, minutely, hourly, daily, weekly, monthly, yearly
+    };
+
+    // throw std::system_error with errc::invalid_rule when rule is malformed
+    explicit RRule(const std::string& rule);
+    RRule(const std::string& rule, std::error_code& ec);
+
+    const std::string& str() const { return rule_; }
+
+    Frequency   frequency() const { return freq_; }
+    unsigned    interval()  const { return interval_; }
+
+    // throw std::invalid_argument for HOURLY to SECONDLY, BYHOUR, BYMINUTE or BYSECOND
+    DateRecurrence expand(const Date& start) const;
+
+    template <class Duration>
+    DateTimeRecurrence<typename std::common_type<Duration, std::chrono::seconds>::type>
+    expand(const DateTime<Duration>& start) const;
+
+private:
+    friend class DateRecurrence;
+    template <class Duration> friend class DateTimeRecurrence;
+
+    enum class Until : unsigned char
+    {
+        none, date, local, utc
+    };
+
+    struct Nth
+    {
+        unsigned char   weekday;    // 0 for Sunday
+        signed char     n;          // -53 to 53, not 0
+    };
+
+    std::string         rule_;
+    Frequency           freq_ = Frequency::daily;
+    unsigned            interval_ = 1;
+    bool                has_count_ = false;
+    std::uint64_t       count_ = 0;
+    Until               until_kind_ = Until::none;
+    std::int64_t        until_ = 0;                 // seconds since 1970-01-01
+    std::uint16_t       months_ = 0;                // bit m for BYMONTH=m
+    std::uint32_t       monthdays_ = 0;             // bit d for BYMONTHDAY=d
+    std::uint32_t       monthdays_last_ = 0;        // bit d for BYMONTHDAY=-d
+    unsigned char       weekdays_ = 0;              // bit w for BYDAY without ordinal
+    std::vector<Nth>    nth_;                       // BYDAY with ordinals
+    std::uint32_t       hours_ = 0;                 // bit h for BYHOUR=h
+    std::uint64_t       minutes_ = 0;
+    std::uint64_t       seconds_ = 0;
+    std::vector<int>    setpos_;
+    unsigned char       wkst_ = 1;                  // Monday
+
+    const char* parse(const std::string& rule);
+
+    bool has_monthday() const { return monthdays_ != 0 || monthdays_last_ != 0; }
+    bool has_byday()    const { return weekdays_ != 0 || !nth_.empty(); }
+
+    // BYMONTH, BYMONTHDAY and BYDAY without ordinal as filters of day n
+    bool day_allowed(std::int32_t n) const;
+    // the days of month m of year y in bits 1 to 31, from the day of start
+    // without BYMONTHDAY nor BYDAY; year_nth is for ordinals of the year
+    std::uint32_t month_days(std::int32_t y, unsigned m, std::int32_t first, unsigned start_day,
+                             const std::uint32_t* year_nth) const;
+    void year_nth(std::int32_t y, std::uint32_t* bits) const;
+    // the days of period k in order, false past the last day expanded; DAILY
+    // rules move k forward to the next day allowed
+    bool period_days(const detail::RRuleStart& s, std::int64_t& k, std::vector<std::int32_t>& days) const;
+    // the times of the days of YEARLY to DAILY rules, seconds of the day in order
+    void day_times(const detail::RRuleStart& s, std::vector<std::int32_t>& times) const;
+    // indexes of the occurrences of a period of n kept by BYSETPOS, in order
+    void select(std::size_t n, std::vector<std::size_t>& positions) const;
+};
+
+
+// DateRecurrence
+// The dates of an RRule from a start Date. Iterators are forward iterators,
+// valid while the DateRecurrence is.
+class DateRecurrence
+{
+public:
+    class iterator;
+
+    iterator begin() const;
+    iterator end()   const;
+
+private:
+    friend class RRule;
+
+    DateRecurrence(const RRule& rule, const Date& start);
+
+    RRule               rule_;
+    detail::RRuleStart  start_;
+};
+
+class DateRecurrence::iterator
+{
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = Date;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = void;
+    using reference         = Date;
+
+    iterator() = default;
+
+    Date operator*() const { return SerialDate(buf_[i_]).date(); }
+
+    iterator& operator++();
+    iterator  operator++(int) { iterator x = *this; ++*this; return x; }
+
+    bool operator==(const iterator& x) const { return done_ == x.done_ && (done_ || n_ == x.n_); }
+    bool operator!=(const iterator& x) const { return !(*this == x); }
+
+private:
+    friend class DateRecurrence;
+
+    explicit iterator(const DateRecurrence* r) : r_(r) { fill(); }
+
+    void fill();
+
+    const DateRecurrence*       r_ = nullptr;
+    std::int64_t                k_ = 0;     // next period
+    std::uint64_t               n_ = 0;     // occurrences before this one
+    std::vector<std::int32_t>   days_;
+    std::vector<std::size_t>    positions_;
+    std::vector<std::int32_t>   buf_;       // the occurrences of the period
+    std::size_t                 i_ = 0;
+    bool                        last_ = false;  // no period after buf_
+    bool                        done_ = true;
+};
+
+
+// DateTimeRecurrence
+// The times of an RRule from a start DateTime, in its zone. Conversions go
+// through a ZoneCache. Iterators are forward iterators, valid while the
+// DateTimeRecurrence is.
+template <class Duration>
+class DateTimeRecurrence
+{
+public:
+    class iterator;
+
+    iterator begin() const;
+    iterator end()   const;
+
+private:
+    friend class RRule;
+
+    DateTimeRecurrence(const RRule& rule, const DateTime<Duration>& start);
+
+    // the instant of a local time, with the offset before a gap and the first of an overlap
+    static date::sys_seconds to_sys(ZoneCache& cache, const date::local_seconds& tp);
+
+    RRule                   rule_;
+    detail::RRuleStart      start_;
+    const date::time_zone*  zone_;
+    date::sys_seconds       sys_;       // start, whole seconds
+    Duration                fraction_;  // below the second, added to all occurrences
+    std::int64_t            unit_;      // seconds of the periods of HOURLY to SECONDLY
+    date::sys_seconds       base_;      // start of the first of them
+};
+
+template <class Duration>
+class DateTimeRecurrence<Duration>::iterator
+{
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = DateTime<Duration>;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = void;
+    using reference         = DateTime<Duration>;
+
+    iterator() = default;
+
+    DateTime<Duration> operator*() const
+    {
+        return DateTime<Duration>(date::zoned_time<Duration>(r_->zone_, buf_[i_] + r_->fraction_));
+    }
+
+    iterator& operator++();
+    iterator  operator++(int) { iterator x = *this; ++*this; return x; }
+
+    bool operator==(const iterator& x) const { return done_ == x.done_ && (done_ || n_ == x.n_); }
+    bool operator!=(const iterator& x) const { return !(*this == x); }
+
+private:
+    friend class DateTimeRecurrence;
+
+    explicit iterator(const DateTimeRecurrence* r) : r_(r), cache_(r->zone_) { fill(); }
+
+    void fill();
+    bool fill_days();
+    bool fill_units();
+    bool past_until(date::sys_seconds tp);
+
+    const DateTimeRecurrence*       r_ = nullptr;
+    ZoneCache                       cache_{nullptr};
+    std::int64_t                    k_ = 0;
+    std::uint64_t                   n_ = 0;
+    std::vector<std::int32_t>       days_;
+    std::vector<std::int32_t>       times_;
+    std::vector<std::size_t>        positions_;
+    std::vector<date::sys_seconds>  units_;
+    std::vector<date::sys_seconds>  buf_;
+    std::size_t                     i_ = 0;
+    bool                            last_ = false;
+    bool                            done_ = true;
+};
+
+
+// RRule impl
+
+namespace detail
+{
+
+const std::int32_t rrule_last_day = 2932896;   // 9999-12-31
+
+// index of the lowest set bit of x, not 0
+inline
+unsigned countr_zero(std::uint64_t x)
+{
+#if defined(__GNUC__)
+    return static_cast<unsigned>(__builtin_ctzll(x));
+#else
+    unsigned n = 0;
+    for (; (x & 1) == 0; x >>= 1)
+    {
+        ++n;
+    }
+    return n;
+#endif
+}
+
+// the set bits of x from the lowest, f(index)
+template <class F>
+inline
+void for_each_bit(std::uint64_t x, F f)
+{
+    for (; x != 0; x &= x - 1)
+    {
+        f(countr_zero(x));
+    }
+}
+
+// index of the lowest set bit of x above bit i, 64 when none
+inline
+unsigned next_bit(std::uint64_t x, unsigned i)
+{
+    x = i >= 63 ? 0 : x >> (i + 1) << (i + 1);
+    return x == 0 ? 64 : countr_zero(x);
+}
+
+inline
+bool rrule_weekday(const std::string& s, std::size_t pos, unsigned char& wd)
+{
+    static const char names[] = "SUMOTUWETHFRSA";
+    if (s.size() != pos + 2)
+    {
+        return false;
+    }
+    for (unsigned char i = 0; i < 7; ++i)
+    {
+        if (s[pos] == names[2 * i] && s[pos + 1] == names[2 * i + 1])
+        {
+            wd = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+// [+-]digits with min <= value <= max
+inline
+bool rrule_int(const std::string& s, std::int64_t min, std::int64_t max, std::int64_t& out)
+{
+    std::size_t i = 0;
+    const bool negative = !s.empty() && s[0] == '-';
+    if (!s.empty() && (s[0] == '-' || s[0] == '+'))
+    {
+        ++i;
+    }
+    if (i == s.size() || s.size() - i > 10)
+    {
+        return false;
+    }
+    std::int64_t x = 0;
+    for (; i < s.size(); ++i)
+    {
+        if (s[i] < '0' || s[i] > '9')
+        {
+            return false;
+        }
+        x = x * 10 + (s[i] - '0');
+    }
+    out = negative ? -x : x;
+    return min <= out && out <= max;
+}
+
+// comma separated values of min to max, not 0, as bits of mask (negative ones
+// in negative_mask when given)
+inline
+bool rrule_bits(const std::string& s, std::int64_t min, std::int64_t max, std::uint64_t& mask,
+                std::uint64_t* negative_mask = nullptr)
+{
+    std::size_t begin = 0;
+    while (true)
+    {
+        const std::size_t end = std::min(s.find(',', begin), s.size());
+        std::int64_t x;
+        if (!rrule_int(s.substr(begin, end - begin), min, max, x) || (x == 0 && min < 0))
+        {
+            return false;
+        }
+        if (x < 0)
+        {
+            *negative_mask |= std::uint64_t(1) << -x;
+        }
+        else
+        {
+            mask |= std::uint64_t(1) << x;
+        }
+        if (end == s.size())
+        {
+            return true;
+        }
+        begin = end + 1;
+    }
+}
+
+} // namespace detail
+
+inline
+RRule::RRule(const std::string& rule)
+{
+    if (const char* error = parse(rule))
+    {
+        throw std::system_error(make_error_code(errc::invalid_rule), "RRule(\"" + rule + "\"): " + error);
+    }
+}
+
+inline
+RRule::RRule(const std::string& rule, std::error_code& ec)
+{
+    if (parse(rule))
+    {
+        ec = errc::invalid_rule;
+        *this = RRule("FREQ=DAILY");
+    }
+    else
+    {
+        ec.clear();
+    }
+}
+
+// nullptr or what is wrong
+inline
+const char* RRule::parse(const std::string& rule)
+{
+    rule_ = rule;
+    std::string s = rule;
+    std::transform(s.begin(), s.end(), s.begin(), [](char c) { return c >= 'a' && c <= 'z' ? static_cast<char>(c - 32) : c; });
+    if (s.compare(0, 6, "RRULE:") == 0)
+    {
+        s.erase(0, 6);
+    }
+
+    const char* const names[] = {"FREQ", "INTERVAL", "COUNT", "UNTIL", "BYMONTH", "BYMONTHDAY", "BYDAY",
+                                 "BYHOUR", "BYMINUTE", "BYSECOND", "BYSETPOS", "WKST"};
+    const std::size_t n_names = sizeof(names) / sizeof(names[0]);
+    unsigned seen = 0;
+    std::size_t begin = 0;
+    while (begin < s.size())
+    {
+        const std::size_t end = std::min(s.find(';', begin), s.size());
+        const std::size_t eq = s.find('=', begin);
+        if (eq >= end)
+        {
+            return "expected NAME=VALUE";
+        }
+        const std::string name = s.substr(begin, eq - begin);
+        const std::string value = s.substr(eq + 1, end - eq - 1);
+        begin = end + 1;
+
+        if (name == "BYYEARDAY" || name == "BYWEEKNO")
+        {
+            return "BYYEARDAY and BYWEEKNO are not supported";
+        }
+        const std::size_t part = static_cast<std::size_t>(std::find(names, names + n_names, name) - names);
+        if (part == n_names)
+        {
+            return "unknown part";
+        }
+        if (seen & (1u << part))
+        {
+            return "repeated part";
+        }
+        seen |= 1u << part;
+
+        std::int64_t x;
+        std::uint64_t bits = 0;
+        std::uint64_t negative = 0;
+        switch (part)
+        {
+        case 0:
+        {
+            const char* const freqs[] = {"SECONDLY", "MINUTELY", "HOURLY", "DAILY", "WEEKLY", "MONTHLY", "YEARLY"};
+            const auto f = std::find(freqs, freqs + 7, value) - freqs;
+            if (f == 7)
+            {
+                return "unknown FREQ";
+            }
+            freq_ = static_cast<Frequency>(f);
+            break;
+        }
+        case 1:
+            if (!detail::rrule_int(value, 1, 1000000, x))
+            {
+                return "INTERVAL must be 1 to 1000000";
+            }
+            interval_ = static_cast<unsigned>(x);
+            break;
+        case 2:
+            if (!detail::rrule_int(value, 0, 9999999999, x) || value[0] == '-' || value[0] == '+')
+            {
+                return "COUNT must be a count";
+            }
+            has_count_ = true;
+            count_ = static_cast<std::uint64_t>(x);
+            break;
+        case 3:
+        {
+            // YYYYMMDD or YYYYMMDDTHHMMSS, with Z for UTC
+            const bool utc = !value.empty() && value.back() == 'Z';
+            const std::size_t size = value.size() - (utc ? 1 : 0);
+            bool digits = (size == 8 && !utc) || (size == 15 && value[8] == 'T');
+            for (std::size_t i = 0; digits && i < size; ++i)
+            {
+                digits = i == 8 || (value[i] >= '0' && value[i] <= '9');
+            }
+            std::int64_t y, mo, d, h = 0, mi = 0, sec = 0;
+            if (!digits
+                || !detail::rrule_int(value.substr(0, 4), 0, 9999, y) || !detail::rrule_int(value.substr(4, 2), 1, 12, mo)
+                || !detail::rrule_int(value.substr(6, 2), 1, 31, d)
+                || (size == 15 && (!detail::rrule_int(value.substr(9, 2), 0, 23, h)
+                                   || !detail::rrule_int(value.substr(11, 2), 0, 59, mi)
+                                   || !detail::rrule_int(value.substr(13, 2), 0, 60, sec))))
+            {
+                return "UNTIL must be YYYYMMDD or YYYYMMDDTHHMMSS[Z]";
+            }
+            const auto ymd = date::year(static_cast<int>(y)) / static_cast<unsigned>(mo) / static_cast<unsigned>(d);
+            if (!ymd.ok())
+            {
+                return "UNTIL is not a date";
+            }
+            until_kind_ = size == 8 ? Until::date : utc ? Until::utc : Until::local;
+            until_ = date::sys_days(ymd).time_since_epoch().count() * 86400 + h * 3600 + mi * 60 + sec;
+            break;
+        }
+        case 4:
+            if (!detail::rrule_bits(value, 1, 12, bits))
+            {
+                return "BYMONTH must be 1 to 12";
+            }
+            months_ = static_cast<std::uint16_t>(bits);
+            break;
+        case 5:
+            if (!detail::rrule_bits(value, -31, 31, bits, &negative))
+            {
+                return "BYMONTHDAY must be 1 to 31 or -31 to -1";
+            }
+            monthdays_ = static_cast<std::uint32_t>(bits);
+            monthdays_last_ = static_cast<std::uint32_t>(negative);
+            break;
+        case 6:
+        {
+            std::size_t b = 0;
+            while (true)
+            {
+                const std::size_t e = std::min(value.find(',', b), value.size());
+                const std::string item = value.substr(b, e - b);
+                if (item.size() < 2)
+                {
+                    return "BYDAY must be weekdays, as 2TU or -1FR";
+                }
+                const std::size_t day = item.size() - 2;
+                unsigned char wd;
+                if (!detail::rrule_weekday(item, day, wd))
+                {
+                    return "BYDAY must be weekdays, as 2TU or -1FR";
+                }
+                if (day == 0)
+                {
+                    weekdays_ |= static_cast<unsigned char>(1u << wd);
+                }
+                else if (!detail::rrule_int(item.substr(0, day), -53, 53, x) || x == 0)
+                {
+                    return "BYDAY ordinals must be 1 to 53 or -53 to -1";
+                }
+                else
+                {
+                    nth_.push_back(Nth{wd, static_cast<signed char>(x)});
+                }
+                if (e == value.size())
+                {
+                    break;
+                }
+                b = e + 1;
+            }
+            break;
+        }
+        case 7:
+            if (!detail::rrule_bits(value, 0, 23, bits))
+            {
+                return "BYHOUR must be 0 to 23";
+            }
+            hours_ = static_cast<std::uint32_t>(bits);
+            break;
+        case 8:
+            if (!detail::rrule_bits(value, 0, 59, bits))
+            {
+                return "BYMINUTE must be 0 to 59";
+            }
+            minutes_ = bits;
+            break;
+        case 9:
+            if (!detail::rrule_bits(value, 0, 59, bits))
+            {
+                return "BYSECOND must be 0 to 59";
+            }
+            seconds_ = bits;
+            break;
+        case 10:
+        {
+            std::size_t b = 0;
+            while (true)
+            {
+                const std::size_t e = std::min(value.find(',', b), value.size());
+                if (!detail::rrule_int(value.substr(b, e - b), -366, 366, x) || x == 0)
+                {
+                    return "BYSETPOS must be 1 to 366 or -366 to -1";
+                }
+                setpos_.push_back(static_cast<int>(x));
+                if (e == value.size())
+                {
+                    break;
+                }
+                b = e + 1;
+            }
+            break;
+        }
+        case 11:
+            if (!detail::rrule_weekday(value, 0, wkst_))
+            {
+                return "WKST must be a weekday";
+            }
+            break;
+        }
+    }
+
+    if ((seen & 1) == 0)
+    {
+        return "FREQ is required";
+    }
+    if (has_count_ && until_kind_ != Until::none)
+    {
+        return "COUNT and UNTIL are exclusive";
+    }
+    if (!nth_.empty() && freq_ != Frequency::monthly && freq_ != Frequency::yearly)
+    {
+        return "BYDAY ordinals need FREQ=MONTHLY or FREQ=YEARLY";
+    }
+    return nullptr;
+}
+
+inline
+DateRecurrence RRule::expand(const Date& start) const
+{
+    if (freq_ < Frequency::daily || hours_ != 0 || minutes_ != 0 || seconds_ != 0)
+    {
+        throw std::invalid_argument("RRule: times need a DateTime start");
+    }
+    return DateRecurrence(*this, start);
+}
+
+template <class Duration>
+inline
+DateTimeRecurrence<typename std::common_type<Duration, std::chrono::seconds>::type>
+RRule::expand(const DateTime<Duration>& start) const
+{
+    return DateTimeRecurrence<typename std::common_type<Duration, std::chrono::seconds>::type>(*this, start);
+}
+
+inline
+bool RRule::day_allowed(std::int32_t n) const
+{
+    if (weekdays_ != 0 && ((weekdays_ >> detail::weekday_from_day(n)) & 1) == 0)
+    {
+        return false;
+    }
+    if (months_ == 0 && !has_monthday())
+    {
+        return true;
+    }
+    std::int32_t y;
+    unsigned char m, d;
+    detail::civil_from_day(n, y, m, d);
+    if (months_ != 0 && ((months_ >> m) & 1) == 0)
+    {
+        return false;
+    }
+    return !has_monthday() || ((monthdays_ >> d) & 1) != 0
+        || ((monthdays_last_ >> (detail::days_in_month(y, m) + 1 - d)) & 1) != 0;
+}
+
+inline
+void RRule::year_nth(std::int32_t y, std::uint32_t* bits) const
+{
+    std::fill(bits, bits + 13, 0u);
+    const std::int32_t first = detail::day_from_civil(y, 1, 1);
+    const std::int32_t last = detail::day_from_civil(y, 12, 31);
+    for (const auto& x : nth_)
+    {
+        const date::weekday wd(unsigned{x.weekday});
+        std::int32_t n;
+        if (x.n > 0)
+        {
+            n = date::sys_days(date::year(y) / date::jan / wd[1]).time_since_epoch().count() + 7 * (x.n - 1);
+        }
+        else
+        {
+            n = date::sys_days(date::year(y) / date::dec / wd[date::last]).time_since_epoch().count() + 7 * (x.n + 1);
+        }
+        if (first <= n && n <= last)
+        {
+            std::int32_t yy;
+            unsigned char m, d;
+            detail::civil_from_day(n, yy, m, d);
+            bits[m] |= 1u << d;
+        }
+    }
+}
+
+inline
+std::uint32_t RRule::month_days(std::int32_t y, unsigned m, std::int32_t first, unsigned start_day,
+                                const std::uint32_t* year_nth) const
+{
+    const unsigned dim = detail::days_in_month(y, m);
+    std::uint32_t mask = (0xffffffffu >> (31 - dim)) & ~1u;  // bits 1 to dim
+    if (!has_monthday() && !has_byday())
+    {
+        return mask & (std::uint32_t(1) << start_day);
+    }
+    if (has_monthday())
+    {
+        std::uint32_t days = monthdays_;
+        detail::for_each_bit(monthdays_last_, [&](unsigned k) {
+            if (k <= dim)
+            {
+                days |= 1u << (dim + 1 - k);
+            }
+        });
+        mask &= days;
+    }
+    if (has_byday())
+    {
+        // each weekday every 7 days from its first one
+        const unsigned w1 = detail::weekday_from_day(first);
+        std::uint64_t days = 0;
+        detail::for_each_bit(weekdays_, [&](unsigned wd) {
+            days |= std::uint64_t(0x10204081) << ((wd + 7 - w1) % 7 + 1);
+        });
+        if (year_nth != nullptr)
+        {
+            days |= year_nth[m];
+        }
+        else
+        {
+            const date::year_month ym = date::year(y) / date::month(m);
+            for (const auto& x : nth_)
+            {
+                const date::weekday wd(unsigned{x.weekday});
+                if (x.n > 0 && x.n <= 5)
+                {
+                    const date::year_month_weekday ymw = ym / wd[static_cast<unsigned>(x.n)];
+                    if (ymw.ok())
+                    {
+                        days |= std::uint64_t(1) << static_cast<unsigned>(date::year_month_day(ymw).day());
+                    }
+                }
+                else if (x.n < 0 && x.n >= -5)
+                {
+                    const int d = static_cast<int>(static_cast<unsigned>(date::year_month_day(ym / wd[date::last]).day()))
+                                + 7 * (x.n + 1);
+                    if (d >= 1)
+                    {
+                        days |= std::uint64_t(1) << d;
+                    }
+                }
+            }
+        }
+        mask &= static_cast<std::uint32_t>(days);
+    }
+    return mask;
+}
+
+inline
+bool RRule::period_days(const detail::RRuleStart& s, std::int64_t& k, std::vector<std::int32_t>& days) const
+{
+    days.clear();
+    const std::int64_t step = static_cast<std::int64_t>(interval_) * k;
+    switch (freq_)
+    {
+    case Frequency::yearly:
+    {
+        const std::int64_t y = s.year + step;
+        if (y > 9999)
+        {
+            return false;
+        }
+        const auto yy = static_cast<std::int32_t>(y);
+        std::uint32_t nth[13];
+        const bool of_year = !nth_.empty() && months_ == 0;
+        if (of_year)
+        {
+            year_nth(yy, nth);
+        }
+        const unsigned months = months_ != 0 ? months_ : has_monthday() || has_byday() ? 0x1ffeu : 1u << s.month;
+        detail::for_each_bit(months, [&](unsigned m) {
+            const std::int32_t first = detail::day_from_civil(yy, m, 1);
+            detail::for_each_bit(month_days(yy, m, first, s.day, of_year ? nth : nullptr), [&](unsigned d) {
+                days.push_back(first + static_cast<std::int32_t>(d) - 1);
+            });
+        });
+        return true;
+    }
+    case Frequency::monthly:
+    {
+        const std::int64_t t = std::int64_t{s.year} * 12 + (s.month - 1) + step;
+        const auto y = static_cast<std::int32_t>(detail::floor_div(t, 12));
+        const auto m = static_cast<unsigned>(detail::floor_mod(t, 12)) + 1;
+        if (y > 9999)
+        {
+            return false;
+        }
+        if (months_ == 0 || ((months_ >> m) & 1) != 0)
+        {
+            const std::int32_t first = detail::day_from_civil(y, m, 1);
+            detail::for_each_bit(month_days(y, m, first, s.day, nullptr), [&](unsigned d) {
+                days.push_back(first + static_cast<std::int32_t>(d) - 1);
+            });
+        }
+        return true;
+    }
+    case Frequency::weekly:
+    {
+        const std::int64_t week = s.serial - (s.weekday + 7 - wkst_) % 7 + 7 * step;
+        if (week > detail::rrule_last_day)
+        {
+            return false;
+        }
+        const unsigned weekdays = weekdays_ != 0 ? weekdays_ : 1u << s.weekday;
+        for (unsigned i = 0; i < 7; ++i)
+        {
+            const auto n = static_cast<std::int32_t>(week + i);
+            if (((weekdays >> ((wkst_ + i) % 7)) & 1) != 0 && day_allowed(n))
+            {
+                days.push_back(n);
+            }
+        }
+        return true;
+    }
+    default:  // daily
+    {
+        std::int64_t n = s.serial + step;
+        while (n <= detail::rrule_last_day && !day_allowed(static_cast<std::int32_t>(n)))
+        {
+            // the next day that may be allowed, then the next one of the rule from there
+            std::int32_t y;
+            unsigned char m, d;
+            detail::civil_from_day(static_cast<std::int32_t>(n), y, m, d);
+            std::int64_t next = n + 1;
+            if (months_ != 0 && ((months_ >> m) & 1) == 0)
+            {
+                const unsigned m2 = detail::next_bit(months_, m);
+                next = m2 <= 12 ? detail::day_from_civil(y, m2, 1)
+                                : detail::day_from_civil(y + 1, detail::countr_zero(months_), 1);
+            }
+            else if (weekdays_ != 0 && ((weekdays_ >> detail::weekday_from_day(static_cast<std::int32_t>(n))) & 1) == 0)
+            {
+                const unsigned wd = detail::weekday_from_day(static_cast<std::int32_t>(n));
+                const unsigned w2 = detail::next_bit(weekdays_ | (weekdays_ << 7), wd);
+                next = n + (w2 - wd);
+            }
+            k = std::max(k + 1, detail::floor_div(next - s.serial + interval_ - 1, interval_));
+            n = s.serial + static_cast<std::int64_t>(interval_) * k;
+        }
+        if (n > detail::rrule_last_day)
+        {
+            return false;
+        }
+        days.push_back(static_cast<std::int32_t>(n));
+        return true;
+    }
+    }
+}
+
+inline
+void RRule::day_times(const detail::RRuleStart& s, std::vector<std::int32_t>& times) const
+{
+    times.clear();
+    const std::uint64_t hours = hours_ != 0 ? hours_ : std::uint64_t(1) << (s.second / 3600);
+    const std::uint64_t minutes = minutes_ != 0 ? minutes_ : std::uint64_t(1) << (s.second / 60 % 60);
+    const std::uint64_t seconds = seconds_ != 0 ? seconds_ : std::uint64_t(1) << (s.second % 60);
+    detail::for_each_bit(hours, [&](unsigned h) {
+        detail::for_each_bit(minutes, [&](unsigned m) {
+            detail::for_each_bit(seconds, [&](unsigned sec) {
+                times.push_back(static_cast<std::int32_t>(h * 3600 + m * 60 + sec));
+            });
+        });
+    });
+}
+
+inline
+void RRule::select(std::size_t n, std::vector<std::size_t>& positions) const
+{
+    positions.clear();
+    if (setpos_.empty())
+    {
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            positions.push_back(i);
+        }
+        return;
+    }
+    for (int p : setpos_)
+    {
+        const auto i = p > 0 ? static_cast<std::int64_t>(p) - 1 : static_cast<std::int64_t>(n) + p;
+        if (0 <= i && i < static_cast<std::int64_t>(n))
+        {
+            positions.push_back(static_cast<std::size_t>(i));
+        }
+    }
+    std::sort(positions.begin(), positions.end());
+    positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+}
+
+
+// DateRecurrence impl
+
+inline
+DateRecurrence::DateRecurrence(const RRule& rule, const Date& start)
+    : rule_(rule)
+{
+    const SerialDate s(start);
+    start_ = detail::RRuleStart{s.serial(), static_cast<int>(start.year()), static_cast<unsigned>(start.month()),
+                                static_cast<unsigned>(start.day()), detail::weekday_from_day(s.serial()), 0};
+}
+
+inline
+DateRecurrence::iterator DateRecurrence::begin() const
+{
+    return iterator(this);
+}
+
+inline
+DateRecurrence::iterator DateRecurrence::end() const
+{
+    return iterator();
+}
+
+inline
+void DateRecurrence::iterator::fill()
+{
+    const RRule& rule = r_->rule_;
+    done_ = rule.has_count_ && n_ >= rule.count_;
+    while (!done_ && i_ == buf_.size())
+    {
+        if (last_ || !rule.period_days(r_->start_, k_, days_))
+        {
+            done_ = true;
+            return;
+        }
+        ++k_;
+        buf_.clear();
+        i_ = 0;
+        rule.select(days_.size(), positions_);
+        for (auto p : positions_)
+        {
+            const std::int32_t n = days_[p];
+            if (n < r_->start_.serial)
+            {
+                continue;
+            }
+            if (rule.until_kind_ != RRule::Until::none && n > detail::floor_div(rule.until_, 86400))
+            {
+                last_ = true;
+                break;
+            }
+            buf_.push_back(n);
+        }
+    }
+}
+
+inline
+DateRecurrence::iterator& DateRecurrence::iterator::operator++()
+{
+    ++i_;
+    ++n_;
+    fill();
+    return *this;
+}
+
+
+// DateTimeRecurrence impl
+
+template <class Duration>
+inline
+DateTimeRecurrence<Duration>::DateTimeRecurrence(const RRule& rule, const DateTime<Duration>& start)
+    : rule_(rule), zone_(start.zoned_time().get_time_zone())
+{
+    const auto local = start.zoned_time().get_local_time();
+    const auto seconds = date::floor<std::chrono::seconds>(local);
+    const auto day = date::floor<date::days>(local);
+    fraction_ = local - seconds;
+    sys_ = date::floor<std::chrono::seconds>(start.zoned_time().get_sys_time());
+
+    const auto ymd = date::year_month_day(day);
+    const auto serial = static_cast<std::int32_t>(day.time_since_epoch().count());
+    start_ = detail::RRuleStart{serial, static_cast<int>(ymd.year()), static_cast<unsigned>(ymd.month()),
+                                static_cast<unsigned>(ymd.day()), detail::weekday_from_day(serial),
+                                static_cast<std::int32_t>((seconds - day).count())};
+
+    unit_ = rule_.freq_ == RRule::Frequency::hourly ? 3600 : rule_.freq_ == RRule::Frequency::minutely ? 60 : 1;
+    base_ = sys_ - std::chrono::seconds(start_.second % unit_);
+}
+
+template <class Duration>
+inline
+typename DateTimeRecurrence<Duration>::iterator DateTimeRecurrence<Duration>::begin() const
+{
+    return iterator(this);
+}
+
+template <class Duration>
+inline
+typename DateTimeRecurrence<Duration>::iterator DateTimeRecurrence<Duration>::end() const
+{
+    return iterator();
+}
+
+template <class Duration>
+inline
+date::sys_seconds DateTimeRecurrence<Duration>::to_sys(ZoneCache& cache, const date::local_seconds& tp)
+{
+    date::sys_seconds out;
+    if (cache.to_sys(tp, out))
+    {
+        return out;
+    }
+    return date::sys_seconds(tp.time_since_epoch()) - cache.zone()->get_info(tp).first.offset;
+}
+
+template <class Duration>
+inline
+bool DateTimeRecurrence<Duration>::iterator::past_until(date::sys_seconds tp)
+{
+    const RRule& rule = r_->rule_;
+    switch (rule.until_kind_)
+    {
+    case RRule::Until::none:
+        return false;
+    case RRule::Until::utc:
+        return tp.time_since_epoch().count() > rule.until_;
+    case RRule::Until::local:
+        return cache_.to_local(tp).time_since_epoch().count() > rule.until_;
+    default:
+        return detail::floor_div(cache_.to_local(tp).time_since_epoch().count(), 86400)
+             > detail::floor_div(rule.until_, 86400);
+    }
+}
+
+// YEARLY to DAILY: the days of a period times the times of a day
+template <class Duration>
+inline
+bool DateTimeRecurrence<Duration>::iterator::fill_days()
+{
+    const RRule& rule = r_->rule_;
+    if (!rule.period_days(r_->start_, k_, days_))
+    {
+        return false;
+    }
+    ++k_;
+    rule.select(days_.size() * times_.size(), positions_);
+    for (auto p : positions_)
+    {
+        const std::int64_t local = std::int64_t{days_[p / times_.size()]} * 86400 + times_[p % times_.size()];
+        const auto tp = r_->to_sys(cache_, date::local_seconds(std::chrono::seconds(local)));
+        if (tp < r_->sys_)
+        {
+            continue;
+        }
+        if (past_until(tp))
+        {
+            last_ = true;
+            break;
+        }
+        buf_.push_back(tp);
+    }
+    return true;
+}
+
+// HOURLY to SECONDLY: the occurrences of an hour, minute or second of absolute time
+template <class Duration>
+inline
+bool DateTimeRecurrence<Duration>::iterator::fill_units()
+{
+    const RRule& rule = r_->rule_;
+    const std::int64_t unit = r_->unit_;
+    const std::int64_t step = unit * rule.interval_;
+    while (true)
+    {
+        const auto p = r_->base_ + std::chrono::seconds(step * k_);
+        const std::int64_t local = cache_.to_local(p).time_since_epoch().count();
+        const auto day = static_cast<std::int32_t>(detail::floor_div(local, 86400));
+        if (day > detail::rrule_last_day)
+        {
+            return false;
+        }
+        const auto tod = static_cast<unsigned>(local - std::int64_t{day} * 86400);
+
+        // the next local time that may be allowed, when this one is not
+        std::int64_t next = 0;
+        if (!rule.day_allowed(day))
+        {
+            next = (std::int64_t{day} + 1) * 86400;
+        }
+        else if (rule.hours_ != 0 && ((rule.hours_ >> (tod / 3600)) & 1) == 0)
+        {
+            const unsigned h = detail::next_bit(rule.hours_, tod / 3600);
+            next = std::int64_t{day} * 86400 + (h < 24 ? h * 3600 : 86400);
+        }
+        else if (unit < 3600 && rule.minutes_ != 0 && ((rule.minutes_ >> (tod / 60 % 60)) & 1) == 0)
+        {
+            const unsigned m = detail::next_bit(rule.minutes_, tod / 60 % 60);
+            next = local - tod % 3600 + (m < 60 ? m * 60 : 3600);
+        }
+        else if (unit < 60 && rule.seconds_ != 0 && ((rule.seconds_ >> (tod % 60)) & 1) == 0)
+        {
+            const unsigned sec = detail::next_bit(rule.seconds_, tod % 60);
+            next = local - tod % 60 + (sec < 60 ? sec : 60);
+        }
+        if (next != 0)
+        {
+            const auto target = r_->to_sys(cache_, date::local_seconds(std::chrono::seconds(next)));
+            k_ = std::max(k_ + 1, detail::floor_div((target - r_->base_).count() + step - 1, step));
+            continue;
+        }
+
+        // the local start of the hour or minute, and the times within it
+        const auto start = p - std::chrono::seconds(tod % unit);
+        units_.clear();
+        if (unit == 1)
+        {
+            units_.push_back(start);
+        }
+        else
+        {
+            const std::uint64_t minutes = unit == 60 ? 1 : rule.minutes_ != 0 ? rule.minutes_
+                                                                             : std::uint64_t(1) << (r_->start_.second / 60 % 60);
+            const std::uint64_t seconds = rule.seconds_ != 0 ? rule.seconds_ : std::uint64_t(1) << (r_->start_.second % 60);
+            detail::for_each_bit(minutes, [&](unsigned m) {
+                detail::for_each_bit(seconds, [&](unsigned sec) {
+                    units_.push_back(start + std::chrono::seconds(unit == 60 ? sec : m * 60 + sec));
+                });
+            });
+        }
+        ++k_;
+        rule.select(units_.size(), positions_);
+        for (auto i : positions_)
+        {
+            if (units_[i] < r_->sys_)
+            {
+                continue;
+            }
+            if (past_until(units_[i]))
+            {
+                last_ = true;
+                break;
+            }
+            buf_.push_back(units_[i]);
+        }
+        return true;
+    }
+}
+
+template <class Duration>
+inline
+void DateTimeRecurrence<Duration>::iterator::fill()
+{
+    const RRule& rule = r_->rule_;
+    if (times_.empty() && rule.freq_ >= RRule::Frequency::daily)
+    {
+        rule.day_times(r_->start_, times_);
+    }
+    done_ = rule.has_count_ && n_ >= rule.count_;
+    while (!done_ && i_ == buf_.size())
+    {
+        buf_.clear();
+        i_ = 0;
+        if (last_ || !(rule.freq_ >= RRule::Frequency::daily ? fill_days() : fill_units()))
+        {
+            done_ = true;
+        }
+    }
+}
+
+template <class Duration>
+inline
+typename DateTimeRecurrence<Duration>::iterator& DateTimeRecurrence<Duration>::iterator::operator++()
+{
+    ++i_;
+    ++n_;
+    fill();
+    return *this;
+}
+
+} // namespace datetime
+
+#endif // DATETIME_RRULE_H
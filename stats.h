@@ -0,0 +1,647 @@
+#ifndef DATETIME_STATS_H
+#define DATETIME_STATS_H
+
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Florian Dang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "bulk.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace datetime
+{
+// DeltaSummary
+// Count, sum, extremes, mean and variance of a column of TimeDelta, or of
+// std::chrono durations truncated to microseconds as by TimeDelta. The sum is
+// kept exactly: when it is out of the range of TimeDelta, overflow is set and
+// sum is zero, the other fields are still right. The mean is exact as well,
+// rounded half to even as timedelta / int in Python.
+//
+// The kernels use AVX-512 or AVX2 when the compiler targets them (e.g.
+// -march=native), the same arithmetic one value at a time otherwise.
+struct DeltaSummary
+{
+    std::size_t count       = 0;
+    bool        overflow    = false;
+    TimeDelta   sum         = TimeDelta(std::chrono::microseconds(0));
+    TimeDelta   mean        = TimeDelta(std::chrono::microseconds(0));
+    TimeDelta   min         = TimeDelta(std::chrono::microseconds(0));
+    TimeDelta   max         = TimeDelta(std::chrono::microseconds(0));
+    double      variance    = 0;    // population variance, in squared microseconds
+
+    TimeDelta stddev() const;       // rounded to the microsecond
+};
+
+DeltaSummary describe_column(const TimeDelta* deltas, std::size_t n);
+
+// Same, splitting the rows over the threads of pool.
+DeltaSummary describe_column(const TimeDelta* deltas, std::size_t n, ThreadPool& pool);
+
+template <class Rep, class Period>
+DeltaSummary describe_column(const std::chrono::duration<Rep, Period>* durations, std::size_t n);
+
+template <class Rep, class Period>
+DeltaSummary describe_column(const std::chrono::duration<Rep, Period>* durations, std::size_t n,
+                             ThreadPool& pool);
+
+
+// DeltaHistogram
+// Log-linear (HDR) histogram of TimeDelta values for approximate percentiles
+// in constant memory. The buckets split each power of two of microseconds into
+// 2^(significant_bits - 1) equal parts, both ways from zero, so a percentile is
+// within a relative error of 2^-significant_bits (and exact below
+// 2^significant_bits microseconds). Histograms with the same significant_bits
+// merge exactly, e.g. one per thread.
+class DeltaHistogram
+{
+public:
+    explicit DeltaHistogram(unsigned significant_bits = 7); // 1 to 12, 7 is below 1%
+
+    void add(const TimeDelta& x);
+    void add(const TimeDelta* deltas, std::size_t n);
+    void add(const TimeDelta* deltas, std::size_t n, ThreadPool& pool);
+
+    // throws std::invalid_argument unless both have the same significant_bits
+    void merge(const DeltaHistogram& other);
+    void clear();
+
+    unsigned        significant_bits()  const { return bits_; }
+    std::uint64_t   count()             const { return count_; }
+
+    // exact extremes and the value at or below which p percent of the values
+    // are, p in [0, 100]; throw std::out_of_range when the histogram is empty
+    TimeDelta min() const;
+    TimeDelta max() const;
+    TimeDelta percentile(double p) const;
+
+private:
+    unsigned                    bits_;
+    std::size_t                 half_;      // buckets on each side of zero
+    std::vector<std::uint64_t>  counts_;    // negative values from the lowest, then the others
+    std::uint64_t               count_ = 0;
+    std::int64_t                min_ = std::numeric_limits<std::int64_t>::max();
+    std::int64_t                max_ = std::numeric_limits<std::int64_t>::min();
+
+    std::size_t     index(std::int64_t v) const;
+    std::int64_t    value(std::size_t index) const; // middle of the bucket
+};
+
+
+// DeltaSummary impl
+
+namespace detail
+{
+
+using delta_rep = std::chrono::microseconds::rep;
+
+static_assert(sizeof(TimeDelta) == sizeof(delta_rep) && std::is_standard_layout<TimeDelta>::value,
+              "TimeDelta columns are read as arrays of microsecond counts");
+
+// Summary of some rows. The sum is high * 2^32 + low, low < 2^32: each value
+// adds its high 32 bits to high and its low 32 bits to low, which cannot
+// overflow for less than 2^31 rows. mean and m2 (the sum of the squared
+// deviations from mean) are merged as in Chan, Golub and LeVeque (1979).
+struct DeltaPartial
+{
+    std::uint64_t   count   = 0;
+    std::int64_t    high    = 0;
+    std::uint64_t   low     = 0;
+    delta_rep       min     = std::numeric_limits<delta_rep>::max();
+    delta_rep       max     = std::numeric_limits<delta_rep>::min();
+    double          mean    = 0;
+    double          m2      = 0;
+};
+
+// rows per pass: the second pass (squared deviations) reads them from L1
+const std::size_t delta_block = 4096;
+
+inline
+void merge_partial(DeltaPartial& a, const DeltaPartial& b)
+{
+    if (b.count == 0)
+    {
+        return;
+    }
+    if (a.count == 0)
+    {
+        a = b;
+        return;
+    }
+    const double n = static_cast<double>(a.count + b.count);
+    const double delta = b.mean - a.mean;
+    a.mean += delta * static_cast<double>(b.count) / n;
+    a.m2 += b.m2 + delta * delta * static_cast<double>(a.count) * static_cast<double>(b.count) / n;
+    a.count += b.count;
+    a.low += b.low;
+    a.high += b.high + static_cast<std::int64_t>(a.low >> 32);
+    a.low &= 0xffffffff;
+    a.min = std::min(a.min, b.min);
+    a.max = std::max(a.max, b.max);
+}
+
+// Adds the low halves to low, the unsigned high halves to high and counts the
+// negative values, from which the signed high halves follow. Returns the
+// number of rows done, the rest is for the scalar loop.
+#if defined(__AVX512F__)
+
+#if defined(__GNUC__) && !defined(__clang__)
+// gcc 12 warns on _mm512_undefined_epi32() inside the reduction intrinsics
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+inline
+std::size_t delta_sums_simd(const delta_rep* x, std::size_t n, std::uint64_t& low, std::uint64_t& high,
+                            std::uint64_t& negatives, delta_rep& min, delta_rep& max)
+{
+    const __m512i mask = _mm512_set1_epi64(0xffffffff);
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i one = _mm512_set1_epi64(1);
+    __m512i lo = zero, hi = zero, neg = zero;
+    __m512i mn = _mm512_set1_epi64(min), mx = _mm512_set1_epi64(max);
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m512i v = _mm512_loadu_si512(x + i);
+        lo = _mm512_add_epi64(lo, _mm512_and_si512(v, mask));
+        hi = _mm512_add_epi64(hi, _mm512_srli_epi64(v, 32));
+        neg = _mm512_mask_add_epi64(neg, _mm512_cmplt_epi64_mask(v, zero), neg, one);
+        mn = _mm512_min_epi64(mn, v);
+        mx = _mm512_max_epi64(mx, v);
+    }
+    low += static_cast<std::uint64_t>(_mm512_reduce_add_epi64(lo));
+    high += static_cast<std::uint64_t>(_mm512_reduce_add_epi64(hi));
+    negatives += static_cast<std::uint64_t>(_mm512_reduce_add_epi64(neg));
+    min = _mm512_reduce_min_epi64(mn);
+    max = _mm512_reduce_max_epi64(mx);
+    return i;
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#elif defined(__AVX2__)
+
+inline
+std::size_t delta_sums_simd(const delta_rep* x, std::size_t n, std::uint64_t& low, std::uint64_t& high,
+                            std::uint64_t& negatives, delta_rep& min, delta_rep& max)
+{
+    const __m256i mask = _mm256_set1_epi64x(0xffffffff);
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i lo = zero, hi = zero, neg = zero;
+    __m256i mn = _mm256_set1_epi64x(min), mx = _mm256_set1_epi64x(max);
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i));
+        lo = _mm256_add_epi64(lo, _mm256_and_si256(v, mask));
+        hi = _mm256_add_epi64(hi, _mm256_srli_epi64(v, 32));
+        // v < 0: all ones lanes, i.e. -1
+        neg = _mm256_sub_epi64(neg, _mm256_cmpgt_epi64(zero, v));
+        mn = _mm256_blendv_epi8(mn, v, _mm256_cmpgt_epi64(mn, v));
+        mx = _mm256_blendv_epi8(mx, v, _mm256_cmpgt_epi64(v, mx));
+    }
+    alignas(32) std::int64_t lanes[5][4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes[0]), lo);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes[1]), hi);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes[2]), neg);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes[3]), mn);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes[4]), mx);
+    for (int k = 0; k < 4; ++k)
+    {
+        low += static_cast<std::uint64_t>(lanes[0][k]);
+        high += static_cast<std::uint64_t>(lanes[1][k]);
+        negatives += static_cast<std::uint64_t>(lanes[2][k]);
+        min = std::min<delta_rep>(min, lanes[3][k]);
+        max = std::max<delta_rep>(max, lanes[4][k]);
+    }
+    return i;
+}
+
+#else
+
+inline
+std::size_t delta_sums_simd(const delta_rep*, std::size_t, std::uint64_t&, std::uint64_t&,
+                            std::uint64_t&, delta_rep&, delta_rep&)
+{
+    return 0;
+}
+
+#endif
+
+// at most delta_block rows
+inline
+DeltaPartial summarize_block(const delta_rep* x, std::size_t n)
+{
+    DeltaPartial p;
+    if (n == 0)
+    {
+        return p;
+    }
+    std::uint64_t low = 0, high = 0, negatives = 0;
+    delta_rep min = p.min, max = p.max;
+    for (std::size_t i = delta_sums_simd(x, n, low, high, negatives, min, max); i < n; ++i)
+    {
+        const auto u = static_cast<std::uint64_t>(x[i]);
+        low += u & 0xffffffff;
+        high += u >> 32;
+        negatives += x[i] < 0;
+        min = std::min(min, x[i]);
+        max = std::max(max, x[i]);
+    }
+    // the high halves of negative values are 2^32 too large as unsigned
+    high -= negatives << 32;
+    p.count = n;
+    p.high = static_cast<std::int64_t>(high) + static_cast<std::int64_t>(low >> 32);
+    p.low = low & 0xffffffff;
+    p.min = min;
+    p.max = max;
+    p.mean = (static_cast<double>(p.high) * 4294967296.0 + static_cast<double>(p.low)) / static_cast<double>(n);
+
+    // independent sums so that the additions overlap
+    double m0 = 0, m1 = 0, m2 = 0, m3 = 0;
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        const double d0 = static_cast<double>(x[i]) - p.mean;
+        const double d1 = static_cast<double>(x[i + 1]) - p.mean;
+        const double d2 = static_cast<double>(x[i + 2]) - p.mean;
+        const double d3 = static_cast<double>(x[i + 3]) - p.mean;
+        m0 += d0 * d0;
+        m1 += d1 * d1;
+        m2 += d2 * d2;
+        m3 += d3 * d3;
+    }
+    for (; i < n; ++i)
+    {
+        const double d = static_cast<double>(x[i]) - p.mean;
+        m0 += d * d;
+    }
+    p.m2 = (m0 + m1) + (m2 + m3);
+    return p;
+}
+
+// the counts themselves when the layout allows, otherwise converted into buf
+inline
+const delta_rep* delta_ticks(const TimeDelta* values, std::size_t, delta_rep*)
+{
+    return reinterpret_cast<const delta_rep*>(values);
+}
+
+inline
+const delta_rep* delta_ticks(const std::chrono::microseconds* values, std::size_t, delta_rep*)
+{
+    return reinterpret_cast<const delta_rep*>(values);
+}
+
+template <class Rep, class Period>
+inline
+const delta_rep* delta_ticks(const std::chrono::duration<Rep, Period>* values, std::size_t n, delta_rep* buf)
+{
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        buf[i] = TimeDelta(values[i]).to_duration().count();
+    }
+    return buf;
+}
+
+template <class T>
+inline
+void summarize_rows(const T* values, std::size_t begin, std::size_t end, DeltaPartial& out)
+{
+    delta_rep buf[delta_block];
+    for (std::size_t b = begin; b < end; b += delta_block)
+    {
+        const std::size_t n = std::min(delta_block, end - b);
+        merge_partial(out, summarize_block(delta_ticks(values + b, n, buf), n));
+    }
+}
+
+inline
+DeltaSummary finish_summary(const DeltaPartial& p)
+{
+    using std::chrono::microseconds;
+    DeltaSummary s;
+    s.count = static_cast<std::size_t>(p.count);
+    if (p.count == 0)
+    {
+        return s;
+    }
+    const std::int64_t limit = std::int64_t(1) << 31;
+    s.overflow = p.high < -limit || p.high >= limit;
+    if (!s.overflow)
+    {
+        s.sum = TimeDelta(microseconds(p.high * 4294967296 + static_cast<std::int64_t>(p.low)));
+    }
+
+    // (high * 2^32 + low) / count, in two steps of at most 64 bits
+    const auto n = static_cast<std::int64_t>(p.count);
+    const std::int64_t q1 = floor_div(p.high, n);
+    const auto rest = (static_cast<std::uint64_t>(floor_mod(p.high, n)) << 32) + p.low;
+    const std::uint64_t q2 = rest / p.count;
+    const std::uint64_t r2 = rest % p.count;
+    auto mean = static_cast<std::int64_t>((static_cast<std::uint64_t>(q1) << 32) + q2);
+    if (2 * r2 > p.count || (2 * r2 == p.count && (mean & 1) != 0))
+    {
+        ++mean;
+    }
+    s.mean = TimeDelta(microseconds(mean));
+    s.min = TimeDelta(microseconds(p.min));
+    s.max = TimeDelta(microseconds(p.max));
+    s.variance = p.m2 / static_cast<double>(p.count);
+    return s;
+}
+
+template <class T>
+inline
+DeltaSummary describe_rows(const T* values, std::size_t n)
+{
+    DeltaPartial p;
+    summarize_rows(values, 0, n, p);
+    return finish_summary(p);
+}
+
+template <class T>
+inline
+DeltaSummary describe_rows(const T* values, std::size_t n, ThreadPool& pool)
+{
+    std::vector<DeltaPartial> partials(pool.size());
+    pool.parallel_for(n, 16 * delta_block, [&](unsigned worker, std::size_t begin, std::size_t end) {
+        summarize_rows(values, begin, end, partials[worker]);
+    });
+    DeltaPartial p;
+    for (const auto& q : partials)
+    {
+        merge_partial(p, q);
+    }
+    return finish_summary(p);
+}
+
+} // namespace detail
+
+inline
+TimeDelta DeltaSummary::stddev() const
+{
+    return TimeDelta(std::chrono::microseconds(std::llrint(std::sqrt(variance))));
+}
+
+inline
+DeltaSummary describe_column(const TimeDelta* deltas, std::size_t n)
+{
+    return detail::describe_rows(deltas, n);
+}
+
+inline
+DeltaSummary describe_column(const TimeDelta* deltas, std::size_t n, ThreadPool& pool)
+{
+    return detail::describe_rows(deltas, n, pool);
+}
+
+template <class Rep, class Period>
+inline
+DeltaSummary describe_column(const std::chrono::duration<Rep, Period>* durations, std::size_t n)
+{
+    return detail::describe_rows(durations, n);
+}
+
+template <class Rep, class Period>
+inline
+DeltaSummary describe_column(const std::chrono::duration<Rep, Period>* durations, std::size_t n,
+                             ThreadPool& pool)
+{
+    return detail::describe_rows(durations, n, pool);
+}
+
+
+// DeltaHistogram impl
+
+namespace detail
+{
+
+// number of bits needed to write x, 0 for 0
+inline
+unsigned bit_width(std::uint64_t x)
+{
+#if defined(__GNUC__)
+    return x == 0 ? 0 : 64 - static_cast<unsigned>(__builtin_clzll(x));
+#else
+    unsigned n = 0;
+    for (; x != 0; x >>= 1)
+    {
+        ++n;
+    }
+    return n;
+#endif
+}
+
+} // namespace detail
+
+inline
+DeltaHistogram::DeltaHistogram(unsigned significant_bits)
+    : bits_(significant_bits)
+{
+    if (significant_bits < 1 || significant_bits > 12)
+    {
+        throw std::invalid_argument("DeltaHistogram: significant_bits must be 1 to 12");
+    }
+    // 2^bits exact buckets, then 2^(bits - 1) per power of two up to 2^64
+    half_ = (std::size_t(1) << bits_) + (64 - bits_) * (std::size_t(1) << (bits_ - 1));
+    counts_.assign(2 * half_, 0);
+}
+
+inline
+std::size_t DeltaHistogram::index(std::int64_t v) const
+{
+    const std::uint64_t m = v < 0 ? 0 - static_cast<std::uint64_t>(v) : static_cast<std::uint64_t>(v);
+    const std::uint64_t sub_buckets = std::uint64_t(1) << bits_;
+    std::size_t bucket;
+    if (m < sub_buckets)
+    {
+        bucket = static_cast<std::size_t>(m);
+    }
+    else
+    {
+        const unsigned shift = detail::bit_width(m) - bits_;
+        bucket = static_cast<std::size_t>(sub_buckets + (shift - 1) * (sub_buckets >> 1)
+                                          + ((m >> shift) - (sub_buckets >> 1)));
+    }
+    return v < 0 ? half_ - 1 - bucket : half_ + bucket;
+}
+
+inline
+std::int64_t DeltaHistogram::value(std::size_t index) const
+{
+    const bool negative = index < half_;
+    const std::size_t bucket = negative ? half_ - 1 - index : index - half_;
+    const std::uint64_t sub_buckets = std::uint64_t(1) << bits_;
+    std::uint64_t m = bucket;
+    if (bucket >= sub_buckets)
+    {
+        const std::uint64_t half = sub_buckets >> 1;
+        const unsigned shift = static_cast<unsigned>((bucket - sub_buckets) / half + 1);
+        const std::uint64_t low = ((bucket - sub_buckets) % half + half) << shift;
+        m = low + ((std::uint64_t(1) << shift) >> 1);
+    }
+    std::int64_t v;
+    if (negative)
+    {
+        const std::uint64_t most = std::uint64_t(1) << 63;
+        v = m >= most ? std::numeric_limits<std::int64_t>::min() : -static_cast<std::int64_t>(m);
+    }
+    else
+    {
+        v = m > static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max())
+          ? std::numeric_limits<std::int64_t>::max() : static_cast<std::int64_t>(m);
+    }
+    return std::min(std::max(v, min_), max_);
+}
+
+inline
+void DeltaHistogram::add(const TimeDelta& x)
+{
+    const std::int64_t v = x.to_duration().count();
+    ++counts_[index(v)];
+    ++count_;
+    min_ = std::min(min_, v);
+    max_ = std::max(max_, v);
+}
+
+inline
+void DeltaHistogram::add(const TimeDelta* deltas, std::size_t n)
+{
+    std::int64_t lo = min_, hi = max_;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        const std::int64_t v = deltas[i].to_duration().count();
+        ++counts_[index(v)];
+        lo = std::min(lo, v);
+        hi = std::max(hi, v);
+    }
+    count_ += n;
+    min_ = lo;
+    max_ = hi;
+}
+
+inline
+void DeltaHistogram::add(const TimeDelta* deltas, std::size_t n, ThreadPool& pool)
+{
+    std::vector<DeltaHistogram> parts(pool.size(), DeltaHistogram(bits_));
+    pool.parallel_for(n, 65536, [&](unsigned worker, std::size_t begin, std::size_t end) {
+        parts[worker].add(deltas + begin, end - begin);
+    });
+    for (const auto& part : parts)
+    {
+        merge(part);
+    }
+}
+
+inline
+void DeltaHistogram::merge(const DeltaHistogram& other)
+{
+    if (other.bits_ != bits_)
+    {
+        throw std::invalid_argument("DeltaHistogram: merge with different significant_bits");
+    }
+    for (std::size_t i = 0; i < counts_.size(); ++i)
+    {
+        counts_[i] += other.counts_[i];
+    }
+    count_ += other.count_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+}
+
+inline
+void DeltaHistogram::clear()
+{
+    std::fill(counts_.begin(), counts_.end(), 0);
+    count_ = 0;
+    min_ = std::numeric_limits<std::int64_t>::max();
+    max_ = std::numeric_limits<std::int64_t>::min();
+}
+
+inline
+TimeDelta DeltaHistogram::min() const
+{
+    if (count_ == 0)
+    {
+        throw std::out_of_range("DeltaHistogram: empty");
+    }
+    return TimeDelta(std::chrono::microseconds(min_));
+}
+
+inline
+TimeDelta DeltaHistogram::max() const
+{
+    if (count_ == 0)
+    {
+        throw std::out_of_range("DeltaHistogram: empty");
+    }
+    return TimeDelta(std::chrono::microseconds(max_));
+}
+
+inline
+TimeDelta DeltaHistogram::percentile(double p) const
+{
+    if (count_ == 0)
+    {
+        throw std::out_of_range("DeltaHistogram: empty");
+    }
+    if (!(p > 0))
+    {
+        return min();
+    }
+    if (p >= 100)
+    {
+        return max();
+    }
+    // the rank-th smallest value, rank from 1
+    auto rank = static_cast<std::uint64_t>(std::ceil(p / 100 * static_cast<double>(count_)));
+    rank = std::min(std::max<std::uint64_t>(rank, 1), count_);
+    std::uint64_t seen = 0;
+    std::size_t i = 0;
+    for (; i + 1 < counts_.size(); ++i)
+    {
+        seen += counts_[i];
+        if (seen >= rank)
+        {
+            break;
+        }
+    }
+    return TimeDelta(std::chrono::microseconds(value(i)));
+}
+
+} // namespace datetime
+
+#endif // DATETIME_STATS_H
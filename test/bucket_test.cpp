@@ -0,0 +1,232 @@
+#include "lest.h"
+#define CASE( name ) lest_CASE( specification(), name )
+extern lest::tests & specification();
+
+#include "bucket.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+
+using namespace datetime;
+using namespace std::chrono;
+
+const BucketUnit units[] = {BucketUnit::minute, BucketUnit::hour, BucketUnit::day, BucketUnit::week,
+                            BucketUnit::month};
+
+date::sys_seconds utc(int y, unsigned m, unsigned d, int h = 0, int mi = 0, int s = 0)
+{
+    return date::sys_days(date::year(y)/m/d) + hours(h) + minutes(mi) + seconds(s);
+}
+
+// the local unit of a local time, by date.h
+date::local_seconds local_unit(date::local_seconds t, BucketUnit unit)
+{
+    switch (unit)
+    {
+    case BucketUnit::minute:
+        return date::floor<minutes>(t);
+    case BucketUnit::hour:
+        return date::floor<hours>(t);
+    case BucketUnit::day:
+        return date::floor<date::days>(t);
+    case BucketUnit::week:
+        {
+            auto d = date::floor<date::days>(t);
+            return d - (date::weekday(d) - date::mon);
+        }
+    case BucketUnit::month:
+    default:
+        {
+            date::year_month_day ymd(date::floor<date::days>(t));
+            return date::local_days(ymd.year()/ymd.month()/1);
+        }
+    }
+}
+
+
+CASE("LocalBuckets UTC" "[bucket]")
+{
+    const auto t = utc(2017, 3, 15, 13, 47, 31) + milliseconds(250);
+    LocalBuckets minute(nullptr, BucketUnit::minute);
+    LocalBuckets hour(nullptr, BucketUnit::hour);
+    LocalBuckets day(nullptr, BucketUnit::day);
+    LocalBuckets week(nullptr, BucketUnit::week);
+    LocalBuckets month(nullptr, BucketUnit::month);
+
+    EXPECT(minute.floor(t) == utc(2017, 3, 15, 13, 47));
+    EXPECT(hour.floor(t) == utc(2017, 3, 15, 13));
+    EXPECT(day.floor(t) == utc(2017, 3, 15));
+    EXPECT(week.floor(t) == utc(2017, 3, 13));
+    EXPECT(month.floor(t) == utc(2017, 3, 1));
+
+    EXPECT(minute.ceil(t) == utc(2017, 3, 15, 13, 48));
+    EXPECT(hour.ceil(t) == utc(2017, 3, 15, 14));
+    EXPECT(day.ceil(t) == utc(2017, 3, 16));
+    EXPECT(week.ceil(t) == utc(2017, 3, 20));
+    EXPECT(month.ceil(t) == utc(2017, 4, 1));
+    EXPECT(month.ceil(utc(2016, 12, 31, 23, 59, 59)) == utc(2017, 1, 1));
+    EXPECT(month.ceil(utc(2017, 3, 1)) == utc(2017, 3, 1));
+
+    EXPECT(minute.round(t) == utc(2017, 3, 15, 13, 48));
+    EXPECT(hour.round(t) == utc(2017, 3, 15, 14));
+    EXPECT(day.round(t) == utc(2017, 3, 16));
+    EXPECT(week.round(t) == utc(2017, 3, 13));
+    EXPECT(month.round(t) == utc(2017, 3, 1));
+    EXPECT(month.round(utc(2017, 2, 15)) == utc(2017, 3, 1));
+
+    // ties to the even unit since the epoch
+    EXPECT(minute.round(utc(1970, 1, 1, 0, 0, 30)) == utc(1970, 1, 1));
+    EXPECT(minute.round(utc(1970, 1, 1, 0, 1, 30)) == utc(1970, 1, 1, 0, 2));
+    EXPECT(minute.round(utc(1969, 12, 31, 23, 59, 30)) == utc(1970, 1, 1));
+    EXPECT(week.floor(utc(1970, 1, 1)) == utc(1969, 12, 29));
+    EXPECT(week.floor(utc(1969, 12, 28, 23)) == utc(1969, 12, 22));
+    EXPECT(month.floor(utc(1600, 2, 29, 12)) == utc(1600, 2, 1));
+    EXPECT(month.ceil(utc(1600, 2, 29, 12)) == utc(1600, 3, 1));
+}
+
+
+CASE("LocalBuckets UTC matches date.h" "[bucket]")
+{
+    for (auto unit : units)
+    {
+        LocalBuckets buckets(nullptr, unit);
+        for (auto t = utc(1965, 1, 1); t < utc(1975, 1, 1); t += seconds(86400 * 3 + 3607))
+        {
+            const auto lo = local_unit(date::local_seconds(t.time_since_epoch()), unit).time_since_epoch();
+            EXPECT(buckets.floor(t).time_since_epoch() == lo);
+            EXPECT(buckets.ceil(t) >= t);
+            EXPECT(buckets.floor(buckets.ceil(t)) == buckets.ceil(t));
+        }
+    }
+}
+
+
+CASE("bucket columns" "[bucket]")
+{
+    std::vector<date::sys_time<milliseconds>> times;
+    std::uint64_t x = 88172645463325252ULL;
+    for (int i = 0; i < 20000; ++i)
+    {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        times.push_back(date::sys_time<milliseconds>(utc(2000, 1, 1)) + milliseconds(x % 1000000000000));
+    }
+    std::vector<date::sys_time<milliseconds>> sorted(times);
+    std::sort(sorted.begin(), sorted.end());
+
+    for (auto unit : units)
+    {
+        std::vector<date::sys_time<milliseconds>> out(times.size());
+        floor_column(times.data(), times.size(), nullptr, unit, out.data());
+        for (std::size_t i = 0; i < times.size(); ++i)
+        {
+            EXPECT(out[i] == LocalBuckets(nullptr, unit).floor(times[i]));
+        }
+        ceil_column(times.data(), times.size(), nullptr, unit, out.data());
+        for (std::size_t i = 0; i < times.size(); ++i)
+        {
+            EXPECT(out[i] == LocalBuckets(nullptr, unit).ceil(times[i]));
+        }
+        round_column(times.data(), times.size(), nullptr, unit, out.data());
+        for (std::size_t i = 0; i < times.size(); ++i)
+        {
+            EXPECT(out[i] == LocalBuckets(nullptr, unit).round(times[i]));
+        }
+
+        // in place, sorted
+        out = sorted;
+        floor_column(out.data(), out.size(), nullptr, unit, out.data());
+        for (std::size_t i = 0; i < sorted.size(); ++i)
+        {
+            EXPECT(out[i] == LocalBuckets(nullptr, unit).floor(sorted[i]));
+        }
+    }
+}
+
+
+CASE("LocalBuckets transitions" "[bucket]")
+{
+    // Paris: 2017-03-26 02:00 CET -> 03:00 CEST, 2017-10-29 03:00 CEST -> 02:00 CET
+    LocalBuckets day(date::locate_zone("Europe/Paris"), BucketUnit::day);
+    EXPECT(day.floor(utc(2017, 3, 26, 10)) == utc(2017, 3, 25, 23));
+    EXPECT(day.ceil(utc(2017, 3, 26, 10)) == utc(2017, 3, 26, 22));
+    EXPECT(day.floor(utc(2017, 3, 26, 0, 30)) == utc(2017, 3, 25, 23));
+    EXPECT(day.floor(utc(2017, 10, 29, 12)) == utc(2017, 10, 28, 22));
+    EXPECT(day.ceil(utc(2017, 10, 28, 22, 0, 1)) == utc(2017, 10, 29, 23));
+    EXPECT(day.round(utc(2017, 10, 29, 10, 30)) == utc(2017, 10, 28, 22));
+    EXPECT(day.round(utc(2017, 10, 29, 10, 31)) == utc(2017, 10, 29, 23));
+
+    // the hour repeated is two buckets, the hour skipped none
+    LocalBuckets hour(date::locate_zone("Europe/Paris"), BucketUnit::hour);
+    EXPECT(hour.floor(utc(2017, 10, 29, 0, 30)) == utc(2017, 10, 29, 0));
+    EXPECT(hour.ceil(utc(2017, 10, 29, 0, 30)) == utc(2017, 10, 29, 1));
+    EXPECT(hour.floor(utc(2017, 10, 29, 1, 30)) == utc(2017, 10, 29, 1));
+    EXPECT(hour.ceil(utc(2017, 3, 26, 0, 59)) == utc(2017, 3, 26, 1));
+    EXPECT(hour.floor(utc(2017, 3, 26, 1, 30)) == utc(2017, 3, 26, 1));
+
+    LocalBuckets month(date::locate_zone("Europe/Paris"), BucketUnit::month);
+    EXPECT(month.floor(utc(2017, 3, 31, 12)) == utc(2017, 2, 28, 23));
+    EXPECT(month.ceil(utc(2017, 3, 31, 12)) == utc(2017, 3, 31, 22));
+    LocalBuckets week(date::locate_zone("Europe/Paris"), BucketUnit::week);
+    EXPECT(week.floor(utc(2017, 3, 26, 12)) == utc(2017, 3, 19, 23));
+    EXPECT(week.ceil(utc(2017, 3, 26, 12)) == utc(2017, 3, 26, 22));
+
+    // Sao Paulo: 2018-02-18 00:00 -02 -> 2018-02-17 23:00 -03, 2018-11-04 00:00 -03 -> 01:00 -02
+    LocalBuckets sp(date::locate_zone("America/Sao_Paulo"), BucketUnit::day);
+    EXPECT(sp.floor(utc(2018, 2, 18, 2, 30)) == utc(2018, 2, 17, 2));
+    EXPECT(sp.ceil(utc(2018, 2, 18, 2, 30)) == utc(2018, 2, 18, 3));
+    EXPECT(sp.floor(utc(2018, 11, 4, 14)) == utc(2018, 11, 4, 3));
+    EXPECT(sp.ceil(utc(2018, 11, 3, 14)) == utc(2018, 11, 4, 3));
+
+    // Lord Howe: 2017-04-02 02:00 +11 -> 01:30 +10:30, local 01:00 lasts 90 minutes
+    LocalBuckets lh(date::locate_zone("Australia/Lord_Howe"), BucketUnit::hour);
+    EXPECT(lh.floor(utc(2017, 4, 1, 15, 15)) == utc(2017, 4, 1, 14));
+    EXPECT(lh.ceil(utc(2017, 4, 1, 14, 15)) == utc(2017, 4, 1, 15, 30));
+
+    // Kolkata: hours are half past in UTC
+    LocalBuckets in(date::locate_zone("Asia/Kolkata"), BucketUnit::hour);
+    EXPECT(in.floor(utc(2017, 1, 1, 12, 10)) == utc(2017, 1, 1, 11, 30));
+}
+
+
+CASE("LocalBuckets transitions match date.h" "[bucket]")
+{
+    for (auto name : {"Europe/Paris", "America/Sao_Paulo", "Australia/Lord_Howe", "America/St_Johns",
+                      "Asia/Kolkata", "Pacific/Apia"})
+    {
+        const auto zone = date::locate_zone(name);
+        for (auto unit : units)
+        {
+            // sorted, then each with a fresh cache
+            std::vector<date::sys_seconds> times;
+            for (auto t = utc(2011, 3, 1); t < utc(2012, 6, 1); t += seconds(1753))
+            {
+                times.push_back(t);
+            }
+            std::vector<date::sys_seconds> lo(times.size()), hi(times.size());
+            floor_column(times.data(), times.size(), zone, unit, lo.data());
+            ceil_column(times.data(), times.size(), zone, unit, hi.data());
+            for (std::size_t i = 0; i < times.size(); ++i)
+            {
+                const auto t = times[i];
+                LocalBuckets buckets(zone, unit);
+                EXPECT(buckets.floor(t) == lo[i]);
+                EXPECT(lo[i] <= t);
+                EXPECT(t <= hi[i]);
+                EXPECT((hi[i] == lo[i]) == (t == lo[i]));
+                EXPECT(LocalBuckets(zone, unit).floor(lo[i]) == lo[i]);
+                EXPECT(LocalBuckets(zone, unit).floor(hi[i]) == hi[i]);
+                EXPECT((i == 0 || lo[i - 1] <= lo[i]));
+                const auto local = date::make_zoned(zone, t).get_local_time();
+                const auto start = date::make_zoned(zone, lo[i]).get_local_time();
+                EXPECT(local_unit(start, unit) == local_unit(local, unit));
+            }
+        }
+    }
+}
+
+} // anonymous namespace
@@ -0,0 +1,160 @@
+#include "lest.h"
+#define CASE( name ) lest_CASE( specification(), name )
+extern lest::tests & specification();
+
+#include "bulk.h"
+
+namespace 
+{
+
+using namespace datetime;
+using namespace std::chrono;
+
+
+CASE("strptime_column" "[bulk]") 
+{
+    std::vector<std::string> column = {
+        "2017-06-21 16:30:05", "garbage", "2017-06-21 16:30:05.25", "2017-13-01 00:00:00", "1970-01-01 00:00:01"
+    };
+    std::vector<date::sys_time<milliseconds>> out(column.size());
+    bool errors[5];
+
+    auto failed = strptime_column(column.data(), column.size(), Format("%Y-%m-%d %H:%M:%S"), nullptr,
+                                  out.data(), errors);
+    EXPECT(failed == 2u);
+    EXPECT(!errors[0]);
+    EXPECT(errors[1]);
+    EXPECT(errors[3]);
+    EXPECT(out[0] == date::sys_days(date::year(2017)/6/21) + seconds(16*3600 + 30*60 + 5));
+    EXPECT(out[2] == out[0] + milliseconds(250));
+    EXPECT(out[4] == date::sys_time<milliseconds>(seconds(1)));
+}
+
+
+CASE("strptime_column with offsets" "[bulk]") 
+{
+    std::vector<std::string> column = { "2017-06-12 09:28:10 +0200", "2017-06-12 02:28:10 -05:00" };
+    std::vector<date::sys_seconds> out(column.size());
+    bool errors[2];
+
+    auto failed = strptime_column(column.data(), column.size(), Format("%F %T %z"), nullptr,
+                                  out.data(), errors);
+    EXPECT(failed == 0u);
+    EXPECT(out[0] == date::sys_days(date::year(2017)/6/12) + seconds(7*3600 + 28*60 + 10));
+    EXPECT(out[1] == out[0]);
+}
+
+
+CASE("parallel strptime_column" "[bulk]") 
+{
+    const std::size_t n = 100000;
+    std::vector<std::string> column(n);
+    auto start = date::sys_days(date::year(2000)/1/1);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        column[i] = i % 97 == 0 ? "bad" : date::format("%F %T", start + minutes(37 * i));
+    }
+    std::vector<date::sys_seconds> out(n);
+    std::unique_ptr<bool[]> errors(new bool[n]);
+
+    ThreadPool pool(4);
+    auto failed = strptime_column(column.data(), n, Format("%F %T"), nullptr, out.data(), errors.get(), pool);
+
+    EXPECT(failed == (n + 96) / 97);
+    bool all = true;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        all = all && errors[i] == (i % 97 == 0) && (errors[i] || out[i] == start + minutes(37 * i));
+    }
+    EXPECT(all);
+}
+
+
+CASE("parallel_for covers the range once" "[bulk]") 
+{
+    ThreadPool pool(3);
+    std::vector<int> hits(10007, 0);
+    pool.parallel_for(hits.size(), 64, [&](unsigned, std::size_t begin, std::size_t end) {
+        for (auto i = begin; i < end; ++i)
+        {
+            ++hits[i];
+        }
+    });
+    EXPECT(std::count(hits.begin(), hits.end(), 1) == static_cast<long>(hits.size()));
+
+    EXPECT_THROWS_AS(pool.parallel_for(1000, 10, [](unsigned, std::size_t begin, std::size_t) {
+        if (begin >= 500) throw std::runtime_error("boom");
+    }), std::runtime_error);
+}
+
+
+CASE("parallel_for from several threads" "[bulk]") 
+{
+    ThreadPool pool(3);
+    std::vector<std::vector<int>> hits(4, std::vector<int>(5003, 0));
+    std::vector<std::thread> callers;
+    for (auto& h : hits)
+    {
+        callers.emplace_back([&pool, &h] {
+            for (int round = 0; round < 20; ++round)
+            {
+                pool.parallel_for(h.size(), 16, [&](unsigned, std::size_t begin, std::size_t end) {
+                    for (auto i = begin; i < end; ++i)
+                    {
+                        ++h[i];
+                    }
+                });
+            }
+        });
+    }
+    for (auto& t : callers)
+    {
+        t.join();
+    }
+    for (const auto& h : hits)
+    {
+        EXPECT(std::count(h.begin(), h.end(), 20) == static_cast<long>(h.size()));
+    }
+}
+
+
+CASE("strftime_column" "[bulk]") 
+{
+    std::vector<date::sys_time<milliseconds>> times = {
+        date::sys_days(date::year(2017)/6/21) + hours(16) + milliseconds(250),
+        date::sys_days(date::year(1970)/1/1)
+    };
+    TextColumn text;
+    strftime_column(times.data(), times.size(), Format("%F %T %Z"), nullptr, '\n', text);
+    EXPECT(text.join() == "2017-06-21 16:00:00.250 UTC\n1970-01-01 00:00:00.000 UTC\n");
+    EXPECT(text.size() == 56u);
+
+    // rows longer than the first one
+    strftime_column(times.data(), times.size(), Format("%B %d"), nullptr, ',', text);
+    EXPECT(text.join() == "June 21,January 01,");
+
+    strftime_column(times.data(), 0, Format("%F"), nullptr, ',', text);
+    EXPECT(text.chunks.empty());
+}
+
+
+CASE("parallel strftime_column" "[bulk]") 
+{
+    const std::size_t n = 100000;
+    std::vector<date::sys_seconds> times(n);
+    std::string expected;
+    auto start = date::sys_days(date::year(2000)/1/1);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        times[i] = start + minutes(37 * i);
+        expected += date::format("%A %F %T", times[i]) + ';';
+    }
+
+    ThreadPool pool(4);
+    TextColumn text;
+    strftime_column(times.data(), n, Format("%A %F %T"), nullptr, ';', text, pool);
+    EXPECT(text.chunks.size() > 1u);
+    EXPECT(text.join() == expected);
+}
+
+}
@@ -0,0 +1,190 @@
+#include "lest.h"
+#define CASE( name ) lest_CASE( specification(), name )
+extern lest::tests & specification();
+
+#include "business.h"
+
+#include <memory>
+#include <set>
+#include <vector>
+
+namespace
+{
+
+using namespace datetime;
+
+std::vector<Date> holidays()
+{
+    // some French holidays, a few on weekends
+    std::vector<Date> v;
+    for (int y = 2015; y <= 2019; ++y)
+    {
+        for (auto md : {date::jan/1, date::may/1, date::may/8, date::jul/14, date::aug/15, date::nov/1,
+                        date::nov/11, date::dec/25})
+        {
+            v.push_back(Date(date::year(y)/md));
+        }
+    }
+    v.push_back(Date(date::year(2017)/4/17));
+    v.push_back(Date(date::year(2017)/5/25));
+    v.push_back(Date(date::year(2017)/6/5));
+    return v;
+}
+
+// the loops replaced by BusinessCalendar
+struct Loop
+{
+    std::set<Date> holidays;
+    unsigned weekend;
+
+    bool business(const Date& d) const
+    {
+        return ((weekend >> static_cast<unsigned>(d.objweekday())) & 1) == 0 && holidays.count(d) == 0;
+    }
+};
+
+
+CASE("BusinessCalendar" "[business]")
+{
+    BusinessCalendar cal({date::sat, date::sun}, holidays());
+    EXPECT(cal.weekend_mask() == 0x41u);
+    EXPECT(cal.is_business_day(Date(date::year(2017)/7/13)));
+    EXPECT(!cal.is_business_day(Date(date::year(2017)/7/14)));
+    EXPECT(!cal.is_business_day(Date(date::year(2017)/7/15)));
+    EXPECT(!cal.is_business_day(SerialDate(Date(date::year(2017)/5/1))));
+
+    // T+2 over a bridge: Thursday 2017-07-13, holiday on Friday
+    EXPECT(cal.add_business_days(Date(date::year(2017)/7/13), 2) == Date(date::year(2017)/7/18));
+    EXPECT(cal.add_business_days(Date(date::year(2017)/7/18), -2) == Date(date::year(2017)/7/13));
+    EXPECT(cal.add_business_days(Date(date::year(2017)/7/15), 0) == Date(date::year(2017)/7/17));
+    EXPECT(cal.add_business_days(Date(date::year(2017)/7/17), 0) == Date(date::year(2017)/7/17));
+    EXPECT(cal.next(Date(date::year(2017)/7/13)) == Date(date::year(2017)/7/17));
+    EXPECT(cal.prev(Date(date::year(2017)/7/17)) == Date(date::year(2017)/7/13));
+    EXPECT(cal.next(SerialDate(Date(date::year(2016)/12/30))) == SerialDate(Date(date::year(2017)/1/2)));
+
+    // a weekend start is rolled forward first, as numpy.busday_offset(roll='forward')
+    EXPECT(cal.add_business_days(Date(date::year(2017)/1/7), 1) == Date(date::year(2017)/1/10));
+    EXPECT(cal.add_business_days(SerialDate(Date(date::year(2017)/1/8)), 2) == SerialDate(Date(date::year(2017)/1/11)));
+    EXPECT(cal.add_business_days(Date(date::year(2017)/1/7), -1) == Date(date::year(2017)/1/6));
+    EXPECT(cal.next(Date(date::year(2017)/1/7)) == Date(date::year(2017)/1/9));
+    EXPECT(cal.prev(Date(date::year(2017)/1/8)) == Date(date::year(2017)/1/6));
+    // Ascension Thursday 2017-05-25
+    EXPECT(cal.add_business_days(Date(date::year(2017)/5/24), 1) == Date(date::year(2017)/5/26));
+
+    EXPECT(cal.business_days_between(Date(date::year(2017)/7/1), Date(date::year(2017)/8/1)) == 20);
+    EXPECT(cal.business_days_between(Date(date::year(2017)/8/1), Date(date::year(2017)/7/1)) == -20);
+    EXPECT(cal.business_days_between(Date(date::year(2017)/1/1), Date(date::year(2018)/1/1)) == 260 - 9);
+    EXPECT(cal.business_days_between(Date(date::year(2017)/7/14), Date(date::year(2017)/7/14)) == 0);
+    // no holidays out of 2015 to 2019
+    EXPECT(cal.business_days_between(Date(date::year(2030)/1/7), Date(date::year(2030)/1/14)) == 5);
+    EXPECT(cal.add_business_days(Date(date::year(1990)/1/5), 1) == Date(date::year(1990)/1/8));
+
+    cal.add_holiday(Date(date::year(2022)/7/14));
+    EXPECT(!cal.is_business_day(Date(date::year(2022)/7/14)));
+    EXPECT(cal.business_days_between(Date(date::year(2022)/7/11), Date(date::year(2022)/7/18)) == 4);
+    EXPECT(cal.business_days_between(Date(date::year(2010)/1/1), Date(date::year(2030)/1/1))
+           == BusinessCalendar().business_days_between(Date(date::year(2010)/1/1), Date(date::year(2030)/1/1)) - 34);
+
+    EXPECT_THROWS_AS(BusinessCalendar({date::sun, date::mon, date::tue, date::wed, date::thu, date::fri, date::sat}),
+                     std::invalid_argument);
+}
+
+
+CASE("BusinessCalendar matches a loop" "[business]")
+{
+    const std::vector<std::vector<date::weekday>> weekends = {
+        {date::sat, date::sun}, {date::fri, date::sat}, {date::sun}, {}, {date::mon, date::wed, date::fri, date::sat}
+    };
+    for (const auto& weekend : weekends)
+    {
+        BusinessCalendar cal(weekend, holidays());
+        Loop loop{std::set<Date>(), 0};
+        for (const auto& wd : weekend)
+        {
+            loop.weekend |= 1u << static_cast<unsigned>(wd);
+        }
+        for (const auto& d : holidays())
+        {
+            loop.holidays.insert(d);
+        }
+
+        const auto first = SerialDate(Date(date::year(2014)/12/1)).serial();
+        const auto last = SerialDate(Date(date::year(2020)/2/1)).serial();
+        bool same = true;
+        std::int64_t count = 0;
+        for (auto n = first; n < last; ++n)
+        {
+            const auto d = SerialDate(n).date();
+            same = same && cal.is_business_day(d) == loop.business(d);
+            same = same && cal.business_days_between(SerialDate(first), SerialDate(n)) == count;
+            count += loop.business(d);
+
+            for (std::int32_t k : {-40, -3, -1, 0, 1, 2, 7, 23})
+            {
+                // the loop: roll forward, then step a day at a time, counting business days
+                auto x = d;
+                while (!loop.business(x))
+                {
+                    x = x + TimeDelta(date::days(1));
+                }
+                for (std::int32_t left = k; left != 0;)
+                {
+                    x = x + TimeDelta(date::days(left > 0 ? 1 : -1));
+                    if (loop.business(x))
+                    {
+                        left += left > 0 ? -1 : 1;
+                    }
+                }
+                same = same && cal.add_business_days(d, k) == x;
+            }
+
+            auto after = d + TimeDelta(date::days(1));
+            while (!loop.business(after))
+            {
+                after = after + TimeDelta(date::days(1));
+            }
+            auto before = d - TimeDelta(date::days(1));
+            while (!loop.business(before))
+            {
+                before = before - TimeDelta(date::days(1));
+            }
+            same = same && cal.next(d) == after && cal.prev(d) == before;
+        }
+        EXPECT(same);
+    }
+}
+
+
+CASE("BusinessCalendar columns" "[business]")
+{
+    BusinessCalendar cal({date::sat, date::sun}, holidays());
+    std::vector<Date> dates;
+    std::vector<SerialDate> serial;
+    for (int i = 0; i < 2000; ++i)
+    {
+        serial.push_back(SerialDate(Date(date::year(2015)/1/1)) + date::days(i * 7 % 1811));
+        dates.push_back(serial.back().date());
+    }
+    const auto n = dates.size();
+
+    std::unique_ptr<bool[]> flags(new bool[n]);
+    cal.is_business_day(dates.data(), n, flags.get());
+    std::vector<Date> t2(n);
+    cal.add_business_days(dates.data(), n, 2, t2.data());
+    std::vector<SerialDate> t2_serial(serial);
+    cal.add_business_days(t2_serial.data(), n, 2, t2_serial.data());
+    std::vector<std::int64_t> between(n), between_serial(n);
+    cal.business_days_between(dates.data(), t2.data(), n, between.data());
+    cal.business_days_between(serial.data(), t2_serial.data(), n, between_serial.data());
+
+    bool same = true;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        same = same && flags[i] == cal.is_business_day(dates[i]);
+        same = same && t2[i] == cal.add_business_days(dates[i], 2) && t2_serial[i] == SerialDate(t2[i]);
+        same = same && between[i] == 2 && between_serial[i] == between[i];
+    }
+    EXPECT(same);
+}
+
+} // anonymous namespace
@@ -0,0 +1,85 @@
+#include "lest.h"
+#define CASE( name ) lest_CASE( specification(), name )
+extern lest::tests & specification();
+
+#include "calendar.h"
+
+#include <vector>
+
+namespace 
+{
+
+using namespace datetime;
+
+
+CASE("civil_from_days" "[calendar]") 
+{
+    std::int32_t days[] = {0, -1, 17338, 11016, -719468, 59, 60};
+    std::int32_t year[7];
+    unsigned char month[7], day[7];
+    civil_from_days(days, 7, year, month, day);
+    EXPECT((year[0] == 1970 && month[0] == 1 && day[0] == 1));
+    EXPECT((year[1] == 1969 && month[1] == 12 && day[1] == 31));
+    EXPECT((year[2] == 2017 && month[2] == 6 && day[2] == 21));
+    EXPECT((year[3] == 2000 && month[3] == 2 && day[3] == 29));
+    EXPECT((year[4] == 0 && month[4] == 3 && day[4] == 1));
+    EXPECT((year[5] == 1970 && month[5] == 3 && day[5] == 1));
+    EXPECT((year[6] == 1970 && month[6] == 3 && day[6] == 2));
+}
+
+
+CASE("civil columns match date" "[calendar]") 
+{
+    // every 7th day of the range of date::year, both ways
+    auto first = date::sys_days(date::year::min()/1/1).time_since_epoch().count();
+    auto last = date::sys_days(date::year::max()/12/31).time_since_epoch().count();
+    std::vector<std::int32_t> days;
+    for (auto d = first; d <= last; d += 7)
+    {
+        days.push_back(d);
+    }
+    days.push_back(last);
+    auto n = days.size();
+    std::vector<std::int32_t> year(n), back(n);
+    std::vector<unsigned char> month(n), day(n);
+    civil_from_days(days.data(), n, year.data(), month.data(), day.data());
+    days_from_civil(year.data(), month.data(), day.data(), n, back.data());
+
+    bool same = true;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        date::year_month_day ymd{date::sys_days{date::days{days[i]}}};
+        same = same && static_cast<int>(ymd.year()) == year[i] && static_cast<unsigned>(ymd.month()) == month[i] &&
+               static_cast<unsigned>(ymd.day()) == day[i] && back[i] == days[i];
+    }
+    EXPECT(same);
+}
+
+CASE("week date and day of year columns" "[calendar]") 
+{
+    // every 3rd day of the range of date::year, but the last days of its last week
+    auto first = date::sys_days(date::year::min()/1/1).time_since_epoch().count();
+    auto last = date::sys_days(date::year::max()/12/28).time_since_epoch().count();
+    std::vector<std::int32_t> days;
+    for (auto d = first; d <= last; d += 3)
+    {
+        days.push_back(d);
+    }
+    auto n = days.size();
+    std::vector<std::int32_t> year(n);
+    std::vector<unsigned char> week(n), weekday(n);
+    std::vector<unsigned short> yday(n);
+    iso_from_days(days.data(), n, year.data(), week.data(), weekday.data());
+    dayofyear_from_days(days.data(), n, yday.data());
+
+    bool same = true;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        auto iso = SerialDate(days[i]).isocalendar();
+        same = same && iso.year == year[i] && iso.week == week[i] && iso.weekday == weekday[i] &&
+               SerialDate(days[i]).dayofyear() == yday[i];
+    }
+    EXPECT(same);
+}
+
+} // anonymous namespace
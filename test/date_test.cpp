@@ -45,7 +45,129 @@ CASE("operation" "[date]")
     auto delta = TimeDelta(date::weeks(1), date::days(2)); // + 9 days
     
     EXPECT(d1 + delta == Date(date::year(2017)/6/19));
+    // only the days count, as in Python: one hour back is the day before
+    EXPECT(d1 + TimeDelta(std::chrono::hours(-1)) == Date(date::year(2017)/6/9));
 }
 
+
+CASE("ctime" "[date]") 
+{
+    auto d = Date(date::year(2017)/6/21);
+    EXPECT(d.ctime() == "Wed Jun 21 00:00:00 2017");
+    EXPECT(Date(date::year(2017)/6/4).ctime() == "Sun Jun  4 00:00:00 2017");
+}
+
+
+CASE("c locale names" "[date]") 
+{
+    std::ostringstream os;
+    os << date::c_locale_names;
+    date::to_stream(os, "%A %B %x %r", date::sys_days(date::year(2017)/6/21) + std::chrono::hours(15));
+    EXPECT(os.str() == "Wednesday June 06/21/17 03:00:00 PM");
+
+    std::ostringstream nomonth;
+    nomonth << date::c_locale_names;
+    date::to_stream(nomonth, "%b %B", date::month(13));
+    EXPECT(nomonth.fail());
+    EXPECT(nomonth.str() == "");
+
+    std::ostringstream noc;
+    noc << date::c_locale_names;
+    date::to_stream(noc, "%c", date::fields<std::chrono::seconds>{date::year(2017)/13/21, date::weekday(3u)});
+    EXPECT(noc.fail());
+
+    std::istringstream is("wednesday, jun 21 2017 03:04:05 pm");
+    is >> date::c_locale_names;
+    date::sys_seconds tp;
+    is >> date::parse("%a, %b %d %Y %I:%M:%S %p", tp);
+    EXPECT(!is.fail());
+    EXPECT(tp == date::sys_days(date::year(2017)/6/21) + std::chrono::seconds(15*3600 + 4*60 + 5));
+
+    std::istringstream bad("Wed Jux 21 00:00:00 2017");
+    bad >> date::c_locale_names;
+    bad >> date::parse("%c", tp);
+    EXPECT(bad.fail());
+
+    std::istringstream c("Wed Jun 21 15:04:05 2017");
+    c >> date::c_locale_names;
+    c >> date::parse("%c", tp);
+    EXPECT(!c.fail());
+    EXPECT(tp == date::sys_days(date::year(2017)/6/21) + std::chrono::seconds(15*3600 + 4*60 + 5));
 }
 
+
+CASE("format_to" "[date]") 
+{
+    auto d = Date(date::year(2017)/6/21);
+    std::string s = "date: ";
+    format_to(std::back_inserter(s), d);
+    EXPECT(s == "date: " + to_string(d));
+
+    std::vector<char> v;
+    format_to(std::back_inserter(v), d, Format("%A %d %B %Y"));
+    EXPECT(std::string(v.begin(), v.end()) == "Wednesday 21 June 2017");
+
+    char buf[8];
+    auto r = format_to_n(buf, sizeof(buf), d);
+    EXPECT(std::string(buf, r.out) == "2017-06-");
+    EXPECT(r.size == 10u);
+}
+
+CASE("ordering" "[date]") 
+{
+    auto d = Date(date::year(2017)/6/21);
+    auto e = Date(date::year(2017)/7/1);
+    EXPECT(d != e);
+    EXPECT(d < e);
+    EXPECT(d <= e);
+    EXPECT(e > d);
+    EXPECT(e >= d);
+    EXPECT(d <= d);
+    EXPECT(!(d < d));
+}
+
+CASE("isocalendar and ordinals" "[date]") 
+{
+    auto d = Date(date::year(2017)/6/21);
+    EXPECT((d.isocalendar() == IsoCalendar{2017, 25, 3}));
+    EXPECT(d.weekday() == 2u);
+    EXPECT(d.toordinal() == 736501);
+    EXPECT(d.dayofyear() == 172u);
+    EXPECT(Date::fromordinal(736501) == d);
+    EXPECT(Date::fromordinal(1) == Date(date::year(1)/1/1));
+    EXPECT(Date(date::year(1)/1/1).toordinal() == 1);
+    EXPECT(Date(date::year(2016)/12/31).dayofyear() == 366u);
+    EXPECT(Date(date::year(2017)/3/1).dayofyear() == 60u);
+
+    // weeks across years
+    EXPECT((Date(date::year(2008)/12/29).isocalendar() == IsoCalendar{2009, 1, 1}));
+    EXPECT((Date(date::year(2010)/1/3).isocalendar() == IsoCalendar{2009, 53, 7}));
+    EXPECT((Date(date::year(2005)/1/1).isocalendar() == IsoCalendar{2004, 53, 6}));
+    EXPECT((Date(date::year(2006)/1/1).isocalendar() == IsoCalendar{2005, 52, 7}));
+    EXPECT((Date(date::year(2020)/12/31).isocalendar() == IsoCalendar{2020, 53, 4}));
+    EXPECT((Date(date::year(2021)/1/3).isocalendar() == IsoCalendar{2020, 53, 7}));
+    EXPECT((Date(date::year(2021)/1/4).isocalendar() == IsoCalendar{2021, 1, 1}));
+    EXPECT((Date(date::year(2019)/12/30).isocalendar() == IsoCalendar{2020, 1, 1}));
+    EXPECT((Date(date::year(1969)/12/29).isocalendar() == IsoCalendar{1970, 1, 1}));
+}
+
+
+CASE("constexpr" "[date]") 
+{
+    using namespace datetime::literals;
+
+    static constexpr Date solstices[] = {2017_y/6/21, 2018_y/6/21, 2019_y/6/21};
+    static_assert(solstices[0].year() == 2017_y && solstices[0].day() == 21_d, "accessors");
+    static_assert(solstices[0] < solstices[1] && solstices[2] != solstices[1], "ordering");
+#if __cplusplus >= 201402
+    static_assert(solstices[0] + TimeDelta(10_days) == Date(2017_y/7/1), "addition");
+    static_assert((solstices[1] - solstices[0]).days() == 365, "difference");
+    static_assert(solstices[0].isoweekday() == 3, "weekday");
+    static_assert(solstices[0].isocalendar().week == 25, "ISO week");
+    static_assert(Date::fromordinal(solstices[0].toordinal() + 10) == Date(2017_y/7/1), "ordinals");
+#endif
+
+    EXPECT((solstices[2] - TimeDelta(365_days)) == Date(2018_y/6/21));
+}
+
+}
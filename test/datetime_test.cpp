@@ -3,6 +3,7 @@
 extern lest::tests & specification();
 
 #include "datetime.h"
+#include "bulk.h"
 
 namespace 
 {
@@ -27,6 +28,174 @@ CASE("fromtimestamp" "[datetime]")
 }
 
 
+CASE("fromtimestamp exact" "[datetime]") 
+{
+    using namespace std::chrono;
+    std::error_code ec;
+    const std::string s = "1497252490.028200626";
+    auto x = DateTime<nanoseconds>::fromtimestamp(s.data(), s.data() + s.size(), date::locate_zone("Europe/Paris"), ec);
+    EXPECT(!ec);
+    EXPECT(to_string(x) == "2017-06-12 09:28:10.028200626 CEST");
+
+    x = DateTime<nanoseconds>::fromtimestamp(seconds(1497252490), nanoseconds(28200626), "Europe/Paris");
+    EXPECT(to_string(x) == "2017-06-12 09:28:10.028200626 CEST");
+
+    const std::string bad = "1497252490,0";
+    DateTime<nanoseconds>::fromtimestamp(bad.data(), bad.data() + bad.size(), nullptr, ec);
+    EXPECT(ec == errc::parse_error);
+    const std::string ms = "1497252490028";
+    x = DateTime<nanoseconds>::fromtimestamp(ms.data(), ms.data() + ms.size(), nullptr, ec, milliseconds(1));
+    EXPECT(!ec);
+    EXPECT(x.timestamp_ns() == 1497252490028000000);
+    const std::string huge = "10000000000";
+    DateTime<nanoseconds>::fromtimestamp(huge.data(), huge.data() + huge.size(), nullptr, ec);
+    EXPECT(ec == errc::timestamp_out_of_range);
+}
+
+
+
+CASE("utcfromtimestamp exact" "[datetime]") 
+{
+    using namespace std::chrono;
+    auto x = DateTime<nanoseconds>::utcfromtimestamp(seconds(1497252490), nanoseconds(28200626));
+    EXPECT(x.timestamp_ns() == 1497252490028200626);
+    x = DateTime<nanoseconds>::utcfromtimestamp(seconds(1), nanoseconds(-1));
+    EXPECT(x.timestamp_ns() == 999999999);
+    x = DateTime<nanoseconds>::utcfromtimestamp(seconds(0), nanoseconds(2500000000));
+    EXPECT(x.timestamp_ns() == 2500000000);
+    EXPECT_THROWS_AS(DateTime<nanoseconds>::utcfromtimestamp(seconds(10000000000)), std::system_error);
+}
 
+
+CASE("arithmetic precision" "[datetime]") 
+{
+    using namespace std::chrono;
+    auto x = DateTime<nanoseconds>::utcfromtimestamp(seconds(1497252490), nanoseconds(28200626));
+    auto y = DateTime<nanoseconds>::utcfromtimestamp(seconds(1497252490), nanoseconds(1));
+    auto d = x - y;
+    static_assert(std::is_same<decltype(d), BasicTimeDelta<nanoseconds>>::value, "difference in nanoseconds");
+    EXPECT(d.to_duration() == nanoseconds(28200625));
+    EXPECT(TimeDelta(d).to_duration() == microseconds(28200));
+    EXPECT((y + d).timestamp_ns() == x.timestamp_ns());
+    EXPECT((x - d).timestamp_ns() == y.timestamp_ns());
+
+    // a DateTime in seconds plus microseconds is in microseconds
+    auto s = DateTime<seconds>::utcfromtimestamp(seconds(1497252490));
+    auto z = TimeDelta(microseconds(-1)) + s;
+    static_assert(std::is_same<decltype(z), DateTime<microseconds>>::value, "sum in microseconds");
+    EXPECT(z.timestamp_ns() == 1497252489999999000);
+    EXPECT((x - s).to_duration() == nanoseconds(28200626));
 }
 
+
+CASE("strftime_column" "[datetime]") 
+{
+    using namespace std::chrono;
+    auto paris = date::locate_zone("Europe/Paris");
+    std::vector<date::sys_seconds> times = {
+        date::sys_days(date::year(2017)/3/26) + minutes(59),
+        date::sys_days(date::year(2017)/3/26) + hours(1)
+    };
+    TextColumn text;
+    strftime_column(times.data(), times.size(), Format("%F %T %Z %z"), paris, '\n', text);
+    EXPECT(text.join() == "2017-03-26 01:59:00 CET +0100\n2017-03-26 03:00:00 CEST +0200\n");
+
+    std::vector<DateTime<seconds>> values = {
+        DateTime<seconds>(date::make_zoned(paris, times[0])),
+        DateTime<seconds>(date::make_zoned("America/New_York", times[1]))
+    };
+    strftime_column(values.data(), values.size(), Format("%T %Z"), ',', text);
+    EXPECT(text.join() == "01:59:00 CET,21:00:00 EDT,");
+}
+
+
+CASE("timestamp" "[datetime]") 
+{
+    using namespace std::chrono;
+    char buf[32];
+
+    auto x = DateTime<nanoseconds>(date::make_zoned("UTC", date::sys_time<nanoseconds>(nanoseconds(1497252490028200626))));
+    EXPECT(x.timestamp_seconds() == 1497252490);
+    EXPECT(x.timestamp_ms() == 1497252490028);
+    EXPECT(x.timestamp_us() == 1497252490028200);
+    EXPECT(x.timestamp_ns() == 1497252490028200626);
+    EXPECT(std::abs(x.timestamp() - 1497252490.0282006) < 1e-6);
+    EXPECT(std::string(buf, x.timestamp_to_chars(buf, buf + sizeof(buf))) == "1497252490.028200626");
+    EXPECT(x.timestamp_to_chars(buf, buf + 10) == nullptr);
+
+    auto s = DateTime<seconds>(date::make_zoned("UTC", date::sys_seconds(seconds(1497252490))));
+    EXPECT(s.timestamp() == 1497252490.0);
+    EXPECT(std::string(buf, s.timestamp_to_chars(buf, buf + sizeof(buf))) == "1497252490");
+
+    auto neg = DateTime<milliseconds>(date::make_zoned("UTC", date::sys_time<milliseconds>(milliseconds(-1500))));
+    EXPECT(neg.timestamp_seconds() == -2);
+    EXPECT(neg.timestamp() == -1.5);
+    EXPECT(std::string(buf, neg.timestamp_to_chars(buf, buf + sizeof(buf))) == "-1.500");
+
+    // beyond the range of nanoseconds
+    auto far = DateTime<microseconds>(date::make_zoned("UTC", date::sys_days(date::year(2300)/1/1) + microseconds(1500000)));
+    EXPECT(std::string(buf, far.timestamp_to_chars(buf, buf + sizeof(buf))) == "10413792001.500000");
+    auto early = DateTime<microseconds>(date::make_zoned("UTC", date::sys_days(date::year(1600)/1/1) + microseconds(250000)));
+    EXPECT(std::string(buf, early.timestamp_to_chars(buf, buf + sizeof(buf))) == "-11676095999.750000");
+}
+
+
+CASE("error codes" "[datetime]") 
+{
+    using namespace std::chrono;
+    std::error_code ec;
+
+    auto paris = locate_zone("Europe/Paris", ec);
+    EXPECT(!ec);
+    EXPECT(paris == date::locate_zone("Europe/Paris"));
+
+    auto x = DateTime<>::fromtimestamp(1497252490.0282006, "Europe/Paris", ec);
+    EXPECT(!ec);
+    EXPECT(to_string(x) == "2017-06-12 09:28:10.028200626 CEST");
+    DateTime<>::fromtimestamp(1e300, "Europe/Paris", ec);
+    EXPECT(ec == errc::timestamp_out_of_range);
+
+    // negative fractions are before the whole second
+    auto before = DateTime<microseconds>::fromtimestamp(-1.5, "UTC", ec);
+    EXPECT(!ec);
+    EXPECT(before.zoned_time().get_sys_time().time_since_epoch() == milliseconds(-1500));
+    EXPECT(to_string(before) == "1969-12-31 23:59:58.500000 UTC");
+    before = DateTime<microseconds>::fromtimestamp(-0.25, "UTC", ec);
+    EXPECT(before.zoned_time().get_sys_time().time_since_epoch() == milliseconds(-250));
+    EXPECT(DateTime<microseconds>::utcfromtimestamp(-1.5).zoned_time().get_sys_time().time_since_epoch() ==
+           milliseconds(-1500));
+    EXPECT(DateTime<microseconds>::fromtimestamp(-86400.75, "UTC").zoned_time().get_sys_time().time_since_epoch() ==
+           milliseconds(-86400750));
+    EXPECT(DateTime<seconds>::utcfromtimestamp(-3).zoned_time().get_sys_time().time_since_epoch() == seconds(-3));
+    EXPECT_THROWS_AS(DateTime<>::utcfromtimestamp(1e300), std::system_error);
+
+    Format f("%F %T");
+    std::string s = "2017-06-12 09:28:10.5";
+    auto y = DateTime<milliseconds>::strptime(s.data(), s.data() + s.size(), f, paris, ec);
+    EXPECT(!ec);
+    EXPECT(to_string(y) == "2017-06-12 09:28:10.500 CEST");
+    s = "2017-03-26 02:30:00";
+    DateTime<>::strptime(s.data(), s.data() + s.size(), f, paris, ec);
+    EXPECT(ec == errc::nonexistent_local_time);
+    s = "2017-10-29 02:30:00";
+    DateTime<>::strptime(s.data(), s.data() + s.size(), f, paris, ec);
+    EXPECT(ec == errc::ambiguous_local_time);
+
+    EXPECT_THROWS_AS(DateTime<>::strptime("21/13/92 16:30", "%d/%m/%y %H:%M"), std::system_error);
+}
+
+
+CASE("format_to" "[datetime]") 
+{
+    using namespace std::chrono;
+    auto x = DateTime<milliseconds>(date::make_zoned("Europe/Paris", date::sys_days(date::year(2017)/6/21) + milliseconds(1234)));
+    std::string s;
+    format_to(std::back_inserter(s), x);
+    EXPECT(s == to_string(x));
+
+    char buf[64];
+    auto r = format_to_n(buf, sizeof(buf), x, Format("%a, %d %b %Y %T %z"));
+    EXPECT(std::string(buf, r.out) == "Wed, 21 Jun 2017 02:00:01.234 +0200");
+}
+
+}
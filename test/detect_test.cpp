@@ -0,0 +1,128 @@
+#include "lest.h"
+#define CASE( name ) lest_CASE( specification(), name )
+extern lest::tests & specification();
+
+#include "detect.h"
+
+namespace 
+{
+
+using namespace datetime;
+using namespace std::chrono;
+
+
+DetectedFormat detect(const std::vector<std::string>& column)
+{
+    return detect_format(column.data(), column.size());
+}
+
+const date::sys_seconds june21 = date::sys_days(date::year(2017)/6/21);
+
+
+CASE("detect iso formats" "[detect]") 
+{
+    EXPECT(detect({"2017-06-21T10:00:00Z", "2017-06-22T11:00:00.5Z"}).str() == "%Y-%m-%dT%H:%M:%SZ");
+    EXPECT(detect({"2017-06-21T10:00:00+02:00", "2017-06-22T11:00:00-0130"}).str() == "%Y-%m-%dT%H:%M:%S%z");
+    EXPECT(detect({"2017-06-21", "2017-06-22"}).str() == "%Y-%m-%d");
+    EXPECT(detect({"20170621T100000", "20170622T110000"}).str() == "%Y%m%dT%H%M%S");
+}
+
+
+CASE("detect day order" "[detect]") 
+{
+    EXPECT(detect({"06/21/2017", "07/01/2017"}).str() == "%m/%d/%Y");
+    EXPECT(detect({"21/06/2017", "01/07/2017"}).str() == "%d/%m/%Y");
+    EXPECT(detect({"01/02/2017", "03/04/2017"}).str() == "%m/%d/%Y"); // ambiguous: month first
+    EXPECT(detect({"21.06.2017 10:00", "22.06.2017 11:30"}).str() == "%d.%m.%Y %H:%M");
+}
+
+
+CASE("detect epoch and rfc 2822" "[detect]") 
+{
+    EXPECT(detect({"1497252490", "1497252491.5"}).kind() == DetectedFormat::Kind::epoch_seconds);
+    EXPECT(detect({"1497252490028"}).kind() == DetectedFormat::Kind::epoch_milliseconds);
+    EXPECT(detect({"1497252490028200"}).kind() == DetectedFormat::Kind::epoch_microseconds);
+    EXPECT(detect({"1497252490028200626"}).kind() == DetectedFormat::Kind::epoch_nanoseconds);
+    EXPECT(detect({"Sun, 06 Nov 1994 08:49:37 +0100"}).kind() == DetectedFormat::Kind::rfc2822);
+
+    auto none = detect({"garbage", ""});
+    EXPECT(!none.ok());
+    EXPECT(none.kind() == DetectedFormat::Kind::none);
+}
+
+
+CASE("parse_column with a detected format" "[detect]") 
+{
+    std::vector<std::string> column = {"2017-06-21 00:00:00", "2017-06-21 00:00:01.25", "2017-06-21 00:01",
+                                       "1497252490", "nonsense", "2017-06-21 00:00:02"};
+    auto format = detect_format(column.data(), column.size(), 3);
+    EXPECT(format.str() == "%Y-%m-%d %H:%M:%S");
+    EXPECT(format.confidence() == 2.0 / 3);
+
+    std::vector<date::sys_time<milliseconds>> out(column.size());
+    bool errors[6];
+    EXPECT(parse_column(column.data(), column.size(), format, nullptr, out.data(), errors) == 2u);
+    EXPECT(out[1] == june21 + milliseconds(1250));
+    EXPECT(out[2] == june21 + minutes(1)); // fallback to another candidate of the sample
+    EXPECT(errors[3]);                     // epoch seconds were not in the sample
+    EXPECT(errors[4]);
+    EXPECT(out[5] == june21 + seconds(2));
+
+    ThreadPool pool(2);
+    std::vector<date::sys_time<milliseconds>> out2(column.size());
+    EXPECT(parse_column(column.data(), column.size(), format, nullptr, out2.data(), errors, pool) == 2u);
+    EXPECT(out2 == out);
+}
+
+
+CASE("dates are not taken for epochs" "[detect]") 
+{
+    std::vector<std::string> column = {"20170621", "20170622", "20170623", "20171341", "2017062"};
+    auto format = detect(column);
+    EXPECT(format.kind() == DetectedFormat::Kind::format);
+    EXPECT(format.str() == "%Y%m%d");
+    std::vector<date::sys_seconds> out(column.size());
+    bool errors[5];
+    EXPECT(parse_column(column.data(), column.size(), format, nullptr, out.data(), errors) >= 1u);
+    EXPECT(out[0] == june21);
+    EXPECT(errors[3]);
+    EXPECT(out[3] == date::sys_seconds{});
+
+    EXPECT(!detect({"12345678"}).ok());
+    EXPECT(!detect({"-1497252490"}).ok());
+    EXPECT(!detect({"14972524900"}).ok());
+    EXPECT(detect({"99999999999", "1497252490"}).confidence() == 0.5);
+}
+
+
+CASE("rows are not read with day and month swapped" "[detect]") 
+{
+    std::vector<std::string> column = {"06/21/2017", "07/01/2017", "13/02/2017", "02/13/2017"};
+    auto format = detect_format(column.data(), column.size(), 3);
+    EXPECT(format.str() == "%m/%d/%Y");
+    std::vector<date::sys_seconds> out(column.size());
+    bool errors[4];
+    EXPECT(parse_column(column.data(), column.size(), format, nullptr, out.data(), errors) == 1u);
+    EXPECT(errors[2]);
+    EXPECT(out[3] == date::sys_days(date::year(2017)/2/13));
+
+    column = {"21/06/2017", "01/07/2017", "06/21/2017"};
+    format = detect_format(column.data(), column.size(), 2);
+    EXPECT(format.str() == "%d/%m/%Y");
+    EXPECT(parse_column(column.data(), column.size(), format, nullptr, out.data(), errors) == 1u);
+    EXPECT(errors[2]);
+}
+
+
+CASE("epoch strings are exact" "[detect]") 
+{
+    std::vector<std::string> column = {"1497252490.028200626", "-1.5"};
+    auto format = detect(column);
+    std::vector<date::sys_time<nanoseconds>> out(2);
+    bool errors[2];
+    EXPECT(parse_column(column.data(), column.size(), format, nullptr, out.data(), errors) == 0u);
+    EXPECT(out[0].time_since_epoch() == nanoseconds(1497252490028200626));
+    EXPECT(out[1].time_since_epoch() == milliseconds(-1500));
+}
+
+}
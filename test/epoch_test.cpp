@@ -0,0 +1,81 @@
+#include "lest.h"
+#define CASE( name ) lest_CASE( specification(), name )
+extern lest::tests & specification();
+
+#include "bulk.h"
+
+#include <cstring>
+
+namespace 
+{
+
+using namespace datetime;
+using namespace std::chrono;
+
+template <class Duration>
+bool parse(const char* s, date::sys_time<Duration>& out, nanoseconds unit = seconds(1))
+{
+    return parse_epoch(s, s + std::strlen(s), out, unit) == s + std::strlen(s);
+}
+
+
+CASE("parse_epoch" "[epoch]") 
+{
+    date::sys_time<nanoseconds> ns;
+    EXPECT(parse("1497252490.028200626", ns));
+    EXPECT(ns.time_since_epoch().count() == 1497252490028200626);
+    EXPECT(parse("1497252490028.200626", ns, milliseconds(1)));
+    EXPECT(ns.time_since_epoch().count() == 1497252490028200626);
+    EXPECT(parse("1497252490028200.626", ns, microseconds(1)));
+    EXPECT(ns.time_since_epoch().count() == 1497252490028200626);
+    EXPECT(parse("1497252490028200626", ns, nanoseconds(1)));
+    EXPECT(ns.time_since_epoch().count() == 1497252490028200626);
+    EXPECT(parse("-1.5", ns));
+    EXPECT(ns.time_since_epoch().count() == -1500000000);
+    EXPECT(parse("0.0000000019", ns));
+    EXPECT(ns.time_since_epoch().count() == 1);
+
+    date::sys_time<microseconds> us;
+    EXPECT(parse("-0.0000015", us));
+    EXPECT(us.time_since_epoch().count() == -2);     // floored
+
+    // beyond the range of nanoseconds, but not of seconds
+    date::sys_seconds s;
+    EXPECT(!parse("10000000000", ns));
+    EXPECT(parse("10000000000", s));
+    EXPECT(s.time_since_epoch().count() == 10000000000);
+    EXPECT(!parse("99999999999999999999", s));
+
+    EXPECT(!parse("", s));
+    EXPECT(!parse("-", s));
+    EXPECT(!parse("1e9", s));
+    EXPECT(!parse("12", s, nanoseconds(7)));
+}
+
+
+CASE("fromtimestamp_column" "[epoch]") 
+{
+    std::int64_t seconds_[] = {1497252490, -1, 10000000000};
+    std::int64_t nanoseconds_[] = {28200626, 999999999, 0};
+    date::sys_time<nanoseconds> out[4];
+    bool errors[4];
+    EXPECT(fromtimestamp_column(seconds_, nanoseconds_, 3, out, errors) == 1u);
+    EXPECT(out[0].time_since_epoch().count() == 1497252490028200626);
+    EXPECT(out[1].time_since_epoch().count() == -1);
+    EXPECT((!errors[0] && !errors[1] && errors[2]));
+
+    std::vector<std::string> column = {"1497252490028.200626", "garbage", "-1", "1497252490028"};
+    EXPECT(fromtimestamp_column(column.data(), column.size(), milliseconds(1), out, errors) == 1u);
+    EXPECT(out[0].time_since_epoch().count() == 1497252490028200626);
+    EXPECT(errors[1]);
+    EXPECT(out[2].time_since_epoch().count() == -1000000);
+
+    std::vector<std::string> many(10000, "1497252490.5");
+    std::vector<date::sys_time<milliseconds>> parallel(many.size());
+    std::unique_ptr<bool[]> many_errors(new bool[many.size()]);
+    ThreadPool pool(3);
+    EXPECT(fromtimestamp_column(many.data(), many.size(), seconds(1), parallel.data(), many_errors.get(), pool) == 0u);
+    EXPECT(parallel.back().time_since_epoch().count() == 1497252490500);
+}
+
+} // anonymous namespace
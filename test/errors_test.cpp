@@ -0,0 +1,44 @@
+#include "lest.h"
+#define CASE( name ) lest_CASE( specification(), name )
+extern lest::tests & specification();
+
+#include "datetime.h"
+
+namespace 
+{
+
+using namespace datetime;
+
+
+CASE("error codes" "[errors]") 
+{
+    std::error_code ec = errc::parse_error;
+    EXPECT(ec.category() == error_category());
+    EXPECT(ec.message() == "string does not match format");
+    EXPECT(std::string(ec.category().name()) == "datetime");
+}
+
+
+CASE("try_locate_zone" "[errors]") 
+{
+    EXPECT(try_locate_zone("Not/A_Zone") == nullptr);
+    std::error_code ec;
+    EXPECT(locate_zone("Not/A_Zone", ec) == nullptr);
+    EXPECT(ec == errc::unknown_time_zone);
+}
+
+
+CASE("strptime without exceptions" "[errors]") 
+{
+    std::error_code ec;
+    Format f("%Y-%m-%d %H:%M:%S");
+    for (std::string s : {"2017-02-30 00:00:00", "2017-06-21", "2017-06-21 10:00:00 trailing", ""})
+    {
+        DateTime<>::strptime(s.data(), s.data() + s.size(), f, nullptr, ec);
+        EXPECT(ec == errc::parse_error);
+    }
+    DateTime<>::fromtimestamp(0, "Not/A_Zone", ec);
+    EXPECT(ec == errc::unknown_time_zone);
+}
+
+}
@@ -0,0 +1,136 @@
+#include "lest.h"
+#define CASE( name ) lest_CASE( specification(), name )
+extern lest::tests & specification();
+
+#include "datetime.h"
+
+namespace 
+{
+
+using namespace datetime;
+using namespace std::chrono;
+
+
+template <class Duration = seconds>
+bool parse(const Format& f, const std::string& s, date::local_time<Duration>& tp)
+{
+    return f.parse(s.data(), s.data() + s.size(), tp) == s.data() + s.size();
+}
+
+date::local_seconds local(date::year_month_day ymd, seconds s = seconds(0))
+{
+    return date::local_days(ymd) + s;
+}
+
+
+CASE("parse" "[format]") 
+{
+    date::local_seconds tp;
+    EXPECT(parse(Format("%Y-%m-%d %H:%M:%S"), "2017-06-21 16:30:05", tp));
+    EXPECT(tp == local(date::year(2017)/6/21, seconds(16*3600 + 30*60 + 5)));
+
+    EXPECT(parse(Format("%d/%m/%y %H:%M"), "21/11/92 16:30", tp));
+    EXPECT(tp == local(date::year(1992)/11/21, seconds(16*3600 + 30*60)));
+
+    EXPECT(parse(Format("%a, %d %b %Y %T"), "Wed, 21 jun 2017 00:00:01", tp));
+    EXPECT(tp == local(date::year(2017)/6/21, seconds(1)));
+
+    EXPECT(parse(Format("%c"), "Sun Jun  4 03:00:00 2017", tp));
+    EXPECT(tp == local(date::year(2017)/6/4, hours(3)));
+
+    EXPECT(parse(Format("%Y %j %I%p"), "2017 172 3PM", tp));
+    EXPECT(tp == local(date::year(2017)/6/21, hours(15)));
+}
+
+
+CASE("parse subseconds and offset" "[format]") 
+{
+    date::local_time<microseconds> tp;
+    EXPECT(parse(Format("%FT%T"), "2017-06-12T07:28:10.0282006", tp));
+    EXPECT(tp == local(date::year(2017)/6/12, seconds(7*3600 + 28*60 + 10)) + microseconds(28200));
+
+    Format f("%F %T %z");
+    EXPECT(f.has_offset());
+    std::string s = "2017-06-12 09:28:10 +0200";
+    minutes offset;
+    date::local_seconds t;
+    EXPECT(f.parse(s.data(), s.data() + s.size(), t, &offset) == s.data() + s.size());
+    EXPECT(offset == hours(2));
+
+    Format z("%F %z");
+    for (std::string good : {"+05", "+0530", "+05:30", "-0000"})
+    {
+        s = "2017-06-12 " + good;
+        EXPECT(z.parse(s.data(), s.data() + s.size(), t, &offset) == s.data() + s.size());
+    }
+    EXPECT(offset == minutes(0));
+    s = "2017-06-12 -05:30";
+    EXPECT(z.parse(s.data(), s.data() + s.size(), t, &offset) != nullptr);
+    EXPECT(offset == -minutes(330));
+    for (std::string bad : {"+05:", "+0599", "+05:60", "+05:3", "+053x"})
+    {
+        s = "2017-06-12 " + bad;
+        EXPECT(z.parse(s.data(), s.data() + s.size(), t, &offset) == nullptr);
+    }
+}
+
+
+CASE("parse rejects bad input" "[format]") 
+{
+    date::local_seconds tp;
+    Format f("%Y-%m-%d %H:%M:%S");
+    EXPECT(!parse(f, "2017-02-30 00:00:00", tp));
+    EXPECT(!parse(f, "2017-06-21 24:00:00", tp));
+    EXPECT(!parse(f, "2017-06-21T00:00:00", tp));
+    EXPECT(!parse(f, "2017-06-21", tp));
+    EXPECT(!parse(Format("%a %F"), "Thu 2017-06-21", tp)); // a Wednesday
+    EXPECT(!parse(Format("%b %Y"), "Jux 2017", tp));
+}
+
+
+CASE("parse fallback" "[format]") 
+{
+    date::local_seconds tp;
+    EXPECT(parse(Format("%G-W%V-%u"), "2017-W25-3", tp));
+    EXPECT(tp == local(date::year(2017)/6/21));
+}
+
+
+CASE("format" "[format]") 
+{
+    auto tp = local(date::year(2017)/6/21, seconds(9*3600 + 3*60 + 4)) + milliseconds(56);
+    char buf[64];
+    auto end = Format("%a, %d %b %Y %T").format(buf, buf + sizeof(buf), tp);
+    EXPECT(std::string(buf, end) == "Wed, 21 Jun 2017 09:03:04.056");
+    end = Format("%c | %r | %j %u").format(buf, buf + sizeof(buf), tp);
+    EXPECT(std::string(buf, end) == "Wed Jun 21 09:03:04 2017 | 09:03:04 AM | 172 3");
+
+    std::string abbrev = "CEST";
+    seconds offset = hours(2);
+    std::string s;
+    Format("%FT%H:%M:%S.%f%z %Z").format_to(std::back_inserter(s), tp, &abbrev, &offset);
+    EXPECT(s == "2017-06-21T09:03:04.056000+0200 CEST");
+
+    EXPECT(Format("%F %T").format(buf, buf + 10, tp) == nullptr);
+    EXPECT_THROWS_AS(Format("%z").format(buf, buf + sizeof(buf), tp), std::runtime_error);
+}
+
+
+CASE("format fallback" "[format]") 
+{
+    char buf[64];
+    auto end = Format("%G-W%V-%u %S.%f").format(buf, buf + sizeof(buf),
+        local(date::year(2017)/6/21, seconds(4)) + microseconds(12));
+    EXPECT(std::string(buf, end) == "2017-W25-3 04.000012");
+}
+
+
+CASE("parse microseconds" "[format]") 
+{
+    date::local_time<microseconds> tp;
+    EXPECT(parse(Format("%H:%M:%S.%f %Y-%m-%d"), "09:03:04.5 2017-06-21", tp));
+    EXPECT(tp == local(date::year(2017)/6/21, seconds(9*3600 + 3*60 + 4)) + milliseconds(500));
+    EXPECT(!parse(Format("%S.%f %F"), "04.1234567 2017-06-21", tp));
+}
+
+}
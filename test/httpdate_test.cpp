@@ -0,0 +1,106 @@
+#include "lest.h"
+#define CASE( name ) lest_CASE( specification(), name )
+extern lest::tests & specification();
+
+#include "httpdate.h"
+
+namespace 
+{
+
+using namespace datetime;
+using namespace std::chrono;
+
+
+const date::sys_seconds example = date::sys_days(date::year(1994)/11/6) + hours(8) + minutes(49) + seconds(37);
+
+const char* parse(const std::string& s, date::sys_seconds& tp)
+{
+    return parse_http_date(s.data(), s.data() + s.size(), tp);
+}
+
+bool parse_all(const std::string& s, date::sys_seconds& tp)
+{
+    return parse(s, tp) == s.data() + s.size();
+}
+
+bool parse_all(const std::string& s, date::sys_seconds& tp, minutes& offset)
+{
+    return parse_rfc2822(s.data(), s.data() + s.size(), tp, &offset) == s.data() + s.size();
+}
+
+
+CASE("format http date" "[httpdate]") 
+{
+    char buf[http_date_length];
+    auto end = http_date_to_chars(buf, buf + sizeof(buf), example + milliseconds(999));
+    EXPECT(std::string(buf, end) == "Sun, 06 Nov 1994 08:49:37 GMT");
+    EXPECT(http_date_to_chars(buf, buf + sizeof(buf) - 1, example) == nullptr);
+    EXPECT(http_date_to_chars(buf, buf + sizeof(buf), date::sys_days(date::year(10000)/1/1)) == nullptr);
+
+    char buf2[rfc2822_length];
+    end = rfc2822_to_chars(buf2, buf2 + sizeof(buf2), example, -hours(5));
+    EXPECT(std::string(buf2, end) == "Sun, 06 Nov 1994 03:49:37 -0500");
+}
+
+
+CASE("parse http date" "[httpdate]") 
+{
+    date::sys_seconds tp;
+    EXPECT(parse_all("Sun, 06 Nov 1994 08:49:37 GMT", tp));
+    EXPECT(tp == example);
+    tp = {};
+    EXPECT(parse_all("Sunday, 06-Nov-94 08:49:37 GMT", tp));
+    EXPECT(tp == example);
+    tp = {};
+    EXPECT(parse_all("Sun Nov  6 08:49:37 1994", tp));
+    EXPECT(tp == example);
+    EXPECT(parse_all("Sat, 01 May 2010 00:00:00 GMT", tp));
+    EXPECT(tp == date::sys_days(date::year(2010)/5/1));
+}
+
+
+CASE("parse http date rejects bad input" "[httpdate]") 
+{
+    date::sys_seconds tp;
+    EXPECT(parse("", tp) == nullptr);
+    EXPECT(parse("Mon, 06 Nov 1994 08:49:37 GMT", tp) == nullptr); // a Sunday
+    EXPECT(parse("Sun, 6 Nov 1994 08:49:37 GMT", tp) == nullptr);
+    EXPECT(parse("Sun, 06 Nov 1994 08:49:37 UTC", tp) == nullptr);
+    EXPECT(parse("Sun, 31 Nov 1994 08:49:37 GMT", tp) == nullptr);
+    EXPECT(parse("Sun, 06 Nov 1994 24:49:37 GMT", tp) == nullptr);
+    EXPECT(parse("Sun, 06 Nov 1994 08:49", tp) == nullptr);
+    EXPECT(parse("Sunday, 06 Nov 1994 08:49:37 GMT", tp) == nullptr);
+}
+
+
+CASE("parse rfc 2822" "[httpdate]") 
+{
+    date::sys_seconds tp;
+    minutes offset;
+    EXPECT(parse_all("Sun, 06 Nov 1994 09:49:37 +0100", tp, offset));
+    EXPECT(tp == example);
+    EXPECT(offset == hours(1));
+    EXPECT(parse_all("6 Nov 94 03:49:37 EST", tp, offset));
+    EXPECT(tp == example);
+    EXPECT(offset == -hours(5));
+    EXPECT(parse_all(" Sun ,  6 Nov 1994  08:49 Z", tp, offset));
+    EXPECT(tp == example - seconds(37));
+
+    EXPECT(!parse_all("Mon, 06 Nov 1994 09:49:37 +0100", tp, offset));
+    EXPECT(!parse_all("06 Nov 1994 09:49:37", tp, offset));
+    EXPECT(!parse_all("06 Nov 1994 09:49:37 +01", tp, offset));
+}
+
+
+CASE("http date cache" "[httpdate]") 
+{
+    HttpDateCache cache;
+    char buf[TimeCache::max_length];
+    EXPECT(cache.copy(buf) == http_date_length);
+    date::sys_seconds tp;
+    EXPECT(parse_http_date(buf, buf + http_date_length, tp) == buf + http_date_length);
+    auto now = date::floor<seconds>(system_clock::now());
+    EXPECT((now - seconds(1) <= tp && tp <= now));
+}
+
+}
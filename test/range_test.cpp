@@ -0,0 +1,171 @@
+#include "lest.h"
+#define CASE( name ) lest_CASE( specification(), name )
+extern lest::tests & specification();
+
+#include "range.h"
+#include "bulk.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+
+using namespace datetime;
+using namespace std::chrono;
+
+
+CASE("date_range days" "[range]")
+{
+    auto r = date_range(Date(date::year(2016)/2/20), Date(date::year(2016)/3/5));
+    EXPECT(r.size() == 15u);
+    EXPECT(r.front() == Date(date::year(2016)/2/20));
+    EXPECT(r.back() == Date(date::year(2016)/3/5));
+    EXPECT(r[9] == Date(date::year(2016)/2/29));
+
+    // iterating agrees with the index
+    std::size_t i = 0;
+    for (auto d : r)
+    {
+        EXPECT(d == r[i++]);
+    }
+    EXPECT(i == r.size());
+
+    auto weekly = date_range(Date(date::year(2016)/12/1), Date(date::year(2017)/1/31), date::weeks(1));
+    EXPECT(weekly.size() == 9u);
+    EXPECT(weekly.back() == Date(date::year(2017)/1/26));
+    std::vector<Date> v(weekly.begin(), weekly.end());
+    EXPECT(v[5] == Date(date::year(2017)/1/5));
+
+    auto down = date_range(Date(date::year(2000)/3/2), Date(date::year(2000)/2/27), date::days(-2));
+    EXPECT(down.size() == 3u);
+    EXPECT(down.back() == Date(date::year(2000)/2/27));
+    EXPECT(*++down.begin() == Date(date::year(2000)/2/29));
+
+    EXPECT(date_range(Date(date::year(2017)/1/2), Date(date::year(2017)/1/1)).empty());
+    EXPECT(date_range(Date(date::year(2017)/1/1), Date(date::year(2017)/1/1)).size() == 1u);
+    EXPECT_THROWS_AS(date_range(Date(date::year(2017)/1/1), Date(date::year(2017)/1/2), date::days(0)), std::invalid_argument);
+}
+
+
+CASE("date_range months" "[range]")
+{
+    // month ends stay month ends, other days are clamped
+    auto ends = date_range(Date(date::year(2016)/1/31), Date(date::year(2016)/12/31), date::months(1));
+    EXPECT(ends.size() == 12u);
+    EXPECT(ends[1] == Date(date::year(2016)/2/29));
+    EXPECT(ends[3] == Date(date::year(2016)/4/30));
+    EXPECT(ends[4] == Date(date::year(2016)/5/31));
+
+    auto thirtieth = date_range(Date(date::year(2016)/1/30), Date(date::year(2016)/4/29), date::months(1));
+    EXPECT(thirtieth.size() == 3u);
+    std::vector<Date> v(thirtieth.begin(), thirtieth.end());
+    EXPECT(v[1] == Date(date::year(2016)/2/29));
+    EXPECT(v[2] == Date(date::year(2016)/3/30));
+
+    auto quarters = date_range(Date(date::year(2017)/11/15), Date(date::year(2016)/11/16), date::months(-3));
+    EXPECT(quarters.size() == 4u);
+    EXPECT(quarters.back() == Date(date::year(2017)/2/15));
+    EXPECT(*(quarters.end() - 1) == Date(date::year(2017)/2/15));
+}
+
+
+CASE("date_range iterators" "[range]")
+{
+    auto r = date_range(Date(date::year(1999)/12/25), Date(date::year(2001)/1/10), date::days(3));
+    auto it = r.begin();
+    it += 10;
+    EXPECT(*it == r[10]);
+    EXPECT(it[5] == r[15]);
+    EXPECT(*--it == r[9]);
+    EXPECT(r.end() - r.begin() == static_cast<std::ptrdiff_t>(r.size()));
+    EXPECT(std::distance(r.begin(), r.end()) == static_cast<std::ptrdiff_t>(r.size()));
+    EXPECT(std::lower_bound(r.begin(), r.end(), Date(date::year(2000)/3/1)) - r.begin() == 23);
+
+    // stepping back from the end visits the same dates
+    std::vector<Date> forward(r.begin(), r.end());
+    std::vector<Date> backward;
+    for (auto p = r.end(); p != r.begin();)
+    {
+        backward.push_back(*--p);
+    }
+    std::reverse(backward.begin(), backward.end());
+    EXPECT(forward == backward);
+}
+
+
+CASE("date_range slice" "[range]")
+{
+    auto r = date_range(Date(date::year(2015)/1/31), Date(date::year(2020)/12/31), date::months(1));
+    auto s = r.slice(1, 4);
+    EXPECT(s.size() == 3u);
+    EXPECT(s.front() == Date(date::year(2015)/2/28));
+    EXPECT(s.back() == Date(date::year(2015)/4/30));
+    EXPECT(r.slice(70, 100).size() == 2u);
+    EXPECT(r.slice(80, 90).empty());
+
+    std::vector<Date> serial(r.begin(), r.end());
+    std::vector<Date> parallel(r.size());
+    ThreadPool pool(3);
+    pool.parallel_for(r.size(), 7, [&](unsigned, std::size_t begin, std::size_t end) {
+        auto chunk = r.slice(begin, end);
+        std::copy(chunk.begin(), chunk.end(), parallel.begin() + static_cast<std::ptrdiff_t>(begin));
+    });
+    EXPECT(parallel == serial);
+}
+
+
+CASE("date_range of DateTime" "[range]")
+{
+    auto paris = date::locate_zone("Europe/Paris");
+    auto start = DateTime<seconds>(date::make_zoned(paris, date::local_days(date::year(2017)/3/24) + hours(2)));
+    auto end = DateTime<seconds>(date::make_zoned(paris, date::local_days(date::year(2017)/3/28) + hours(2)));
+
+    // days step the wall clock: 2017-03-26 02:00 does not exist in Paris
+    auto daily = date_range(start, end, date::days(1));
+    EXPECT(daily.size() == 5u);
+    EXPECT(daily[1].strftime("%F %T %Z") == "2017-03-25 02:00:00 CET");
+    EXPECT(daily[2].strftime("%F %T %Z") == "2017-03-26 03:00:00 CEST");
+    EXPECT(daily[3].strftime("%F %T %Z") == "2017-03-27 02:00:00 CEST");
+    std::size_t i = 0;
+    for (auto x : daily)
+    {
+        EXPECT(x.zoned_time().get_sys_time() == daily[i++].zoned_time().get_sys_time());
+    }
+
+    // other steps are absolute
+    auto hourly = date_range(start, end, hours(24));
+    EXPECT(hourly.size() == 4u);
+    EXPECT(hourly[3].strftime("%F %T %Z") == "2017-03-27 03:00:00 CEST");
+    auto fine = date_range(start, end, TimeDelta(minutes(15)));
+    EXPECT(fine.size() == 4u * 96 - 4 + 1);
+    EXPECT((*(fine.begin() + 4)).zoned_time().get_sys_time() == start.zoned_time().get_sys_time() + hours(1));
+}
+
+
+CASE("date_range of DateTime slice" "[range]")
+{
+    auto ny = date::locate_zone("America/New_York");
+    auto start = DateTime<seconds>(date::make_zoned(ny, date::local_days(date::year(2016)/1/1) + hours(12)));
+    auto end = DateTime<seconds>(date::make_zoned(ny, date::local_days(date::year(2018)/1/1)));
+    auto r = date_range(start, end, date::days(1));
+    EXPECT(r.size() == 731u);
+
+    std::vector<std::int64_t> serial;
+    for (auto x : r)
+    {
+        serial.push_back(x.timestamp_seconds());
+    }
+    std::vector<std::int64_t> parallel(r.size());
+    ThreadPool pool(3);
+    pool.parallel_for(r.size(), 50, [&](unsigned, std::size_t begin, std::size_t end) {
+        for (auto x : r.slice(begin, end))
+        {
+            parallel[begin++] = x.timestamp_seconds();
+        }
+    });
+    EXPECT(parallel == serial);
+    EXPECT(r[200].strftime("%T") == "12:00:00");
+}
+
+} // anonymous namespace
@@ -0,0 +1,167 @@
+#include "lest.h"
+#define CASE( name ) lest_CASE( specification(), name )
+extern lest::tests & specification();
+
+#include "relativedelta.h"
+
+#include <vector>
+
+namespace
+{
+
+using namespace datetime;
+using namespace std::chrono;
+
+
+CASE("RelativeDelta months" "[relativedelta]")
+{
+    const RelativeDelta month(date::months(1));
+    EXPECT(Date(date::year(2016)/1/31) + month == Date(date::year(2016)/2/29));
+    EXPECT(Date(date::year(2016)/1/31) + 2 * month == Date(date::year(2016)/3/31));
+    EXPECT(Date(date::year(2016)/1/31) + month + month == Date(date::year(2016)/3/29));
+    EXPECT(Date(date::year(2016)/3/31) - month == Date(date::year(2016)/2/29));
+    EXPECT(Date(date::year(2017)/1/15) - RelativeDelta(date::months(13)) == Date(date::year(2015)/12/15));
+    EXPECT(Date(date::year(2016)/2/29) + RelativeDelta(date::years(1)) == Date(date::year(2017)/2/28));
+    EXPECT(Date(date::year(2016)/2/29) + RelativeDelta(date::years(4)) == Date(date::year(2020)/2/29));
+    EXPECT(Date(date::year(2016)/12/30) + RelativeDelta(date::months(2), date::days(1)) == Date(date::year(2017)/3/1));
+    EXPECT(Date(date::year(2016)/12/30) + RelativeDelta(date::weeks(-1)) == Date(date::year(2016)/12/23));
+    EXPECT(RelativeDelta(date::years(1), date::months(-2)).months() == 10);
+    EXPECT(RelativeDelta(date::weeks(1), date::days(-2)).days() == 5);
+}
+
+
+CASE("RelativeDelta absolute fields" "[relativedelta]")
+{
+    // end of month, end of next quarter, first of next month
+    EXPECT(Date(date::year(2016)/2/3) + RelativeDelta(date::last) == Date(date::year(2016)/2/29));
+    EXPECT(Date(date::year(2017)/2/3) + RelativeDelta(date::months(1), date::last) == Date(date::year(2017)/3/31));
+    auto d = Date(date::year(2017)/11/20);
+    auto quarter_end = RelativeDelta(date::months(5 - (static_cast<unsigned>(d.month()) - 1) % 3), date::last);
+    EXPECT(d + quarter_end == Date(date::year(2018)/3/31));
+    EXPECT(d + RelativeDelta(date::months(1), date::day(1)) == Date(date::year(2017)/12/1));
+
+    // replaced before the months are added, the day is clamped
+    EXPECT(Date(date::year(2017)/5/31) + RelativeDelta(date::year(2016), date::month(2)) == Date(date::year(2016)/2/29));
+    EXPECT(Date(date::year(2017)/5/31) + RelativeDelta(date::month(1), date::months(1)) == Date(date::year(2017)/2/28));
+    EXPECT(Date(date::year(2017)/5/2) + RelativeDelta(date::day(31), date::months(1)) == Date(date::year(2017)/6/30));
+    EXPECT(Date(date::year(2017)/5/2) + RelativeDelta(date::last, date::day(3)) == Date(date::year(2017)/5/3));
+    EXPECT(Date(date::year(2017)/5/2) - RelativeDelta(date::day(20), date::days(1)) == Date(date::year(2017)/5/19));
+}
+
+
+CASE("RelativeDelta weekday anchors" "[relativedelta]")
+{
+    // 2017-06-14 is a Wednesday
+    const auto wed = Date(date::year(2017)/6/14);
+    EXPECT(wed + RelativeDelta(date::fri) == Date(date::year(2017)/6/16));
+    EXPECT(wed + RelativeDelta(date::wed) == wed);
+    EXPECT(wed + RelativeDelta(date::days(1), date::wed) == Date(date::year(2017)/6/21));
+    EXPECT(wed + RelativeDelta(date::days(-6), date::mon) == Date(date::year(2017)/6/12));
+    EXPECT(wed + RelativeDelta(date::tue[2]) == Date(date::year(2017)/6/13));
+    EXPECT(wed + RelativeDelta(date::thu[1]) == Date(date::year(2017)/6/1));
+    EXPECT(wed + RelativeDelta(date::fri[date::last]) == Date(date::year(2017)/6/30));
+    EXPECT(wed + RelativeDelta(date::sun[date::last]) == Date(date::year(2017)/6/25));
+    EXPECT(wed + RelativeDelta(date::months(1), date::wed[3]) == Date(date::year(2017)/7/19));
+    // the anchor is taken in the month reached after the days
+    EXPECT(wed + RelativeDelta(date::days(20), date::mon[1]) == Date(date::year(2017)/7/3));
+    EXPECT(wed + RelativeDelta(date::days(-20), date::mon[date::last]) == Date(date::year(2017)/5/29));
+    // a fifth one goes on into the next month
+    EXPECT(Date(date::year(2017)/2/1) + RelativeDelta(date::mon[5]) == Date(date::year(2017)/3/6));
+
+    EXPECT(SerialDate(wed) + RelativeDelta(date::fri[date::last]) == SerialDate(Date(date::year(2017)/6/30)));
+    EXPECT(SerialDate(wed) - RelativeDelta(date::months(4), date::last) == SerialDate(Date(date::year(2017)/2/28)));
+}
+
+
+CASE("RelativeDelta arithmetic" "[relativedelta]")
+{
+    auto x = RelativeDelta(date::months(1), date::day(5), date::fri);
+    auto y = RelativeDelta(date::days(2), date::last);
+    auto z = x + y;
+    EXPECT(z == RelativeDelta(date::months(1), date::days(2), date::last, date::fri));
+    EXPECT(z != x);
+    EXPECT(x + RelativeDelta() == x);
+    EXPECT(-x == RelativeDelta(date::months(-1), date::day(5), date::fri));
+    EXPECT(x - x == RelativeDelta(date::day(5), date::fri));
+    EXPECT(3 * y == RelativeDelta(date::days(6), date::last));
+    EXPECT(RelativeDelta(date::years(1)) == RelativeDelta(date::months(12)));
+    EXPECT(RelativeDelta(date::year(2000)) != RelativeDelta(date::year(2001)));
+}
+
+
+CASE("add_column" "[relativedelta]")
+{
+    const RelativeDelta deltas[] = {
+        RelativeDelta(date::months(1)),
+        RelativeDelta(date::years(-3), date::months(5), date::last),
+        RelativeDelta(date::months(1), date::day(1), date::days(-1)),
+        RelativeDelta(date::days(10), date::wed[2]),
+        RelativeDelta(date::months(2), date::fri[date::last]),
+        RelativeDelta(date::sun),
+        RelativeDelta(date::year(2000), date::days(3)),
+    };
+    std::vector<std::int32_t> days;
+    for (std::int32_t n = -800; n < 2500; n += 3)
+    {
+        days.push_back(n * 7 + 1);
+    }
+    for (const auto& delta : deltas)
+    {
+        std::vector<std::int32_t> out(days.size());
+        add_column(days.data(), days.size(), delta, out.data());
+
+        std::vector<SerialDate> serial;
+        std::vector<Date> dates;
+        for (auto n : days)
+        {
+            serial.push_back(SerialDate(n));
+            dates.push_back(SerialDate(n).date());
+        }
+        add_column(serial.data(), serial.size(), delta, serial.data());
+        add_column(dates.data(), dates.size(), delta, dates.data());
+
+        bool same = true;
+        for (std::size_t i = 0; i < days.size(); ++i)
+        {
+            const auto expected = SerialDate(days[i]).date() + delta;
+            same = same && SerialDate(out[i]) == SerialDate(expected) && serial[i] == SerialDate(expected)
+                        && dates[i] == expected && delta.apply(days[i]) == out[i];
+        }
+        EXPECT(same);
+    }
+}
+
+
+CASE("RelativeDelta DateTime" "[relativedelta]")
+{
+    auto paris = date::locate_zone("Europe/Paris");
+    auto x = DateTime<seconds>(date::make_zoned(paris, date::local_days(date::year(2017)/1/26) + hours(2) + minutes(30)));
+
+    // the wall clock moves, the time of day stays
+    auto y = x + RelativeDelta(date::months(2), date::sun[date::last]);
+    EXPECT(y.strftime("%F %T %Z") == "2017-03-26 03:00:00 CEST");
+    EXPECT((x + RelativeDelta(date::months(2))).strftime("%F %T %Z") == "2017-03-26 03:00:00 CEST");
+    EXPECT((x + RelativeDelta(date::months(3), date::last)).strftime("%F %T %Z") == "2017-04-30 02:30:00 CEST");
+    EXPECT((x - RelativeDelta(date::years(1))).strftime("%F %T %Z") == "2016-01-26 02:30:00 CET");
+
+    std::vector<DateTime<seconds>> v;
+    for (int i = 0; i < 40; ++i)
+    {
+        v.push_back(x + RelativeDelta(date::weeks(i)));
+    }
+    v.push_back(DateTime<seconds>(date::make_zoned(date::locate_zone("Asia/Tokyo"),
+                                                   date::local_days(date::year(2017)/8/31) + hours(23))));
+    const RelativeDelta billing(date::months(1), date::last);
+    std::vector<DateTime<seconds>> out(v);
+    add_column(v.data(), v.size(), billing, out.data());
+    bool same = true;
+    for (std::size_t i = 0; i < v.size(); ++i)
+    {
+        same = same && out[i].zoned_time().get_sys_time() == (v[i] + billing).zoned_time().get_sys_time()
+                    && out[i].zoned_time().get_time_zone() == v[i].zoned_time().get_time_zone();
+    }
+    EXPECT(same);
+    EXPECT(out.back().strftime("%F %T %Z") == "2017-09-30 23:00:00 JST");
+}
+
+} // anonymous namespace
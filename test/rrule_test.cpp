@@ -0,0 +1,227 @@
+#include "lest.h"
+#define CASE( name ) lest_CASE( specification(), name )
+extern lest::tests & specification();
+
+#include "rrule.h"
+
+#include <vector>
+
+namespace
+{
+
+using namespace datetime;
+using namespace std::chrono;
+
+std::vector<Date> dates(const std::string& rule, const Date& start, std::size_t max = 100)
+{
+    std::vector<Date> v;
+    for (auto d : RRule(rule).expand(start))
+    {
+        if (v.size() == max)
+        {
+            break;
+        }
+        v.push_back(d);
+    }
+    return v;
+}
+
+template <class Duration>
+std::vector<std::string> times(const std::string& rule, const DateTime<Duration>& start, std::size_t max = 100)
+{
+    std::vector<std::string> v;
+    for (auto t : RRule(rule).expand(start))
+    {
+        if (v.size() == max)
+        {
+            break;
+        }
+        v.push_back(t.strftime("%F %T %Z"));
+    }
+    return v;
+}
+
+
+CASE("RRule parse" "[rrule]")
+{
+    RRule r("RRULE:freq=Weekly;INTERVAL=2;BYDAY=TU,FR;WKST=SU");
+    EXPECT(r.frequency() == RRule::Frequency::weekly);
+    EXPECT(r.interval() == 2u);
+    EXPECT(r.str() == "RRULE:freq=Weekly;INTERVAL=2;BYDAY=TU,FR;WKST=SU");
+
+    const char* invalid[] = {
+        "", "INTERVAL=2", "FREQ=FORTNIGHTLY", "FREQ=DAILY;FREQ=DAILY", "FREQ=DAILY;INTERVAL=0",
+        "FREQ=DAILY;COUNT=2;UNTIL=20170101", "FREQ=DAILY;UNTIL=20170230", "FREQ=DAILY;UNTIL=2017+1+1",
+        "FREQ=DAILY;UNTIL=20170101Z", "FREQ=DAILY;BYMONTH=13", "FREQ=DAILY;BYMONTHDAY=0",
+        "FREQ=DAILY;BYDAY=XX", "FREQ=DAILY;BYDAY=2TU", "FREQ=MONTHLY;BYDAY=54MO", "FREQ=DAILY;BYHOUR=24",
+        "FREQ=DAILY;BYSECOND=60", "FREQ=YEARLY;BYWEEKNO=20", "FREQ=DAILY;BYSETPOS=0", "FREQ=DAILY;COLOR=RED",
+        "FREQ=DAILY;BYMONTH", "FREQ=DAILY;BYMONTH=1,"
+    };
+    for (auto s : invalid)
+    {
+        EXPECT_THROWS_AS(RRule{s}, std::system_error);
+        std::error_code ec;
+        RRule(s, ec);
+        EXPECT(ec == errc::invalid_rule);
+    }
+    std::error_code ec = errc::parse_error;
+    RRule("FREQ=YEARLY;UNTIL=20171231T235959Z;BYMONTHDAY=1,-1;BYSETPOS=1,-1;", ec);
+    EXPECT(!ec);
+
+    EXPECT_THROWS_AS(RRule("FREQ=HOURLY").expand(Date(date::year(2017)/1/1)), std::invalid_argument);
+    EXPECT_THROWS_AS(RRule("FREQ=DAILY;BYHOUR=9").expand(Date(date::year(2017)/1/1)), std::invalid_argument);
+}
+
+
+CASE("RRule monthly" "[rrule]")
+{
+    // every 2nd Tuesday
+    EXPECT((dates("FREQ=MONTHLY;BYDAY=2TU;COUNT=4", Date(date::year(2017)/1/1))
+           == std::vector<Date>{Date(date::year(2017)/1/10), Date(date::year(2017)/2/14), Date(date::year(2017)/3/14), Date(date::year(2017)/4/11)}));
+    // last weekday of the month
+    EXPECT((dates("FREQ=MONTHLY;BYDAY=MO,TU,WE,TH,FR;BYSETPOS=-1;COUNT=3", Date(date::year(2017)/1/1))
+           == std::vector<Date>{Date(date::year(2017)/1/31), Date(date::year(2017)/2/28), Date(date::year(2017)/3/31)}));
+    EXPECT((dates("FREQ=MONTHLY;BYMONTHDAY=-1;UNTIL=20170430", Date(date::year(2017)/1/15))
+           == std::vector<Date>{Date(date::year(2017)/1/31), Date(date::year(2017)/2/28), Date(date::year(2017)/3/31), Date(date::year(2017)/4/30)}));
+    // months without the day of start are skipped
+    EXPECT((dates("FREQ=MONTHLY;COUNT=3", Date(date::year(2017)/1/31))
+           == std::vector<Date>{Date(date::year(2017)/1/31), Date(date::year(2017)/3/31), Date(date::year(2017)/5/31)}));
+    // RFC 5545: Friday the 13th
+    EXPECT((dates("FREQ=MONTHLY;BYDAY=FR;BYMONTHDAY=13;COUNT=5", Date(date::year(1997)/9/2))
+           == std::vector<Date>{Date(date::year(1998)/2/13), Date(date::year(1998)/3/13), Date(date::year(1998)/11/13), Date(date::year(1999)/8/13),
+                                Date(date::year(2000)/10/13)}));
+    // RFC 5545: the 2nd to last Monday, every other month in the summer
+    EXPECT((dates("FREQ=MONTHLY;INTERVAL=2;BYMONTH=6,8;BYDAY=-2MO;COUNT=3", Date(date::year(2016)/12/1))
+           == std::vector<Date>{Date(date::year(2017)/6/19), Date(date::year(2017)/8/21), Date(date::year(2018)/6/18)}));
+    // quarter ends
+    EXPECT((dates("FREQ=MONTHLY;INTERVAL=3;BYMONTHDAY=-1;COUNT=3", Date(date::year(2017)/3/1))
+           == std::vector<Date>{Date(date::year(2017)/3/31), Date(date::year(2017)/6/30), Date(date::year(2017)/9/30)}));
+    // never
+    EXPECT(dates("FREQ=MONTHLY;BYMONTH=2;BYMONTHDAY=30", Date(date::year(2017)/1/1)).empty());
+}
+
+
+CASE("RRule yearly" "[rrule]")
+{
+    EXPECT((dates("FREQ=YEARLY;BYMONTH=2;BYMONTHDAY=29;COUNT=3", Date(date::year(2015)/1/1))
+           == std::vector<Date>{Date(date::year(2016)/2/29), Date(date::year(2020)/2/29), Date(date::year(2024)/2/29)}));
+    EXPECT((dates("FREQ=YEARLY;COUNT=3", Date(date::year(2016)/2/29))
+           == std::vector<Date>{Date(date::year(2016)/2/29), Date(date::year(2020)/2/29), Date(date::year(2024)/2/29)}));
+    // RFC 5545: the 20th Monday of the year, and the Thanksgivings
+    EXPECT((dates("FREQ=YEARLY;BYDAY=20MO;COUNT=3", Date(date::year(1997)/5/19))
+           == std::vector<Date>{Date(date::year(1997)/5/19), Date(date::year(1998)/5/18), Date(date::year(1999)/5/17)}));
+    EXPECT((dates("FREQ=YEARLY;BYMONTH=11;BYDAY=4TH;COUNT=3", Date(date::year(2017)/1/1))
+           == std::vector<Date>{Date(date::year(2017)/11/23), Date(date::year(2018)/11/22), Date(date::year(2019)/11/28)}));
+    EXPECT((dates("FREQ=YEARLY;BYDAY=-1FR;COUNT=2", Date(date::year(2017)/1/1))
+           == std::vector<Date>{Date(date::year(2017)/12/29), Date(date::year(2018)/12/28)}));
+    EXPECT(dates("FREQ=YEARLY;BYMONTH=1,7;BYDAY=SU", Date(date::year(2017)/1/1)).size() == 100u);
+    EXPECT(dates("FREQ=YEARLY;BYMONTH=1,7;BYDAY=SU;UNTIL=20171231", Date(date::year(2017)/1/1)).size() == 10u);
+    // stops after 9999
+    EXPECT(dates("FREQ=YEARLY;INTERVAL=100", Date(date::year(1970)/6/1), 1000).size() == 81u);
+}
+
+
+CASE("RRule weekly and daily" "[rrule]")
+{
+    // RFC 5545: WKST changes the weeks of intervals
+    EXPECT((dates("FREQ=WEEKLY;INTERVAL=2;COUNT=4;BYDAY=TU,SU;WKST=MO", Date(date::year(1997)/8/5))
+           == std::vector<Date>{Date(date::year(1997)/8/5), Date(date::year(1997)/8/10), Date(date::year(1997)/8/19), Date(date::year(1997)/8/24)}));
+    EXPECT((dates("FREQ=WEEKLY;INTERVAL=2;COUNT=4;BYDAY=TU,SU;WKST=SU", Date(date::year(1997)/8/5))
+           == std::vector<Date>{Date(date::year(1997)/8/5), Date(date::year(1997)/8/17), Date(date::year(1997)/8/19), Date(date::year(1997)/8/31)}));
+    EXPECT((dates("FREQ=WEEKLY;COUNT=2", Date(date::year(2017)/6/14))
+           == std::vector<Date>{Date(date::year(2017)/6/14), Date(date::year(2017)/6/21)}));
+    EXPECT((dates("FREQ=DAILY;BYMONTH=1;BYDAY=MO;COUNT=3", Date(date::year(2017)/6/1))
+           == std::vector<Date>{Date(date::year(2018)/1/1), Date(date::year(2018)/1/8), Date(date::year(2018)/1/15)}));
+
+    // the jumps of DAILY rules give the days of a loop over all days
+    const char* rules[] = {
+        "FREQ=DAILY;INTERVAL=3;BYDAY=MO,FR", "FREQ=DAILY;INTERVAL=10;BYMONTH=2,3,12;BYDAY=SA",
+        "FREQ=DAILY;BYMONTHDAY=1,15,-1;BYMONTH=4", "FREQ=DAILY;INTERVAL=7;BYDAY=TU", "FREQ=DAILY;INTERVAL=5",
+    };
+    const auto start = Date(date::year(2016)/11/3);
+    for (auto rule : rules)
+    {
+        RRule r(rule);
+        std::vector<Date> loop;
+        for (auto n = SerialDate(start).serial(); loop.size() < 40 && n < SerialDate(start).serial() + 20000;
+             n += static_cast<std::int32_t>(r.interval()))
+        {
+            // the rule as one day, filtered by the rule
+            auto d = SerialDate(n).date();
+            if (!dates(std::string(rule) + ";COUNT=1", d).empty() && dates(std::string(rule) + ";COUNT=1", d)[0] == d)
+            {
+                loop.push_back(d);
+            }
+        }
+        EXPECT(dates(rule, start, loop.size()) == loop);
+    }
+}
+
+
+CASE("RRule iterators" "[rrule]")
+{
+    auto r = RRule("FREQ=MONTHLY;BYMONTHDAY=1,15;COUNT=5").expand(Date(date::year(2017)/1/10));
+    std::vector<Date> v(r.begin(), r.end());
+    EXPECT((v == std::vector<Date>{Date(date::year(2017)/1/15), Date(date::year(2017)/2/1), Date(date::year(2017)/2/15), Date(date::year(2017)/3/1),
+                                   Date(date::year(2017)/3/15)}));
+    auto it = r.begin();
+    auto copy = it++;
+    EXPECT(*copy == Date(date::year(2017)/1/15));
+    EXPECT(*it == Date(date::year(2017)/2/1));
+    EXPECT(copy != it);
+    EXPECT(++copy == it);
+    EXPECT(std::distance(r.begin(), r.end()) == 5);
+    EXPECT(RRule("FREQ=DAILY;COUNT=0").expand(Date(date::year(2017)/1/1)).begin() == r.end());
+}
+
+
+CASE("RRule DateTime" "[rrule]")
+{
+    auto paris = date::locate_zone("Europe/Paris");
+    auto at = [&](int y, unsigned m, unsigned d, int h, int mi) {
+        return DateTime<seconds>(date::make_zoned(paris, date::local_days(date::year(y)/m/d) + hours(h) + minutes(mi)));
+    };
+
+    // hours are absolute: 23 of them on the day clocks go forward
+    EXPECT((times("FREQ=HOURLY;COUNT=4", at(2017, 3, 26, 0, 0))
+           == std::vector<std::string>{"2017-03-26 00:00:00 CET", "2017-03-26 01:00:00 CET",
+                                       "2017-03-26 03:00:00 CEST", "2017-03-26 04:00:00 CEST"}));
+    EXPECT(times("FREQ=HOURLY;UNTIL=20170326T235959", at(2017, 3, 26, 0, 0)).size() == 23u);
+    EXPECT(times("FREQ=HOURLY;UNTIL=20171029T235959", at(2017, 10, 29, 0, 0)).size() == 25u);
+    EXPECT((times("FREQ=HOURLY;BYHOUR=2;COUNT=4", at(2017, 10, 28, 0, 0))
+           == std::vector<std::string>{"2017-10-28 02:00:00 CEST", "2017-10-29 02:00:00 CEST",
+                                       "2017-10-29 02:00:00 CET", "2017-10-30 02:00:00 CET"}));
+
+    // days are on the wall clock: 02:30 does not exist on 2017-03-26
+    EXPECT((times("FREQ=DAILY;COUNT=3", at(2017, 3, 25, 2, 30))
+           == std::vector<std::string>{"2017-03-25 02:30:00 CET", "2017-03-26 03:30:00 CEST",
+                                       "2017-03-27 02:30:00 CEST"}));
+    EXPECT((times("FREQ=WEEKLY;BYDAY=SU;BYHOUR=2;BYMINUTE=30;COUNT=2", at(2017, 10, 22, 0, 0))
+           == std::vector<std::string>{"2017-10-22 02:30:00 CEST", "2017-10-29 02:30:00 CEST"}));
+    EXPECT((times("FREQ=DAILY;BYHOUR=9,17;BYMINUTE=0,30;COUNT=5", at(2017, 6, 1, 12, 0))
+           == std::vector<std::string>{"2017-06-01 17:00:00 CEST", "2017-06-01 17:30:00 CEST",
+                                       "2017-06-02 09:00:00 CEST", "2017-06-02 09:30:00 CEST",
+                                       "2017-06-02 17:00:00 CEST"}));
+    // the last weekday of the month at 18:00
+    EXPECT((times("FREQ=MONTHLY;BYDAY=MO,TU,WE,TH,FR;BYHOUR=18;BYMINUTE=0;BYSECOND=0;BYSETPOS=-1;COUNT=2",
+                  at(2017, 1, 1, 0, 0))
+           == std::vector<std::string>{"2017-01-31 18:00:00 CET", "2017-02-28 18:00:00 CET"}));
+
+    // every 15 minutes of 9 o'clock on weekdays, from 08:50
+    auto ny = DateTime<seconds>(date::make_zoned(date::locate_zone("America/New_York"),
+                                                 date::local_days(date::year(2017)/6/2) + hours(8) + minutes(50)));
+    EXPECT((times("FREQ=MINUTELY;INTERVAL=15;BYHOUR=9;BYDAY=MO,TU,WE,TH,FR;COUNT=6", ny)
+           == std::vector<std::string>{"2017-06-02 09:05:00 EDT", "2017-06-02 09:20:00 EDT",
+                                       "2017-06-02 09:35:00 EDT", "2017-06-02 09:50:00 EDT",
+                                       "2017-06-05 09:05:00 EDT", "2017-06-05 09:20:00 EDT"}));
+    EXPECT(times("FREQ=SECONDLY;INTERVAL=20;BYSECOND=0,40;UNTIL=20170602T130000Z", ny).size() == 21u);
+    EXPECT(times("FREQ=HOURLY;BYMINUTE=0,30;UNTIL=20170602T100000", ny).size() == 3u);
+
+    // sub-second parts of start are kept
+    auto ms = DateTime<milliseconds>(date::make_zoned(paris, date::local_days(date::year(2017)/1/1) + milliseconds(250)));
+    auto r = RRule("FREQ=DAILY;COUNT=2").expand(ms);
+    auto it = r.begin();
+    EXPECT((*++it).zoned_time().get_sys_time() == ms.zoned_time().get_sys_time() + hours(24));
+}
+
+} // anonymous namespace
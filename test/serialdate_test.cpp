@@ -0,0 +1,127 @@
+#include "lest.h"
+#define CASE( name ) lest_CASE( specification(), name )
+extern lest::tests & specification();
+
+#include "datetime.h"
+
+#include <algorithm>
+#include <sstream>
+#include <type_traits>
+#include <vector>
+
+namespace 
+{
+
+using namespace datetime;
+
+
+CASE("basic" "[serialdate]") 
+{
+    static_assert(sizeof(SerialDate) == 4 && std::is_trivially_copyable<SerialDate>::value, "columnar layout");
+
+    SerialDate d(date::year(2017), date::month(6), date::day(21));
+    EXPECT(d.serial() == 17338);
+    EXPECT(d.year() == date::year(2017));
+    EXPECT(d.month() == date::month(6));
+    EXPECT(d.day() == date::day(21));
+    EXPECT(d.weekday() == 2u);
+    EXPECT(d.isoweekday() == 3u);
+    EXPECT(d.objweekday() == date::weekday(3u));
+    EXPECT(d.isoformat() == "2017-06-21");
+    EXPECT(d.strftime("%d/%m/%Y") == "21/06/2017");
+    EXPECT(SerialDate(-1).weekday() == 2u);
+    EXPECT(SerialDate(date::year(1969)/12/31).serial() == -1);
+
+    std::ostringstream os;
+    os << d;
+    EXPECT(os.str() == "2017-06-21");
+}
+
+
+CASE("conversions" "[serialdate]") 
+{
+    Date x(date::year(2000), date::month(2), date::day(29));
+    SerialDate d = x;
+    EXPECT(d.date() == x);
+    EXPECT(d.sys_days() == date::sys_days(date::year(2000)/2/29));
+    EXPECT(SerialDate(date::sys_days(date::year(-32767)/1/1)).year_month_day() == date::year(-32767)/1/1);
+    EXPECT(SerialDate(date::sys_days(date::year(32767)/12/31)).year_month_day() == date::year(32767)/12/31);
+}
+
+
+CASE("arithmetic and ordering" "[serialdate]") 
+{
+    SerialDate d(date::year(2017), date::month(6), date::day(21));
+    EXPECT((d + date::days(11)).year_month_day() == date::year(2017)/7/2);
+    EXPECT((d - TimeDelta(date::weeks(1))).year_month_day() == date::year(2017)/6/14);
+    EXPECT((TimeDelta(date::days(1)) + d).year_month_day() == date::year(2017)/6/22);
+    EXPECT((d - SerialDate(date::year(2017), date::month(1), date::day(1))).days() == 171);
+
+    auto e = d;
+    e += date::days(1);
+    EXPECT(d < e);
+    EXPECT(d <= e);
+    EXPECT(e > d);
+    EXPECT(e >= d);
+    EXPECT(d != e);
+    e -= date::days(1);
+    EXPECT(d == e);
+
+    std::vector<SerialDate> column = {SerialDate(5), SerialDate(-3), SerialDate(2)};
+    std::sort(column.begin(), column.end());
+    EXPECT(column.front().serial() == -3);
+}
+
+CASE("isocalendar and ordinals" "[serialdate]") 
+{
+    // day by day: weeks follow Mondays, and week 1 has January 4th
+    SerialDate d(date::year(1890), date::month(1), date::day(1));
+    auto prev = d.isocalendar();
+    EXPECT((prev == IsoCalendar{1890, 1, 3}));
+    bool same = true;
+    for (d += date::days(1); d < SerialDate(date::year(2110), date::month(1), date::day(1)); d += date::days(1))
+    {
+        auto iso = d.isocalendar();
+        same = same && iso.weekday == d.isoweekday();
+        if (iso.weekday != 1)
+        {
+            same = same && iso.year == prev.year && iso.week == prev.week;
+        }
+        else if ((d.month() == date::jan && d.day() <= date::day(4)) ||
+                 (d.month() == date::dec && d.day() >= date::day(29)))
+        {
+            same = same && iso.year == prev.year + 1 && iso.week == 1 && (prev.week == 52 || prev.week == 53);
+        }
+        else
+        {
+            same = same && iso.year == prev.year && iso.week == prev.week + 1;
+        }
+        same = same && d.dayofyear() == static_cast<unsigned>((d - SerialDate(d.year()/1/1)).days()) + 1;
+        same = same && SerialDate::fromordinal(d.toordinal()) == d;
+        prev = iso;
+    }
+    EXPECT(same);
+    EXPECT(SerialDate(0).toordinal() == 719163);
+    // a Saturday, in the last week of the year before the range of date::year
+    EXPECT((SerialDate(date::year(-32767)/1/1).isocalendar() == IsoCalendar{-32768, 53, 6}));
+}
+
+
+CASE("constexpr" "[serialdate]") 
+{
+    using namespace datetime::literals;
+
+    static constexpr SerialDate epoch(date::sys_days(date::days(0)));
+    static_assert((epoch + 17338_days).serial() == 17338, "addition");
+    static_assert((epoch - TimeDelta(1_days)) < epoch, "ordering");
+    static_assert(epoch.objweekday() == date::weekday(4u), "Thursday");
+#if __cplusplus >= 201402
+    static_assert(SerialDate(2017_y/6/21).serial() == 17338, "from civil");
+    static_assert(SerialDate(17338).year_month_day() == 2017_y/6/21, "to civil");
+    static_assert(SerialDate(17338).weekday() == 2, "weekday");
+#endif
+
+    EXPECT((epoch + 17338_days).year_month_day() == 2017_y/6/21);
+}
+
+} // anonymous namespace
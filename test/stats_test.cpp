@@ -0,0 +1,212 @@
+#include "lest.h"
+#define CASE( name ) lest_CASE( specification(), name )
+extern lest::tests & specification();
+
+#include "stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace
+{
+
+using namespace datetime;
+using namespace std::chrono;
+
+std::vector<TimeDelta> deltas(std::size_t n)
+{
+    // spread over about +-10 days, negative ones included
+    std::vector<TimeDelta> v;
+    std::uint64_t x = 88172645463325252ULL;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        v.push_back(TimeDelta(microseconds(static_cast<std::int64_t>(x % 1728000000000) - 864000000000)));
+    }
+    return v;
+}
+
+
+CASE("describe_column" "[stats]")
+{
+    std::vector<TimeDelta> v = {TimeDelta(seconds(1)), TimeDelta(seconds(-2)), TimeDelta(milliseconds(3500)),
+                                TimeDelta(microseconds(1))};
+    auto s = describe_column(v.data(), v.size());
+    EXPECT(s.count == 4u);
+    EXPECT(!s.overflow);
+    EXPECT(s.sum.to_duration() == microseconds(2500001));
+    EXPECT(s.mean.to_duration() == microseconds(625000)); // 625000.25
+    EXPECT(s.min.to_duration() == seconds(-2));
+    EXPECT(s.max.to_duration() == milliseconds(3500));
+
+    double var = 0;
+    for (const auto& x : v)
+    {
+        double d = static_cast<double>(x.to_duration().count()) - 625000.25;
+        var += d * d / 4;
+    }
+    EXPECT(std::abs(s.variance - var) <= 1e-9 * var);
+    EXPECT(s.stddev().to_duration() == microseconds(std::llrint(std::sqrt(var))));
+
+    // means rounded half to even
+    std::vector<TimeDelta> w = {TimeDelta(microseconds(1)), TimeDelta(microseconds(2))};
+    EXPECT(describe_column(w.data(), 2).mean.to_duration() == microseconds(2));
+    w = {TimeDelta(microseconds(-1)), TimeDelta(microseconds(-2))};
+    EXPECT(describe_column(w.data(), 2).mean.to_duration() == microseconds(-2));
+    w = {TimeDelta(microseconds(-3)), TimeDelta(microseconds(2))};
+    EXPECT(describe_column(w.data(), 2).mean.to_duration() == microseconds(0));
+
+    auto empty = describe_column(v.data(), 0);
+    EXPECT(empty.count == 0u);
+    EXPECT(empty.sum.to_duration() == microseconds(0));
+}
+
+
+CASE("describe_column matches a loop" "[stats]")
+{
+    for (std::size_t n : {1u, 3u, 7u, 4096u, 4099u, 20011u})
+    {
+        auto v = deltas(n);
+        std::int64_t sum = 0;
+        std::int64_t lo = std::numeric_limits<std::int64_t>::max();
+        std::int64_t hi = std::numeric_limits<std::int64_t>::min();
+        for (const auto& x : v)
+        {
+            sum += x.to_duration().count();
+            lo = std::min(lo, x.to_duration().count());
+            hi = std::max(hi, x.to_duration().count());
+        }
+        auto s = describe_column(v.data(), n);
+        EXPECT(s.sum.to_duration().count() == sum);
+        EXPECT(s.min.to_duration().count() == lo);
+        EXPECT(s.max.to_duration().count() == hi);
+        auto mean = s.mean.to_duration().count();
+        auto n64 = static_cast<std::int64_t>(n);
+        EXPECT(std::abs(mean * n64 - sum) * 2 <= n64);
+
+        ThreadPool pool(3);
+        auto p = describe_column(v.data(), n, pool);
+        EXPECT(p.sum.to_duration() == s.sum.to_duration());
+        EXPECT(p.mean.to_duration() == s.mean.to_duration());
+        EXPECT(p.min.to_duration() == s.min.to_duration());
+        EXPECT(p.max.to_duration() == s.max.to_duration());
+        EXPECT(std::abs(p.variance - s.variance) <= 1e-9 * s.variance);
+    }
+}
+
+
+CASE("describe_column overflow" "[stats]")
+{
+    const auto big = microseconds(std::numeric_limits<std::int64_t>::max());
+    std::vector<TimeDelta> v(5, TimeDelta(big));
+    auto s = describe_column(v.data(), v.size());
+    EXPECT(s.overflow);
+    EXPECT(s.sum.to_duration() == microseconds(0));
+    EXPECT(s.mean.to_duration() == big);
+    EXPECT(s.max.to_duration() == big);
+
+    v.push_back(TimeDelta(-big));
+    v.push_back(TimeDelta(-big));
+    v.push_back(TimeDelta(-big));
+    v.push_back(TimeDelta(-big));
+    v.push_back(TimeDelta(-big - microseconds(1)));
+    s = describe_column(v.data(), v.size());
+    EXPECT(!s.overflow);
+    EXPECT(s.sum.to_duration() == microseconds(-1));
+    EXPECT(s.min.to_duration() == -big - microseconds(1));
+}
+
+
+CASE("describe_column durations" "[stats]")
+{
+    std::vector<milliseconds> ms = {milliseconds(5), milliseconds(-15), milliseconds(40)};
+    auto s = describe_column(ms.data(), ms.size());
+    EXPECT(s.sum.to_duration() == milliseconds(30));
+    EXPECT(s.mean.to_duration() == milliseconds(10));
+    EXPECT(s.min.to_duration() == milliseconds(-15));
+
+    std::vector<microseconds> us = {microseconds(3), microseconds(4)};
+    EXPECT(describe_column(us.data(), us.size()).sum.to_duration() == microseconds(7));
+
+    std::vector<nanoseconds> ns = {nanoseconds(1999), nanoseconds(-1999)};
+    s = describe_column(ns.data(), ns.size());
+    EXPECT(s.max.to_duration() == microseconds(1)); // truncated as by TimeDelta
+    EXPECT(s.min.to_duration() == microseconds(-1));
+}
+
+
+CASE("DeltaHistogram" "[stats]")
+{
+    DeltaHistogram h;
+    EXPECT_THROWS_AS(h.percentile(50), std::out_of_range);
+    EXPECT_THROWS_AS(DeltaHistogram(0), std::invalid_argument);
+    EXPECT_THROWS_AS(DeltaHistogram(13), std::invalid_argument);
+
+    std::vector<TimeDelta> v;
+    for (std::int64_t i = 1; i <= 100000; ++i)
+    {
+        v.push_back(TimeDelta(microseconds(i * 1000)));
+    }
+    h.add(v.data(), v.size());
+    EXPECT(h.count() == 100000u);
+    EXPECT(h.min().to_duration() == milliseconds(1));
+    EXPECT(h.max().to_duration() == seconds(100));
+    EXPECT(h.percentile(0).to_duration() == milliseconds(1));
+    EXPECT(h.percentile(100).to_duration() == seconds(100));
+    for (double p : {1.0, 25.0, 50.0, 90.0, 99.0, 99.9})
+    {
+        double exact = p * 1000;  // ms
+        double got = static_cast<double>(h.percentile(p).to_duration().count()) / 1000;
+        EXPECT(std::abs(got - exact) <= exact / 128);
+    }
+
+    // small values are exact, negative ones too
+    DeltaHistogram g(7);
+    for (int i = -100; i <= 100; ++i)
+    {
+        g.add(TimeDelta(microseconds(i)));
+    }
+    EXPECT(g.percentile(50).to_duration() == microseconds(0));
+    EXPECT(g.percentile(0.5).to_duration() == microseconds(-99));
+    EXPECT(g.percentile(75).to_duration() == microseconds(50));
+
+    DeltaHistogram extremes(3);
+    extremes.add(TimeDelta(microseconds(std::numeric_limits<std::int64_t>::min())));
+    extremes.add(TimeDelta(microseconds(std::numeric_limits<std::int64_t>::max())));
+    EXPECT(extremes.percentile(50).to_duration().count() == std::numeric_limits<std::int64_t>::min());
+    auto top = extremes.percentile(99).to_duration().count();
+    EXPECT(top >= std::numeric_limits<std::int64_t>::max() / 8 * 7);
+    EXPECT(extremes.percentile(100).to_duration().count() == std::numeric_limits<std::int64_t>::max());
+}
+
+
+CASE("DeltaHistogram merge" "[stats]")
+{
+    auto v = deltas(50000);
+    DeltaHistogram whole(9), a(9), b(9);
+    whole.add(v.data(), v.size());
+    a.add(v.data(), 20000);
+    b.add(v.data() + 20000, 30000);
+    a.merge(b);
+    EXPECT(a.count() == whole.count());
+    for (double p : {0.0, 10.0, 50.0, 99.0, 100.0})
+    {
+        EXPECT(a.percentile(p).to_duration() == whole.percentile(p).to_duration());
+    }
+
+    ThreadPool pool(3);
+    DeltaHistogram parallel(9);
+    parallel.add(v.data(), v.size(), pool);
+    EXPECT(parallel.percentile(50).to_duration() == whole.percentile(50).to_duration());
+    EXPECT(parallel.min().to_duration() == whole.min().to_duration());
+
+    EXPECT_THROWS_AS(a.merge(DeltaHistogram(7)), std::invalid_argument);
+    a.clear();
+    EXPECT(a.count() == 0u);
+}
+
+} // anonymous namespace
@@ -0,0 +1,82 @@
+#include "lest.h"
+#define CASE( name ) lest_CASE( specification(), name )
+extern lest::tests & specification();
+
+#include "datetime.h"
+
+namespace 
+{
+
+using namespace datetime;
+using namespace std::chrono;
+
+
+CASE("basic" "[time]") 
+{
+    Time t(hours(13), minutes(5), seconds(7), microseconds(123456));
+    EXPECT(t.hour()        == 13);
+    EXPECT(t.minute()      == 5);
+    EXPECT(t.seconds()     == 7);
+    EXPECT(t.microsecond() == 123456);
+}
+
+
+CASE("isoformat" "[time]") 
+{
+    EXPECT(Time(hours(13), minutes(5), seconds(7)).isoformat() == "13:05:07");
+    EXPECT(Time(hours(13), microseconds(20)).isoformat() == "13:00:00.000020");
+}
+
+
+CASE("strftime" "[time]") 
+{
+    Time t(hours(13), minutes(5), seconds(7), microseconds(123456));
+    EXPECT(t.strftime("%I:%M:%S.%f %p") == "01:05:07.123456 PM");
+    EXPECT(t.strftime("%T") == "13:05:07.123456");
+    EXPECT(Time(hours(13), minutes(5), seconds(7)).strftime("%H:%M:%S") == "13:05:07");
+    EXPECT(Time(hours(13), nanoseconds(1500)).strftime("%T") == "13:00:00.000001");
+    EXPECT(t.strftime("%X") == "13:05:07");
+    EXPECT(t.strftime("%Y-%m-%d") == "1900-01-01");
+
+    Format f("%H%M%S.%f");
+    char buf[16];
+    auto end = t.strftime(buf, buf + sizeof(buf), f);
+    EXPECT(std::string(buf, end) == "130507.123456");
+    EXPECT(t.strftime(buf, buf + 8, f) == nullptr);
+}
+
+
+CASE("format_to" "[time]") 
+{
+    Time t(hours(13), minutes(5), seconds(7), microseconds(123456));
+    std::ostringstream os;
+    os << t;
+    std::string s;
+    format_to(std::back_inserter(s), t);
+    EXPECT(s == t.isoformat());
+    s.clear();
+    format_to(std::back_inserter(s), Time(hours(13), minutes(5), seconds(7)));
+    EXPECT(s == "13:05:07");
+
+    char buf[32];
+    auto r = format_to_n(buf, sizeof(buf), t, Format("%I:%M %p"));
+    EXPECT(std::string(buf, r.out) == "01:05 PM");
+    EXPECT(r.size == 8u);
+
+    std::string delta;
+    format_to(std::back_inserter(delta), TimeDelta(date::days(3), hours(5), microseconds(12)));
+    EXPECT(delta == "3 days, 05:00:00.000012");
+}
+
+CASE("constexpr" "[time]") 
+{
+    using namespace datetime::literals;
+
+    static constexpr Time opening[] = {Time(9_h), Time(9_h, 30_min), Time(13_h, 45_s, 250_ms)};
+    static_assert(opening[1].hour() == 9 && opening[1].minute() == 30, "hour and minute");
+    static_assert(opening[2].seconds() == 45 && opening[2].microsecond() == 250000, "seconds");
+
+    EXPECT(opening[2].isoformat() == "13:00:45.250000");
+}
+
+}
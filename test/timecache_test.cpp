@@ -0,0 +1,75 @@
+#include "lest.h"
+#define CASE( name ) lest_CASE( specification(), name )
+extern lest::tests & specification();
+
+#include "timecache.h"
+
+#include <atomic>
+
+namespace 
+{
+
+using namespace datetime;
+
+
+CASE("cached strings" "[timecache]") 
+{
+    TimeCache cache;
+    auto iso = cache.add_format("%Y-%m-%dT%H:%M:%S", 3);
+    auto http = cache.add_format("%a, %d %b %Y %H:%M:%S GMT");
+
+    auto before = date::floor<std::chrono::seconds>(std::chrono::system_clock::now());
+    auto s = cache.str(iso);
+    auto after = date::floor<std::chrono::seconds>(std::chrono::system_clock::now());
+
+    EXPECT(s.size() == 23u);
+    EXPECT(s[19] == '.');
+    EXPECT((s.substr(0, 19) == date::format("%Y-%m-%dT%H:%M:%S", before) ||
+            s.substr(0, 19) == date::format("%Y-%m-%dT%H:%M:%S", after)));
+    EXPECT(cache.str(http).size() == 29u);
+
+    char buf[TimeCache::max_length];
+    EXPECT(cache.copy(http, buf) == 29u);
+    EXPECT(std::string(buf + 25, 4) == " GMT");
+}
+
+
+CASE("invalid formats" "[timecache]") 
+{
+    TimeCache cache;
+    EXPECT_THROWS_AS(cache.add_format("%Y-%m-%d", 3), std::invalid_argument);
+    EXPECT_THROWS_AS(cache.add_format("%%S", 3), std::invalid_argument);
+    EXPECT_THROWS_AS(cache.add_format("%S", 10), std::invalid_argument);
+}
+
+
+CASE("concurrent readers with ticker" "[timecache]") 
+{
+    TimeCache cache;
+    auto id = cache.add_format("%H:%M:%S", 6);
+    cache.start_ticker();
+
+    std::atomic<int> bad{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t)
+    {
+        readers.emplace_back([&] {
+            char buf[TimeCache::max_length];
+            for (int i = 0; i < 20000; ++i)
+            {
+                if (cache.copy(id, buf) != 15 || buf[2] != ':' || buf[8] != '.')
+                {
+                    ++bad;
+                }
+            }
+        });
+    }
+    for (auto& r : readers)
+    {
+        r.join();
+    }
+    cache.stop_ticker();
+    EXPECT(bad == 0);
+}
+
+}
@@ -0,0 +1,318 @@
+#include "lest.h"
+#define CASE( name ) lest_CASE( specification(), name )
+extern lest::tests & specification();
+
+#include "datetime.h"
+
+#include <cstring>
+#include <sstream>
+#include <unordered_map>
+
+namespace 
+{
+
+using namespace datetime;
+using namespace std::chrono;
+
+using Style = TimeDelta::Style;
+
+std::int64_t total(const TimeDelta& td)
+{
+    return (86400LL * td.days() + td.seconds()) * 1000000 + td.microseconds();
+}
+
+bool parse(const char* s, Style style, std::int64_t& us)
+{
+    TimeDelta td(microseconds(0));
+    auto last = s + std::strlen(s);
+    if (TimeDelta::from_chars(s, last, td, style) != last)
+    {
+        return false;
+    }
+    us = total(td);
+    return true;
+}
+
+
+CASE("normalization" "[timedelta]") 
+{
+    // as timedelta in Python: only days may be negative
+    auto td = TimeDelta(hours(-1));
+    EXPECT(td.days() == -1);
+    EXPECT(td.seconds() == 82800);
+    EXPECT(td.microseconds() == 0);
+    EXPECT(td.total_seconds() == -3600);
+
+    td = TimeDelta(microseconds(-1));
+    EXPECT(td.days() == -1);
+    EXPECT(td.seconds() == 86399);
+    EXPECT(td.microseconds() == 999999);
+    EXPECT(td.to_duration() == microseconds(-1));
+
+    td = TimeDelta(date::days(1), seconds(-1), microseconds(1500000));
+    EXPECT(td.days() == 1);
+    EXPECT(td.seconds() == 0);
+    EXPECT(td.microseconds() == 500000);
+
+    EXPECT((TimeDelta(seconds(1)) - TimeDelta(seconds(2))).to_duration() == seconds(-1));
+    EXPECT((-3 * TimeDelta(milliseconds(5))).to_duration() == milliseconds(-15));
+    EXPECT((1.5 * TimeDelta(seconds(1))).to_duration() == milliseconds(1500));
+    EXPECT((TimeDelta(microseconds(3)) * 0.5).to_duration() == microseconds(2)); // half to even
+
+    std::ostringstream os;
+    os << TimeDelta(hours(-1));
+    EXPECT(os.str() == "-1 days, 23:00:00.000000");
+}
+
+CASE("str python" "[timedelta]") 
+{
+    EXPECT(TimeDelta(seconds(0)).str() == "0:00:00");
+    EXPECT(TimeDelta(date::days(1)).str() == "1 day, 0:00:00");
+    EXPECT(TimeDelta(date::days(3), hours(5), microseconds(12)).str() == "3 days, 5:00:00.000012");
+    EXPECT(TimeDelta(microseconds(-1)).str() == "-1 day, 23:59:59.999999");
+    EXPECT(TimeDelta(milliseconds(-1500)).str() == "-1 day, 23:59:58.500000");
+    EXPECT(TimeDelta(date::days(-2), hours(1)).str() == "-2 days, 1:00:00");
+}
+
+
+CASE("str iso8601" "[timedelta]") 
+{
+    EXPECT(TimeDelta(seconds(0)).str(Style::iso8601) == "PT0S");
+    EXPECT(TimeDelta(date::days(1), hours(2), minutes(3), milliseconds(4500)).str(Style::iso8601) == "P1DT2H3M4.5S");
+    EXPECT(TimeDelta(date::days(2)).str(Style::iso8601) == "P2D");
+    EXPECT(TimeDelta(minutes(90)).str(Style::iso8601) == "PT1H30M");
+    EXPECT(TimeDelta(microseconds(-1)).str(Style::iso8601) == "-PT0.000001S");
+}
+
+
+CASE("str compact" "[timedelta]") 
+{
+    EXPECT(TimeDelta(seconds(0)).str(Style::compact) == "0us");
+    EXPECT(TimeDelta(microseconds(250)).str(Style::compact) == "250us");
+    EXPECT(TimeDelta(microseconds(1500)).str(Style::compact) == "1.5ms");
+    EXPECT(TimeDelta(milliseconds(-1500)).str(Style::compact) == "-1.5s");
+    EXPECT(TimeDelta(hours(1)).str(Style::compact) == "1h0m0s");
+    EXPECT(TimeDelta(hours(1), minutes(2), milliseconds(3500)).str(Style::compact) == "1h2m3.5s");
+}
+
+
+CASE("to_chars" "[timedelta]") 
+{
+    char buf[TimeDelta::max_chars];
+    auto td = TimeDelta(date::days(-99999), microseconds(-999999));
+    for (auto style : {Style::python, Style::iso8601, Style::compact})
+    {
+        auto end = td.to_chars(buf, buf + sizeof(buf), style);
+        EXPECT(end != nullptr);
+        EXPECT(td.to_chars(buf, end - 1, style) == nullptr);
+    }
+    EXPECT(std::string(buf, td.to_chars(buf, buf + sizeof(buf))) == "-100000 days, 23:59:59.000001");
+}
+
+
+CASE("from_chars round trip" "[timedelta]") 
+{
+    const std::int64_t values[] = {0, 1, -1, 999, 1500, -1500000, 86400000000, 90061000001,
+                                   -90061500000, 3600000000, 172800000005};
+    for (auto style : {Style::python, Style::iso8601, Style::compact})
+    {
+        for (auto v : values)
+        {
+            auto s = TimeDelta(microseconds(v)).str(style);
+            std::int64_t us = -42;
+            EXPECT(parse(s.c_str(), style, us));
+            EXPECT(us == v);
+        }
+        // the ends of the range, the most negative has no positive counterpart
+        for (auto td : {TimeDelta::min(), TimeDelta::max()})
+        {
+            TimeDelta back(microseconds(0));
+            const auto s = td.str(style);
+            EXPECT(TimeDelta::from_chars(s.data(), s.data() + s.size(), back, style) == s.data() + s.size());
+            EXPECT(back == td);
+        }
+        using NanoDelta = BasicTimeDelta<nanoseconds>;
+        for (auto td : {NanoDelta::min(), NanoDelta::max()})
+        {
+            NanoDelta back(nanoseconds(0));
+            const auto s = td.str(style);
+            EXPECT(NanoDelta::from_chars(s.data(), s.data() + s.size(), back, style) == s.data() + s.size());
+            EXPECT(back == td);
+        }
+    }
+    TimeDelta td(microseconds(0));
+    const std::string below = "-106751992 days, 19:59:05.224191";
+    EXPECT(TimeDelta::from_chars(below.data(), below.data() + below.size(), td) == nullptr);
+    const std::string above = "PT2562047788H54.775808S";
+    EXPECT(TimeDelta::from_chars(above.data(), above.data() + above.size(), td, Style::iso8601) == nullptr);
+}
+
+
+CASE("from_chars" "[timedelta]") 
+{
+    std::int64_t us = 0;
+    EXPECT((parse("3 days, 1:02:03", Style::python, us) && us == 262923000000LL));
+    EXPECT((parse("-1 day, 23:59:59.5", Style::python, us) && us == -500000));
+    EXPECT(!parse("1 day 0:00:00", Style::python, us));
+    EXPECT(!parse("1:60:00", Style::python, us));
+
+    EXPECT((parse("P1W", Style::iso8601, us) && us == 7 * 86400000000LL));
+    EXPECT((parse("-PT0,5S", Style::iso8601, us) && us == -500000));
+    EXPECT((parse("PT1.5H", Style::iso8601, us) && us == 5400000000LL));
+    EXPECT(!parse("P1Y", Style::iso8601, us));
+    EXPECT(!parse("PT", Style::iso8601, us));
+    EXPECT(!parse("P1H", Style::iso8601, us));
+    EXPECT(!parse("PT1S2M", Style::iso8601, us));
+
+    EXPECT((parse("1h2m3.5s", Style::compact, us) && us == 3723500000LL));
+    EXPECT((parse("2d", Style::compact, us) && us == 2 * 86400000000LL));
+    EXPECT((parse("0", Style::compact, us) && us == 0));
+    EXPECT((parse("10\xc2\xb5s", Style::compact, us) && us == 10));
+    EXPECT((parse("1500ns", Style::compact, us) && us == 2));
+    EXPECT((parse("2500ns", Style::compact, us) && us == 2));
+    EXPECT(!parse("1x", Style::compact, us));
+    EXPECT(!parse("9999999999999999999h", Style::compact, us));
+}
+
+CASE("precision" "[timedelta]") 
+{
+    using NanoDelta = BasicTimeDelta<nanoseconds>;
+    auto td = NanoDelta(nanoseconds(-1));
+    EXPECT(td.days() == -1);
+    EXPECT(td.seconds() == 86399);
+    EXPECT(td.microseconds() == 999999);
+    EXPECT(td.total_seconds() == -1);
+    EXPECT(td.str() == "-1 day, 23:59:59.999999999");
+    EXPECT(td.str(Style::compact) == "-1ns");
+    EXPECT(td.str(Style::iso8601) == "-PT0.000000001S");
+    EXPECT(NanoDelta(microseconds(1500)).str() == "0:00:00.001500");
+    EXPECT(NanoDelta(nanoseconds(1500)).str(Style::compact) == "1.5us");
+    EXPECT(NanoDelta(nanoseconds(1000001)).str(Style::compact) == "1.000001ms");
+
+    // the finer precision wins, and converting back truncates as from a duration
+    auto sum = TimeDelta(microseconds(1)) + NanoDelta(nanoseconds(1));
+    static_assert(std::is_same<decltype(sum), NanoDelta>::value, "common precision");
+    EXPECT(sum.to_duration() == nanoseconds(1001));
+    EXPECT((NanoDelta(nanoseconds(5)) - TimeDelta(seconds(1))).to_duration() == nanoseconds(-999999995));
+    EXPECT(TimeDelta(sum).to_duration() == microseconds(1));
+    EXPECT((3 * NanoDelta(nanoseconds(7))).to_duration() == nanoseconds(21));
+    EXPECT((NanoDelta(nanoseconds(3)) * 0.5).to_duration() == nanoseconds(2));
+
+    std::ostringstream os;
+    os << NanoDelta(hours(-1), nanoseconds(5));
+    EXPECT(os.str() == "-1 days, 23:00:00.000000005");
+    char buf[64];
+    EXPECT(std::string(buf, format_to(buf, BasicTimeDelta<milliseconds>(milliseconds(-1)))) == "-1 days, 23:59:59.999");
+    EXPECT(std::string(buf, format_to(buf, BasicTimeDelta<seconds>(minutes(1)))) == "0 days, 00:01:00");
+
+    // parsing rounds half to even to the tick
+    NanoDelta nd(nanoseconds(0));
+    std::string s = "-1 day, 23:59:59.999999999";
+    EXPECT(NanoDelta::from_chars(s.data(), s.data() + s.size(), nd) == s.data() + s.size());
+    EXPECT(nd.to_duration() == nanoseconds(-1));
+    s = "1500ns";
+    EXPECT(NanoDelta::from_chars(s.data(), s.data() + s.size(), nd, Style::compact) == s.data() + s.size());
+    EXPECT(nd.to_duration() == nanoseconds(1500));
+    BasicTimeDelta<milliseconds> md(milliseconds(0));
+    s = "2.5ms";
+    EXPECT(BasicTimeDelta<milliseconds>::from_chars(s.data(), s.data() + s.size(), md, Style::compact) != nullptr);
+    EXPECT(md.to_duration() == milliseconds(2));
+    s = "-PT0.0035S";
+    EXPECT(BasicTimeDelta<milliseconds>::from_chars(s.data(), s.data() + s.size(), md, Style::iso8601) != nullptr);
+    EXPECT(md.to_duration() == milliseconds(-4));
+    s = "107000d";
+    EXPECT(NanoDelta::from_chars(s.data(), s.data() + s.size(), nd, Style::compact) == nullptr);
+}
+
+CASE("division and ordering" "[timedelta]") 
+{
+    const auto x = TimeDelta(seconds(7));
+    const auto y = TimeDelta(seconds(-2));
+
+    // as in Python: / rounds half to even, // and % floor, % has the sign of y
+    EXPECT((TimeDelta(microseconds(5)) / 2).to_duration() == microseconds(2));
+    EXPECT((TimeDelta(microseconds(7)) / 2).to_duration() == microseconds(4));
+    EXPECT((TimeDelta(microseconds(-5)) / 2).to_duration() == microseconds(-2));
+    EXPECT((TimeDelta(microseconds(5)) / -2).to_duration() == microseconds(-2));
+    EXPECT((TimeDelta(microseconds(-7)) / -2).to_duration() == microseconds(4));
+    EXPECT((TimeDelta(microseconds(10)) / 4.0).to_duration() == microseconds(2));
+    EXPECT(x / y == -3.5);
+    EXPECT(floor_div(x, y) == -4);
+    EXPECT((x % y).to_duration() == seconds(-1));
+    EXPECT((y % x).to_duration() == seconds(5));
+    EXPECT(floor_div(TimeDelta(microseconds(-1)), 2).to_duration() == microseconds(-1));
+    auto qr = divmod(x, TimeDelta(seconds(3)));
+    EXPECT(qr.first == 2);
+    EXPECT(qr.second.to_duration() == seconds(1));
+
+    // ZeroDivisionError in Python
+    const auto zero = TimeDelta(seconds(0));
+    EXPECT_THROWS_AS(x / 0, std::domain_error);
+    EXPECT_THROWS_AS(x / 0.0, std::domain_error);
+    EXPECT_THROWS_AS(x / zero, std::domain_error);
+    EXPECT_THROWS_AS(floor_div(x, 0), std::domain_error);
+    EXPECT_THROWS_AS(floor_div(x, zero), std::domain_error);
+    EXPECT_THROWS_AS(x % zero, std::domain_error);
+    EXPECT_THROWS_AS(divmod(x, zero), std::domain_error);
+    EXPECT_THROWS_AS(x % BasicTimeDelta<nanoseconds>(nanoseconds(0)), std::domain_error);
+
+    EXPECT((-x).to_duration() == seconds(-7));
+    EXPECT((+y).to_duration() == seconds(-2));
+    EXPECT(abs(y) == TimeDelta(seconds(2)));
+    EXPECT(abs(x) == x);
+
+    EXPECT(y < x);
+    EXPECT(x > y);
+    EXPECT(x <= x);
+    EXPECT(x >= x);
+    EXPECT(x != y);
+    EXPECT(TimeDelta(microseconds(1)) == BasicTimeDelta<nanoseconds>(nanoseconds(1000)));
+    EXPECT(TimeDelta(microseconds(1)) > BasicTimeDelta<nanoseconds>(nanoseconds(999)));
+    EXPECT((BasicTimeDelta<nanoseconds>(nanoseconds(1500)) % TimeDelta(microseconds(1))).to_duration() == nanoseconds(500));
+
+    auto z = x;
+    z += y;
+    EXPECT(z == TimeDelta(seconds(5)));
+    z -= y;
+    z *= 3;
+    EXPECT(z == TimeDelta(seconds(21)));
+    z /= 2;
+    EXPECT(z == TimeDelta(milliseconds(10500)));
+    z %= TimeDelta(seconds(4));
+    EXPECT(z == TimeDelta(milliseconds(2500)));
+
+    EXPECT(TimeDelta::resolution().to_duration() == microseconds(1));
+    EXPECT(TimeDelta::min() < TimeDelta::max());
+
+    std::unordered_map<TimeDelta, int> counts;
+    for (int i = 0; i < 10; ++i)
+    {
+        ++counts[TimeDelta(seconds(i % 3))];
+    }
+    EXPECT(counts.size() == 3u);
+    EXPECT(counts[TimeDelta(seconds(0))] == 4);
+}
+
+CASE("constexpr and literals" "[timedelta]") 
+{
+    using namespace datetime::literals;
+
+    static constexpr TimeDelta table[] = {15_min, 1_h + 30_min, TimeDelta(2_days, 250_ms), 3 * 20_s};
+    static_assert(table[0].seconds() == 900, "15_min");
+    static_assert(table[1].seconds() == 5400, "1_h + 30_min");
+    static_assert(table[2].days() == 2 && table[2].microseconds() == 250000, "2_days, 250_ms");
+    static_assert(table[3].total_seconds() == 60, "3 * 20_s");
+
+    constexpr TimeDelta td(1_h, 30_min, 1500_us);
+    static_assert((td - 1_h).seconds() == 1800 && (td - 1_h).microseconds() == 1500, "difference");
+    static_assert(TimeDelta(date::days(-1), 1_s).seconds() == 1, "normalized as in Python");
+
+    EXPECT(table[1].str() == "1:30:00");
+    EXPECT(TimeDelta(std::chrono::nanoseconds(600), std::chrono::nanoseconds(600)).microseconds() == 1);
+
+    constexpr BasicTimeDelta<nanoseconds> nd(1_s, 5_us, nanoseconds(7));
+    static_assert((nd + td).to_duration() == nanoseconds(5401001505007), "mixed precisions");
+    static_assert(td / 3 < td && floor_div(td, TimeDelta(1_min)) == 90 && -td == TimeDelta(-td.to_duration()), "operators");
+}
+
+} // anonymous namespace
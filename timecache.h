@@ -0,0 +1,353 @@
+#ifndef DATETIME_TIMECACHE_H
+#define DATETIME_TIMECACHE_H
+
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Florian Dang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "datetime.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace datetime
+{
+// TimeCache
+// Current time rendered once per second for a set of registered formats, in
+// the spirit of nginx cached time strings. Reading costs a clock read, a copy
+// of the pre-rendered string and a patch of the sub-second digits.
+//
+// Formats are registered with add_format() before the cache is shared between
+// threads. Readers never block: the strings live in a ring of slots published
+// through an atomic index, each slot guarded by a sequence counter. The cache
+// is refreshed lazily by the first reader seeing a new second, or ahead of
+// time by the optional ticker thread.
+class TimeCache
+{
+public:
+    static const std::size_t max_length = 64; // longer renderings are truncated
+
+    TimeCache(const date::time_zone* zone = nullptr); // nullptr means UTC
+    ~TimeCache();
+
+    TimeCache(const TimeCache&) = delete;
+    TimeCache& operator=(const TimeCache&) = delete;
+
+    // subsecond_digits (0 to 9) digits are inserted after the first %S
+    std::size_t add_format(const std::string& format, unsigned subsecond_digits = 0);
+
+    // buf must hold at least max_length chars, returns the length written
+    std::size_t copy(std::size_t id, char* buf) const;
+    std::string str(std::size_t id) const;
+
+    void refresh() const;
+
+    void start_ticker();
+    void stop_ticker();
+
+private:
+    static const std::size_t num_slots = 8;
+
+    struct Format
+    {
+        std::string prefix; // up to and including %S
+        std::string suffix;
+        unsigned digits;
+    };
+
+    struct Rendered
+    {
+        std::size_t length;
+        std::size_t fraction; // position of the sub-second digits
+    };
+
+    struct Slot
+    {
+        std::atomic<unsigned> seq{0}; // odd while being written
+        date::sys_seconds second{};
+    };
+
+    using Clock = std::chrono::system_clock;
+
+    const date::time_zone* zone_;
+    std::vector<Format> formats_;
+
+    mutable Slot slots_[num_slots];
+    mutable std::vector<char> data_;          // num_slots * formats * max_length
+    mutable std::vector<Rendered> rendered_;  // num_slots * formats
+    mutable std::atomic<std::size_t> current_{0};
+    mutable std::atomic<bool> updating_{false};
+
+    std::thread ticker_;
+    std::mutex ticker_mutex_;
+    std::condition_variable ticker_cv_;
+    bool ticker_stop_ = false;
+
+    bool update(date::sys_seconds second) const;
+    Rendered render(std::size_t id, date::sys_seconds second, char* buf) const;
+    std::size_t render_now(std::size_t id, Clock::time_point now, char* buf) const;
+    static void patch_fraction(char* buf, const Rendered& r, unsigned digits,
+                               Clock::duration subsecond);
+};
+
+
+// TimeCache impl
+
+inline
+TimeCache::TimeCache(const date::time_zone* zone)
+    : zone_(zone)
+    {}
+
+inline
+TimeCache::~TimeCache()
+{
+    stop_ticker();
+}
+
+inline
+std::size_t TimeCache::add_format(const std::string& format, unsigned subsecond_digits)
+{
+    if (subsecond_digits > 9)
+    {
+        throw std::invalid_argument("TimeCache: at most 9 sub-second digits");
+    }
+    Format f{format, "", subsecond_digits};
+    if (subsecond_digits > 0)
+    {
+        // find the first %S which is not an escaped %%S
+        std::size_t i = 0;
+        for (; i + 1 < format.size(); ++i)
+        {
+            if (format[i] == '%')
+            {
+                if (format[i+1] == 'S')
+                {
+                    break;
+                }
+                ++i;
+            }
+        }
+        if (i + 1 >= format.size())
+        {
+            throw std::invalid_argument("TimeCache: sub-second digits require %S in format");
+        }
+        f.prefix = format.substr(0, i + 2);
+        f.suffix = format.substr(i + 2);
+    }
+    formats_.push_back(f);
+
+    // start again from empty slots so that the next read renders all formats
+    data_.assign(num_slots * formats_.size() * max_length, '\0');
+    rendered_.assign(num_slots * formats_.size(), Rendered{0, 0});
+    for (auto& slot : slots_)
+    {
+        slot.second = date::sys_seconds{};
+    }
+    update(date::floor<std::chrono::seconds>(Clock::now()));
+    return formats_.size() - 1;
+}
+
+inline
+TimeCache::Rendered TimeCache::render(std::size_t id, date::sys_seconds second, char* buf) const
+{
+    const Format& f = formats_[id];
+    std::string s;
+    if (zone_ == nullptr)
+    {
+        s = detail::format_c_locale(f.prefix.c_str(), second);
+    }
+    else
+    {
+        s = detail::format_c_locale(f.prefix.c_str(), date::make_zoned(zone_, second));
+    }
+    Rendered r{0, s.size() + 1};
+    if (f.digits > 0)
+    {
+        s += '.';
+        s.append(f.digits, '0');
+        if (zone_ == nullptr)
+        {
+            s += detail::format_c_locale(f.suffix.c_str(), second);
+        }
+        else
+        {
+            s += detail::format_c_locale(f.suffix.c_str(), date::make_zoned(zone_, second));
+        }
+    }
+    r.length = std::min(s.size(), static_cast<std::size_t>(max_length));
+    if (r.fraction + f.digits > r.length)
+    {
+        r.fraction = r.length; // digits were truncated away
+    }
+    std::memcpy(buf, s.data(), r.length);
+    return r;
+}
+
+inline
+bool TimeCache::update(date::sys_seconds second) const
+{
+    if (updating_.exchange(true, std::memory_order_acquire))
+    {
+        return false; // somebody else is refreshing
+    }
+    auto next = (current_.load(std::memory_order_relaxed) + 1) % num_slots;
+    Slot& slot = slots_[next];
+    slot.seq.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.second = second;
+    for (std::size_t id = 0; id < formats_.size(); ++id)
+    {
+        auto k = next * formats_.size() + id;
+        rendered_[k] = render(id, second, &data_[k * max_length]);
+    }
+
+    slot.seq.fetch_add(1, std::memory_order_release);
+    current_.store(next, std::memory_order_release);
+    updating_.store(false, std::memory_order_release);
+    return true;
+}
+
+inline
+void TimeCache::patch_fraction(char* buf, const Rendered& r, unsigned digits,
+                               Clock::duration subsecond)
+{
+    if (digits == 0 || r.fraction >= r.length)
+    {
+        return;
+    }
+    auto x = static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(subsecond).count());
+    for (unsigned i = digits; i < 9; ++i)
+    {
+        x /= 10;
+    }
+    for (unsigned i = digits; i > 0; --i)
+    {
+        buf[r.fraction + i - 1] = static_cast<char>('0' + x % 10);
+        x /= 10;
+    }
+}
+
+inline
+std::size_t TimeCache::render_now(std::size_t id, Clock::time_point now, char* buf) const
+{
+    auto second = date::floor<std::chrono::seconds>(now);
+    auto r = render(id, second, buf);
+    patch_fraction(buf, r, formats_[id].digits, now - second);
+    return r.length;
+}
+
+inline
+std::size_t TimeCache::copy(std::size_t id, char* buf) const
+{
+    auto now = Clock::now();
+    auto second = date::floor<std::chrono::seconds>(now);
+    while (true)
+    {
+        auto index = current_.load(std::memory_order_acquire);
+        const Slot& slot = slots_[index];
+        auto seq = slot.seq.load(std::memory_order_acquire);
+        if (seq & 1)
+        {
+            continue;
+        }
+        if (slot.second != second)
+        {
+            if (slot.second < second && update(second))
+            {
+                continue;
+            }
+            return render_now(id, now, buf); // rare: concurrent refresh or clock step
+        }
+        auto k = index * formats_.size() + id;
+        Rendered r = rendered_[k];
+        std::memcpy(buf, &data_[k * max_length], r.length);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) != seq)
+        {
+            continue;
+        }
+        patch_fraction(buf, r, formats_[id].digits, now - second);
+        return r.length;
+    }
+}
+
+inline
+std::string TimeCache::str(std::size_t id) const
+{
+    char buf[max_length];
+    return std::string(buf, copy(id, buf));
+}
+
+inline
+void TimeCache::refresh() const
+{
+    auto second = date::floor<std::chrono::seconds>(Clock::now());
+    if (slots_[current_.load(std::memory_order_acquire)].second != second)
+    {
+        update(second);
+    }
+}
+
+inline
+void TimeCache::start_ticker()
+{
+    if (ticker_.joinable())
+    {
+        return;
+    }
+    ticker_stop_ = false;
+    ticker_ = std::thread([this] {
+        std::unique_lock<std::mutex> lock(ticker_mutex_);
+        while (!ticker_stop_)
+        {
+            refresh();
+            auto next = date::floor<std::chrono::seconds>(Clock::now()) + std::chrono::seconds(1);
+            ticker_cv_.wait_until(lock, next, [this] { return ticker_stop_; });
+        }
+    });
+}
+
+inline
+void TimeCache::stop_ticker()
+{
+    if (!ticker_.joinable())
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(ticker_mutex_);
+        ticker_stop_ = true;
+    }
+    ticker_cv_.notify_all();
+    ticker_.join();
+}
+
+} // namespace datetime
+
+#endif // DATETIME_TIMECACHE_H